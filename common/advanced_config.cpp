@@ -81,6 +81,16 @@ static const wxChar DRCEpsilon[] = wxT( "DRCEpsilon" );
 static const wxChar DRCSliverWidthTolerance[] = wxT( "DRCSliverWidthTolerance" );
 static const wxChar DRCSliverAngleTolerance[] = wxT( "DRCSliverAngleTolerance" );
 
+/**
+ * Re-run the clearance tests of DRC in the neighbourhood of each board edit.
+ */
+static const wxChar IncrementalDRC[] = wxT( "IncrementalDRC" );
+
+/**
+ * Collect per-provider and per-rule timings of each DRC run (see the KICAD_DRC_PROFILE trace).
+ */
+static const wxChar DRCProfile[] = wxT( "DRCProfile" );
+
 /**
  * Used to calculate the actual hole size from the finish hole size.
  * IPC-6012 says 0.015-0.018mm; Cadence says at least 0.020mm for a Class 2 board and at least
@@ -281,6 +291,8 @@ ADVANCED_CFG::ADVANCED_CFG()
                                             // any constraints.
     m_SliverWidthTolerance      = 0.08;
     m_SliverAngleTolerance      = 20.0;
+    m_IncrementalDRC            = false;
+    m_DRCProfile                = false;
 
     m_HoleWallThickness         = 0.020;    // IPC-6012 says 15-18um; Cadence says at least
                                             // 0.020 for a Class 2 board and at least 0.025
@@ -356,6 +368,12 @@ void ADVANCED_CFG::loadSettings( wxConfigBase& aCfg )
     configParams.push_back( new PARAM_CFG_DOUBLE( true, AC_KEYS::DRCSliverAngleTolerance,
                                                   &m_SliverAngleTolerance, 20.0, 1.0, 90.0 ) );
 
+    configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::IncrementalDRC,
+                                                &m_IncrementalDRC, false ) );
+
+    configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::DRCProfile,
+                                                &m_DRCProfile, false ) );
+
     configParams.push_back( new PARAM_CFG_DOUBLE( true, AC_KEYS::HoleWallThickness,
                                                   &m_HoleWallThickness, 0.020, 0.0, 1.0 ) );
 
@@ -22,6 +22,7 @@
 #include <set>
 #include <vector>
 #include <algorithm>
+#include <deque>
 
 #include <string_utils.h>
 #include <wx/log.h>
@@ -798,6 +799,7 @@ bool COMPILER::generateUCode( UCODE* aCode, CONTEXT* aPreflightContext )
         std::unique_ptr<VALUE> val = std::make_unique<VALUE>( 1.0 );
         // Empty expression returns true
         aCode->AddOp( new UOP( TR_UOP_PUSH_VALUE, std::move(val) ) );
+        aCode->Link();
         return true;
     }
 
@@ -956,6 +958,7 @@ bool COMPILER::generateUCode( UCODE* aCode, CONTEXT* aPreflightContext )
                         stack.push_back( pnode );
 
                     node->leaf[1]->SetUop( TR_OP_METHOD_CALL, func, std::move( vref ) );
+                    node->leaf[1]->uop->SetArgCount( (int) params.size() );
                     node->isTerminal = false;
                     break;
                 }
@@ -1080,10 +1083,36 @@ bool COMPILER::generateUCode( UCODE* aCode, CONTEXT* aPreflightContext )
 
     libeval_dbg(2,"dump: \n%s\n", aCode->Dump().c_str() );
 
+    aCode->Link();
+
     return true;
 }
 
 
+static double evalBinaryOp( CONTEXT* aCtx, int aOp, const VALUE* arg1, const VALUE* arg2 )
+{
+    double arg2Value = arg2 ? arg2->AsDouble() : 0.0;
+    double arg1Value = arg1 ? arg1->AsDouble() : 0.0;
+
+    switch( aOp )
+    {
+    case TR_OP_ADD:           return arg1Value + arg2Value;
+    case TR_OP_SUB:           return arg1Value - arg2Value;
+    case TR_OP_MUL:           return arg1Value * arg2Value;
+    case TR_OP_DIV:           return arg1Value / arg2Value;
+    case TR_OP_LESS_EQUAL:    return arg1Value <= arg2Value ? 1 : 0;
+    case TR_OP_GREATER_EQUAL: return arg1Value >= arg2Value ? 1 : 0;
+    case TR_OP_LESS:          return arg1Value < arg2Value ? 1 : 0;
+    case TR_OP_GREATER:       return arg1Value > arg2Value ? 1 : 0;
+    case TR_OP_EQUAL:         return arg1 && arg2 && arg1->EqualTo( aCtx, arg2 ) ? 1 : 0;
+    case TR_OP_NOT_EQUAL:     return arg1 && arg2 && arg1->NotEqualTo( aCtx, arg2 ) ? 1 : 0;
+    case TR_OP_BOOL_AND:      return arg1Value != 0.0 && arg2Value != 0.0 ? 1 : 0;
+    case TR_OP_BOOL_OR:       return arg1Value != 0.0 || arg2Value != 0.0 ? 1 : 0;
+    default:                  return 0.0;
+    }
+}
+
+
 void UOP::Exec( CONTEXT* ctx )
 {
     switch( m_op )
@@ -1115,9 +1144,6 @@ void UOP::Exec( CONTEXT* ctx )
     {
         LIBEVAL::VALUE* arg2 = ctx->Pop();
         LIBEVAL::VALUE* arg1 = ctx->Pop();
-        double          arg2Value = arg2 ? arg2->AsDouble() : 0.0;
-        double          arg1Value = arg1 ? arg1->AsDouble() : 0.0;
-        double          result;
 
         if( ctx->HasErrorCallback() )
         {
@@ -1135,51 +1161,8 @@ void UOP::Exec( CONTEXT* ctx )
             }
         }
 
-        switch( m_op )
-        {
-        case TR_OP_ADD:
-            result = arg1Value + arg2Value;
-            break;
-        case TR_OP_SUB:
-            result = arg1Value - arg2Value;
-            break;
-        case TR_OP_MUL:
-            result = arg1Value * arg2Value;
-            break;
-        case TR_OP_DIV:
-            result = arg1Value / arg2Value;
-            break;
-        case TR_OP_LESS_EQUAL:
-            result = arg1Value <= arg2Value ? 1 : 0;
-            break;
-        case TR_OP_GREATER_EQUAL:
-            result = arg1Value >= arg2Value ? 1 : 0;
-            break;
-        case TR_OP_LESS:
-            result = arg1Value < arg2Value ? 1 : 0;
-            break;
-        case TR_OP_GREATER:
-            result = arg1Value > arg2Value ? 1 : 0;
-            break;
-        case TR_OP_EQUAL:
-            result = arg1 && arg2 && arg1->EqualTo( ctx, arg2 ) ? 1 : 0;
-            break;
-        case TR_OP_NOT_EQUAL:
-            result = arg1 && arg2 && arg1->NotEqualTo( ctx, arg2 ) ? 1 : 0;
-            break;
-        case TR_OP_BOOL_AND:
-            result = arg1Value != 0.0 && arg2Value != 0.0 ? 1 : 0;
-            break;
-        case TR_OP_BOOL_OR:
-            result = arg1Value != 0.0 || arg2Value != 0.0 ? 1 : 0;
-            break;
-        default:
-            result = 0.0;
-            break;
-        }
-
         auto rp = ctx->AllocValue();
-        rp->Set( result );
+        rp->Set( evalBinaryOp( ctx, m_op, arg1, arg2 ) );
         ctx->Push( rp );
         return;
     }
@@ -1207,17 +1190,284 @@ void UOP::Exec( CONTEXT* ctx )
 }
 
 
+struct VM_PROGRAM::NODE
+{
+    UOP*             uop;
+    int              left;      ///< operand nodes, or -1
+    int              right;
+    std::vector<int> args;      ///< argument nodes of a method call
+};
+
+
+std::unique_ptr<VM_PROGRAM> VM_PROGRAM::Build( const std::vector<UOP*>& aCode )
+{
+    std::vector<NODE> nodes;
+    std::vector<int>  stack;
+
+    // Replay the stack code symbolically to recover the expression tree
+    for( UOP* op : aCode )
+    {
+        NODE node = { op, -1, -1, {} };
+
+        switch( op->m_op )
+        {
+        case TR_UOP_PUSH_VAR:
+            break;
+
+        case TR_UOP_PUSH_VALUE:
+            // Bare identifiers push no value at all
+            if( !op->m_value )
+                return nullptr;
+
+            break;
+
+        case TR_OP_METHOD_CALL:
+            if( !op->m_func || op->m_argCount < 0 || (int) stack.size() < op->m_argCount )
+                return nullptr;
+
+            node.args.assign( stack.end() - op->m_argCount, stack.end() );
+            stack.resize( stack.size() - op->m_argCount );
+            break;
+
+        case TR_OP_BOOL_NOT:
+            if( stack.empty() )
+                return nullptr;
+
+            node.left = stack.back();
+            stack.pop_back();
+            break;
+
+        default:
+            // Anything else the stack interpreter doesn't treat as a binary operator is either
+            // a no-op or unknown, and left to it
+            if( !( op->m_op & TR_OP_BINARY_MASK ) || stack.size() < 2 )
+                return nullptr;
+
+            node.right = stack.back();
+            stack.pop_back();
+            node.left = stack.back();
+            stack.pop_back();
+            break;
+        }
+
+        nodes.push_back( std::move( node ) );
+        stack.push_back( (int) nodes.size() - 1 );
+    }
+
+    if( stack.size() != 1 )
+        return nullptr;
+
+    std::unique_ptr<VM_PROGRAM> program( new VM_PROGRAM() );
+
+    program->m_result = program->emit( nodes, stack.back() );
+
+    return program;
+}
+
+
+int VM_PROGRAM::emit( const std::vector<NODE>& aNodes, int aNode )
+{
+    const NODE& node = aNodes[ aNode ];
+    INSTRUCTION instr = { VM_BINARY, node.uop->m_op, 0, 0, 0, node.uop };
+
+    switch( node.uop->m_op )
+    {
+    case TR_UOP_PUSH_VALUE:
+        m_constants.push_back( node.uop->m_value.get() );
+        return constant( (int) m_constants.size() - 1 );
+
+    case TR_UOP_PUSH_VAR:
+        instr.op = VM_LOAD_VAR;
+        break;
+
+    case TR_OP_METHOD_CALL:
+    {
+        std::vector<int> args;
+
+        for( int arg : node.args )
+            args.push_back( emit( aNodes, arg ) );
+
+        instr.op = VM_METHOD_CALL;
+        instr.b = (int) m_callArgs.size();
+
+        m_callArgs.push_back( (int) args.size() );
+        m_callArgs.insert( m_callArgs.end(), args.begin(), args.end() );
+        break;
+    }
+
+    case TR_OP_BOOL_NOT:
+        instr.op = VM_NOT;
+        instr.a = emit( aNodes, node.left );
+        break;
+
+    case TR_OP_BOOL_AND:
+    case TR_OP_BOOL_OR:
+    {
+        int    dst = m_registerCount++;
+        int    left = emit( aNodes, node.left );
+        size_t jump = m_code.size();
+
+        m_code.push_back( { node.uop->m_op == TR_OP_BOOL_AND ? VM_JUMP_IF_FALSE : VM_JUMP_IF_TRUE,
+                            0, dst, left, 0, node.uop } );
+
+        int right = emit( aNodes, node.right );
+
+        m_code.push_back( { VM_TEST, 0, dst, right, 0, node.uop } );
+        m_code[ jump ].b = (int) m_code.size();
+        return dst;
+    }
+
+    default:
+        instr.a = emit( aNodes, node.left );
+        instr.b = emit( aNodes, node.right );
+        break;
+    }
+
+    instr.dst = m_registerCount++;
+    m_code.push_back( instr );
+    return instr.dst;
+}
+
+
+const VALUE* VM_PROGRAM::Run( CONTEXT* aCtx ) const
+{
+    // Register files are kept per thread, and per nesting level in case a method call
+    // evaluates another expression.  A deque doesn't move the ones in use as it grows.
+    thread_local std::deque<std::vector<VALUE>> registerFiles;
+    thread_local size_t                         depth = 0;
+
+    struct NESTING
+    {
+        NESTING( size_t& aDepth ) : m_depth( aDepth ) { ++m_depth; }
+        ~NESTING() { --m_depth; }
+
+        size_t& m_depth;
+    };
+
+    if( registerFiles.size() <= depth )
+        registerFiles.emplace_back();
+
+    std::vector<VALUE>& registers = registerFiles[ depth ];
+    NESTING             nesting( depth );
+
+    if( (int) registers.size() < m_registerCount )
+        registers.resize( m_registerCount );
+
+    auto operand =
+            [&]( int aOperand ) -> VALUE*
+            {
+                if( aOperand >= 0 )
+                    return &registers[ aOperand ];
+                else
+                    return m_constants[ -1 - aOperand ];
+            };
+
+    for( size_t pc = 0; pc < m_code.size(); )
+    {
+        const INSTRUCTION& instr = m_code[ pc++ ];
+        VALUE&             dst = registers[ instr.dst ];
+
+        switch( instr.op )
+        {
+        case VM_LOAD_VAR:
+            if( instr.uop->m_ref )
+                instr.uop->m_ref->FetchValue( aCtx, dst );
+            else
+                dst.Clear();
+
+            break;
+
+        case VM_METHOD_CALL:
+        {
+            const int* args = &m_callArgs[ instr.b ];
+            int        sp = aCtx->SP();
+
+            for( int ii = 1; ii <= args[0]; ++ii )
+                aCtx->Push( operand( args[ii] ) );
+
+            aCtx->LendValue( &dst );
+            instr.uop->m_func( aCtx, instr.uop->m_ref.get() );
+            aCtx->LendValue( nullptr );
+
+            // A method which didn't consume exactly its arguments leaves the stack interpreter
+            // with a corrupt stack, which fails the expression
+            if( aCtx->SP() != sp + 1 )
+            {
+                while( aCtx->SP() > sp )
+                    aCtx->Pop();
+
+                return nullptr;
+            }
+
+            VALUE* result = aCtx->Pop();
+
+            if( result != &dst )
+                dst.Set( *result );
+
+            break;
+        }
+
+        case VM_BINARY:
+            dst.Set( evalBinaryOp( aCtx, instr.binaryOp, operand( instr.a ),
+                                   operand( instr.b ) ) );
+            break;
+
+        case VM_NOT:
+            dst.Set( operand( instr.a )->AsDouble() != 0.0 ? 0.0 : 1.0 );
+            break;
+
+        case VM_JUMP_IF_FALSE:
+            if( operand( instr.a )->AsDouble() == 0.0 )
+            {
+                dst.Set( 0.0 );
+                pc = instr.b;
+            }
+
+            break;
+
+        case VM_JUMP_IF_TRUE:
+            if( operand( instr.a )->AsDouble() != 0.0 )
+            {
+                dst.Set( 1.0 );
+                pc = instr.b;
+            }
+
+            break;
+
+        case VM_TEST:
+            dst.Set( operand( instr.a )->AsDouble() != 0.0 ? 1.0 : 0.0 );
+            break;
+        }
+    }
+
+    return operand( m_result );
+}
+
+
 VALUE* UCODE::Run( CONTEXT* ctx )
 {
     static VALUE g_false( 0 );
 
     try
     {
+        // Runs with an error callback stay on the stack interpreter, which evaluates every
+        // operand and so reports every problem
+        if( m_program && !ctx->HasErrorCallback() )
+        {
+            if( const VALUE* result = m_program->Run( ctx ) )
+                return ctx->StoreResult( *result );
+
+            return &g_false;
+        }
+
         for( UOP* op : m_ucode )
             op->Exec( ctx );
     }
     catch(...)
     {
+        // A method call may have thrown while holding a register
+        ctx->LendValue( nullptr );
+
         // rules which fail outright should not be fired
         return &g_false;
     }
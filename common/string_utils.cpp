@@ -693,27 +693,23 @@ bool WildCompareString( const wxString& pattern, const wxString& string_to_tst,
                         bool case_sensitive )
 {
     const wxChar* cp = nullptr, * mp = nullptr;
-    const wxChar* wild, * str;
-    wxString      _pattern, _string_to_tst;
+    const wxChar* wild = pattern.wc_str();
+    const wxChar* str = string_to_tst.wc_str();
 
-    if( case_sensitive )
-    {
-        wild = pattern.GetData();
-        str = string_to_tst.GetData();
-    }
-    else
-    {
-        _pattern = pattern;
-        _pattern.MakeUpper();
-        _string_to_tst = string_to_tst;
-        _string_to_tst.MakeUpper();
-        wild   = _pattern.GetData();
-        str = _string_to_tst.GetData();
-    }
+    // Characters are folded as they are compared rather than by upper-casing copies of both
+    // strings, so that rule evaluation doesn't allocate on every wildcard match
+    auto matches =
+            [&]( wxChar aWild, wxChar aChar )
+            {
+                if( aWild == '?' || aWild == aChar )
+                    return true;
+
+                return !case_sensitive && wxToupper( aWild ) == wxToupper( aChar );
+            };
 
     while( ( *str ) && ( *wild != '*' ) )
     {
-        if( ( *wild != *str ) && ( *wild != '?' ) )
+        if( !matches( *wild, *str ) )
             return false;
 
         wild++;
@@ -729,7 +725,7 @@ bool WildCompareString( const wxString& pattern, const wxString& string_to_tst,
             mp = wild;
             cp = str + 1;
         }
-        else if( ( *wild == *str ) || ( *wild == '?' ) )
+        else if( matches( *wild, *str ) )
         {
             wild++;
             str++;
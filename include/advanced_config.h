@@ -107,6 +107,17 @@ public:
     double m_SliverWidthTolerance;
     double m_SliverAngleTolerance;
 
+    /**
+     * Re-run the clearance tests of DRC around each edit of the board.
+     */
+    bool m_IncrementalDRC;
+
+    /**
+     * Time every DRC run by provider and by rule, and write the report to the
+     * KICAD_DRC_PROFILE trace.
+     */
+    bool m_DRCProfile;
+
     /**
      * Hole wall plating thickness.  Used to determine actual hole size from finish hole size.
      * Units are mm.
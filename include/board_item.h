@@ -53,13 +53,28 @@ public:
     BOARD_ITEM( BOARD_ITEM* aParent, KICAD_T idtype ) :
             EDA_ITEM( aParent, idtype ),
             m_layer( F_Cu ),
-            m_group( nullptr )
+            m_group( nullptr ),
+            m_geometryRevision( nextGeometryRevision() )
     {
     }
 
     void SetParentGroup( PCB_GROUP* aGroup ) { m_group = aGroup; }
     PCB_GROUP* GetParentGroup() const { return m_group; }
 
+    /**
+     * Return a value identifying the current geometry of the item.
+     *
+     * It is unique across all items and changes whenever the board is notified that the item
+     * was modified (see BOARD::OnItemChanged()).  Used to validate cached geometric results
+     * such as DRC distances.
+     */
+    uint64_t GetGeometryRevision() const { return m_geometryRevision; }
+
+    /**
+     * Give the item a new geometry revision, invalidating any cached geometric results.
+     */
+    void BumpGeometryRevision() { m_geometryRevision = nextGeometryRevision(); }
+
     // Do not create a copy constructor & operator=.
     // The ones generated by the compiler are adequate.
     int GetX() const
@@ -326,8 +341,11 @@ protected:
      */
     virtual wxString layerMaskDescribe() const;
 
+    static uint64_t nextGeometryRevision();
+
     PCB_LAYER_ID    m_layer;
     PCB_GROUP*      m_group;
+    uint64_t        m_geometryRevision;
 };
 
 #ifndef SWIG
@@ -24,8 +24,10 @@
 #include <cstddef>
 #include <functional>
 #include <map>
+#include <memory>
 #include <string>
 #include <stack>
+#include <vector>
 
 #include <base_units.h>
 #include <wx/intl.h>
@@ -245,6 +247,8 @@ public:
     {
         m_type = VT_NUMERIC;
         m_valueDbl = aValue;
+        m_isDeferredDbl = false;
+        m_isDeferredStr = false;
     }
 
     void SetDeferredEval( std::function<double()> aLambda )
@@ -261,19 +265,39 @@ public:
         m_isDeferredStr = true;
     }
 
+    /**
+     * Assigning into an existing VALUE reuses its string buffer when that is large enough.
+     */
     void Set( const wxString& aValue )
     {
         m_type = VT_STRING;
         m_valueStr = aValue;
+        m_isDeferredDbl = false;
+        m_isDeferredStr = false;
     }
 
     void Set( const VALUE &val )
     {
         m_type = val.m_type;
-        m_valueDbl = val.m_valueDbl;
+        m_valueDbl = val.AsDouble();
+        m_isDeferredDbl = false;
+        m_isDeferredStr = false;
 
         if( m_type == VT_STRING )
-            m_valueStr = val.m_valueStr;
+            m_valueStr = val.AsString();
+    }
+
+    /**
+     * Return to the undefined state, keeping the string buffer for reuse.
+     */
+    void Clear()
+    {
+        m_type = VT_UNDEFINED;
+        m_valueDbl = 0;
+        m_valueStr.clear();
+        m_stringIsWildcard = false;
+        m_isDeferredDbl = false;
+        m_isDeferredStr = false;
     }
 
 private:
@@ -297,6 +321,16 @@ public:
 
     virtual VAR_TYPE_T GetType() const = 0;
     virtual VALUE GetValue( CONTEXT* aCtx ) = 0;
+
+    /**
+     * Store the value in \a aResult.  The register machine keeps its registers from run to
+     * run, so references which can assign their value in place avoid building a temporary
+     * VALUE (and a string copy) on each evaluation.
+     */
+    virtual void FetchValue( CONTEXT* aCtx, VALUE& aResult )
+    {
+        aResult.Set( GetValue( aCtx ) );
+    }
 };
 
 
@@ -305,9 +339,9 @@ class CONTEXT
 public:
     CONTEXT() :
         m_stack(),
-        m_stackPtr( 0 )
+        m_stackPtr( 0 ),
+        m_lentValue( nullptr )
     {
-        m_ownedValues.reserve( 20 );
     }
 
     virtual ~CONTEXT()
@@ -320,15 +354,47 @@ public:
 
     VALUE* AllocValue()
     {
+        if( m_lentValue )
+        {
+            VALUE* value = m_lentValue;
+            m_lentValue = nullptr;
+            value->Clear();
+            return value;
+        }
+
+        // Reserved on first use, as contexts evaluated by the register machine usually never
+        // get here
+        if( m_ownedValues.empty() )
+            m_ownedValues.reserve( 20 );
+
         m_ownedValues.emplace_back( new VALUE );
         return m_ownedValues.back();
     }
 
+    /**
+     * Have the next AllocValue() hand out \a aValue (cleared) rather than a new VALUE.  The
+     * register machine uses this to let a method call write its result into a register.
+     */
+    void LendValue( VALUE* aValue )
+    {
+        m_lentValue = aValue;
+    }
+
     void Push( VALUE* v )
     {
         m_stack[ m_stackPtr++ ] = v;
     }
 
+    /**
+     * Hold a copy of \a aValue for the lifetime of the context (or until the next call).
+     */
+    VALUE* StoreResult( const VALUE& aValue )
+    {
+        m_result = VALUE();
+        m_result.Set( aValue );
+        return &m_result;
+    }
+
     VALUE* Pop()
     {
         if( m_stackPtr == 0 )
@@ -358,11 +424,83 @@ private:
     std::vector<VALUE*> m_ownedValues;
     VALUE*              m_stack[100];       // std::stack not performant enough
     int                 m_stackPtr;
+    VALUE*              m_lentValue;
+    VALUE               m_result;
 
     std::function<void( const wxString& aMessage, int aOffset )> m_errorCallback;
 };
 
 
+/**
+ * Register machine form of a UCODE program.
+ *
+ * The stack code is rebuilt into an expression tree and emitted as three-address
+ * instructions over a register file which each thread reuses from run to run.  Variables are
+ * fetched into their registers in place (see VAR_REF::FetchValue()) and method calls write
+ * their result into theirs (see CONTEXT::LendValue()), so once the registers have grown to
+ * fit, a run allocates nothing itself.  What is left are allocations made by the references
+ * and methods: generic properties return their value by copy, and methods which defer their
+ * result do so through a std::function.  Constants are read in place from the UOPs which
+ * own them, and && and || skip their right-hand operand when the left one decides the
+ * result.
+ */
+class VM_PROGRAM
+{
+public:
+    /**
+     * @return the program for \a aCode, or nullptr if the stack code uses something the
+     *         register machine doesn't reproduce exactly.
+     */
+    static std::unique_ptr<VM_PROGRAM> Build( const std::vector<UOP*>& aCode );
+
+    /**
+     * @return the result, valid until the next run on the same thread, or nullptr if the
+     *         evaluation failed.
+     */
+    const VALUE* Run( CONTEXT* aCtx ) const;
+
+private:
+    enum OPCODE
+    {
+        VM_LOAD_VAR,            ///< dst = ref( a )
+        VM_METHOD_CALL,         ///< dst = method( a ) called with arguments b
+        VM_BINARY,              ///< dst = a <binaryOp> b
+        VM_NOT,                 ///< dst = !a
+        VM_JUMP_IF_FALSE,       ///< if !a: dst = 0 and jump to b
+        VM_JUMP_IF_TRUE,        ///< if a: dst = 1 and jump to b
+        VM_TEST                 ///< dst = a != 0
+    };
+
+    struct INSTRUCTION
+    {
+        OPCODE op;
+        int    binaryOp;        ///< TR_OP_* for VM_BINARY
+        int    dst;             ///< register
+        int    a;               ///< operand, see operand()
+        int    b;               ///< operand, jump target or index into m_callArgs
+        UOP*   uop;             ///< source op of loads and calls
+    };
+
+    struct NODE;
+
+    VM_PROGRAM() :
+            m_registerCount( 0 ),
+            m_result( 0 )
+    {}
+
+    int emit( const std::vector<NODE>& aNodes, int aNode );
+
+    /// Registers are >= 0, constants are -1 - their index in m_constants
+    static int constant( int aIndex ) { return -1 - aIndex; }
+
+    std::vector<INSTRUCTION>  m_code;
+    std::vector<VALUE*>       m_constants;
+    std::vector<int>          m_callArgs;       ///< per call: argument count, then operands
+    int                       m_registerCount;
+    int                       m_result;         ///< operand holding the result
+};
+
+
 class UCODE
 {
 public:
@@ -371,11 +509,22 @@ public:
     void AddOp( UOP* uop )
     {
         m_ucode.push_back(uop);
+        m_program.reset();
+    }
+
+    /**
+     * Build the register machine form of the program once all ops have been added.
+     */
+    void Link()
+    {
+        m_program = VM_PROGRAM::Build( m_ucode );
     }
 
     VALUE* Run( CONTEXT* ctx );
     wxString Dump() const;
 
+    const std::vector<UOP*>& GetOps() const { return m_ucode; }
+
     virtual std::unique_ptr<VAR_REF> CreateVarRef( const wxString& var, const wxString& field )
     {
         return nullptr;
@@ -388,7 +537,8 @@ public:
 
 protected:
 
-    std::vector<UOP*> m_ucode;
+    std::vector<UOP*>           m_ucode;
+    std::unique_ptr<VM_PROGRAM> m_program;
 };
 
 
@@ -422,12 +572,35 @@ public:
 
     wxString Format() const;
 
+    /**
+     * @return the variable (or method object) read by the op, or nullptr.
+     */
+    const VAR_REF* GetRef() const { return m_ref.get(); }
+
+    bool IsFuncCall() const { return (bool) m_func; }
+
+    int GetOp() const { return m_op; }
+
+    /**
+     * @return the value pushed by a TR_UOP_PUSH_VALUE op, or nullptr.
+     */
+    VALUE* GetConstant() const { return m_value.get(); }
+
+    /**
+     * Number of arguments the compiler pushed for a method call.
+     */
+    void SetArgCount( int aCount ) { m_argCount = aCount; }
+    int GetArgCount() const { return m_argCount; }
+
 private:
+    friend class VM_PROGRAM;
+
     int                      m_op;
 
     FUNC_CALL_REF            m_func;
     std::unique_ptr<VAR_REF> m_ref;
     std::unique_ptr<VALUE>   m_value;
+    int                      m_argCount = -1;
 };
 
 class TOKENIZER
@@ -198,6 +198,14 @@ extern const wxChar* const traceEnvVars;
  */
 extern const wxChar* const traceGalProfile;
 
+/**
+ * Flag to enable output of the DRC profile report (when enabled by the DRCProfile advanced
+ * config option).
+ *
+ * Use "KICAD_DRC_PROFILE" to enable.
+ */
+extern const wxChar* const traceDrcProfile;
+
 ///@}
 
 /**
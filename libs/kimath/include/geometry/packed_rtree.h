@@ -0,0 +1,349 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __PACKED_RTREE_H
+#define __PACKED_RTREE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+/**
+ * A static, bulk-loaded 2D R-tree for read-mostly spatial queries.
+ *
+ * Items are staged with Insert() and the tree is built in one go by Build(): the items are
+ * sorted along a Hilbert curve through their bounding box centers and packed bottom-up into
+ * nodes of \a NODE_SIZE children.  All boxes live in one contiguous array, so a query touches
+ * far fewer cache lines than the pointer-based #RTree and building costs a single sort instead
+ * of one heap allocation per node.
+ *
+ * The query interface mirrors #RTree::Search(): the visitor is called with each item whose box
+ * overlaps (inclusively) the query box and returns false to stop the search.
+ *
+ * The tree cannot be modified after Build(); call Clear() and rebuild instead.
+ */
+template <class DATATYPE, class ELEMTYPE = int, int NODE_SIZE = 16>
+class PACKED_RTREE
+{
+public:
+    PACKED_RTREE() :
+            m_built( false )
+    {}
+
+    /**
+     * Stage an item for the next Build().
+     */
+    void Insert( const ELEMTYPE aMin[2], const ELEMTYPE aMax[2], const DATATYPE& aData )
+    {
+        m_boxes.push_back( { aMin[0], aMin[1], aMax[0], aMax[1] } );
+        m_items.push_back( aData );
+        m_built = false;
+    }
+
+    /**
+     * Pack all staged items into the tree.
+     */
+    void Build()
+    {
+        m_levelBounds.clear();
+        m_nodeBoxes.clear();
+
+        const size_t count = m_items.size();
+
+        if( count == 0 )
+        {
+            m_built = true;
+            return;
+        }
+
+        BOX extents = m_boxes[0];
+
+        for( const BOX& box : m_boxes )
+            extents.Merge( box );
+
+        // Sort items by the Hilbert index of their center
+        std::vector<uint32_t> hilbert( count );
+        double width = double( extents.maxX ) - extents.minX;
+        double height = double( extents.maxY ) - extents.minY;
+        double scaleX = width > 0 ? 65535.0 / width : 0.0;
+        double scaleY = height > 0 ? 65535.0 / height : 0.0;
+
+        for( size_t ii = 0; ii < count; ++ii )
+        {
+            const BOX& box = m_boxes[ii];
+            double     cx = ( double( box.minX ) + box.maxX ) / 2.0 - extents.minX;
+            double     cy = ( double( box.minY ) + box.maxY ) / 2.0 - extents.minY;
+
+            hilbert[ii] = hilbertIndex( uint32_t( cx * scaleX ), uint32_t( cy * scaleY ) );
+        }
+
+        std::vector<size_t> order( count );
+        std::iota( order.begin(), order.end(), 0 );
+        std::stable_sort( order.begin(), order.end(),
+                          [&]( size_t a, size_t b )
+                          {
+                              return hilbert[a] < hilbert[b];
+                          } );
+
+        std::vector<BOX>      sortedBoxes( count );
+        std::vector<DATATYPE> sortedItems;
+        sortedItems.reserve( count );
+
+        for( size_t ii = 0; ii < count; ++ii )
+        {
+            sortedBoxes[ii] = m_boxes[order[ii]];
+            sortedItems.push_back( m_items[order[ii]] );
+        }
+
+        m_boxes = std::move( sortedBoxes );
+        m_items = std::move( sortedItems );
+
+        // Level 0 is the items themselves; every upper level groups NODE_SIZE consecutive
+        // entries of the level below.  m_levelBounds[i] is the end of level i in the combined
+        // index space (items first, then m_nodeBoxes).
+        m_levelBounds.push_back( count );
+
+        size_t levelStart = 0;
+        size_t levelEnd = count;
+
+        while( levelEnd - levelStart > 1 )
+        {
+            for( size_t ii = levelStart; ii < levelEnd; ii += NODE_SIZE )
+            {
+                BOX    nodeBox = boxAt( ii );
+                size_t last = std::min( ii + NODE_SIZE, levelEnd );
+
+                for( size_t jj = ii + 1; jj < last; ++jj )
+                    nodeBox.Merge( boxAt( jj ) );
+
+                m_nodeBoxes.push_back( nodeBox );
+            }
+
+            levelStart = levelEnd;
+            levelEnd = count + m_nodeBoxes.size();
+            m_levelBounds.push_back( levelEnd );
+        }
+
+        m_built = true;
+    }
+
+    /**
+     * Remove all items, staged or built.
+     */
+    void Clear()
+    {
+        m_boxes.clear();
+        m_items.clear();
+        m_nodeBoxes.clear();
+        m_levelBounds.clear();
+        m_built = false;
+    }
+
+    /**
+     * Call \a aVisitor for every item overlapping the box [aMin, aMax].
+     *
+     * @param aVisitor is called with each found item and returns false to stop the search.
+     * @return the number of items visited.
+     */
+    template <class VISITOR>
+    int Search( const ELEMTYPE aMin[2], const ELEMTYPE aMax[2], VISITOR& aVisitor ) const
+    {
+        if( !m_built || m_items.empty() )
+            return 0;
+
+        const BOX query = { aMin[0], aMin[1], aMax[0], aMax[1] };
+        int       found = 0;
+
+        // Nodes still to examine, as (first child index, level).  The search is depth-first,
+        // so at most NODE_SIZE - 1 siblings wait on each level and the stack can live on the
+        // call stack.  The root is the single entry of the top level.
+        std::pair<size_t, size_t> stack[( NODE_SIZE - 1 ) * maxLevels() + 1];
+        size_t                    depth = 0;
+        size_t                    topLevel = m_levelBounds.size() - 1;
+
+        stack[depth++] = { levelBegin( topLevel ), topLevel };
+
+        while( depth > 0 )
+        {
+            --depth;
+            size_t first = stack[depth].first;
+            size_t level = stack[depth].second;
+
+            size_t last = std::min( first + NODE_SIZE, m_levelBounds[level] );
+
+            for( size_t ii = first; ii < last; ++ii )
+            {
+                if( !boxAt( ii ).Overlaps( query ) )
+                    continue;
+
+                if( level == 0 )
+                {
+                    found++;
+
+                    if( !aVisitor( m_items[ii] ) )
+                        return found;
+                }
+                else
+                {
+                    size_t childLevelStart = levelBegin( level - 1 );
+                    size_t childIndex = ii - levelBegin( level );
+
+                    stack[depth++] = { childLevelStart + childIndex * NODE_SIZE, level - 1 };
+                }
+            }
+        }
+
+        return found;
+    }
+
+    int Search( const ELEMTYPE aMin[2], const ELEMTYPE aMax[2],
+                std::function<bool( const DATATYPE& )> aVisitor ) const
+    {
+        return Search<std::function<bool( const DATATYPE& )>>( aMin, aMax, aVisitor );
+    }
+
+    /**
+     * @return true if the tree has been built and no item was staged since.
+     */
+    bool IsBuilt() const { return m_built; }
+
+    size_t size() const { return m_items.size(); }
+
+    bool empty() const { return m_items.empty(); }
+
+    /**
+     * Iterate over all items, in packing order after Build().
+     */
+    typename std::vector<DATATYPE>::const_iterator begin() const { return m_items.begin(); }
+    typename std::vector<DATATYPE>::const_iterator end() const { return m_items.end(); }
+
+private:
+    static_assert( NODE_SIZE >= 2, "PACKED_RTREE nodes need at least two children" );
+
+    /**
+     * @return the number of levels of a tree of 2^32 items, the most the search stack allows.
+     */
+    static constexpr size_t maxLevels()
+    {
+        size_t levels = 1;
+
+        for( uint64_t capacity = 1; capacity < ( uint64_t( 1 ) << 32 ); capacity *= NODE_SIZE )
+            levels++;
+
+        return levels;
+    }
+
+    struct BOX
+    {
+        ELEMTYPE minX;
+        ELEMTYPE minY;
+        ELEMTYPE maxX;
+        ELEMTYPE maxY;
+
+        void Merge( const BOX& aOther )
+        {
+            minX = std::min( minX, aOther.minX );
+            minY = std::min( minY, aOther.minY );
+            maxX = std::max( maxX, aOther.maxX );
+            maxY = std::max( maxY, aOther.maxY );
+        }
+
+        bool Overlaps( const BOX& aOther ) const
+        {
+            return minX <= aOther.maxX && aOther.minX <= maxX
+                   && minY <= aOther.maxY && aOther.minY <= maxY;
+        }
+    };
+
+    const BOX& boxAt( size_t aIndex ) const
+    {
+        return aIndex < m_boxes.size() ? m_boxes[aIndex] : m_nodeBoxes[aIndex - m_boxes.size()];
+    }
+
+    size_t levelBegin( size_t aLevel ) const
+    {
+        return aLevel == 0 ? 0 : m_levelBounds[aLevel - 1];
+    }
+
+    /**
+     * Hilbert curve index of a point in a 2^16 x 2^16 grid.
+     * From "Fast Hilbert curve generation, sorting, and range queries" by rawrunprotected
+     * (public domain).
+     */
+    static uint32_t hilbertIndex( uint32_t x, uint32_t y )
+    {
+        uint32_t a = x ^ y;
+        uint32_t b = 0xFFFF ^ a;
+        uint32_t c = 0xFFFF ^ ( x | y );
+        uint32_t d = x & ( y ^ 0xFFFF );
+
+        uint32_t A = a | ( b >> 1 );
+        uint32_t B = ( a >> 1 ) ^ a;
+        uint32_t C = ( ( c >> 1 ) ^ ( b & ( d >> 1 ) ) ) ^ c;
+        uint32_t D = ( ( a & ( c >> 1 ) ) ^ ( d >> 1 ) ) ^ d;
+
+        a = A; b = B; c = C; d = D;
+        A = ( ( a & ( a >> 2 ) ) ^ ( b & ( b >> 2 ) ) );
+        B = ( ( a & ( b >> 2 ) ) ^ ( b & ( ( a ^ b ) >> 2 ) ) );
+        C ^= ( ( a & ( c >> 2 ) ) ^ ( b & ( d >> 2 ) ) );
+        D ^= ( ( b & ( c >> 2 ) ) ^ ( ( a ^ b ) & ( d >> 2 ) ) );
+
+        a = A; b = B; c = C; d = D;
+        A = ( ( a & ( a >> 4 ) ) ^ ( b & ( b >> 4 ) ) );
+        B = ( ( a & ( b >> 4 ) ) ^ ( b & ( ( a ^ b ) >> 4 ) ) );
+        C ^= ( ( a & ( c >> 4 ) ) ^ ( b & ( d >> 4 ) ) );
+        D ^= ( ( b & ( c >> 4 ) ) ^ ( ( a ^ b ) & ( d >> 4 ) ) );
+
+        a = A; b = B; c = C; d = D;
+        C ^= ( ( a & ( c >> 8 ) ) ^ ( b & ( d >> 8 ) ) );
+        D ^= ( ( b & ( c >> 8 ) ) ^ ( ( a ^ b ) & ( d >> 8 ) ) );
+
+        a = C ^ ( C >> 1 );
+        b = D ^ ( D >> 1 );
+
+        uint32_t i0 = x ^ y;
+        uint32_t i1 = b | ( 0xFFFF ^ ( i0 | a ) );
+
+        auto interleave =
+                []( uint32_t v ) -> uint32_t
+                {
+                    v = ( v | ( v << 8 ) ) & 0x00FF00FF;
+                    v = ( v | ( v << 4 ) ) & 0x0F0F0F0F;
+                    v = ( v | ( v << 2 ) ) & 0x33333333;
+                    v = ( v | ( v << 1 ) ) & 0x55555555;
+                    return v;
+                };
+
+        return ( interleave( i1 ) << 1 ) | interleave( i0 );
+    }
+
+    bool                  m_built;
+    std::vector<BOX>      m_boxes;        ///< item boxes, in packing order once built
+    std::vector<DATATYPE> m_items;
+    std::vector<BOX>      m_nodeBoxes;    ///< boxes of all internal nodes, level by level
+    std::vector<size_t>   m_levelBounds;  ///< end index of each level in the combined space
+};
+
+#endif // __PACKED_RTREE_H
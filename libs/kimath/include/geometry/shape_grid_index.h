@@ -0,0 +1,294 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __SHAPE_GRID_INDEX_H
+#define __SHAPE_GRID_INDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <geometry/shape.h>
+#include <geometry/shape_index.h>
+#include <math/box2.h>
+
+/**
+ * A uniform grid of shapes, for indexes that change all the time and are queried with small
+ * boxes.
+ *
+ * An item is stored in every cell its bounding box overlaps, along with the box, so that adding
+ * or removing it only touches a few cells and never rebalances anything, unlike #SHAPE_INDEX,
+ * and a query only reads the contiguous arrays of the cells its box overlaps.  An item met in
+ * several of these cells is only reported in the one holding the top-left corner of its overlap
+ * with the query box.  Items spanning too many cells are kept in a list of their own.
+ *
+ * The cells are hashed, so the grid doesn't need to know the extents of its contents.  They
+ * should be about as large as the typical query box.
+ *
+ * The query interface mirrors SHAPE_INDEX::Query().  The order the items are visited in is
+ * unspecified.
+ */
+template <class T = SHAPE*>
+class SHAPE_GRID_INDEX
+{
+public:
+    /**
+     * @param aCellSizeLog2 is the log2 of the cell size.
+     * @param aMaxCells is the number of cells an item may span before it is stored apart.
+     */
+    SHAPE_GRID_INDEX( int aCellSizeLog2 = 21, int aMaxCells = 256 ) :
+            m_cellSizeLog2( aCellSizeLog2 ),
+            m_maxCells( aMaxCells ),
+            m_size( 0 )
+    {}
+
+    /**
+     * Add a shape to the index.
+     */
+    void Add( T aShape )
+    {
+        Add( aShape, boundingBox( aShape ) );
+    }
+
+    /**
+     * Add a shape with an alternate bounding box.  It must be removed with the same box.
+     */
+    void Add( T aShape, const BOX2I& aBbox )
+    {
+        ENTRY entry = makeEntry( aShape, aBbox );
+        RANGE range = cellRange( entry );
+
+        if( isOversize( range ) )
+        {
+            m_oversize.push_back( entry );
+        }
+        else
+        {
+            for( int x = range.x0; x <= range.x1; x++ )
+            {
+                for( int y = range.y0; y <= range.y1; y++ )
+                    m_cells[cellKey( x, y )].push_back( entry );
+            }
+        }
+
+        m_size++;
+    }
+
+    /**
+     * Remove a shape from the index.
+     */
+    void Remove( T aShape )
+    {
+        Remove( aShape, boundingBox( aShape ) );
+    }
+
+    /**
+     * Remove a shape added with an alternate bounding box.
+     */
+    void Remove( T aShape, const BOX2I& aBbox )
+    {
+        RANGE range = cellRange( makeEntry( aShape, aBbox ) );
+        bool  found = false;
+
+        if( isOversize( range ) )
+        {
+            found = removeFromCell( m_oversize, aShape );
+        }
+        else
+        {
+            // Empty cells are kept, as the items of a routed area keep coming and going
+            for( int x = range.x0; x <= range.x1; x++ )
+            {
+                for( int y = range.y0; y <= range.y1; y++ )
+                {
+                    auto it = m_cells.find( cellKey( x, y ) );
+
+                    if( it != m_cells.end() && removeFromCell( it->second, aShape ) )
+                        found = true;
+                }
+            }
+        }
+
+        if( found )
+            m_size--;
+    }
+
+    /**
+     * Remove all the contents of the index.
+     */
+    void RemoveAll()
+    {
+        m_cells.clear();
+        m_oversize.clear();
+        m_size = 0;
+    }
+
+    /**
+     * @return the number of shapes in the index.
+     */
+    size_t Size() const { return m_size; }
+
+    /**
+     * Run a callback on every shape whose bounding box overlaps the bounding box of \a aShape,
+     * inflated by \a aMinDistance.  The visitor returns false to stop the search.
+     *
+     * @return the number of shapes the visitor accepted.
+     */
+    template <class V>
+    int Query( const SHAPE* aShape, int aMinDistance, V& aVisitor ) const
+    {
+        BOX2I box = aShape->BBox();
+        box.Inflate( aMinDistance );
+
+        return Query( box, aVisitor );
+    }
+
+    /**
+     * Run a callback on every shape whose bounding box overlaps \a aBox.  The visitor returns
+     * false to stop the search.
+     *
+     * @return the number of shapes the visitor accepted.
+     */
+    template <class V>
+    int Query( const BOX2I& aBox, V& aVisitor ) const
+    {
+        const ENTRY query = makeEntry( T(), aBox );
+        const RANGE range = cellRange( query );
+        int         count = 0;
+
+        for( int x = range.x0; x <= range.x1; x++ )
+        {
+            for( int y = range.y0; y <= range.y1; y++ )
+            {
+                auto it = m_cells.find( cellKey( x, y ) );
+
+                if( it == m_cells.end() )
+                    continue;
+
+                for( const ENTRY& entry : it->second )
+                {
+                    if( !overlaps( entry, query ) )
+                        continue;
+
+                    // Report the item only once, in the cell holding the top-left corner of
+                    // its overlap with the query
+                    if( ( std::max( entry.minX, query.minX ) >> m_cellSizeLog2 ) != x
+                            || ( std::max( entry.minY, query.minY ) >> m_cellSizeLog2 ) != y )
+                    {
+                        continue;
+                    }
+
+                    if( !aVisitor( entry.item ) )
+                        return count;
+
+                    count++;
+                }
+            }
+        }
+
+        for( const ENTRY& entry : m_oversize )
+        {
+            if( !overlaps( entry, query ) )
+                continue;
+
+            if( !aVisitor( entry.item ) )
+                return count;
+
+            count++;
+        }
+
+        return count;
+    }
+
+private:
+    struct ENTRY
+    {
+        int minX;
+        int minY;
+        int maxX;
+        int maxY;
+        T   item;
+    };
+
+    ///< Cells overlapped by a box, inclusive.
+    struct RANGE
+    {
+        int x0;
+        int y0;
+        int x1;
+        int y1;
+    };
+
+    static ENTRY makeEntry( T aShape, const BOX2I& aBox )
+    {
+        return { aBox.GetX(), aBox.GetY(), aBox.GetRight(), aBox.GetBottom(), aShape };
+    }
+
+    static bool overlaps( const ENTRY& aA, const ENTRY& aB )
+    {
+        return aA.maxX >= aB.minX && aA.minX <= aB.maxX && aA.maxY >= aB.minY
+               && aA.minY <= aB.maxY;
+    }
+
+    RANGE cellRange( const ENTRY& aEntry ) const
+    {
+        // Arithmetic shifts round negative coordinates down, like the cells do
+        return { aEntry.minX >> m_cellSizeLog2, aEntry.minY >> m_cellSizeLog2,
+                 aEntry.maxX >> m_cellSizeLog2, aEntry.maxY >> m_cellSizeLog2 };
+    }
+
+    bool isOversize( const RANGE& aRange ) const
+    {
+        return (int64_t) ( aRange.x1 - aRange.x0 + 1 ) * ( aRange.y1 - aRange.y0 + 1 )
+               > m_maxCells;
+    }
+
+    static uint64_t cellKey( int aX, int aY )
+    {
+        return ( (uint64_t) (uint32_t) aX << 32 ) | (uint32_t) aY;
+    }
+
+    static bool removeFromCell( std::vector<ENTRY>& aCell, T aShape )
+    {
+        for( size_t ii = 0; ii < aCell.size(); ii++ )
+        {
+            if( aCell[ii].item == aShape )
+            {
+                aCell[ii] = aCell.back();
+                aCell.pop_back();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    int                                               m_cellSizeLog2;
+    int                                               m_maxCells;
+    std::unordered_map<uint64_t, std::vector<ENTRY>> m_cells;
+    std::vector<ENTRY>                                m_oversize;  ///< items spanning many cells
+    size_t                                            m_size;
+};
+
+#endif // __SHAPE_GRID_INDEX_H
@@ -160,6 +160,20 @@ public:
             m_bbox( aShape.m_bbox )
     {}
 
+    /**
+     * Move constructor.  Must be noexcept so that containers of line chains (POLYGON,
+     * SHAPE_POLY_SET::m_polys) move their elements on reallocation instead of deep-copying them.
+     */
+    SHAPE_LINE_CHAIN( SHAPE_LINE_CHAIN&& aShape ) noexcept :
+            SHAPE_LINE_CHAIN_BASE( SH_LINE_CHAIN ),
+            m_points( std::move( aShape.m_points ) ),
+            m_shapes( std::move( aShape.m_shapes ) ),
+            m_arcs( std::move( aShape.m_arcs ) ),
+            m_closed( aShape.m_closed ),
+            m_width( aShape.m_width ),
+            m_bbox( aShape.m_bbox )
+    {}
+
     SHAPE_LINE_CHAIN( const std::vector<int>& aV );
 
     SHAPE_LINE_CHAIN( const std::vector<wxPoint>& aV, bool aClosed = false ) :
@@ -184,6 +198,15 @@ public:
         m_shapes = std::vector<std::pair<ssize_t, ssize_t>>( aV.size(), SHAPES_ARE_PT );
     }
 
+    SHAPE_LINE_CHAIN( std::vector<VECTOR2I>&& aV, bool aClosed = false ) :
+            SHAPE_LINE_CHAIN_BASE( SH_LINE_CHAIN ),
+            m_points( std::move( aV ) ),
+            m_closed( aClosed ),
+            m_width( 0 )
+    {
+        m_shapes = std::vector<std::pair<ssize_t, ssize_t>>( m_points.size(), SHAPES_ARE_PT );
+    }
+
     SHAPE_LINE_CHAIN( const SHAPE_ARC& aArc, bool aClosed = false ) :
             SHAPE_LINE_CHAIN_BASE( SH_LINE_CHAIN ),
             m_closed( aClosed ),
@@ -233,6 +256,7 @@ public:
                           VECTOR2I* aLocation = nullptr ) const override;
 
     SHAPE_LINE_CHAIN& operator=( const SHAPE_LINE_CHAIN& ) = default;
+    SHAPE_LINE_CHAIN& operator=( SHAPE_LINE_CHAIN&& ) noexcept = default;
 
     SHAPE* Clone() const override;
 
@@ -526,7 +550,13 @@ public:
      */
     void Append( const SHAPE_LINE_CHAIN& aOtherLine );
 
-    void Append( const SHAPE_ARC& aArc );
+    /**
+     * Append an arc at the end of the line chain.
+     *
+     * @param aArc is the arc to append.
+     * @param aAccuracy is the maximum deviation of the segment approximation from the true arc.
+     */
+    void Append( const SHAPE_ARC& aArc, double aAccuracy = SHAPE_ARC::DefaultAccuracyForPCB() );
 
     void Insert( size_t aVertex, const VECTOR2I& aP );
 
@@ -897,6 +927,13 @@ protected:
         amendArc( aArcIndex, m_arcs[aArcIndex].GetP0(), aNewEnd );
     }
 
+    /**
+     * Shrink each arc to the run of points that still reference it, e.g. after a boolean
+     * operation kept only part of it.  Arcs left with fewer than two points are converted
+     * to plain points.
+     */
+    void fitArcsToPoints();
+
     /**
      * Return the arc index for the given segment index, looking backwards
      */
@@ -1002,6 +1002,23 @@ public:
         Inflate( -aAmount, aCircleSegmentsCount, aCornerStrategy );
     }
 
+    /**
+     * Perform outline inflation using round corners that are kept as true arcs.
+     *
+     * Unlike Inflate(), which lets Clipper replace every rounded corner by a run of anonymous
+     * segments, the corners are built as SHAPE_ARCs and carried through the union that removes
+     * self-intersections, so the resulting outlines report them via ArcCount(), collide against
+     * them as arcs and can be exported as arcs.  The segment approximation stored alongside
+     * each arc is built with \a aMaxError.
+     *
+     * Only outward offsets are handled natively; a negative \a aAmount falls back to
+     * Inflate() with an equivalent segment count.
+     *
+     * @param aAmount is the number of units to offset edges.
+     * @param aMaxError is the maximum deviation of the arc approximation from the true arc.
+     */
+    void InflateWithArcs( int aAmount, int aMaxError );
+
     /**
      * Perform outline inflation/deflation, using round corners.
      *
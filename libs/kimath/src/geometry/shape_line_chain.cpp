@@ -101,28 +101,33 @@ ClipperLib::Path SHAPE_LINE_CHAIN::convertToClipper( bool aRequiredOrientation,
                                                      std::vector<CLIPPER_Z_VALUE>& aZValueBuffer,
                                                      std::vector<SHAPE_ARC>& aArcBuffer ) const
 {
-    ClipperLib::Path c_path;
-    SHAPE_LINE_CHAIN input;
-    bool             orientation = Area( false ) >= 0;
-    ssize_t          shape_offset = aArcBuffer.size();
+    ClipperLib::Path        c_path;
+    SHAPE_LINE_CHAIN        reversed;
+    const SHAPE_LINE_CHAIN* input = this;
+    bool                    orientation = Area( false ) >= 0;
+    ssize_t                 shape_offset = aArcBuffer.size();
 
+    // Only pay for a copy of the chain when the winding actually has to be flipped
     if( orientation != aRequiredOrientation )
-        input = Reverse();
-    else
-        input = *this;
+    {
+        reversed = Reverse();
+        input = &reversed;
+    }
+
+    c_path.reserve( input->PointCount() );
 
-    for( int i = 0; i < input.PointCount(); i++ )
+    for( int i = 0; i < input->PointCount(); i++ )
     {
-        const VECTOR2I& vertex = input.CPoint( i );
+        const VECTOR2I& vertex = input->CPoint( i );
 
-        CLIPPER_Z_VALUE z_value( input.m_shapes[i], shape_offset );
+        CLIPPER_Z_VALUE z_value( input->m_shapes[i], shape_offset );
         size_t          z_value_ptr = aZValueBuffer.size();
         aZValueBuffer.push_back( z_value );
 
-        c_path.push_back( ClipperLib::IntPoint( vertex.x, vertex.y, z_value_ptr ) );
+        c_path.emplace_back( vertex.x, vertex.y, z_value_ptr );
     }
 
-    aArcBuffer.insert( aArcBuffer.end(), input.m_arcs.begin(), input.m_arcs.end() );
+    aArcBuffer.insert( aArcBuffer.end(), input->m_arcs.begin(), input->m_arcs.end() );
 
     return c_path;
 }
@@ -218,6 +223,63 @@ void SHAPE_LINE_CHAIN::amendArc( size_t aArcIndex, const VECTOR2I& aNewStart,
 }
 
 
+void SHAPE_LINE_CHAIN::fitArcsToPoints()
+{
+    ssize_t n = m_shapes.size();
+
+    auto isOnArc =
+            [&]( ssize_t aPt, ssize_t aArcIndex )
+            {
+                return m_shapes[aPt].first == aArcIndex || m_shapes[aPt].second == aArcIndex;
+            };
+
+    for( ssize_t arcIdx = m_arcs.size() - 1; arcIdx >= 0; --arcIdx )
+    {
+        ssize_t first = -1;
+        ssize_t last = -1;
+        ssize_t count = 0;
+
+        for( ssize_t pt = 0; pt < n; pt++ )
+        {
+            if( isOnArc( pt, arcIdx ) )
+            {
+                if( first < 0 )
+                    first = pt;
+
+                last = pt;
+                count++;
+            }
+        }
+
+        // fixIndicesRotation() leaves a lone arc alone, so on a closed chain its points can
+        // run past the last vertex and continue at vertex 0.  The arc then starts at the
+        // beginning of the trailing run and ends at the end of the leading one.
+        if( m_closed && first == 0 && last == n - 1 && count < n )
+        {
+            last = 0;
+
+            while( last + 1 < n && isOnArc( last + 1, arcIdx ) )
+                last++;
+
+            first = n - 1;
+
+            while( first > 0 && isOnArc( first - 1, arcIdx ) )
+                first--;
+        }
+
+        if( first < 0 || first == last )
+        {
+            convertArc( arcIdx );
+        }
+        else if( m_points[first] != m_arcs[arcIdx].GetP0()
+                 || m_points[last] != m_arcs[arcIdx].GetP1() )
+        {
+            amendArc( arcIdx, m_points[first], m_points[last] );
+        }
+    }
+}
+
+
 void SHAPE_LINE_CHAIN::splitArc( ssize_t aPtIndex, bool aCoincident )
 {
     if( aPtIndex < 0 )
@@ -1243,7 +1305,7 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_LINE_CHAIN& aOtherLine )
 }
 
 
-void SHAPE_LINE_CHAIN::Append( const SHAPE_ARC& aArc )
+void SHAPE_LINE_CHAIN::Append( const SHAPE_ARC& aArc, double aAccuracy )
 {
     SEG startToEnd( aArc.GetP0(), aArc.GetP1() );
 
@@ -1255,7 +1317,7 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_ARC& aArc )
     }
     else
     {
-        SHAPE_LINE_CHAIN chain = aArc.ConvertToPolyline();
+        SHAPE_LINE_CHAIN chain = aArc.ConvertToPolyline( aAccuracy );
 
         // @todo should the below 4 LOC be moved to SHAPE_ARC::ConvertToPolyline ?
         chain.m_arcs.push_back( aArc );
@@ -203,8 +203,8 @@ int SHAPE_POLY_SET::NewOutline()
     POLYGON poly;
 
     empty_path.SetClosed( true );
-    poly.push_back( empty_path );
-    m_polys.push_back( poly );
+    poly.push_back( std::move( empty_path ) );
+    m_polys.push_back( std::move( poly ) );
     return m_polys.size() - 1;
 }
 
@@ -484,7 +484,7 @@ int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 
     poly.push_back( aOutline );
 
-    m_polys.push_back( poly );
+    m_polys.push_back( std::move( poly ) );
 
     return m_polys.size() - 1;
 }
@@ -562,6 +562,68 @@ void SHAPE_POLY_SET::ClearArcs()
 }
 
 
+/**
+ * Build a Clipper Z-fill callback that records, for every intersection point Clipper creates,
+ * which arcs the two intersecting edges belonged to so that arcs survive the operation.
+ */
+static ClipperLib::ZFillCallback arcTrackingZFill( std::vector<CLIPPER_Z_VALUE>& aZValues )
+{
+    return [&aZValues]( ClipperLib::IntPoint& e1bot, ClipperLib::IntPoint& e1top,
+                        ClipperLib::IntPoint& e2bot, ClipperLib::IntPoint& e2top,
+                        ClipperLib::IntPoint& pt )
+        {
+            auto arcIndex =
+                [&]( const ssize_t& aZvalue, const ssize_t& aCompareVal = -1 ) -> ssize_t
+                {
+                    ssize_t retval;
+
+                    retval = aZValues.at( aZvalue ).m_SecondArcIdx;
+
+                    if( retval == -1 || ( aCompareVal > 0 && retval != aCompareVal ) )
+                        retval = aZValues.at( aZvalue ).m_FirstArcIdx;
+
+                    return retval;
+                };
+
+            auto arcSegment =
+                [&]( const ssize_t& aBottomZ, const ssize_t aTopZ ) -> ssize_t
+                {
+                    ssize_t retval = arcIndex( aBottomZ );
+
+                    if( retval != -1 )
+                    {
+                        if( retval != arcIndex( aTopZ, retval ) )
+                            retval = -1; // Not an arc segment as the two indices do not match
+                    }
+
+                    return retval;
+                };
+
+            ssize_t e1ArcSegmentIndex = arcSegment( e1bot.Z, e1top.Z );
+            ssize_t e2ArcSegmentIndex = arcSegment( e2bot.Z, e2top.Z );
+
+            CLIPPER_Z_VALUE newZval;
+
+            if( e1ArcSegmentIndex != -1 )
+            {
+                newZval.m_FirstArcIdx = e1ArcSegmentIndex;
+                newZval.m_SecondArcIdx = e2ArcSegmentIndex;
+            }
+            else
+            {
+                newZval.m_FirstArcIdx = e2ArcSegmentIndex;
+                newZval.m_SecondArcIdx = -1;
+            }
+
+            size_t z_value_ptr = aZValues.size();
+            aZValues.push_back( newZval );
+
+            pt.Z = z_value_ptr;
+            //@todo amend X,Y values to true intersection between arcs or arc and segment
+        };
+}
+
+
 void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET& aOtherShape,
                                 POLYGON_MODE aFastMode )
 {
@@ -585,7 +647,6 @@ void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET
 
     std::vector<CLIPPER_Z_VALUE> zValues;
     std::vector<SHAPE_ARC> arcBuffer;
-    std::map<VECTOR2I, CLIPPER_Z_VALUE> newIntersectPoints;
 
     for( const POLYGON& poly : aShape.m_polys )
     {
@@ -607,66 +668,7 @@ void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET
 
     ClipperLib::PolyTree solution;
 
-    ClipperLib::ZFillCallback callback =
-            [&]( ClipperLib::IntPoint & e1bot, ClipperLib::IntPoint & e1top,
-                ClipperLib::IntPoint & e2bot, ClipperLib::IntPoint & e2top,
-                ClipperLib::IntPoint & pt )
-            {
-                auto arcIndex =
-                    [&]( const ssize_t& aZvalue, const ssize_t& aCompareVal = -1 ) -> ssize_t
-                    {
-                        ssize_t retval;
-
-                        retval = zValues.at( aZvalue ).m_SecondArcIdx;
-
-                        if( retval == -1 || ( aCompareVal > 0 && retval != aCompareVal ) )
-                            retval = zValues.at( aZvalue ).m_FirstArcIdx;
-
-                        return retval;
-                    };
-
-                auto arcSegment =
-                    [&]( const ssize_t& aBottomZ, const ssize_t aTopZ ) -> ssize_t
-                    {
-                        ssize_t retval = arcIndex( aBottomZ );
-
-                        if( retval != -1 )
-                        {
-                            if( retval != arcIndex( aTopZ, retval ) )
-                                retval = -1; // Not an arc segment as the two indices do not match
-                        }
-
-                        return retval;
-                    };
-
-                ssize_t e1ArcSegmentIndex = arcSegment( e1bot.Z, e1top.Z );
-                ssize_t e2ArcSegmentIndex = arcSegment( e2bot.Z, e2top.Z );
-
-                CLIPPER_Z_VALUE newZval;
-
-                if( e1ArcSegmentIndex != -1 )
-                {
-                    newZval.m_FirstArcIdx = e1ArcSegmentIndex;
-                    newZval.m_SecondArcIdx = e2ArcSegmentIndex;
-                }
-                else
-                {
-                    newZval.m_FirstArcIdx = e2ArcSegmentIndex;
-                    newZval.m_SecondArcIdx = -1;
-                }
-
-                size_t z_value_ptr = zValues.size();
-                zValues.push_back( newZval );
-
-                // Only worry about arc segments for later processing
-                if( newZval.m_FirstArcIdx != -1 )
-                    newIntersectPoints.insert( { VECTOR2I( pt.X, pt.Y ), newZval } );
-
-                pt.Z = z_value_ptr;
-                //@todo amend X,Y values to true intersection between arcs or arc and segment
-            };
-
-    c.ZFillFunction( callback ); // register callback
+    c.ZFillFunction( arcTrackingZFill( zValues ) ); // register callback
 
     c.Execute( aType, solution, ClipperLib::pftNonZero, ClipperLib::pftNonZero );
 
@@ -813,6 +815,122 @@ void SHAPE_POLY_SET::Inflate( int aAmount, int aCircleSegCount, CORNER_STRATEGY
 }
 
 
+void SHAPE_POLY_SET::InflateWithArcs( int aAmount, int aMaxError )
+{
+    if( aAmount <= 0 )
+    {
+        Inflate( aAmount, GetArcToSegmentCount( std::abs( aAmount ), aMaxError, 360.0 ) );
+        return;
+    }
+
+    const double delta = aAmount;
+
+    std::vector<CLIPPER_Z_VALUE> zValues;
+    std::vector<SHAPE_ARC>       arcBuffer;
+    ClipperLib::Clipper          c;
+
+    for( const POLYGON& poly : m_polys )
+    {
+        for( size_t ii = 0; ii < poly.size(); ii++ )
+        {
+            // Outlines are oriented positive and holes negative, so the right-hand normal of
+            // every edge points away from the copper.
+            std::vector<CLIPPER_Z_VALUE> unusedZ;
+            std::vector<SHAPE_ARC>       unusedArcs;
+            ClipperLib::Path src = poly[ii].convertToClipper( ii == 0, unusedZ, unusedArcs );
+            size_t           n = src.size();
+
+            if( n < 3 )
+                continue;
+
+            std::vector<VECTOR2D> normals( n );
+
+            for( size_t jj = 0; jj < n; jj++ )
+            {
+                const ClipperLib::IntPoint& a = src[jj];
+                const ClipperLib::IntPoint& b = src[( jj + 1 ) % n];
+                double dx = double( b.X ) - a.X;
+                double dy = double( b.Y ) - a.Y;
+                double len = std::hypot( dx, dy );
+
+                normals[jj] = len > 0.0 ? VECTOR2D( dy / len, -dx / len ) : VECTOR2D( 0, 0 );
+            }
+
+            // Build the raw offset curve the same way ClipperOffset does, except that convex
+            // joins are emitted as arcs around the original vertex.
+            SHAPE_LINE_CHAIN raw;
+
+            for( size_t jj = 0; jj < n; jj++ )
+            {
+                const VECTOR2D& n1 = normals[( jj + n - 1 ) % n];
+                const VECTOR2D& n2 = normals[jj];
+                VECTOR2D        pt( src[jj].X, src[jj].Y );
+                VECTOR2I        start( KiROUND( pt.x + n1.x * delta ),
+                                       KiROUND( pt.y + n1.y * delta ) );
+                VECTOR2I        end( KiROUND( pt.x + n2.x * delta ),
+                                     KiROUND( pt.y + n2.y * delta ) );
+                double          sinA = n1.x * n2.y - n2.x * n1.y;
+                double          cosA = n1.x * n2.x + n1.y * n2.y;
+
+                if( std::fabs( sinA * delta ) < 1.0 && cosA > 0 )
+                {
+                    // Practically collinear edges
+                    raw.Append( start );
+                }
+                else if( sinA < 0 && std::fabs( sinA * delta ) >= 1.0 )
+                {
+                    // Concave join: route through the vertex and let the union clean it up
+                    raw.Append( start );
+                    raw.Append( src[jj].X, src[jj].Y );
+                    raw.Append( end );
+                }
+                else
+                {
+                    VECTOR2D bisector = n1 + n2;
+                    double   len = bisector.EuclideanNorm();
+
+                    // A 180 degree turn has no bisector; cap it in the incoming direction
+                    if( len < 1e-9 )
+                        bisector = VECTOR2D( -n1.y, n1.x );
+                    else
+                        bisector = bisector * ( 1.0 / len );
+
+                    VECTOR2I mid( KiROUND( pt.x + bisector.x * delta ),
+                                  KiROUND( pt.y + bisector.y * delta ) );
+
+                    raw.Append( SHAPE_ARC( start, mid, end, 0 ), aMaxError );
+                }
+            }
+
+            raw.SetClosed( true );
+
+            if( raw.PointCount() < 3 )
+                continue;
+
+            // Keep the natural winding of the raw curve: a hole narrower than the offset turns
+            // inside out and must then drop out of the positive-fill union.
+            c.AddPath( raw.convertToClipper( raw.Area( false ) >= 0, zValues, arcBuffer ),
+                       ClipperLib::ptSubject, true );
+        }
+    }
+
+    ClipperLib::PolyTree solution;
+
+    c.ZFillFunction( arcTrackingZFill( zValues ) );
+    c.Execute( ClipperLib::ctUnion, solution, ClipperLib::pftPositive, ClipperLib::pftPositive );
+
+    importTree( &solution, zValues, arcBuffer );
+
+    // Where raw offset curves overlapped, Clipper keeps only part of a corner arc.  Shrink such
+    // arcs to the points that survived so they match their approximation again.
+    for( POLYGON& poly : m_polys )
+    {
+        for( SHAPE_LINE_CHAIN& chain : poly )
+            chain.fitArcsToPoints();
+    }
+}
+
+
 void SHAPE_POLY_SET::importTree( ClipperLib::PolyTree*               tree,
                                  const std::vector<CLIPPER_Z_VALUE>& aZValueBuffer,
                                  const std::vector<SHAPE_ARC>&       aArcBuffer )
@@ -831,7 +949,7 @@ void SHAPE_POLY_SET::importTree( ClipperLib::PolyTree*               tree,
             for( unsigned int i = 0; i < n->Childs.size(); i++ )
                 paths.emplace_back( n->Childs[i]->Contour, aZValueBuffer, aArcBuffer );
 
-            m_polys.push_back( paths );
+            m_polys.push_back( std::move( paths ) );
         }
     }
 }
@@ -869,7 +987,78 @@ struct FractureEdge
 typedef std::vector<FractureEdge*> FractureEdgeSet;
 
 
-static int processEdge( FractureEdgeSet& edges, FractureEdge* edge )
+/**
+ * A uniform grid over the fracture edges.  The leftward ray cast from a hole then only has to
+ * visit the cells of its own row, right to left, until a hit is found, instead of testing every
+ * edge of the polygon.  Each cell keeps its edges in creation order so that ties resolve exactly
+ * as they would in a scan over all edges.
+ */
+class FractureEdgeGrid
+{
+public:
+    FractureEdgeGrid( const BOX2I& aBBox, size_t aEdgeCount ) :
+            m_origin( aBBox.GetOrigin() )
+    {
+        int64_t cells = std::max<int64_t>( 1, std::sqrt( aEdgeCount / 4.0 ) );
+
+        m_cols = std::min<int64_t>( cells, int64_t( aBBox.GetWidth() ) + 1 );
+        m_rows = std::min<int64_t>( cells, int64_t( aBBox.GetHeight() ) + 1 );
+        m_cellWidth = ( int64_t( aBBox.GetWidth() ) + m_cols ) / m_cols;
+        m_cellHeight = ( int64_t( aBBox.GetHeight() ) + m_rows ) / m_rows;
+        m_cells.resize( m_cols * m_rows );
+    }
+
+    void Add( FractureEdge* aEdge )
+    {
+        int colMin = Column( std::min( aEdge->m_p1.x, aEdge->m_p2.x ) );
+        int colMax = Column( std::max( aEdge->m_p1.x, aEdge->m_p2.x ) );
+        int rowMin = row( std::min( aEdge->m_p1.y, aEdge->m_p2.y ) );
+        int rowMax = row( std::max( aEdge->m_p1.y, aEdge->m_p2.y ) );
+
+        for( int r = rowMin; r <= rowMax; ++r )
+        {
+            for( int c = colMin; c <= colMax; ++c )
+                m_cells[r * m_cols + c].push_back( aEdge );
+        }
+    }
+
+    int Column( int aX ) const
+    {
+        int64_t idx = ( int64_t( aX ) - m_origin.x ) / m_cellWidth;
+
+        return std::min<int64_t>( std::max<int64_t>( idx, 0 ), m_cols - 1 );
+    }
+
+    ///< Left edge of column \a aCol; the column covers [ColumnStart( aCol ), ColumnStart( aCol + 1 ) ).
+    int64_t ColumnStart( int aCol ) const
+    {
+        return int64_t( m_origin.x ) + aCol * m_cellWidth;
+    }
+
+    const FractureEdgeSet& Cell( int aCol, int aY ) const
+    {
+        return m_cells[row( aY ) * m_cols + aCol];
+    }
+
+private:
+    int row( int aY ) const
+    {
+        int64_t idx = ( int64_t( aY ) - m_origin.y ) / m_cellHeight;
+
+        return std::min<int64_t>( std::max<int64_t>( idx, 0 ), m_rows - 1 );
+    }
+
+    VECTOR2I                     m_origin;
+    int64_t                      m_cols;
+    int64_t                      m_rows;
+    int64_t                      m_cellWidth;
+    int64_t                      m_cellHeight;
+    std::vector<FractureEdgeSet> m_cells;
+};
+
+
+static int processEdge( std::deque<FractureEdge>& edgePool, FractureEdgeGrid& grid,
+                        FractureEdge* edge )
 {
     int x   = edge->m_p1.x;
     int y   = edge->m_p1.y;
@@ -878,30 +1067,41 @@ static int processEdge( FractureEdgeSet& edges, FractureEdge* edge )
 
     FractureEdge* e_nearest = nullptr;
 
-    for( FractureEdge* e : edges )
+    // Walk the row leftwards.  An intersection is only counted in the column that contains it,
+    // so the first column with a hit holds the nearest edge and the scan can stop there.
+    for( int col = grid.Column( x ); col >= 0 && !e_nearest; --col )
     {
-        if( !e->matches( y ) )
-            continue;
-
-        int x_intersect;
+        int64_t colStart = grid.ColumnStart( col );
+        int64_t colEnd = grid.ColumnStart( col + 1 );
 
-        if( e->m_p1.y == e->m_p2.y ) // horizontal edge
-        {
-            x_intersect = std::max( e->m_p1.x, e->m_p2.x );
-        }
-        else
+        for( FractureEdge* e : grid.Cell( col, y ) )
         {
-            x_intersect = e->m_p1.x + rescale( e->m_p2.x - e->m_p1.x, y - e->m_p1.y,
-                                               e->m_p2.y - e->m_p1.y );
-        }
+            if( !e->matches( y ) )
+                continue;
 
-        int dist = ( x - x_intersect );
+            int x_intersect;
 
-        if( dist >= 0 && dist < min_dist && e->m_connected )
-        {
-            min_dist    = dist;
-            x_nearest   = x_intersect;
-            e_nearest   = e;
+            if( e->m_p1.y == e->m_p2.y ) // horizontal edge
+            {
+                x_intersect = std::max( e->m_p1.x, e->m_p2.x );
+            }
+            else
+            {
+                x_intersect = e->m_p1.x + rescale( e->m_p2.x - e->m_p1.x, y - e->m_p1.y,
+                                                   e->m_p2.y - e->m_p1.y );
+            }
+
+            if( x_intersect < colStart || x_intersect >= colEnd )
+                continue;
+
+            int dist = ( x - x_intersect );
+
+            if( dist >= 0 && dist < min_dist && e->m_connected )
+            {
+                min_dist    = dist;
+                x_nearest   = x_intersect;
+                e_nearest   = e;
+            }
         }
     }
 
@@ -909,16 +1109,21 @@ static int processEdge( FractureEdgeSet& edges, FractureEdge* edge )
     {
         int count = 0;
 
-        FractureEdge* lead1 = new FractureEdge( true, VECTOR2I( x_nearest, y ), VECTOR2I( x, y ) );
-        FractureEdge* lead2 = new FractureEdge( true, VECTOR2I( x, y ), VECTOR2I( x_nearest, y ) );
-        FractureEdge* split_2 = new FractureEdge( true, VECTOR2I( x_nearest, y ), e_nearest->m_p2 );
+        edgePool.emplace_back( true, VECTOR2I( x_nearest, y ), e_nearest->m_p2 );
+        FractureEdge* split_2 = &edgePool.back();
+        edgePool.emplace_back( true, VECTOR2I( x_nearest, y ), VECTOR2I( x, y ) );
+        FractureEdge* lead1 = &edgePool.back();
+        edgePool.emplace_back( true, VECTOR2I( x, y ), VECTOR2I( x_nearest, y ) );
+        FractureEdge* lead2 = &edgePool.back();
 
-        edges.push_back( split_2 );
-        edges.push_back( lead1 );
-        edges.push_back( lead2 );
+        grid.Add( split_2 );
+        grid.Add( lead1 );
+        grid.Add( lead2 );
 
         FractureEdge* link = e_nearest->m_next;
 
+        // e_nearest stays registered in the cells of its original extent; matches() and the
+        // column test reject the part that now belongs to split_2.
         e_nearest->m_p2 = VECTOR2I( x_nearest, y );
         e_nearest->m_next = lead1;
         lead1->m_next = edge;
@@ -945,16 +1150,18 @@ static int processEdge( FractureEdgeSet& edges, FractureEdge* edge )
 
 void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 {
-    FractureEdgeSet edges;
-    FractureEdgeSet border_edges;
-    FractureEdge*   root = nullptr;
+    std::deque<FractureEdge> edgePool;
+    FractureEdgeSet          border_edges;
+    FractureEdge*            root = nullptr;
 
     bool first = true;
 
     if( paths.size() == 1 )
         return;
 
-    int num_unconnected = 0;
+    int    num_unconnected = 0;
+    BOX2I  bbox;
+    size_t edgeCount = 0;
 
     for( const SHAPE_LINE_CHAIN& path : paths )
     {
@@ -970,10 +1177,15 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
             if( points[i].x < x_min )
                 x_min = points[i].x;
 
+            if( edgeCount == 0 )
+                bbox = BOX2I( points[i], VECTOR2I( 0, 0 ) );
+            else
+                bbox.Merge( points[i] );
+
             // Do not use path.CPoint() here; open-coding it using the local variables "points"
             // and "pointCount" gives a non-trivial performance boost to zone fill times.
-            FractureEdge* fe = new FractureEdge( first, points[ i ],
-                                                 points[ i+1 == pointCount ? 0 : i+1 ] );
+            edgePool.emplace_back( first, points[ i ], points[ i+1 == pointCount ? 0 : i+1 ] );
+            FractureEdge* fe = &edgePool.back();
 
             if( !root )
                 root = fe;
@@ -988,7 +1200,7 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
                 fe->m_next = first_edge;
 
             prev = fe;
-            edges.push_back( fe );
+            edgeCount++;
 
             if( !first )
             {
@@ -1003,43 +1215,59 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
         first = false;    // first path is always the outline
     }
 
-    // keep connecting holes to the main outline, until there's no holes left...
-    while( num_unconnected > 0 )
-    {
-        int x_min = std::numeric_limits<int>::max();
-        auto it = border_edges.begin();
+    if( !root )
+        return;
 
-        FractureEdge* smallestX = nullptr;
+    FractureEdgeGrid grid( bbox, edgeCount );
 
-        // find the left-most hole edge and merge with the outline
-        for( ; it != border_edges.end(); ++it )
-        {
-            FractureEdge* border_edge = *it;
-            int xt = border_edge->m_p1.x;
+    for( FractureEdge& edge : edgePool )
+        grid.Add( &edge );
 
-            if( ( xt <= x_min ) && !border_edge->m_connected )
-            {
-                x_min = xt;
-                smallestX = border_edge;
-            }
-        }
+    // Holes are merged left-most first.  Connecting a hole does not move any border edge, so
+    // the order can be fixed up front; among equal x the edge seen last wins, as it always has.
+    std::vector<std::pair<FractureEdge*, size_t>> order;
+    order.reserve( border_edges.size() );
 
-        int num_processed = processEdge( edges, smallestX );
+    for( size_t ii = 0; ii < border_edges.size(); ++ii )
+        order.emplace_back( border_edges[ii], ii );
+
+    std::sort( order.begin(), order.end(),
+               []( const std::pair<FractureEdge*, size_t>& a,
+                   const std::pair<FractureEdge*, size_t>& b )
+               {
+                   if( a.first->m_p1.x != b.first->m_p1.x )
+                       return a.first->m_p1.x < b.first->m_p1.x;
+
+                   return a.second > b.second;
+               } );
+
+    // keep connecting holes to the main outline, until there's no holes left...
+    for( const std::pair<FractureEdge*, size_t>& entry : order )
+    {
+        if( num_unconnected <= 0 )
+            break;
+
+        if( entry.first->m_connected )
+            continue;
+
+        int num_processed = processEdge( edgePool, grid, entry.first );
 
         // If we can't handle the edge, the zone is broken (maybe)
         if( !num_processed )
         {
             wxLogWarning( "Broken polygon, dropping path" );
-
-            for( FractureEdge* edge : edges )
-                delete edge;
-
             return;
         }
 
         num_unconnected -= num_processed;
     }
 
+    if( num_unconnected > 0 )
+    {
+        wxLogWarning( "Broken polygon, dropping path" );
+        return;
+    }
+
     paths.clear();
     SHAPE_LINE_CHAIN newPath;
 
@@ -1052,9 +1280,6 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 
     newPath.Append( e->m_p1 );
 
-    for( FractureEdge* edge : edges )
-        delete edge;
-
     paths.push_back( std::move( newPath ) );
 }
 
@@ -1375,10 +1600,10 @@ bool SHAPE_POLY_SET::Parse( std::stringstream& aStream )
                 outline.Append( p );
             }
 
-            paths.push_back( outline );
+            paths.push_back( std::move( outline ) );
         }
 
-        m_polys.push_back( paths );
+        m_polys.push_back( std::move( paths ) );
     }
 
     return true;
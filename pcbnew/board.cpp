@@ -207,18 +207,25 @@ void BOARD::IncrementTimeStamp()
 {
     m_timeStamp++;
 
+    InvalidateItemPairCaches();
+
     {
         std::unique_lock<std::mutex> cacheLock( m_CachesMutex );
-        m_InsideAreaCache.clear();
-        m_InsideCourtyardCache.clear();
-        m_InsideFCourtyardCache.clear();
-        m_InsideBCourtyardCache.clear();
         m_LayerExpressionCache.clear();
     }
 
     m_CopperZoneRTrees.clear();
 }
 
+
+void BOARD::InvalidateItemPairCaches()
+{
+    m_InsideAreaCache.Invalidate();
+    m_InsideCourtyardCache.Invalidate();
+    m_InsideFCourtyardCache.Invalidate();
+    m_InsideBCourtyardCache.Invalidate();
+}
+
 std::vector<PCB_MARKER*> BOARD::ResolveDRCExclusions()
 {
     std::shared_ptr<CONNECTIVITY_DATA> conn = GetConnectivity();
@@ -2003,14 +2010,31 @@ void BOARD::RemoveListener( BOARD_LISTENER* aListener )
 }
 
 
+static void bumpGeometryRevision( BOARD_ITEM* aItem )
+{
+    aItem->BumpGeometryRevision();
+
+    // Children of footprints and groups are moved along with their parent
+    if( aItem->Type() == PCB_FOOTPRINT_T )
+        static_cast<FOOTPRINT*>( aItem )->RunOnChildren( bumpGeometryRevision );
+    else if( aItem->Type() == PCB_GROUP_T )
+        static_cast<PCB_GROUP*>( aItem )->RunOnChildren( bumpGeometryRevision );
+}
+
+
 void BOARD::OnItemChanged( BOARD_ITEM* aItem )
 {
+    bumpGeometryRevision( aItem );
+
     InvokeListeners( &BOARD_LISTENER::OnBoardItemChanged, *this, aItem );
 }
 
 
 void BOARD::OnItemsChanged( std::vector<BOARD_ITEM*>& aItems )
 {
+    for( BOARD_ITEM* item : aItems )
+        bumpGeometryRevision( item );
+
     InvokeListeners( &BOARD_LISTENER::OnBoardItemsChanged, *this, aItems );
 }
 
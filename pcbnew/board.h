@@ -34,6 +34,7 @@
 #include <pcb_plot_params.h>
 #include <title_block.h>
 #include <tools/pcb_selection.h>
+#include <item_pair_cache.h>
 #include <mutex>
 #include <list>
 
@@ -214,6 +215,13 @@ public:
 
     int GetTimeStamp() const { return m_timeStamp; }
 
+    /**
+     * Forget the memoized insideArea(), insideCourtyard() etc. results.  Done by
+     * IncrementTimeStamp(), and by BOARD_COMMIT::Push() for commits which don't mark the board
+     * as modified.
+     */
+    void InvalidateItemPairCaches();
+
     /**
      * Find out if the board is being used to hold a single footprint for editing/viewing.
      *
@@ -1090,11 +1098,12 @@ public:
     };
 
     // ------------ Run-time caches -------------
+    ITEM_PAIR_CACHE                                       m_InsideCourtyardCache;
+    ITEM_PAIR_CACHE                                       m_InsideFCourtyardCache;
+    ITEM_PAIR_CACHE                                       m_InsideBCourtyardCache;
+    ITEM_PAIR_CACHE                                       m_InsideAreaCache;
+
     std::mutex                                            m_CachesMutex;
-    std::map< std::pair<BOARD_ITEM*, BOARD_ITEM*>, bool > m_InsideCourtyardCache;
-    std::map< std::pair<BOARD_ITEM*, BOARD_ITEM*>, bool > m_InsideFCourtyardCache;
-    std::map< std::pair<BOARD_ITEM*, BOARD_ITEM*>, bool > m_InsideBCourtyardCache;
-    std::map< std::pair<BOARD_ITEM*, BOARD_ITEM*>, bool > m_InsideAreaCache;
     std::map< wxString, LSET >                            m_LayerExpressionCache;
 
     std::map< ZONE*, std::unique_ptr<DRC_RTREE> >         m_CopperZoneRTrees;
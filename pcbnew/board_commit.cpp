@@ -31,7 +31,9 @@
 #include <board_commit.h>
 #include <tools/pcb_tool_base.h>
 #include <tools/pcb_actions.h>
+#include <tools/drc_tool.h>
 #include <connectivity/connectivity_data.h>
+#include <advanced_config.h>
 
 #include <functional>
 using namespace std::placeholders;
@@ -111,9 +113,64 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
     std::vector<BOARD_ITEM*> bulkRemovedItems;
     std::vector<BOARD_ITEM*> itemsChanged;
 
+    // Where the edit happened, for incremental DRC
+    bool                     incrementalDRC = false;
+    std::vector<BOARD_ITEM*> drcChangedItems;
+    std::vector<EDA_RECT>    drcPreviousAreas;
+    std::set<KIID>           drcRemovedItems;
+
     if( Empty() )
         return;
 
+    if( !m_isFootprintEditor && ADVANCED_CFG::GetCfg().m_IncrementalDRC )
+    {
+        for( COMMIT_LINE& ent : m_changes )
+        {
+            BOARD_ITEM* boardItem = static_cast<BOARD_ITEM*>( ent.m_item );
+
+            if( boardItem->Type() == PCB_MARKER_T || boardItem->Type() == PCB_NETINFO_T )
+                continue;
+
+            incrementalDRC = true;
+
+            switch( ent.m_type & CHT_TYPE )
+            {
+            case CHT_ADD:
+                drcChangedItems.push_back( boardItem );
+                break;
+
+            case CHT_REMOVE:
+                drcPreviousAreas.push_back( boardItem->GetBoundingBox() );
+                drcRemovedItems.insert( boardItem->m_Uuid );
+
+                if( boardItem->Type() == PCB_FOOTPRINT_T )
+                {
+                    static_cast<FOOTPRINT*>( boardItem )->RunOnChildren(
+                            [&]( BOARD_ITEM* aChild )
+                            {
+                                drcRemovedItems.insert( aChild->m_Uuid );
+                            } );
+                }
+
+                break;
+
+            case CHT_MODIFY:
+                drcChangedItems.push_back( boardItem );
+
+                if( ent.m_copy )
+                {
+                    drcPreviousAreas.push_back(
+                            static_cast<BOARD_ITEM*>( ent.m_copy )->GetBoundingBox() );
+                }
+
+                break;
+
+            default:
+                break;
+            }
+        }
+    }
+
     for( COMMIT_LINE& ent : m_changes )
     {
         int changeType = ent.m_type & CHT_TYPE;
@@ -438,15 +495,26 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
     if( itemsDeselected )
         m_toolMgr->PostEvent( EVENTS::UnselectedEvent );
 
-    if( frame )
+    if( frame && aSetDirtyBit )
+    {
+        frame->OnModify();      // also invalidates the board's caches
+    }
+    else
     {
-        if( aSetDirtyBit )
-            frame->OnModify();
-        else
+        // Items may have been moved, deleted or reallocated at the same address
+        board->InvalidateItemPairCaches();
+
+        if( frame )
             frame->Update3DView( true, frame->GetDisplayOptions().m_Live3DRefresh );
     }
 
     clear();
+
+    if( incrementalDRC )
+    {
+        if( DRC_TOOL* drcTool = m_toolMgr->GetTool<DRC_TOOL>() )
+            drcTool->RunIncrementalTests( drcChangedItems, drcPreviousAreas, drcRemovedItems );
+    }
 }
 
 
@@ -549,6 +617,8 @@ void BOARD_COMMIT::Revert()
     if( itemsChanged.size() > 0 )
         board->OnItemsChanged( itemsChanged );
 
+    board->InvalidateItemPairCaches();
+
     if ( !m_isFootprintEditor )
         connectivity->RecalculateRatsnest();
 
@@ -25,6 +25,8 @@
 
 #include <pybind11/pybind11.h>
 
+#include <atomic>
+
 #include <wx/debug.h>
 #include <wx/msgdlg.h>
 #include <i18n_utility.h>
@@ -154,6 +156,14 @@ void BOARD_ITEM::SwapData( BOARD_ITEM* aImage )
 }
 
 
+uint64_t BOARD_ITEM::nextGeometryRevision()
+{
+    static std::atomic<uint64_t> s_revision( 0 );
+
+    return ++s_revision;
+}
+
+
 void BOARD_ITEM::TransformShapeWithClearanceToPolygon( SHAPE_POLY_SET& aCornerBuffer,
                                                        PCB_LAYER_ID aLayer, int aClearanceValue,
                                                        int aError, ERROR_LOC aErrorLoc,
@@ -36,7 +36,7 @@
 #include <view/view_controls.h>
 #include <pcb_painter.h>
 #include <connectivity/connectivity_data.h>
-#include <connectivity/connectivity_algo.h>
+#include <drc/drc_net_topology.h>
 #include <dialogs/dialog_text_entry.h>
 #include <validators.h>
 #include <bitmaps.h>
@@ -1019,52 +1019,6 @@ bool DIALOG_NET_INSPECTOR::netFilterMatches( NETINFO_ITEM* aNet ) const
 }
 
 
-struct NETCODE_CMP_LESS
-{
-    bool operator()( const CN_ITEM* a, const CN_ITEM* b ) const
-    {
-        return a->Net() < b->Net();
-    }
-
-    bool operator()( const CN_ITEM* a, int b ) const
-    {
-        return a->Net() < b;
-    }
-
-    bool operator()( int a, const CN_ITEM* b ) const
-    {
-        return a < b->Net();
-    }
-};
-
-
-std::vector<CN_ITEM*> DIALOG_NET_INSPECTOR::relevantConnectivityItems() const
-{
-    // pre-filter the connectivity items and sort them by netcode.
-    // this avoids quadratic runtime when building the whole net list and
-    // calculating the total length for each net.
-
-    const auto type_bits = std::bitset<MAX_STRUCT_TYPE_ID>()
-            .set( PCB_TRACE_T )
-            .set( PCB_ARC_T )
-            .set( PCB_VIA_T )
-            .set( PCB_PAD_T );
-
-    std::vector<CN_ITEM*> cn_items;
-    cn_items.reserve( 1024 );
-
-    for( CN_ITEM* cn_item : m_brd->GetConnectivity()->GetConnectivityAlgo()->ItemList() )
-    {
-        if( cn_item->Valid() && type_bits[cn_item->Parent()->Type()] )
-            cn_items.push_back( cn_item );
-    }
-
-    std::sort( cn_items.begin(), cn_items.end(), NETCODE_CMP_LESS() );
-
-    return cn_items;
-}
-
-
 void DIALOG_NET_INSPECTOR::updateDisplayedRowValues( const OPT<LIST_ITEM_ITER>& aRow )
 {
     if( !aRow )
@@ -1108,6 +1062,15 @@ wxString DIALOG_NET_INSPECTOR::formatLength( int64_t aValue ) const
 
 
 void DIALOG_NET_INSPECTOR::OnBoardItemAdded( BOARD& aBoard, BOARD_ITEM* aBoardItem )
+{
+    std::set<NETINFO_ITEM*> staleNets;
+
+    itemAdded( aBoardItem, staleNets );
+    updateNets( staleNets );
+}
+
+
+void DIALOG_NET_INSPECTOR::itemAdded( BOARD_ITEM* aBoardItem, std::set<NETINFO_ITEM*>& aStaleNets )
 {
     if( NETINFO_ITEM* net = dynamic_cast<NETINFO_ITEM*>( aBoardItem ) )
     {
@@ -1150,7 +1113,7 @@ void DIALOG_NET_INSPECTOR::OnBoardItemAdded( BOARD& aBoard, BOARD_ITEM* aBoardIt
         }
 
         // resort to generic slower net update otherwise.
-        updateNet( i->GetNet() );
+        aStaleNets.insert( i->GetNet() );
     }
     else if( FOOTPRINT* footprint = dynamic_cast<FOOTPRINT*>( aBoardItem ) )
     {
@@ -1189,14 +1152,28 @@ void DIALOG_NET_INSPECTOR::OnBoardItemAdded( BOARD& aBoard, BOARD_ITEM* aBoardIt
 
 void DIALOG_NET_INSPECTOR::OnBoardItemsAdded( BOARD& aBoard, std::vector<BOARD_ITEM*>& aBoardItem )
 {
+    std::set<NETINFO_ITEM*> staleNets;
+
     for( BOARD_ITEM* item : aBoardItem )
     {
-        OnBoardItemAdded( aBoard, item );
+        itemAdded( item, staleNets );
     }
+
+    updateNets( staleNets );
 }
 
 
 void DIALOG_NET_INSPECTOR::OnBoardItemRemoved( BOARD& aBoard, BOARD_ITEM* aBoardItem )
+{
+    std::set<NETINFO_ITEM*> staleNets;
+
+    itemRemoved( aBoardItem, staleNets );
+    updateNets( staleNets );
+}
+
+
+void DIALOG_NET_INSPECTOR::itemRemoved( BOARD_ITEM* aBoardItem,
+                                        std::set<NETINFO_ITEM*>& aStaleNets )
 {
     if( NETINFO_ITEM* net = dynamic_cast<NETINFO_ITEM*>( aBoardItem ) )
     {
@@ -1248,7 +1225,7 @@ void DIALOG_NET_INSPECTOR::OnBoardItemRemoved( BOARD& aBoard, BOARD_ITEM* aBoard
             }
 
             // resort to generic slower net update otherwise.
-            updateNet( i->GetNet() );
+            aStaleNets.insert( i->GetNet() );
         }
     }
 }
@@ -1257,10 +1234,14 @@ void DIALOG_NET_INSPECTOR::OnBoardItemRemoved( BOARD& aBoard, BOARD_ITEM* aBoard
 void DIALOG_NET_INSPECTOR::OnBoardItemsRemoved( BOARD& aBoard,
                                                 std::vector<BOARD_ITEM*>& aBoardItems )
 {
+    std::set<NETINFO_ITEM*> staleNets;
+
     for( BOARD_ITEM* item : aBoardItems )
     {
-        OnBoardItemRemoved( aBoard, item );
+        itemRemoved( item, staleNets );
     }
+
+    updateNets( staleNets );
 }
 
 
@@ -1317,7 +1298,26 @@ void DIALOG_NET_INSPECTOR::OnBoardNetSettingsChanged( BOARD& aBoard )
 }
 
 
-void DIALOG_NET_INSPECTOR::updateNet( NETINFO_ITEM* aNet )
+void DIALOG_NET_INSPECTOR::updateNets( const std::set<NETINFO_ITEM*>& aNets )
+{
+    if( aNets.empty() )
+        return;
+
+    // one pass over the board for all the nets of this refresh
+    std::set<int> netcodes;
+
+    for( NETINFO_ITEM* net : aNets )
+        netcodes.insert( net->GetNetCode() );
+
+    DRC_NET_TOPOLOGY topology( m_brd );
+    topology.Build( netcodes );
+
+    for( NETINFO_ITEM* net : aNets )
+        updateNet( net, topology );
+}
+
+
+void DIALOG_NET_INSPECTOR::updateNet( NETINFO_ITEM* aNet, const DRC_NET_TOPOLOGY& aTopology )
 {
     // something for the specified net has changed, update that row.
     // ignore nets that are not in our list because the filter doesn't match.
@@ -1341,8 +1341,7 @@ void DIALOG_NET_INSPECTOR::updateNet( NETINFO_ITEM* aNet )
         return;
     }
 
-    std::unique_ptr<LIST_ITEM> new_list_item = buildNewItem( aNet, node_count,
-                                                             relevantConnectivityItems() );
+    std::unique_ptr<LIST_ITEM> new_list_item = buildNewItem( aNet, node_count, aTopology );
 
     if( !cur_net_row )
     {
@@ -1374,62 +1373,33 @@ void DIALOG_NET_INSPECTOR::updateNet( NETINFO_ITEM* aNet )
 
 unsigned int DIALOG_NET_INSPECTOR::calculateViaLength( const PCB_TRACK* aTrack ) const
 {
-    const PCB_VIA&         via = dynamic_cast<const PCB_VIA&>( *aTrack );
-    BOARD_DESIGN_SETTINGS& bds = m_brd->GetDesignSettings();
-
-    // calculate the via length individually from the board stackup and via's start and end layer.
-    if( bds.m_HasStackup )
-    {
-        const BOARD_STACKUP& stackup = bds.GetStackupDescriptor();
-        return stackup.GetLayerDistance( via.TopLayer(), via.BottomLayer() );
-    }
-    else
-    {
-        int dielectricLayers = bds.GetCopperLayerCount() - 1;
-        // FIXME: not all dielectric layers are the same thickness!
-        int layerThickness = bds.GetBoardThickness() / dielectricLayers;
-        int effectiveBottomLayer;
-
-        if( via.BottomLayer() == B_Cu )
-            effectiveBottomLayer = F_Cu + dielectricLayers;
-        else
-            effectiveBottomLayer = via.BottomLayer();
-
-        int layerCount = effectiveBottomLayer - via.TopLayer();
-
-        return layerCount * layerThickness;
-    }
+    return DRC_NET_TOPOLOGY::ViaLength( m_brd, &dynamic_cast<const PCB_VIA&>( *aTrack ) );
 }
 
 
 std::unique_ptr<DIALOG_NET_INSPECTOR::LIST_ITEM>
 DIALOG_NET_INSPECTOR::buildNewItem( NETINFO_ITEM* aNet, unsigned int aPadCount,
-                                    const std::vector<CN_ITEM*>& aCNItems )
+                                    const DRC_NET_TOPOLOGY& aTopology )
 {
     std::unique_ptr<LIST_ITEM> new_item = std::make_unique<LIST_ITEM>( aNet );
 
     new_item->SetPadCount( aPadCount );
 
-    const auto cn_items = std::equal_range( aCNItems.begin(), aCNItems.end(), aNet->GetNetCode(),
-                                            NETCODE_CMP_LESS() );
-
-    for( auto i = cn_items.first; i != cn_items.second; ++i )
+    if( const DRC_NET_TOPOLOGY::NET* net = aTopology.GetNet( aNet->GetNetCode() ) )
     {
-        BOARD_CONNECTED_ITEM* item = ( *i )->Parent();
+        double boardWireLength = 0.0;
+        int    viaCount = 0;
 
-        if( item->Type() == PCB_PAD_T )
-            new_item->AddChipWireLength( static_cast<PAD*>( item )->GetPadToDieLength() );
-
-        else if( PCB_TRACK* track = dynamic_cast<PCB_TRACK*>( item ) )
+        for( const DRC_NET_TOPOLOGY::CHAIN& chain : net->chains )
         {
-            new_item->AddBoardWireLength( track->GetLength() );
-
-            if( item->Type() == PCB_VIA_T )
-            {
-                new_item->AddViaCount( 1 );
-                new_item->AddViaLength( calculateViaLength( track ) );
-            }
+            boardWireLength += chain.Length();
+            viaCount += chain.ViaCount();
         }
+
+        new_item->AddChipWireLength( net->padToDieLength );
+        new_item->AddBoardWireLength( KiROUND( boardWireLength ) );
+        new_item->AddViaCount( viaCount );
+        new_item->AddViaLength( net->viaLength );
     }
 
     return new_item;
@@ -1474,7 +1444,9 @@ void DIALOG_NET_INSPECTOR::buildNetsList()
         }
     }
 
-    std::vector<CN_ITEM*> prefiltered_cn_items = relevantConnectivityItems();
+    // computes the lengths of all nets at once, in parallel
+    DRC_NET_TOPOLOGY topology( m_brd );
+    topology.Build();
 
 
     // collect all nets which pass the filter string and also remember the
@@ -1532,7 +1504,7 @@ void DIALOG_NET_INSPECTOR::buildNetsList()
     for( NET_INFO& ni : nets )
     {
         if( m_cbShowZeroPad->IsChecked() || ni.pad_count > 0 )
-            new_items.emplace_back( buildNewItem( ni.net, ni.pad_count, prefiltered_cn_items ) );
+            new_items.emplace_back( buildNewItem( ni.net, ni.pad_count, topology ) );
     }
 
 
@@ -26,12 +26,13 @@
 #pragma once
 
 #include <core/optional.h>
+#include <set>
 #include <dialog_net_inspector_base.h>
 
 class PCB_EDIT_FRAME;
 class NETINFO_ITEM;
 class BOARD;
-class CN_ITEM;
+class DRC_NET_TOPOLOGY;
 class EDA_PATTERN_MATCH;
 
 class DIALOG_NET_INSPECTOR : public DIALOG_NET_INSPECTOR_BASE, public BOARD_LISTENER
@@ -86,11 +87,23 @@ private:
     wxString formatCount( unsigned int aValue ) const;
     wxString formatLength( int64_t aValue ) const;
 
-    std::vector<CN_ITEM*> relevantConnectivityItems() const;
     bool                  netFilterMatches( NETINFO_ITEM* aNet ) const;
-    void                  updateNet( NETINFO_ITEM* aNet );
+    void                  updateNet( NETINFO_ITEM* aNet, const DRC_NET_TOPOLOGY& aTopology );
+
+    /**
+     * Update the rows of \a aNets, computing their topology in a single pass over the board.
+     */
+    void                  updateNets( const std::set<NETINFO_ITEM*>& aNets );
     unsigned int          calculateViaLength( const PCB_TRACK* ) const;
 
+    /**
+     * Account for an added or removed item in the list.  Nets that can't be updated in place
+     * are added to \a aStaleNets, for a later updateNets().
+     */
+    void                  itemAdded( BOARD_ITEM* aBoardItem, std::set<NETINFO_ITEM*>& aStaleNets );
+    void                  itemRemoved( BOARD_ITEM* aBoardItem,
+                                       std::set<NETINFO_ITEM*>& aStaleNets );
+
     void onSelChanged( wxDataViewEvent& event ) override;
     void onSelChanged();
     void onSortingChanged( wxDataViewEvent& event ) override;
@@ -102,7 +115,7 @@ private:
     void onReport( wxCommandEvent& event ) override;
 
     std::unique_ptr<LIST_ITEM> buildNewItem( NETINFO_ITEM* aNet, unsigned int aPadCount,
-                                             const std::vector<CN_ITEM*>& aCNItems );
+                                             const DRC_NET_TOPOLOGY& aTopology );
 
     void buildNetsList();
     void adjustListColumns();
@@ -0,0 +1,197 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <board.h>
+#include <board_design_settings.h>
+#include <pad.h>
+#include <pcb_track.h>
+#include <geometry/shape.h>
+#include <drc/drc_distance_cache.h>
+
+
+DRC_DISTANCE_CACHE::DRC_DISTANCE_CACHE() :
+        m_board( nullptr ),
+        m_holePlatingThickness( 0 ),
+        m_run( 0 ),
+        m_hits( 0 ),
+        m_misses( 0 )
+{
+}
+
+
+int DRC_DISTANCE_CACHE::shapeCode( const DRC_ITEM_SHAPE& aShape )
+{
+    // Codes identify distinct geometries, so that the DRC and effective shapes share results
+    // wherever they are the same thing.
+    enum
+    {
+        HOLE = 0,
+        COPPER = 1,
+        UNFLASHED = 2,      // pad or via not flashed on the layer: a plated hole
+        COURTYARD = 3
+    };
+
+    const BOARD_ITEM* item = aShape.item;
+
+    if( aShape.type == DRC_SHAPE_TYPE::HOLE )
+        return HOLE;
+
+    if( aShape.type == DRC_SHAPE_TYPE::COURTYARD )
+        return COURTYARD;
+
+    if( item->Type() == PCB_PAD_T )
+    {
+        // A pad's effective shape does not depend on the layer
+        if( aShape.type == DRC_SHAPE_TYPE::EFFECTIVE_SHAPE )
+            return COPPER;
+
+        return static_cast<const PAD*>( item )->FlashLayer( aShape.layer ) ? COPPER : UNFLASHED;
+    }
+
+    if( item->Type() == PCB_VIA_T )
+    {
+        return static_cast<const PCB_VIA*>( item )->FlashLayer( aShape.layer ) ? COPPER
+                                                                               : UNFLASHED;
+    }
+
+    return COPPER;
+}
+
+
+bool DRC_DISTANCE_CACHE::Collide( const DRC_ITEM_SHAPE& aA, const DRC_ITEM_SHAPE& aB,
+                                  int aClearance, int* aActual, VECTOR2I* aLocation )
+{
+    KEY key = { aA.item->m_Uuid, aB.item->m_Uuid, aA.layer, aB.layer,
+                shapeCode( aA ) * 4 + shapeCode( aB ), aA.subShape * 65536 + aB.subShape,
+                aClearance };
+
+    uint64_t revA = aA.item->GetGeometryRevision();
+    uint64_t revB = aB.item->GetGeometryRevision();
+    SHARD&   shard = m_shards[ KEY_HASH()( key ) % SHARD_COUNT ];
+
+    {
+        std::lock_guard<std::mutex> lock( shard.mutex );
+        auto                        it = shard.results.find( key );
+
+        if( it != shard.results.end() && it->second.revA == revA && it->second.revB == revB )
+        {
+            RESULT& result = it->second;
+
+            result.run = m_run;
+            m_hits.fetch_add( 1, std::memory_order_relaxed );
+
+            if( result.collision )
+            {
+                if( aActual )
+                    *aActual = result.actual;
+
+                if( aLocation )
+                    *aLocation = result.location;
+            }
+
+            return result.collision;
+        }
+    }
+
+    // The shard isn't held while testing: another thread may test the same pair meanwhile,
+    // and both store the same result
+    int      actual = 0;
+    VECTOR2I location;
+    bool     collision = aA.shape->Collide( aB.shape, aClearance, &actual, &location );
+
+    m_misses.fetch_add( 1, std::memory_order_relaxed );
+
+    {
+        std::lock_guard<std::mutex> lock( shard.mutex );
+
+        shard.results[ key ] = { revA, revB, collision, actual, location, m_run };
+    }
+
+    if( collision )
+    {
+        if( aActual )
+            *aActual = actual;
+
+        if( aLocation )
+            *aLocation = location;
+    }
+
+    return collision;
+}
+
+
+void DRC_DISTANCE_CACHE::BeginRun( const BOARD* aBoard )
+{
+    int holePlatingThickness = 0;
+
+    if( aBoard )
+        holePlatingThickness = aBoard->GetDesignSettings().GetHolePlatingThickness();
+
+    if( aBoard != m_board || holePlatingThickness != m_holePlatingThickness )
+    {
+        Clear();
+        m_board = aBoard;
+        m_holePlatingThickness = holePlatingThickness;
+    }
+    else
+    {
+        for( SHARD& shard : m_shards )
+        {
+            std::lock_guard<std::mutex> lock( shard.mutex );
+
+            for( auto it = shard.results.begin(); it != shard.results.end(); )
+            {
+                if( it->second.run != m_run )
+                    it = shard.results.erase( it );
+                else
+                    ++it;
+            }
+        }
+    }
+
+    m_run++;
+}
+
+
+void DRC_DISTANCE_CACHE::Clear()
+{
+    for( SHARD& shard : m_shards )
+    {
+        std::lock_guard<std::mutex> lock( shard.mutex );
+        shard.results.clear();
+    }
+}
+
+
+size_t DRC_DISTANCE_CACHE::Size() const
+{
+    size_t size = 0;
+
+    for( const SHARD& shard : m_shards )
+    {
+        std::lock_guard<std::mutex> lock( shard.mutex );
+        size += shard.results.size();
+    }
+
+    return size;
+}
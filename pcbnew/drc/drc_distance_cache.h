@@ -0,0 +1,184 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef DRC_DISTANCE_CACHE_H
+#define DRC_DISTANCE_CACHE_H
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+#include <hash_eda.h>
+#include <kiid.h>
+#include <layer_ids.h>
+#include <math/vector2d.h>
+
+class BOARD;
+class BOARD_ITEM;
+class SHAPE;
+
+
+/**
+ * Which of an item's shapes is being tested.
+ */
+enum class DRC_SHAPE_TYPE
+{
+    DRC_SHAPE,          ///< DRC_ENGINE::GetShape() on the layer
+    EFFECTIVE_SHAPE,    ///< BOARD_ITEM::GetEffectiveShape() on the layer
+    HOLE,               ///< the drilled hole
+    COURTYARD           ///< FOOTPRINT::GetPolyCourtyard() of the layer
+};
+
+
+/**
+ * A shape of a board item, as tested by DRC_DISTANCE_CACHE::Collide().
+ */
+struct DRC_ITEM_SHAPE
+{
+    const BOARD_ITEM* item;
+    const SHAPE*      shape;
+    DRC_SHAPE_TYPE    type;
+    PCB_LAYER_ID      layer;            ///< the layer the shape was fetched for
+    int               subShape = 0;     ///< tells apart pieces of an item tested separately
+};
+
+
+/**
+ * Memoizes shape-to-shape collision results between board items so that DRC providers can
+ * share them, and so that later DRC runs can reuse them for items which have not changed.
+ *
+ * Results are keyed by the pair of item KIIDs, which shape of each item was tested and on
+ * which layer, and the clearance.  They are only reused while both items keep the geometry
+ * revision they had when the result was stored (see BOARD_ITEM::GetGeometryRevision()).
+ *
+ * Each clearance gets a result of its own, so that the distance and location reported for a
+ * collision are always those SHAPE::Collide() finds at that clearance.  A pair is usually
+ * tested with a handful of clearances at most.
+ *
+ * The cache is split into independently locked shards and may be used from several threads.
+ */
+class DRC_DISTANCE_CACHE
+{
+public:
+    DRC_DISTANCE_CACHE();
+
+    /**
+     * Equivalent to aA.shape->Collide( aB.shape, aClearance, aActual, aLocation ).
+     */
+    bool Collide( const DRC_ITEM_SHAPE& aA, const DRC_ITEM_SHAPE& aB, int aClearance,
+                  int* aActual, VECTOR2I* aLocation );
+
+    /**
+     * Equivalent to aShapeA->Collide( aShapeB, aClearance, aActual, aLocation ), where
+     * aShapeA and aShapeB are the shapes of type aTypeA and aTypeB of aItemA and aItemB on
+     * aLayer.
+     */
+    bool Collide( const BOARD_ITEM* aItemA, const SHAPE* aShapeA, DRC_SHAPE_TYPE aTypeA,
+                  const BOARD_ITEM* aItemB, const SHAPE* aShapeB, DRC_SHAPE_TYPE aTypeB,
+                  PCB_LAYER_ID aLayer, int aClearance, int* aActual, VECTOR2I* aLocation )
+    {
+        return Collide( { aItemA, aShapeA, aTypeA, aLayer }, { aItemB, aShapeB, aTypeB, aLayer },
+                        aClearance, aActual, aLocation );
+    }
+
+    /**
+     * Prepare for a new DRC run.
+     *
+     * Drops everything if the board or the hole plating thickness changed, otherwise drops
+     * the results which were not used during the previous run (typically those of deleted or
+     * modified items).
+     */
+    void BeginRun( const BOARD* aBoard );
+
+    void Clear();
+
+    size_t Size() const;
+
+    ///< @return the number of queries answered from the cache since it was created.
+    int64_t GetHitCount() const { return m_hits.load( std::memory_order_relaxed ); }
+
+    ///< @return the number of queries which had to test the shapes.
+    int64_t GetMissCount() const { return m_misses.load( std::memory_order_relaxed ); }
+
+private:
+    struct KEY
+    {
+        KIID         a;
+        KIID         b;
+        PCB_LAYER_ID layerA;
+        PCB_LAYER_ID layerB;
+        int          shapes;       ///< which shape of each item, see shapeCode()
+        int          subShapes;
+        int          clearance;
+
+        bool operator==( const KEY& aOther ) const
+        {
+            return a == aOther.a && b == aOther.b && layerA == aOther.layerA
+                   && layerB == aOther.layerB && shapes == aOther.shapes
+                   && subShapes == aOther.subShapes && clearance == aOther.clearance;
+        }
+    };
+
+    struct KEY_HASH
+    {
+        size_t operator()( const KEY& aKey ) const
+        {
+            size_t seed = aKey.a.Hash() ^ ( aKey.b.Hash() * 31 );
+
+            hash_combine( seed, aKey.layerA, aKey.layerB, aKey.shapes, aKey.subShapes,
+                          aKey.clearance );
+            return seed;
+        }
+    };
+
+    struct RESULT
+    {
+        uint64_t revA;
+        uint64_t revB;
+        bool     collision;
+        int      actual;       ///< the distance found, if colliding
+        VECTOR2I location;
+        unsigned run;          ///< the last run in which the result was used
+    };
+
+    struct SHARD
+    {
+        mutable std::mutex                        mutex;
+        std::unordered_map<KEY, RESULT, KEY_HASH> results;
+    };
+
+    static int shapeCode( const DRC_ITEM_SHAPE& aShape );
+
+    static constexpr size_t SHARD_COUNT = 16;
+
+    std::array<SHARD, SHARD_COUNT> m_shards;
+    const BOARD*                   m_board;
+    int                            m_holePlatingThickness;
+    unsigned                       m_run;
+
+    std::atomic<int64_t>           m_hits;
+    std::atomic<int64_t>           m_misses;
+};
+
+#endif // DRC_DISTANCE_CACHE_H
@@ -23,6 +23,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <array>
+
 #include <reporter.h>
 #include <progress_reporter.h>
 #include <string_utils.h>
@@ -34,13 +36,21 @@
 #include <drc/drc_rule_condition.h>
 #include <drc/drc_test_provider.h>
 #include <drc/drc_item.h>
+#include <drc/drc_net_topology.h>
+#include <drc/drc_profile.h>
+#include <connectivity/connectivity_data.h>
+#include <connectivity/from_to_cache.h>
 #include <footprint.h>
+#include <pcb_marker.h>
 #include <pad.h>
+#include <advanced_config.h>
+#include <trace_helpers.h>
 #include <pcb_track.h>
 #include <zone.h>
 #include <geometry/shape.h>
 #include <geometry/shape_segment.h>
 #include <geometry/shape_null.h>
+#include <geometry/packed_rtree.h>
 
 
 // wxListBox's performance degrades horrifically with very large datasets.  It's not clear
@@ -74,7 +84,10 @@ DRC_ENGINE::DRC_ENGINE( BOARD* aBoard, BOARD_DESIGN_SETTINGS *aSettings ) :
     m_reportAllTrackErrors( false ),
     m_testFootprints( false ),
     m_reporter( nullptr ),
-    m_progressReporter( nullptr )
+    m_progressReporter( nullptr ),
+    m_testRegionOnly( false ),
+    m_profiling( false ),
+    m_activeProfile( nullptr )
 {
     m_errorLimits.resize( DRCE_LAST + 1 );
 
@@ -532,6 +545,152 @@ void DRC_ENGINE::compileRules()
             m_constraintMap[ constraint.m_Type ]->push_back( engineConstraint );
         }
     }
+
+    // When every condition of a constraint type reads only nets, netclasses and item types,
+    // the resolved constraint is the same for all item pairs which share those, and EvalRules()
+    // can look it up rather than running the conditions.  Disallow constraints also test the
+    // item's layers and flags, so are always evaluated.
+    m_resolutionTables.clear();
+
+    for( std::pair<DRC_CONSTRAINT_T, std::vector<DRC_ENGINE_CONSTRAINT*>*> pair : m_constraintMap )
+    {
+        if( pair.first == DISALLOW_CONSTRAINT )
+            continue;
+
+        int dependencies = 0;
+
+        for( DRC_ENGINE_CONSTRAINT* c : *pair.second )
+        {
+            if( c->condition )
+                dependencies |= c->condition->GetDependencies();
+        }
+
+        if( dependencies & DRC_RULE_CONDITION::DEP_OTHER )
+            continue;
+
+        std::unique_ptr<RESOLUTION_TABLE> table = std::make_unique<RESOLUTION_TABLE>();
+
+        table->byNet = ( dependencies & DRC_RULE_CONDITION::DEP_NETNAME ) > 0;
+        table->timeStamp = -1;
+        table->generation = newResolutionGeneration();
+
+        m_resolutionTables[ pair.first ] = std::move( table );
+    }
+
+    m_profile.SetRules( m_rules );
+}
+
+
+uint64_t DRC_ENGINE::newResolutionGeneration()
+{
+    static std::atomic<uint64_t> s_next( 1 );
+    return s_next.fetch_add( 1, std::memory_order_relaxed );
+}
+
+
+DRC_ENGINE::LOCAL_RESOLUTION& DRC_ENGINE::localResolution( const RESOLUTION_TABLE* aTable,
+                                                           const RESOLUTION_KEY& aKey )
+{
+    static constexpr size_t LOCAL_SIZE = 256;     // power of 2
+
+    thread_local std::array<LOCAL_RESOLUTION, LOCAL_SIZE> entries{};
+
+    size_t h = RESOLUTION_KEY_HASH()( aKey ) ^ std::hash<const void*>()( aTable );
+    return entries[ ( h ^ ( h >> 16 ) ) & ( LOCAL_SIZE - 1 ) ];
+}
+
+
+bool DRC_ENGINE::findResolution( RESOLUTION_TABLE* aTable, const RESOLUTION_KEY& aKey,
+                                 DRC_CONSTRAINT& aConstraint ) const
+{
+    int timeStamp = m_board->GetTimeStamp();
+
+    // The generation is published before the timestamp, so a matching timestamp guarantees
+    // the generation read after it is current.
+    if( aTable->timeStamp.load( std::memory_order_acquire ) == timeStamp )
+    {
+        uint64_t          generation = aTable->generation.load( std::memory_order_relaxed );
+        LOCAL_RESOLUTION& local = localResolution( aTable, aKey );
+
+        if( local.table == aTable && local.generation == generation && local.key == aKey )
+        {
+            aConstraint = local.constraint;
+            return true;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock( aTable->mutex );
+
+    if( aTable->timeStamp.load( std::memory_order_relaxed ) != timeStamp )
+    {
+        aTable->results.clear();
+        aTable->generation.store( newResolutionGeneration(), std::memory_order_relaxed );
+        aTable->timeStamp.store( timeStamp, std::memory_order_release );
+    }
+
+    auto it = aTable->results.find( aKey );
+
+    if( it == aTable->results.end() )
+        return false;
+
+    aConstraint = it->second;
+    localResolution( aTable, aKey ) = { aTable, aTable->generation.load(), aKey, aConstraint };
+    return true;
+}
+
+
+void DRC_ENGINE::storeResolution( RESOLUTION_TABLE* aTable, const RESOLUTION_KEY& aKey,
+                                  const DRC_CONSTRAINT& aConstraint ) const
+{
+    std::lock_guard<std::mutex> lock( aTable->mutex );
+
+    // Drop resolutions made against a board state which has been invalidated meanwhile
+    if( aTable->timeStamp.load( std::memory_order_relaxed ) != m_board->GetTimeStamp() )
+        return;
+
+    aTable->results.emplace( aKey, aConstraint );
+    localResolution( aTable, aKey ) = { aTable, aTable->generation.load(), aKey, aConstraint };
+}
+
+
+DRC_ENGINE::RESOLUTION_KEY DRC_ENGINE::makeResolutionKey( const RESOLUTION_TABLE* aTable,
+                                                          const BOARD_ITEM* a,
+                                                          const BOARD_ITEM* b,
+                                                          PCB_LAYER_ID aLayer,
+                                                          bool aNonCopper, bool bNonCopper ) const
+{
+    // Stand-ins for items which have no net properties at all, and for connected items
+    // without a NETINFO_ITEM
+    static const char unconnected = 0;
+    static const char noNetinfo = 0;
+
+    auto netKey =
+            [&]( const BOARD_ITEM* aItem ) -> const void*
+            {
+                if( !aItem || !aItem->IsConnected() )
+                    return &unconnected;
+
+                NETINFO_ITEM* net = static_cast<const BOARD_CONNECTED_ITEM*>( aItem )->GetNet();
+
+                if( !net )
+                    return &noNetinfo;
+                else if( aTable->byNet )
+                    return net;
+                else
+                    return net->GetNetClass();
+            };
+
+    RESOLUTION_KEY key;
+
+    key.netA = netKey( a );
+    key.netB = netKey( b );
+    key.typeA = a ? (int) a->Type() : -1;
+    key.typeB = b ? (int) b->Type() : -1;
+    key.layer = aLayer;
+    key.aNonCopper = aNonCopper;
+    key.bNonCopper = bNonCopper;
+
+    return key;
 }
 
 
@@ -560,6 +719,7 @@ void DRC_ENGINE::InitEngine( const wxFileName& aRulePath )
     }
 
     m_constraintMap.clear();
+    m_resolutionTables.clear();
 
     m_board->IncrementTimeStamp();  // Clear board-level caches
 
@@ -591,13 +751,8 @@ void DRC_ENGINE::InitEngine( const wxFileName& aRulePath )
 }
 
 
-void DRC_ENGINE::RunTests( EDA_UNITS aUnits, bool aReportAllTrackErrors, bool aTestFootprints )
+void DRC_ENGINE::resetErrorLimits()
 {
-    m_userUnits = aUnits;
-
-    m_reportAllTrackErrors = aReportAllTrackErrors;
-    m_testFootprints = aTestFootprints;
-
     for( int ii = DRCE_FIRST; ii < DRCE_LAST; ++ii )
     {
         if( m_designSettings->Ignore( ii ) )
@@ -605,35 +760,38 @@ void DRC_ENGINE::RunTests( EDA_UNITS aUnits, bool aReportAllTrackErrors, bool aT
         else
             m_errorLimits[ ii ] = ERROR_LIMIT_MAX;
     }
+}
 
-    m_board->IncrementTimeStamp();      // Invalidate all caches
 
+bool DRC_ENGINE::prepareZones()
+{
     if( !ReportPhase( _( "Tessellating copper zones..." ) ) )
-        return;
+        return false;
 
     // Number of zones between progress bar updates
     int                delta = 5;
     std::vector<ZONE*> copperZones;
 
-    for( ZONE* zone : m_board->Zones() )
-    {
-        zone->CacheBoundingBox();
-        zone->CacheTriangulation();
+    auto prepareZone =
+            [&]( ZONE* zone )
+            {
+                zone->CacheBoundingBox();
+                zone->CacheTriangulation();
 
-        if( ( zone->GetLayerSet() & LSET::AllCuMask() ).any() && !zone->GetIsRuleArea() )
-            copperZones.push_back( zone );
-    }
+                if( ( zone->GetLayerSet() & LSET::AllCuMask() ).any() && !zone->GetIsRuleArea()
+                        && IsInTestRegion( zone ) )
+                {
+                    copperZones.push_back( zone );
+                }
+            };
+
+    for( ZONE* zone : m_board->Zones() )
+        prepareZone( zone );
 
     for( FOOTPRINT* footprint : m_board->Footprints() )
     {
         for( ZONE* zone : footprint->Zones() )
-        {
-            zone->CacheBoundingBox();
-            zone->CacheTriangulation();
-
-            if( ( zone->GetLayerSet() & LSET::AllCuMask() ).any() && !zone->GetIsRuleArea() )
-                copperZones.push_back( zone );
-        }
+            prepareZone( zone );
 
         footprint->BuildPolyCourtyards();
     }
@@ -647,7 +805,7 @@ void DRC_ENGINE::RunTests( EDA_UNITS aUnits, bool aReportAllTrackErrors, bool aT
         if( ( ii % delta ) == 0 || ii == zoneCount -  1 )
         {
             if( !ReportProgress( (double) ii / (double) zoneCount ) )
-                return;
+                return false;
         }
 
         m_board->m_CopperZoneRTrees[ zone ] = std::make_unique<DRC_RTREE>();
@@ -657,15 +815,309 @@ void DRC_ENGINE::RunTests( EDA_UNITS aUnits, bool aReportAllTrackErrors, bool aT
             if( IsCopperLayer( layer ) )
                 m_board->m_CopperZoneRTrees[ zone ]->Insert( zone, layer );
         }
+
+        m_board->m_CopperZoneRTrees[ zone ]->Build();
     }
 
+    return true;
+}
+
+
+void DRC_ENGINE::RunTests( EDA_UNITS aUnits, bool aReportAllTrackErrors, bool aTestFootprints )
+{
+    m_userUnits = aUnits;
+
+    m_reportAllTrackErrors = aReportAllTrackErrors;
+    m_testFootprints = aTestFootprints;
+
+    m_testRegionOnly = false;
+    m_regionItems.clear();
+    m_regionItemIDs.clear();
+    m_removedItemIDs.clear();
+    m_regionErrorCodes.clear();
+
+    resetErrorLimits();
+
+    m_board->IncrementTimeStamp();      // Invalidate all caches
+    m_distanceCache.BeginRun( m_board );
+
+    if( !prepareZones() )
+        return;
+
+    clearRunCaches();
+    beginProfile();
+
     for( DRC_TEST_PROVIDER* provider : m_testProviders )
     {
         ReportAux( wxString::Format( "Run DRC provider: '%s'", provider->GetName() ) );
 
-        if( !provider->Run() )
+        if( !runProvider( provider ) )
             break;
     }
+
+    endProfile();
+    clearRunCaches();
+}
+
+
+DRC_ENGINE::SHARED_INDEX& DRC_ENGINE::GetSharedIndex( const std::vector<KICAD_T>& aTypes )
+{
+    SHARED_INDEX& index = m_sharedIndexes[ aTypes ];
+
+    if( !index.tree )
+        index.tree = std::make_unique<DRC_RTREE>();
+
+    return index;
+}
+
+
+const DRC_NET_TOPOLOGY& DRC_ENGINE::GetNetTopology()
+{
+    if( !m_netTopology )
+    {
+        m_board->GetConnectivity()->GetFromToCache()->Rebuild( m_board );
+
+        m_netTopology = std::make_unique<DRC_NET_TOPOLOGY>( m_board );
+        m_netTopology->Build();
+    }
+
+    return *m_netTopology;
+}
+
+
+void DRC_ENGINE::clearRunCaches()
+{
+    m_sharedIndexes.clear();
+    m_netTopology.reset();
+}
+
+
+void DRC_ENGINE::beginProfile()
+{
+    if( !m_profiling && !ADVANCED_CFG::GetCfg().m_DRCProfile )
+        return;
+
+    m_profile.Reset();
+    m_activeProfile = &m_profile;
+    DRC_RTREE::EnableQueryCount( true );
+}
+
+
+bool DRC_ENGINE::runProvider( DRC_TEST_PROVIDER* aProvider )
+{
+    if( !m_activeProfile )
+        return aProvider->Run();
+
+    m_activeProfile->BeginProvider( aProvider );
+    bool result = aProvider->Run();
+    m_activeProfile->EndProvider();
+
+    return result;
+}
+
+
+void DRC_ENGINE::endProfile()
+{
+    if( !m_activeProfile )
+        return;
+
+    DRC_RTREE::EnableQueryCount( false );
+    m_activeProfile = nullptr;
+
+    if( ADVANCED_CFG::GetCfg().m_DRCProfile )
+        wxLogTrace( traceDrcProfile, "%s", m_profile.ToJSON() );
+}
+
+
+bool DRC_ENGINE::evaluate( DRC_RULE_CONDITION* aExpression, const DRC_RULE* aRule,
+                           const BOARD_ITEM* a, const BOARD_ITEM* b, PCB_LAYER_ID aLayer,
+                           REPORTER* aReporter )
+{
+    DRC_PROFILE::EVAL_TIMER timer( m_activeProfile, aRule );
+
+    return aExpression->EvaluateFor( a, b, aLayer, aReporter );
+}
+
+
+int DRC_ENGINE::worstClearance()
+{
+    static const DRC_CONSTRAINT_T clearanceTypes[] = {
+        CLEARANCE_CONSTRAINT, HOLE_CLEARANCE_CONSTRAINT, HOLE_TO_HOLE_CONSTRAINT,
+        EDGE_CLEARANCE_CONSTRAINT, SILK_CLEARANCE_CONSTRAINT, MECHANICAL_CLEARANCE_CONSTRAINT,
+        MECHANICAL_HOLE_CLEARANCE_CONSTRAINT
+    };
+
+    DRC_CONSTRAINT constraint;
+    int            worst = 0;
+
+    for( DRC_CONSTRAINT_T type : clearanceTypes )
+    {
+        if( QueryWorstConstraint( type, constraint ) )
+            worst = std::max( worst, constraint.GetValue().Min() );
+    }
+
+    // Local clearances override the rules
+    for( ZONE* zone : m_board->Zones() )
+        worst = std::max( worst, zone->GetLocalClearance() );
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+    {
+        for( PAD* pad : footprint->Pads() )
+            worst = std::max( worst, pad->GetLocalClearance() );
+
+        for( ZONE* zone : footprint->Zones() )
+            worst = std::max( worst, zone->GetLocalClearance() );
+    }
+
+    return worst + m_designSettings->GetDRCEpsilon();
+}
+
+
+void DRC_ENGINE::RunIncrementalTests( EDA_UNITS aUnits,
+                                      const std::vector<BOARD_ITEM*>& aChangedItems,
+                                      const std::vector<EDA_RECT>& aPreviousAreas,
+                                      const std::set<KIID>& aRemovedItems )
+{
+    m_userUnits = aUnits;
+
+    m_reportAllTrackErrors = false;
+    m_testFootprints = false;
+
+    resetErrorLimits();
+
+    // Unlike full runs, don't start a new distance cache run: its results are kept for the
+    // items this run doesn't test.
+    m_board->IncrementTimeStamp();      // Invalidate all caches
+
+    std::vector<EDA_RECT> areas = aPreviousAreas;
+    PACKED_RTREE<int>     regionTree;
+    int                   margin = worstClearance();
+
+    for( BOARD_ITEM* item : aChangedItems )
+        areas.push_back( item->GetBoundingBox() );
+
+    for( int ii = 0; ii < (int) areas.size(); ++ii )
+    {
+        EDA_RECT& area = areas[ ii ];
+
+        area.Normalize();
+        area.Inflate( margin );
+
+        int min[2] = { area.GetX(), area.GetY() };
+        int max[2] = { area.GetRight(), area.GetBottom() };
+
+        regionTree.Insert( min, max, ii );
+    }
+
+    regionTree.Build();
+
+    m_testRegionOnly = true;
+    m_regionItems.clear();
+    m_regionItemIDs.clear();
+    m_removedItemIDs = aRemovedItems;
+    m_regionErrorCodes.clear();
+
+    auto addIfInRegion =
+            [&]( BOARD_ITEM* aItem )
+            {
+                EDA_RECT bbox = aItem->GetBoundingBox();
+                int      min[2] = { bbox.GetX(), bbox.GetY() };
+                int      max[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+                auto stopAtFirst =
+                        []( const int& )
+                        {
+                            return false;
+                        };
+
+                if( regionTree.Search( min, max, stopAtFirst ) > 0 )
+                {
+                    m_regionItems.insert( aItem );
+                    m_regionItemIDs.insert( aItem->m_Uuid );
+                }
+            };
+
+    for( PCB_TRACK* track : m_board->Tracks() )
+        addIfInRegion( track );
+
+    for( BOARD_ITEM* item : m_board->Drawings() )
+        addIfInRegion( item );
+
+    for( ZONE* zone : m_board->Zones() )
+        addIfInRegion( zone );
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+    {
+        addIfInRegion( footprint );
+        addIfInRegion( &footprint->Reference() );
+        addIfInRegion( &footprint->Value() );
+
+        for( PAD* pad : footprint->Pads() )
+            addIfInRegion( pad );
+
+        for( BOARD_ITEM* item : footprint->GraphicalItems() )
+            addIfInRegion( item );
+
+        for( ZONE* zone : footprint->Zones() )
+            addIfInRegion( zone );
+    }
+
+    if( !prepareZones() )
+        return;
+
+    clearRunCaches();
+    beginProfile();
+
+    for( DRC_TEST_PROVIDER* provider : m_testProviders )
+    {
+        std::set<int> errorCodes = provider->GetRegionErrorCodes();
+
+        if( errorCodes.empty() )
+            continue;
+
+        m_regionErrorCodes.insert( errorCodes.begin(), errorCodes.end() );
+
+        ReportAux( wxString::Format( "Run DRC provider on %d items: '%s'",
+                                     (int) m_regionItems.size(),
+                                     provider->GetName() ) );
+
+        if( !runProvider( provider ) )
+            break;
+    }
+
+    endProfile();
+    clearRunCaches();
+}
+
+
+bool DRC_ENGINE::allItemsInTestRegion( const std::shared_ptr<RC_ITEM>& aItem ) const
+{
+    for( const KIID& id : { aItem->GetMainItemID(), aItem->GetAuxItemID(),
+                            aItem->GetAuxItem2ID(), aItem->GetAuxItem3ID() } )
+    {
+        if( id != niluuid && !m_regionItemIDs.count( id ) )
+            return false;
+    }
+
+    return true;
+}
+
+
+bool DRC_ENGINE::IsStaleMarker( const PCB_MARKER* aMarker ) const
+{
+    const std::shared_ptr<RC_ITEM>& rcItem = aMarker->GetRCItem();
+
+    if( !m_testRegionOnly || !m_regionErrorCodes.count( rcItem->GetErrorCode() ) )
+        return false;
+
+    for( const KIID& id : { rcItem->GetMainItemID(), rcItem->GetAuxItemID(),
+                            rcItem->GetAuxItem2ID(), rcItem->GetAuxItem3ID() } )
+    {
+        if( id != niluuid && !m_regionItemIDs.count( id ) && !m_removedItemIDs.count( id ) )
+            return false;
+    }
+
+    return true;
 }
 
 
@@ -878,7 +1330,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintType, const BO
                 REPORT( wxString::Format( _( "Checking assertion \"%s\"." ),
                                           EscapeHTML( c->constraint.m_Test->GetExpression() ) ) )
 
-                if( c->constraint.m_Test->EvaluateFor( a, b, aLayer, aReporter ) )
+                if( evaluate( c->constraint.m_Test, c->parentRule, a, b, aLayer, aReporter ) )
                     REPORT( _( "Assertion passed." ) )
                 else
                     REPORT( EscapeHTML( _( "--> Assertion failed. <--" ) ) )
@@ -1105,7 +1557,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintType, const BO
                                                   EscapeHTML( c->condition->GetExpression() ) ) )
                     }
 
-                    if( c->condition->EvaluateFor( a, b, aLayer, aReporter ) )
+                    if( evaluate( c->condition, c->parentRule, a, b, aLayer, aReporter ) )
                     {
                         if( aReporter )
                         {
@@ -1157,9 +1609,33 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintType, const BO
     if( m_constraintMap.count( aConstraintType ) )
     {
         std::vector<DRC_ENGINE_CONSTRAINT*>* ruleset = m_constraintMap[ aConstraintType ];
+        RESOLUTION_TABLE*                    table = nullptr;
+        RESOLUTION_KEY                       key = {};
+        bool                                 resolved = false;
 
-        for( int ii = 0; ii < (int) ruleset->size(); ++ii )
-            processConstraint( ruleset->at( ii ) );
+        // Reports need the rules walked one by one
+        if( !aReporter && m_board )
+        {
+            auto it = m_resolutionTables.find( aConstraintType );
+
+            if( it != m_resolutionTables.end() )
+                table = it->second.get();
+        }
+
+        if( table )
+        {
+            key = makeResolutionKey( table, a, b, aLayer, a_is_non_copper, b_is_non_copper );
+            resolved = findResolution( table, key, constraint );
+        }
+
+        if( !resolved )
+        {
+            for( int ii = 0; ii < (int) ruleset->size(); ++ii )
+                processConstraint( ruleset->at( ii ) );
+
+            if( table )
+                storeResolution( table, key, constraint );
+        }
     }
 
     if( constraint.GetParentRule() && !constraint.GetParentRule()->m_Implicit )
@@ -1296,7 +1772,8 @@ void DRC_ENGINE::ProcessAssertions( const BOARD_ITEM* a,
                 REPORT( wxString::Format( _( "Checking rule assertion \"%s\"." ),
                                           EscapeHTML( c->constraint.m_Test->GetExpression() ) ) )
 
-                if( c->constraint.m_Test->EvaluateFor( a, nullptr, a->GetLayer(), aReporter ) )
+                if( evaluate( c->constraint.m_Test, c->parentRule, a, nullptr, a->GetLayer(),
+                              aReporter ) )
                 {
                     REPORT( _( "Assertion passed." ) )
                 }
@@ -1329,7 +1806,8 @@ void DRC_ENGINE::ProcessAssertions( const BOARD_ITEM* a,
                     REPORT( wxString::Format( _( "Checking rule condition \"%s\"." ),
                                               EscapeHTML( c->condition->GetExpression() ) ) )
 
-                    if( c->condition->EvaluateFor( a, nullptr, a->GetLayer(), aReporter ) )
+                    if( evaluate( c->condition, c->parentRule, a, nullptr, a->GetLayer(),
+                                  aReporter ) )
                     {
                         REPORT( _( "Rule applied." ) )
                         testAssertion( c );
@@ -1365,6 +1843,11 @@ bool DRC_ENGINE::IsErrorLimitExceeded( int error_code )
 
 void DRC_ENGINE::ReportViolation( const std::shared_ptr<DRC_ITEM>& aItem, const wxPoint& aPos )
 {
+    // Violations involving items outside the test region weren't re-tested as a whole; their
+    // markers from the previous run are kept.
+    if( m_testRegionOnly && !allItemsInTestRegion( aItem ) )
+        return;
+
     m_errorLimits[ aItem->GetErrorCode() ] -= 1;
 
     if( m_violationHandler )
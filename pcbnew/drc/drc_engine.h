@@ -24,17 +24,28 @@
 #ifndef DRC_ENGINE_H
 #define DRC_ENGINE_H
 
+#include <atomic>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 
+#include <eda_rect.h>
+#include <kiid.h>
 #include <geometry/shape.h>
 
 #include <drc/drc_rule.h>
+#include <drc/drc_distance_cache.h>
+#include <drc/drc_profile.h>
 
 
 class BOARD_DESIGN_SETTINGS;
 class DRC_TEST_PROVIDER;
+class DRC_RTREE;
+class DRC_NET_TOPOLOGY;
 class PCB_EDIT_FRAME;
 class DS_PROXY_VIEW_ITEM;
 class BOARD_ITEM;
@@ -59,6 +70,7 @@ void drcPrintDebugMessage( int level, const wxString& msg, const char *function,
 
 class DRC_RULE_CONDITION;
 class DRC_ITEM;
+class RC_ITEM;
 class DRC_RULE;
 class DRC_CONSTRAINT;
 
@@ -143,6 +155,38 @@ public:
      */
     void RunTests( EDA_UNITS aUnits,  bool aReportAllTrackErrors, bool aTestFootprints );
 
+    /**
+     * Re-run the tests which can be limited to part of the board around a set of edits.
+     *
+     * The test region covers the bounding boxes of \a aChangedItems, and the areas those items
+     * (or since-removed items) occupied before the edit, each inflated by the worst clearance
+     * of the rules.  Only providers returning some GetRegionErrorCodes() are run, and only
+     * violations between items which all reach the test region are reported.
+     *
+     * Markers of a previous run which this run supersedes are found with IsStaleMarker().
+     *
+     * @param aPreviousAreas are the bounding boxes of modified and removed items before the edit.
+     * @param aRemovedItems are the ids of the items removed by the edit.
+     */
+    void RunIncrementalTests( EDA_UNITS aUnits, const std::vector<BOARD_ITEM*>& aChangedItems,
+                              const std::vector<EDA_RECT>& aPreviousAreas,
+                              const std::set<KIID>& aRemovedItems );
+
+    /**
+     * @return false if \a aItem lies outside the region of an incremental run (and so must not
+     *         be tested); always true during full runs.
+     */
+    bool IsInTestRegion( const BOARD_ITEM* aItem ) const
+    {
+        return !m_testRegionOnly || m_regionItems.count( aItem );
+    }
+
+    /**
+     * @return true if \a aMarker reports a violation which the last incremental run re-tested,
+     *         and so has been either reported again or fixed.
+     */
+    bool IsStaleMarker( const PCB_MARKER* aMarker ) const;
+
     bool IsErrorLimitExceeded( int error_code );
 
     DRC_CONSTRAINT EvalRules( DRC_CONSTRAINT_T aConstraintType, const BOARD_ITEM* a,
@@ -191,7 +235,50 @@ public:
 
     static std::shared_ptr<SHAPE> GetShape( BOARD_ITEM* aItem, PCB_LAYER_ID aLayer );
 
+    /**
+     * Collision results shared by the test providers, and kept from one run to the next for
+     * items which have not changed.
+     */
+    DRC_DISTANCE_CACHE& GetDistanceCache() { return m_distanceCache; }
+
+    /**
+     * Collect timings of the test providers and of the rule expressions in the following runs
+     * (in addition to the runs profiled through the DRCProfile advanced config option).
+     */
+    void SetProfiling( bool aEnable ) { m_profiling = aEnable; }
+
+    /**
+     * @return the timings of the last profiled run.
+     */
+    const DRC_PROFILE& GetProfile() const { return m_profile; }
+
+    struct SHARED_INDEX
+    {
+        std::unique_ptr<DRC_RTREE>        tree;
+        LSET                              layers;       ///< layers indexed so far
+        std::vector<std::pair<LSET, int>> itemCounts;   ///< items found on each layer set
+    };
+
+    /**
+     * Spatial indexes of the items of a given set of types, shared by the test providers of
+     * the current run (see DRC_TEST_PROVIDER::getSharedIndex()).  They are dropped at the end
+     * of each run.
+     */
+    SHARED_INDEX& GetSharedIndex( const std::vector<KICAD_T>& aTypes );
+
+    /**
+     * The topology of the board's nets, computed on first use in a run and shared by the
+     * length-related test providers.  The first call of a run also rebuilds the board's
+     * FROM_TO_CACHE, which the fromTo() rule expression function relies on.
+     */
+    const DRC_NET_TOPOLOGY& GetNetTopology();
+
 private:
+    /**
+     * Drop the data shared by the test providers of a run.
+     */
+    void clearRunCaches();
+
     void addRule( DRC_RULE* rule )
     {
         m_rules.push_back(rule);
@@ -217,6 +304,117 @@ private:
     void loadImplicitRules();
     DRC_RULE* createImplicitRule( const wxString& name );
 
+    void resetErrorLimits();
+
+    void beginProfile();
+    bool runProvider( DRC_TEST_PROVIDER* aProvider );
+    void endProfile();
+
+    /**
+     * Evaluate a condition or assertion expression of \a aRule, timing it when profiling.
+     */
+    bool evaluate( DRC_RULE_CONDITION* aExpression, const DRC_RULE* aRule, const BOARD_ITEM* a,
+                   const BOARD_ITEM* b, PCB_LAYER_ID aLayer, REPORTER* aReporter );
+
+    /**
+     * Cache zone geometry and build the copper zone R-trees (only for zones reaching the test
+     * region during incremental runs).
+     *
+     * @return false if cancelled.
+     */
+    bool prepareZones();
+
+    /**
+     * @return the largest distance at which two items can violate a clearance-type rule.
+     */
+    int worstClearance();
+
+    /**
+     * @return true if every item referenced by \a aItem reaches the test region.
+     */
+    bool allItemsInTestRegion( const std::shared_ptr<RC_ITEM>& aItem ) const;
+
+    /**
+     * Everything the rule resolution of a constraint type reads from a pair of items when all
+     * its conditions depend only on nets, netclasses and item types.
+     */
+    struct RESOLUTION_KEY
+    {
+        const void*  netA;      ///< netclass (or net) of A, or a sentinel
+        const void*  netB;
+        int          typeA;
+        int          typeB;
+        PCB_LAYER_ID layer;
+        bool         aNonCopper;
+        bool         bNonCopper;
+
+        bool operator==( const RESOLUTION_KEY& aOther ) const
+        {
+            return netA == aOther.netA && netB == aOther.netB && typeA == aOther.typeA
+                   && typeB == aOther.typeB && layer == aOther.layer
+                   && aNonCopper == aOther.aNonCopper && bNonCopper == aOther.bNonCopper;
+        }
+    };
+
+    struct RESOLUTION_KEY_HASH
+    {
+        size_t operator()( const RESOLUTION_KEY& aKey ) const
+        {
+            size_t h = std::hash<const void*>()( aKey.netA );
+            h = h * 31 + std::hash<const void*>()( aKey.netB );
+            h = h * 31 + ( aKey.typeA << 8 ) + aKey.typeB;
+            h = h * 31 + ( aKey.layer << 2 ) + ( aKey.aNonCopper << 1 ) + aKey.bNonCopper;
+            return h;
+        }
+    };
+
+    /**
+     * Resolved constraints for one constraint type, filled in as EvalRules() meets new keys.
+     * Emptied whenever the board changes.
+     *
+     * Like ITEM_PAIR_CACHE, each thread also keeps the resolutions it used last and reads them
+     * without locking; they are tagged with the table's generation, which changes (to a value
+     * unique across all tables) whenever the table is emptied.
+     */
+    struct RESOLUTION_TABLE
+    {
+        bool                      byNet;        ///< key on nets rather than netclasses
+        std::atomic<int>          timeStamp;    ///< board timestamp the results are valid for
+        std::atomic<uint64_t>     generation;
+        std::mutex                mutex;
+        std::unordered_map<RESOLUTION_KEY, DRC_CONSTRAINT, RESOLUTION_KEY_HASH> results;
+    };
+
+    RESOLUTION_KEY makeResolutionKey( const RESOLUTION_TABLE* aTable, const BOARD_ITEM* a,
+                                      const BOARD_ITEM* b, PCB_LAYER_ID aLayer,
+                                      bool aNonCopper, bool bNonCopper ) const;
+
+    /**
+     * Look up \a aKey in \a aTable, emptying the table first if the board changed since it
+     * was filled.
+     *
+     * @return true and the resolution in \a aConstraint if found.
+     */
+    bool findResolution( RESOLUTION_TABLE* aTable, const RESOLUTION_KEY& aKey,
+                         DRC_CONSTRAINT& aConstraint ) const;
+
+    void storeResolution( RESOLUTION_TABLE* aTable, const RESOLUTION_KEY& aKey,
+                          const DRC_CONSTRAINT& aConstraint ) const;
+
+    /// A resolution recently used by the current thread
+    struct LOCAL_RESOLUTION
+    {
+        const RESOLUTION_TABLE* table;
+        uint64_t                generation;
+        RESOLUTION_KEY          key;
+        DRC_CONSTRAINT          constraint;
+    };
+
+    static LOCAL_RESOLUTION& localResolution( const RESOLUTION_TABLE* aTable,
+                                              const RESOLUTION_KEY& aKey );
+
+    static uint64_t newResolutionGeneration();
+
 protected:
     BOARD_DESIGN_SETTINGS*           m_designSettings;
     BOARD*                           m_board;
@@ -235,10 +433,30 @@ protected:
     // constraint -> rule -> provider
     std::unordered_map<DRC_CONSTRAINT_T, std::vector<DRC_ENGINE_CONSTRAINT*>*> m_constraintMap;
 
+    // constraint -> precomputed resolutions, for constraint types which don't need the
+    // rule interpreter for every item pair
+    std::unordered_map<DRC_CONSTRAINT_T, std::unique_ptr<RESOLUTION_TABLE>> m_resolutionTables;
+
     DRC_VIOLATION_HANDLER            m_violationHandler;
     REPORTER*                        m_reporter;
     PROGRESS_REPORTER*               m_progressReporter;
 
+    DRC_DISTANCE_CACHE               m_distanceCache;
+
+    // Incremental runs only test the items reaching the test region
+    bool                                   m_testRegionOnly;
+    std::unordered_set<const BOARD_ITEM*>  m_regionItems;
+    std::set<KIID>                         m_regionItemIDs;
+    std::set<KIID>                         m_removedItemIDs;
+    std::set<int>                          m_regionErrorCodes;   ///< errors re-tested
+
+    bool                             m_profiling;
+    DRC_PROFILE                      m_profile;
+    DRC_PROFILE*                     m_activeProfile;    ///< nullptr unless profiling this run
+
+    std::map<std::vector<KICAD_T>, SHARED_INDEX> m_sharedIndexes;
+    std::unique_ptr<DRC_NET_TOPOLOGY>            m_netTopology;
+
     wxString m_msg;  // Allocating strings gets expensive enough to want to avoid it
     std::shared_ptr<KIGFX::VIEW_OVERLAY> m_debugOverlay;
 };
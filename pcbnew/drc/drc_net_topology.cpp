@@ -0,0 +1,372 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <future>
+#include <limits>
+#include <thread>
+#include <tuple>
+
+#include <board.h>
+#include <board_design_settings.h>
+#include <footprint.h>
+#include <pad.h>
+#include <pcb_track.h>
+#include <drc/drc_net_topology.h>
+
+
+DRC_NET_TOPOLOGY::DRC_NET_TOPOLOGY( BOARD* aBoard ) :
+        m_board( aBoard )
+{
+}
+
+
+void DRC_NET_TOPOLOGY::Build( const std::set<int>& aNets )
+{
+    m_nets.clear();
+
+    auto netFor =
+            [&]( BOARD_CONNECTED_ITEM* aItem ) -> NET*
+            {
+                int netcode = aItem->GetNetCode();
+
+                if( netcode <= 0 || ( !aNets.empty() && !aNets.count( netcode ) ) )
+                    return nullptr;
+
+                NET& net = m_nets[ netcode ];
+                net.netcode = netcode;
+                return &net;
+            };
+
+    for( PCB_TRACK* track : m_board->Tracks() )
+    {
+        if( NET* net = netFor( track ) )
+            net->routedItems.push_back( track );
+    }
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+    {
+        for( PAD* pad : footprint->Pads() )
+        {
+            if( NET* net = netFor( pad ) )
+                net->pads.push_back( pad );
+        }
+    }
+
+    std::vector<NET*> nets;
+
+    for( std::pair<const int, NET>& entry : m_nets )
+        nets.push_back( &entry.second );
+
+    size_t              threads = std::min<size_t>( nets.size(),
+                                                    std::thread::hardware_concurrency() );
+    std::atomic<size_t> nextNet( 0 );
+
+    auto buildNets =
+            [&]()
+            {
+                for( size_t ii = nextNet++; ii < nets.size(); ii = nextNet++ )
+                    buildNet( *nets[ii] );
+            };
+
+    if( threads <= 1 )
+    {
+        buildNets();
+        return;
+    }
+
+    std::vector<std::future<void>> returns;
+
+    for( size_t ii = 0; ii < threads; ++ii )
+        returns.emplace_back( std::async( std::launch::async, buildNets ) );
+
+    for( std::future<void>& ret : returns )
+        ret.wait();
+}
+
+
+const DRC_NET_TOPOLOGY::NET* DRC_NET_TOPOLOGY::GetNet( int aNetCode ) const
+{
+    auto it = m_nets.find( aNetCode );
+
+    return it != m_nets.end() ? &it->second : nullptr;
+}
+
+
+DRC_NET_TOPOLOGY::TOTALS DRC_NET_TOPOLOGY::Sum( int aNetCode,
+                                                const std::set<BOARD_CONNECTED_ITEM*>& aItems,
+                                                std::vector<BOARD_CONNECTED_ITEM*>* aOthers ) const
+{
+    TOTALS     totals;
+    size_t     chained = 0;
+    const NET* net = GetNet( aNetCode );
+
+    if( net )
+    {
+        for( const CHAIN& chain : net->chains )
+        {
+            size_t runStart = 0;
+            bool   inRun = false;
+
+            for( size_t ii = 0; ii <= chain.items.size(); ++ii )
+            {
+                bool found = ii < chain.items.size() && aItems.count( chain.items[ii] );
+
+                if( found && !inRun )
+                {
+                    runStart = ii;
+                    inRun = true;
+                }
+                else if( !found && inRun )
+                {
+                    totals.trackLength += chain.Length( runStart, ii - 1 );
+                    totals.viaCount += chain.ViaCount( runStart, ii - 1 );
+                    chained += ii - runStart;
+                    inRun = false;
+                }
+            }
+        }
+    }
+
+    if( aOthers && chained < aItems.size() )
+    {
+        // Every routed item of the net is on one of its chains
+        std::set<BOARD_CONNECTED_ITEM*> routed;
+
+        if( net )
+            routed.insert( net->routedItems.begin(), net->routedItems.end() );
+
+        for( BOARD_CONNECTED_ITEM* item : aItems )
+        {
+            if( !routed.count( item ) )
+                aOthers->push_back( item );
+        }
+    }
+
+    return totals;
+}
+
+
+void DRC_NET_TOPOLOGY::buildNet( NET& aNet ) const
+{
+    typedef std::pair<int, int>         POINT_KEY;     // x, y
+    typedef std::tuple<int, int, int>   END_KEY;       // x, y, layer
+
+    const std::vector<BOARD_CONNECTED_ITEM*>& items = aNet.routedItems;
+
+    std::set<POINT_KEY>                     terminals;
+    std::map<POINT_KEY, std::vector<size_t>> viasAt;
+    std::map<END_KEY, std::vector<size_t>>   ends;
+
+    for( BOARD_CONNECTED_ITEM* item : aNet.pads )
+    {
+        aNet.padToDieLength += static_cast<PAD*>( item )->GetPadToDieLength();
+        terminals.emplace( item->GetPosition().x, item->GetPosition().y );
+    }
+
+    for( size_t ii = 0; ii < items.size(); ++ii )
+    {
+        if( items[ii]->Type() == PCB_VIA_T )
+        {
+            PCB_VIA* via = static_cast<PCB_VIA*>( items[ii] );
+
+            aNet.viaLength += ViaLength( m_board, via );
+            viasAt[ { via->GetPosition().x, via->GetPosition().y } ].push_back( ii );
+        }
+        else
+        {
+            PCB_TRACK* seg = static_cast<PCB_TRACK*>( items[ii] );
+            int        layer = seg->GetLayer();
+
+            ends[ std::make_tuple( seg->GetStart().x, seg->GetStart().y, layer ) ].push_back( ii );
+            ends[ std::make_tuple( seg->GetEnd().x, seg->GetEnd().y, layer ) ].push_back( ii );
+        }
+    }
+
+    // Link the items which continue into each other: two track ends meeting alone, or a via
+    // joining exactly two track ends.  Nothing continues through a pad.  Each item then has
+    // at most two links, and the chains are the runs of linked items.
+    std::vector<std::array<int, 2>> links( items.size(), { { -1, -1 } } );
+
+    auto link =
+            [&]( size_t aA, size_t aB )
+            {
+                if( aA == aB || links[aA][1] >= 0 || links[aB][1] >= 0 )
+                    return;
+
+                links[aA][ links[aA][0] >= 0 ? 1 : 0 ] = (int) aB;
+                links[aB][ links[aB][0] >= 0 ? 1 : 0 ] = (int) aA;
+            };
+
+    auto viaOnEnd =
+            [&]( const END_KEY& aEnd ) -> bool
+            {
+                auto it = viasAt.find( { std::get<0>( aEnd ), std::get<1>( aEnd ) } );
+
+                if( it == viasAt.end() )
+                    return false;
+
+                for( size_t viaIdx : it->second )
+                {
+                    if( items[viaIdx]->IsOnLayer( ToLAYER_ID( std::get<2>( aEnd ) ) ) )
+                        return true;
+                }
+
+                return false;
+            };
+
+    for( const std::pair<const END_KEY, std::vector<size_t>>& end : ends )
+    {
+        POINT_KEY pt( std::get<0>( end.first ), std::get<1>( end.first ) );
+
+        if( end.second.size() != 2 || terminals.count( pt ) || viaOnEnd( end.first ) )
+            continue;
+
+        link( end.second[0], end.second[1] );
+    }
+
+    for( const std::pair<const POINT_KEY, std::vector<size_t>>& at : viasAt )
+    {
+        if( at.second.size() != 1 || terminals.count( at.first ) )
+            continue;
+
+        size_t              viaIdx = at.second[0];
+        PCB_VIA*            via = static_cast<PCB_VIA*>( items[viaIdx] );
+        std::vector<size_t> joined;
+
+        // The track ends at the via's position, all layers: ends is sorted on x, y, then layer
+        for( auto it = ends.lower_bound( std::make_tuple( at.first.first, at.first.second,
+                                                          std::numeric_limits<int>::min() ) );
+             it != ends.end() && std::get<0>( it->first ) == at.first.first
+                    && std::get<1>( it->first ) == at.first.second;
+             ++it )
+        {
+            if( via->IsOnLayer( ToLAYER_ID( std::get<2>( it->first ) ) ) )
+                joined.insert( joined.end(), it->second.begin(), it->second.end() );
+        }
+
+        if( joined.size() == 2 )
+        {
+            link( viaIdx, joined[0] );
+            link( viaIdx, joined[1] );
+        }
+    }
+
+    // Walk the chains from their ends, then whatever is left (loops) from anywhere
+    std::vector<bool> visited( items.size(), false );
+
+    auto walk =
+            [&]( size_t aFirst )
+            {
+                CHAIN  chain;
+                double length = 0.0;
+                int    vias = 0;
+                int    prev = -1;
+                int    cur = (int) aFirst;
+
+                while( cur >= 0 && !visited[cur] )
+                {
+                    visited[cur] = true;
+
+                    if( items[cur]->Type() == PCB_VIA_T )
+                        vias++;
+                    else
+                        length += static_cast<PCB_TRACK*>( items[cur] )->GetLength();
+
+                    chain.items.push_back( items[cur] );
+                    chain.cumulativeLength.push_back( length );
+                    chain.cumulativeVias.push_back( vias );
+
+                    int next = links[cur][0] != prev ? links[cur][0] : links[cur][1];
+                    prev = cur;
+                    cur = next;
+                }
+
+                aNet.chains.push_back( std::move( chain ) );
+            };
+
+    auto onTerminal =
+            [&]( BOARD_CONNECTED_ITEM* aItem ) -> bool
+            {
+                if( aItem->Type() == PCB_VIA_T )
+                {
+                    wxPoint pos = aItem->GetPosition();
+                    return terminals.count( { pos.x, pos.y } ) > 0;
+                }
+
+                PCB_TRACK* seg = static_cast<PCB_TRACK*>( aItem );
+
+                return terminals.count( { seg->GetStart().x, seg->GetStart().y } )
+                       || terminals.count( { seg->GetEnd().x, seg->GetEnd().y } );
+            };
+
+    // Chains ending at a pad start there
+    for( size_t ii = 0; ii < items.size(); ++ii )
+    {
+        if( !visited[ii] && links[ii][1] < 0 && onTerminal( items[ii] ) )
+            walk( ii );
+    }
+
+    for( size_t ii = 0; ii < items.size(); ++ii )
+    {
+        if( !visited[ii] && links[ii][1] < 0 )
+            walk( ii );
+    }
+
+    for( size_t ii = 0; ii < items.size(); ++ii )
+    {
+        if( !visited[ii] )
+            walk( ii );
+    }
+}
+
+
+int DRC_NET_TOPOLOGY::ViaLength( const BOARD* aBoard, const PCB_VIA* aVia )
+{
+    const BOARD_DESIGN_SETTINGS& bds = aBoard->GetDesignSettings();
+
+    // calculate the via length individually from the board stackup and via's start and end layer.
+    if( bds.m_HasStackup )
+    {
+        const BOARD_STACKUP& stackup = bds.GetStackupDescriptor();
+        return stackup.GetLayerDistance( aVia->TopLayer(), aVia->BottomLayer() );
+    }
+    else
+    {
+        int dielectricLayers = bds.GetCopperLayerCount() - 1;
+        // FIXME: not all dielectric layers are the same thickness!
+        int layerThickness = bds.GetBoardThickness() / dielectricLayers;
+        int effectiveBottomLayer;
+
+        if( aVia->BottomLayer() == B_Cu )
+            effectiveBottomLayer = F_Cu + dielectricLayers;
+        else
+            effectiveBottomLayer = aVia->BottomLayer();
+
+        int layerCount = effectiveBottomLayer - aVia->TopLayer();
+
+        return layerCount * layerThickness;
+    }
+}
@@ -0,0 +1,129 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef DRC_NET_TOPOLOGY_H
+#define DRC_NET_TOPOLOGY_H
+
+#include <map>
+#include <set>
+#include <vector>
+
+class BOARD;
+class BOARD_CONNECTED_ITEM;
+class PCB_VIA;
+
+
+/**
+ * The routing topology of the nets of a board: their tracks, arcs and vias as ordered chains
+ * with cumulative lengths and via counts, and their via length and pad-to-die length.
+ *
+ * It is computed once (one net per thread) and shared by the length-related DRC tests of a
+ * run (see DRC_ENGINE::GetNetTopology()), and by the net inspector.  It must be rebuilt when
+ * the board changes.
+ */
+class DRC_NET_TOPOLOGY
+{
+public:
+    /**
+     * A run of tracks, arcs and vias connected end to end.  It passes through a via joining
+     * exactly two of them, and ends at a pad, a branch or a dangling end.  Chains ending at a
+     * pad start there.  Every routed item of a net is in exactly one chain.
+     */
+    struct CHAIN
+    {
+        std::vector<BOARD_CONNECTED_ITEM*> items;             ///< in path order
+        std::vector<double>                cumulativeLength;  ///< up to the end of each item
+        std::vector<int>                   cumulativeVias;    ///< up to each item, included
+
+        double Length() const { return items.empty() ? 0.0 : cumulativeLength.back(); }
+        int    ViaCount() const { return items.empty() ? 0 : cumulativeVias.back(); }
+
+        /**
+         * @return the length of the tracks and arcs from item \a aFirst to \a aLast included.
+         */
+        double Length( size_t aFirst, size_t aLast ) const
+        {
+            return cumulativeLength[aLast] - ( aFirst ? cumulativeLength[aFirst - 1] : 0.0 );
+        }
+
+        int ViaCount( size_t aFirst, size_t aLast ) const
+        {
+            return cumulativeVias[aLast] - ( aFirst ? cumulativeVias[aFirst - 1] : 0 );
+        }
+    };
+
+    struct NET
+    {
+        int                                netcode = 0;
+        std::vector<BOARD_CONNECTED_ITEM*> routedItems;       ///< tracks, arcs and vias
+        std::vector<BOARD_CONNECTED_ITEM*> pads;
+        std::vector<CHAIN>                 chains;
+        int                                viaLength = 0;
+        int                                padToDieLength = 0;
+    };
+
+    /// Track length and via count of a subset of the routed items of a net
+    struct TOTALS
+    {
+        double trackLength = 0.0;
+        int    viaCount = 0;
+    };
+
+    DRC_NET_TOPOLOGY( BOARD* aBoard );
+
+    /**
+     * Compute the topology of \a aNets, or of all nets if empty.
+     */
+    void Build( const std::set<int>& aNets = {} );
+
+    /**
+     * @return the topology of \a aNetCode, or nullptr if the net has no pad nor routed item
+     *         or wasn't part of the last Build().
+     */
+    const NET* GetNet( int aNetCode ) const;
+
+    /**
+     * Add up the tracks, arcs and vias of \a aNetCode found in \a aItems, one run of
+     * consecutive chain items at a time.
+     *
+     * @param aOthers receives the items of \a aItems which aren't on a chain of the net
+     *                (pads, or items the topology was built without).
+     */
+    TOTALS Sum( int aNetCode, const std::set<BOARD_CONNECTED_ITEM*>& aItems,
+                std::vector<BOARD_CONNECTED_ITEM*>* aOthers ) const;
+
+    /**
+     * @return the length of \a aVia through the board stackup (or an approximation of it if
+     *         the board has no stackup).
+     */
+    static int ViaLength( const BOARD* aBoard, const PCB_VIA* aVia );
+
+private:
+    void buildNet( NET& aNet ) const;
+
+    BOARD*             m_board;
+    std::map<int, NET> m_nets;
+};
+
+
+#endif // DRC_NET_TOPOLOGY_H
@@ -0,0 +1,150 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <nlohmann/json.hpp>
+#include <settings/json_settings.h>     // to_json( wxString )
+
+#include <drc/drc_profile.h>
+#include <drc/drc_rule.h>
+#include <drc/drc_rule_condition.h>
+#include <drc/drc_rtree.h>
+#include <drc/drc_test_provider.h>
+
+
+DRC_PROFILE::DRC_PROFILE() :
+        m_providerCPUStart( 0 ),
+        m_providerQueryStart( 0 )
+{
+}
+
+
+void DRC_PROFILE::SetRules( const std::vector<DRC_RULE*>& aRules )
+{
+    m_rules.clear();
+    m_ruleStats.clear();
+    m_providers.clear();
+
+    for( const DRC_RULE* rule : aRules )
+    {
+        m_rules.push_back( rule );
+        m_ruleStats[ rule ];    // stats are atomic, so construct them in place
+    }
+}
+
+
+void DRC_PROFILE::Reset()
+{
+    m_providers.clear();
+
+    for( std::pair<const DRC_RULE* const, RULE_STATS>& entry : m_ruleStats )
+    {
+        entry.second.evaluations = 0;
+        entry.second.nanoseconds = 0;
+    }
+}
+
+
+void DRC_PROFILE::BeginProvider( const DRC_TEST_PROVIDER* aProvider )
+{
+    m_providers.push_back( { aProvider->GetName(), 0.0, 0.0, 0 } );
+
+    m_providerQueryStart = DRC_RTREE::GetQueryCount();
+    m_providerCPUStart = std::clock();
+    m_providerStart = std::chrono::steady_clock::now();
+}
+
+
+void DRC_PROFILE::EndProvider()
+{
+    if( m_providers.empty() )
+        return;
+
+    PROVIDER_STATS& stats = m_providers.back();
+    auto            wall = std::chrono::steady_clock::now() - m_providerStart;
+
+    stats.wallMs = std::chrono::duration<double, std::milli>( wall ).count();
+    stats.cpuMs = 1000.0 * ( std::clock() - m_providerCPUStart ) / CLOCKS_PER_SEC;
+    stats.rtreeQueries = DRC_RTREE::GetQueryCount() - m_providerQueryStart;
+}
+
+
+int64_t DRC_PROFILE::GetRuleStats( const DRC_RULE* aRule, double* aTimeMs ) const
+{
+    auto it = m_ruleStats.find( aRule );
+
+    if( it == m_ruleStats.end() )
+    {
+        if( aTimeMs )
+            *aTimeMs = 0.0;
+
+        return 0;
+    }
+
+    if( aTimeMs )
+        *aTimeMs = it->second.nanoseconds.load() / 1e6;
+
+    return it->second.evaluations.load();
+}
+
+
+wxString DRC_PROFILE::ToJSON() const
+{
+    nlohmann::json providers = nlohmann::json::array();
+    nlohmann::json rules = nlohmann::json::array();
+    double         totalWallMs = 0.0;
+    double         totalCPUMs = 0.0;
+    int64_t        totalQueries = 0;
+
+    for( const PROVIDER_STATS& stats : m_providers )
+    {
+        providers.push_back( { { "name",          stats.name },
+                               { "wall_ms",       stats.wallMs },
+                               { "cpu_ms",        stats.cpuMs },
+                               { "rtree_queries", stats.rtreeQueries } } );
+
+        totalWallMs += stats.wallMs;
+        totalCPUMs += stats.cpuMs;
+        totalQueries += stats.rtreeQueries;
+    }
+
+    for( const DRC_RULE* rule : m_rules )
+    {
+        double  timeMs;
+        int64_t evaluations = GetRuleStats( rule, &timeMs );
+
+        rules.push_back( { { "name",        rule->m_Name },
+                           { "implicit",    rule->m_Implicit },
+                           { "condition",   rule->m_Condition ? rule->m_Condition->GetExpression()
+                                                          : wxString() },
+                           { "evaluations", evaluations },
+                           { "time_ms",     timeMs } } );
+    }
+
+    nlohmann::json js = { { "wall_ms",       totalWallMs },
+                          { "cpu_ms",        totalCPUMs },
+                          { "rtree_queries", totalQueries },
+                          { "providers",     providers },
+                          { "rules",         rules } };
+
+    return wxString::FromUTF8( js.dump( 2 ).c_str() );
+}
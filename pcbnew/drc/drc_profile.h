@@ -0,0 +1,141 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef DRC_PROFILE_H
+#define DRC_PROFILE_H
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <chrono>
+#include <map>
+#include <vector>
+
+#include <wx/string.h>
+
+class DRC_RULE;
+class DRC_TEST_PROVIDER;
+
+
+/**
+ * Timings of a DRC run: wall and CPU time spent in each test provider, the number of
+ * evaluations and the time spent in the condition and assertion expressions of each rule,
+ * and the number of DRC_RTREE searches.
+ *
+ * Rule statistics may be recorded from several threads at once; rules must be registered
+ * with SetRules() beforehand.
+ */
+class DRC_PROFILE
+{
+public:
+    struct PROVIDER_STATS
+    {
+        wxString name;
+        double   wallMs;
+        double   cpuMs;             ///< process CPU time, so including worker threads
+        int64_t  rtreeQueries;
+    };
+
+    struct RULE_STATS
+    {
+        std::atomic<int64_t> evaluations{ 0 };
+        std::atomic<int64_t> nanoseconds{ 0 };
+    };
+
+    /**
+     * Measures the time spent in a scope, for a rule expression evaluation.
+     */
+    class EVAL_TIMER
+    {
+    public:
+        EVAL_TIMER( DRC_PROFILE* aProfile, const DRC_RULE* aRule ) :
+                m_stats( aProfile ? aProfile->ruleStats( aRule ) : nullptr )
+        {
+            if( m_stats )
+                m_start = std::chrono::steady_clock::now();
+        }
+
+        ~EVAL_TIMER()
+        {
+            if( m_stats )
+            {
+                auto elapsed = std::chrono::steady_clock::now() - m_start;
+
+                m_stats->evaluations.fetch_add( 1, std::memory_order_relaxed );
+                m_stats->nanoseconds.fetch_add(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>( elapsed ).count(),
+                        std::memory_order_relaxed );
+            }
+        }
+
+    private:
+        RULE_STATS*                           m_stats;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    DRC_PROFILE();
+
+    /**
+     * Start a new profile for \a aRules, forgetting the previous one.
+     */
+    void SetRules( const std::vector<DRC_RULE*>& aRules );
+
+    /**
+     * Clear the timings, keeping the registered rules.
+     */
+    void Reset();
+
+    void BeginProvider( const DRC_TEST_PROVIDER* aProvider );
+    void EndProvider();
+
+    const std::vector<PROVIDER_STATS>& GetProviderStats() const { return m_providers; }
+
+    /**
+     * @return the number of evaluations of the expressions of \a aRule, and the time spent in
+     *         them in milliseconds through \a aTimeMs.
+     */
+    int64_t GetRuleStats( const DRC_RULE* aRule, double* aTimeMs = nullptr ) const;
+
+    /**
+     * @return the profile as a JSON document.
+     */
+    wxString ToJSON() const;
+
+private:
+    RULE_STATS* ruleStats( const DRC_RULE* aRule )
+    {
+        auto it = m_ruleStats.find( aRule );
+        return it != m_ruleStats.end() ? &it->second : nullptr;
+    }
+
+    std::vector<const DRC_RULE*>             m_rules;        ///< in rule file order
+    std::map<const DRC_RULE*, RULE_STATS>    m_ruleStats;
+    std::vector<PROVIDER_STATS>              m_providers;
+
+    std::chrono::steady_clock::time_point    m_providerStart;
+    std::clock_t                             m_providerCPUStart;
+    int64_t                                  m_providerQueryStart;
+};
+
+
+#endif // DRC_PROFILE_H
@@ -0,0 +1,158 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <nlohmann/json.hpp>
+#include <settings/json_settings.h>     // to_json( wxString )
+#include <wx/filefn.h>
+
+#include <base_units.h>
+#include <board.h>
+#include <board_design_settings.h>
+#include <drc/drc_item.h>
+#include <drc/drc_report_stream.h>
+#include <drc/drc_rule.h>
+
+
+DRC_REPORT_STREAM::DRC_REPORT_STREAM( BOARD* aBoard, EDA_UNITS aUnits ) :
+        m_board( aBoard ),
+        m_units( aUnits ),
+        m_file( nullptr ),
+        m_writeError( false )
+{
+}
+
+
+DRC_REPORT_STREAM::~DRC_REPORT_STREAM()
+{
+    Close();
+}
+
+
+bool DRC_REPORT_STREAM::Open( const wxString& aFileName )
+{
+    Close();
+
+    m_file = wxFopen( aFileName, wxT( "w" ) );
+
+    if( !m_file )
+        return false;
+
+    m_writeError = false;
+    m_counts.clear();
+    m_itemMap.clear();
+    m_board->FillItemMap( m_itemMap );
+
+    return true;
+}
+
+
+bool DRC_REPORT_STREAM::Close()
+{
+    if( !m_file )
+        return true;
+
+    bool ok = !m_writeError && fclose( m_file ) == 0;
+
+    m_file = nullptr;
+    m_itemMap.clear();
+
+    return ok;
+}
+
+
+void DRC_REPORT_STREAM::Report( const std::shared_ptr<DRC_ITEM>& aItem, const wxPoint& aPos )
+{
+    DRC_RULE* rule = aItem->GetViolatingRule();
+    SEVERITY  severity = RPT_SEVERITY_UNDEFINED;
+
+    // Same as PCB_MARKER::GetSeverity(), without the marker
+    if( rule && rule->m_Severity != RPT_SEVERITY_UNDEFINED )
+        severity = rule->m_Severity;
+    else
+        severity = m_board->GetDesignSettings().GetSeverity( aItem->GetErrorCode() );
+
+    wxString severityName;
+
+    switch( severity )
+    {
+    case RPT_SEVERITY_ERROR:     severityName = wxT( "error" );     break;
+    case RPT_SEVERITY_WARNING:   severityName = wxT( "warning" );   break;
+    case RPT_SEVERITY_EXCLUSION: severityName = wxT( "exclusion" ); break;
+    case RPT_SEVERITY_IGNORE:    severityName = wxT( "ignore" );    break;
+    default:                     severityName = wxT( "undefined" ); break;
+    }
+
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    if( !m_file )
+        return;
+
+    nlohmann::json items = nlohmann::json::array();
+
+    for( const KIID& id : { aItem->GetMainItemID(), aItem->GetAuxItemID(),
+                            aItem->GetAuxItem2ID(), aItem->GetAuxItem3ID() } )
+    {
+        if( id == niluuid )
+            break;
+
+        auto     it = m_itemMap.find( id );
+        wxString description;
+
+        if( it != m_itemMap.end() )
+            description = it->second->GetSelectMenuText( m_units );
+
+        items.push_back( { { "uuid",        id.AsString() },
+                           { "description", description } } );
+    }
+
+    nlohmann::json js = { { "code",     aItem->GetErrorCode() },
+                          { "type",     aItem->GetSettingsKey() },
+                          { "severity", severityName },
+                          { "message",  aItem->GetErrorMessage() },
+                          { "rule",     rule ? rule->m_Name : wxString() },
+                          { "x",        To_User_Unit( m_units, aPos.x ) },
+                          { "y",        To_User_Unit( m_units, aPos.y ) },
+                          { "items",    items } };
+
+    std::string line = js.dump() + "\n";
+
+    if( fwrite( line.c_str(), 1, line.size(), m_file ) != line.size() )
+        m_writeError = true;
+
+    m_counts[ severity ]++;
+}
+
+
+int DRC_REPORT_STREAM::GetCount( SEVERITY aSeverity ) const
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    int                         count = 0;
+
+    for( const std::pair<const SEVERITY, int>& entry : m_counts )
+    {
+        if( aSeverity == RPT_SEVERITY_UNDEFINED || entry.first == aSeverity )
+            count += entry.second;
+    }
+
+    return count;
+}
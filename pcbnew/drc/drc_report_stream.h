@@ -0,0 +1,114 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef DRC_REPORT_STREAM_H
+#define DRC_REPORT_STREAM_H
+
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <wx/gdicmn.h>
+#include <wx/string.h>
+
+#include <eda_units.h>
+#include <kiid.h>
+#include <widgets/report_severity.h>
+
+class BOARD;
+class DRC_ITEM;
+class EDA_ITEM;
+
+
+/**
+ * A DRC violation handler writing the violations to a file as they are reported, one JSON
+ * object per line (JSON Lines), instead of keeping DRC_ITEMs or creating board markers.
+ *
+ * Memory use doesn't depend on the number of violations, which makes it suitable for boards
+ * reporting hundreds of thousands of them, in particular in headless runs:
+ *
+ *     DRC_REPORT_STREAM stream( board, EDA_UNITS::MILLIMETRES );
+ *
+ *     if( stream.Open( path ) )
+ *     {
+ *         engine->SetViolationHandler(
+ *                 [&]( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )
+ *                 {
+ *                     stream.Report( aItem, aPos );
+ *                 } );
+ *
+ *         engine->RunTests( ... );
+ *         engine->ClearViolationHandler();
+ *         stream.Close();
+ *     }
+ *
+ * Each line holds the error code and its settings key, the severity, the error message, the
+ * violated rule (if any), the marker position in \a aUnits, and the UUID and description of
+ * each item involved.
+ */
+class DRC_REPORT_STREAM
+{
+public:
+    DRC_REPORT_STREAM( BOARD* aBoard, EDA_UNITS aUnits );
+    ~DRC_REPORT_STREAM();
+
+    /**
+     * Create (or truncate) \a aFileName and start a new report.
+     *
+     * @return false if the file can't be opened.
+     */
+    bool Open( const wxString& aFileName );
+
+    /**
+     * Flush and close the report file.
+     *
+     * @return false if writing the report failed.
+     */
+    bool Close();
+
+    bool IsOpen() const { return m_file != nullptr; }
+
+    /**
+     * Write a violation to the report.  May be called from several threads.
+     */
+    void Report( const std::shared_ptr<DRC_ITEM>& aItem, const wxPoint& aPos );
+
+    /**
+     * @return the number of violations written with \a aSeverity, or all of them by default.
+     */
+    int GetCount( SEVERITY aSeverity = RPT_SEVERITY_UNDEFINED ) const;
+
+private:
+    BOARD*                    m_board;
+    EDA_UNITS                 m_units;
+    FILE*                     m_file;
+    bool                      m_writeError;
+
+    std::map<KIID, EDA_ITEM*> m_itemMap;     ///< filled on Open(); depends on board size only
+    std::map<SEVERITY, int>   m_counts;
+    mutable std::mutex        m_mutex;
+};
+
+
+#endif // DRC_REPORT_STREAM_H
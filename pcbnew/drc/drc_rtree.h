@@ -28,13 +28,20 @@
 #include <eda_rect.h>
 #include <board_item.h>
 #include <pad.h>
+#include <pcb_track.h>
 #include <fp_text.h>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_set>
 #include <set>
 #include <vector>
 
-#include <geometry/rtree.h>
+#include <geometry/packed_rtree.h>
 #include <geometry/shape.h>
 #include <geometry/shape_segment.h>
 #include <math/vector2d.h>
@@ -64,26 +71,21 @@ public:
 
 private:
 
-    using drc_rtree = RTree<ITEM_WITH_SHAPE*, int, 2, double>;
+    using packed_rtree = PACKED_RTREE<ITEM_WITH_SHAPE*, int>;
 
 public:
 
-    DRC_RTREE()
+    DRC_RTREE() :
+            m_count( 0 ),
+            m_dirty( false )
     {
-        for( int layer : LSET::AllLayersMask().Seq() )
-            m_tree[layer] = new drc_rtree();
-
-        m_count = 0;
-    }
-
-    ~DRC_RTREE()
-    {
-        for( auto tree : m_tree )
-            delete tree;
     }
 
     /**
      * Insert an item into the tree on a particular layer with an optional worst clearance.
+     *
+     * The item's shapes are only fetched when the tree is built, by Build() or else by the
+     * first query after the insertion.
      */
     void Insert( BOARD_ITEM* aItem, PCB_LAYER_ID aLayer, int aWorstClearance = 0 )
     {
@@ -102,39 +104,22 @@ public:
         if( aItem->Type() == PCB_FP_TEXT_T && !static_cast<FP_TEXT*>( aItem )->IsVisible() )
             return;
 
-        std::vector<SHAPE*> subshapes;
-        std::shared_ptr<SHAPE> shape = aItem->GetEffectiveShape( aRefLayer );
-        subshapes.clear();
-
-        if( shape->HasIndexableSubshapes() )
-            shape->GetIndexableSubshapes( subshapes );
-        else
-            subshapes.push_back( shape.get() );
-
-        if( aItem->Type() == PCB_PAD_T )
-        {
-            PAD* pad = static_cast<PAD*>( aItem );
-
-            if( pad->GetDrillSizeX() )
-            {
-                const SHAPE* hole = pad->GetEffectiveHoleShape();
-                subshapes.push_back( const_cast<SHAPE*>( hole ) );
-            }
-        }
-
-        for( SHAPE* subshape : subshapes )
-        {
-            BOX2I bbox = subshape->BBox();
-
-            bbox.Inflate( aWorstClearance );
-
-            const int        mmin[2] = { bbox.GetX(), bbox.GetY() };
-            const int        mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
-            ITEM_WITH_SHAPE* itemShape = new ITEM_WITH_SHAPE( aItem, subshape, shape );
+        m_pending.push_back( { aItem, aRefLayer, aTargetLayer, aWorstClearance } );
+        m_dirty.store( true, std::memory_order_release );
+    }
 
-            m_tree[aTargetLayer]->Insert( mmin, mmax, itemShape );
-            m_count++;
-        }
+    /**
+     * Add the items inserted since the last call to the per-layer packed trees, repacking the
+     * layers that received new items.
+     *
+     * The items' shapes are fetched on all cores, and then the trees of the different layers
+     * are packed concurrently.  Call once the tree has been fully populated and is about to be
+     * queried; queries build the tree themselves otherwise, on the first thread to query it.
+     */
+    void Build()
+    {
+        std::lock_guard<std::mutex> lock( m_buildMutex );
+        build();
     }
 
     /**
@@ -142,10 +127,15 @@ public:
      */
     void clear()
     {
-        for( auto tree : m_tree )
-            tree->RemoveAll();
+        std::lock_guard<std::mutex> lock( m_buildMutex );
+
+        for( packed_rtree& tree : m_packedTree )
+            tree.Clear();
 
+        m_pending.clear();
+        m_itemShapes.clear();
         m_count = 0;
+        m_dirty.store( false, std::memory_order_release );
     }
 
     bool CheckColliding( SHAPE* aRefShape, PCB_LAYER_ID aTargetLayer, int aClearance = 0,
@@ -176,7 +166,7 @@ public:
                     return true;
                 };
 
-        this->m_tree[aTargetLayer]->Search( min, max, visit );
+        search( aTargetLayer, min, max, visit );
         return count > 0;
     }
 
@@ -248,7 +238,7 @@ public:
                     return true;
                 };
 
-        this->m_tree[aTargetLayer]->Search( min, max, visit );
+        search( aTargetLayer, min, max, visit );
         return count;
     }
 
@@ -294,7 +284,7 @@ public:
                     return true;
                 };
 
-        this->m_tree[aLayer]->Search( min, max, visit );
+        search( aLayer, min, max, visit );
 
         if( collision )
         {
@@ -331,7 +321,7 @@ public:
                     return true;
                 };
 
-        this->m_tree[aLayer]->Search( min, max, visit );
+        search( aLayer, min, max, visit );
 
         return collision;
     }
@@ -385,7 +375,7 @@ public:
                             return true;
                         };
 
-                this->m_tree[targetLayer]->Search( min, max, visit );
+                search( targetLayer, min, max, visit );
             };
         }
 
@@ -432,72 +422,313 @@ public:
      */
     size_t size() const
     {
+        ensureBuilt();
         return m_count;
     }
 
     bool empty() const
     {
-        return m_count == 0;
+        return size() == 0;
     }
 
-    using iterator = typename drc_rtree::Iterator;
+    /**
+     * Return the items of a layer, so that one can write lines like:
+     *
+     * for( ITEM_WITH_SHAPE* item : rtree.OnLayer( In1_Cu ) )
+     */
+    const packed_rtree& OnLayer( PCB_LAYER_ID aLayer ) const
+    {
+        ensureBuilt();
+        return m_packedTree[int( aLayer )];
+    }
+
+    std::vector<ITEM_WITH_SHAPE*> Overlapping( PCB_LAYER_ID aLayer, const wxPoint& aPoint,
+                                               int aAccuracy = 0 ) const
+    {
+        EDA_RECT rect( aPoint, wxSize( 0, 0 ) );
+        rect.Inflate( aAccuracy );
+        return Overlapping( aLayer, rect );
+    }
+
+    std::vector<ITEM_WITH_SHAPE*> Overlapping( PCB_LAYER_ID aLayer, const EDA_RECT& aRect ) const
+    {
+        std::vector<ITEM_WITH_SHAPE*> items;
+
+        int min[2] = { aRect.GetX(),     aRect.GetY() };
+        int max[2] = { aRect.GetRight(), aRect.GetBottom() };
+
+        auto visit =
+                [&]( ITEM_WITH_SHAPE* aItem ) -> bool
+                {
+                    items.push_back( aItem );
+                    return true;
+                };
+
+        search( aLayer, min, max, visit );
+        return items;
+    }
+
+    /**
+     * Count the searches of all DRC_RTREEs, for DRC profiling.  The counter is shared by all
+     * threads, so it is only updated while enabled.
+     */
+    static void EnableQueryCount( bool aEnable )
+    {
+        queryCountEnabled().store( aEnable, std::memory_order_relaxed );
+    }
 
     /**
-     * The DRC_LAYER struct provides a layer-specific auto-range iterator to the RTree.  Using
-     * this struct, one can write lines like:
+     * @return the number of searches run since the query count was first enabled.
+     */
+    static int64_t GetQueryCount()
+    {
+        return queryCount().load( std::memory_order_relaxed );
+    }
+
+
+private:
+    /// An item waiting for Build()
+    struct PENDING_ITEM
+    {
+        BOARD_ITEM*  item;
+        PCB_LAYER_ID refLayer;
+        PCB_LAYER_ID targetLayer;
+        int          worstClearance;
+    };
+
+    /// A shape and its bounding box, inflated by the worst clearance
+    struct INDEXED_SHAPE
+    {
+        ITEM_WITH_SHAPE* itemShape;
+        BOX2I            bbox;
+    };
+
+    /// Below this number of items, Build() runs on the calling thread
+    static constexpr size_t PARALLEL_THRESHOLD = 1000;
+
+    /**
+     * @return true if the item's effective shape can be fetched on a worker thread while other
+     *         items are fetched on others.
      *
-     * for( auto item : rtree.OnLayer( In1_Cu ) )
+     * Only items whose GetEffectiveShape() is known to touch nothing shared qualify:
+     *  - tracks and arcs build a new shape from their own members;
+     *  - pads build their shapes under their own lock, and each pad is fetched by one thread;
+     *  - vias likewise, unless they remove unconnected layers, in which case FlashLayer()
+     *    looks them up in the board's connectivity map.
      *
-     * and iterate over only the RTree items that are on In1
+     * Everything else is fetched on the calling thread: text and dimensions are stroked
+     * through a global GAL instance which isn't thread-safe, and zones, graphics and the
+     * remaining types haven't been audited for it.
      */
-    struct DRC_LAYER
+    static bool canFetchInParallel( const BOARD_ITEM* aItem )
     {
-        DRC_LAYER( drc_rtree* aTree ) : layer_tree( aTree )
+        switch( aItem->Type() )
         {
-            m_rect = { { INT_MIN, INT_MIN }, { INT_MAX, INT_MAX } };
-        };
+        case PCB_TRACE_T:
+        case PCB_ARC_T:
+        case PCB_PAD_T:
+            return true;
+
+        case PCB_VIA_T:
+            return !static_cast<const PCB_VIA*>( aItem )->GetRemoveUnconnected();
 
-        DRC_LAYER( drc_rtree* aTree, const EDA_RECT aRect ) : layer_tree( aTree )
+        default:
+            return false;
+        }
+    }
+
+    static std::vector<INDEXED_SHAPE> extractShapes( const PENDING_ITEM& aPending )
+    {
+        BOARD_ITEM*            item = aPending.item;
+        std::vector<SHAPE*>    subshapes;
+        std::shared_ptr<SHAPE> shape = item->GetEffectiveShape( aPending.refLayer );
+
+        if( shape->HasIndexableSubshapes() )
+            shape->GetIndexableSubshapes( subshapes );
+        else
+            subshapes.push_back( shape.get() );
+
+        if( item->Type() == PCB_PAD_T )
         {
-            m_rect = { { aRect.GetX(), aRect.GetY() },
-                       { aRect.GetRight(), aRect.GetBottom() } };
-        };
+            PAD* pad = static_cast<PAD*>( item );
+
+            if( pad->GetDrillSizeX() )
+            {
+                const SHAPE* hole = pad->GetEffectiveHoleShape();
+                subshapes.push_back( const_cast<SHAPE*>( hole ) );
+            }
+        }
 
-        drc_rtree::Rect m_rect;
-        drc_rtree*      layer_tree;
+        std::vector<INDEXED_SHAPE> result;
+        result.reserve( subshapes.size() );
 
-        iterator begin()
+        for( SHAPE* subshape : subshapes )
         {
-            return layer_tree->begin( m_rect );
+            BOX2I bbox = subshape->BBox();
+
+            bbox.Inflate( aPending.worstClearance );
+            result.push_back( { new ITEM_WITH_SHAPE( item, subshape, shape ), bbox } );
         }
 
-        iterator end()
+        return result;
+    }
+
+    /**
+     * Add the pending items to the trees.  The caller holds m_buildMutex.
+     */
+    void build()
+    {
+        // Spawning threads isn't worth it for small trees
+        bool parallel = m_pending.size() >= PARALLEL_THRESHOLD;
+
+        // Fetch the shapes of the new items; see canFetchInParallel() for which ones can be
+        // fetched on worker threads
+        std::vector<std::vector<INDEXED_SHAPE>> itemShapes( m_pending.size() );
+
+        for( size_t ii = 0; ii < m_pending.size(); ++ii )
         {
-            return layer_tree->end( m_rect );
+            if( !canFetchInParallel( m_pending[ii].item ) )
+                itemShapes[ii] = extractShapes( m_pending[ii] );
         }
-    };
 
-    DRC_LAYER OnLayer( PCB_LAYER_ID aLayer ) const
+        parallelFor( m_pending.size(), parallel,
+                [&]( size_t aIndex )
+                {
+                    if( canFetchInParallel( m_pending[aIndex].item ) )
+                        itemShapes[aIndex] = extractShapes( m_pending[aIndex] );
+                } );
+
+        // Sort them by layer, keeping their insertion order
+        std::vector<INDEXED_SHAPE> layerShapes[PCB_LAYER_ID_COUNT];
+
+        for( size_t ii = 0; ii < m_pending.size(); ++ii )
+        {
+            std::vector<INDEXED_SHAPE>& layer = layerShapes[m_pending[ii].targetLayer];
+
+            for( const INDEXED_SHAPE& indexed : itemShapes[ii] )
+            {
+                m_itemShapes.emplace_back( indexed.itemShape );
+                layer.push_back( indexed );
+            }
+
+            m_count += itemShapes[ii].size();
+        }
+
+        // Then load each layer's trees
+        std::vector<int> layers;
+
+        for( int layer = 0; layer < PCB_LAYER_ID_COUNT; ++layer )
+        {
+            if( !layerShapes[layer].empty() || !m_packedTree[layer].IsBuilt() )
+                layers.push_back( layer );
+        }
+
+        parallelFor( layers.size(), parallel,
+                [&]( size_t aIndex )
+                {
+                    int layer = layers[aIndex];
+
+                    for( const INDEXED_SHAPE& indexed : layerShapes[layer] )
+                    {
+                        const int mmin[2] = { indexed.bbox.GetX(), indexed.bbox.GetY() };
+                        const int mmax[2] = { indexed.bbox.GetRight(), indexed.bbox.GetBottom() };
+
+                        m_packedTree[layer].Insert( mmin, mmax, indexed.itemShape );
+                    }
+
+                    m_packedTree[layer].Build();
+                } );
+
+        m_pending.clear();
+        m_dirty.store( false, std::memory_order_release );
+    }
+
+    /**
+     * Build the tree if items were inserted since it was last built, so that a tree which
+     * wasn't built explicitly isn't seen empty.  Safe to call from several threads, but the
+     * shapes canFetchInParallel() rejects are then fetched on whichever thread queries first:
+     * trees holding those should still be built with Build().
+     */
+    void ensureBuilt() const
     {
-        return DRC_LAYER( m_tree[int( aLayer )] );
+        if( !m_dirty.load( std::memory_order_acquire ) )
+            return;
+
+        std::lock_guard<std::mutex> lock( m_buildMutex );
+
+        if( m_dirty.load( std::memory_order_relaxed ) )
+            const_cast<DRC_RTREE*>( this )->build();
     }
 
-    DRC_LAYER Overlapping( PCB_LAYER_ID aLayer, const wxPoint& aPoint, int aAccuracy = 0 ) const
+    /**
+     * Call \a aFunc for each index in [0, \a aCount), on all cores if \a aParallel is set.
+     */
+    template <class FUNC>
+    static void parallelFor( size_t aCount, bool aParallel, FUNC&& aFunc )
     {
-        EDA_RECT rect( aPoint, wxSize( 0, 0 ) );
-        rect.Inflate( aAccuracy );
-        return DRC_LAYER( m_tree[int( aLayer )], rect );
+        size_t threadCount = std::min<size_t>( std::thread::hardware_concurrency(), aCount );
+
+        if( !aParallel || threadCount <= 1 )
+        {
+            for( size_t ii = 0; ii < aCount; ++ii )
+                aFunc( ii );
+
+            return;
+        }
+
+        std::atomic<size_t>            next( 0 );
+        std::vector<std::future<void>> returns( threadCount );
+
+        for( size_t ii = 0; ii < threadCount; ++ii )
+        {
+            returns[ii] = std::async( std::launch::async,
+                    [&]()
+                    {
+                        for( size_t i = next++; i < aCount; i = next++ )
+                            aFunc( i );
+                    } );
+        }
+
+        for( std::future<void>& ret : returns )
+            ret.wait();
     }
 
-    DRC_LAYER Overlapping( PCB_LAYER_ID aLayer, const EDA_RECT& aRect ) const
+    /**
+     * Run a search on a layer.
+     */
+    template <class VISITOR>
+    void search( PCB_LAYER_ID aLayer, const int aMin[2], const int aMax[2],
+                 VISITOR& aVisitor ) const
     {
-        return DRC_LAYER( m_tree[int( aLayer )], aRect );
+        ensureBuilt();
+
+        if( queryCountEnabled().load( std::memory_order_relaxed ) )
+            queryCount().fetch_add( 1, std::memory_order_relaxed );
+
+        m_packedTree[aLayer].Search( aMin, aMax, aVisitor );
     }
 
+    static std::atomic<bool>& queryCountEnabled()
+    {
+        static std::atomic<bool> s_enabled( false );
+        return s_enabled;
+    }
+
+    static std::atomic<int64_t>& queryCount()
+    {
+        static std::atomic<int64_t> s_count( 0 );
+        return s_count;
+    }
 
 private:
-    drc_rtree*  m_tree[PCB_LAYER_ID_COUNT];
-    size_t      m_count;
+    packed_rtree m_packedTree[PCB_LAYER_ID_COUNT];
+    size_t       m_count;
+
+    std::vector<PENDING_ITEM>                     m_pending;
+    std::vector<std::unique_ptr<ITEM_WITH_SHAPE>> m_itemShapes;   ///< owned by the tree
+
+    mutable std::mutex                            m_buildMutex;
+    std::atomic<bool>                             m_dirty;        ///< items wait for build()
 };
 
 
@@ -30,7 +30,8 @@
 
 DRC_RULE_CONDITION::DRC_RULE_CONDITION( const wxString& aExpression ) :
     m_expression( aExpression ),
-    m_ucode ( nullptr )
+    m_ucode ( nullptr ),
+    m_dependencies( DEP_OTHER )
 {
 }
 
@@ -112,6 +113,27 @@ bool DRC_RULE_CONDITION::Compile( REPORTER* aReporter, int aSourceLine, int aSou
     PCB_EXPR_CONTEXT preflightContext( F_Cu );
 
     bool ok = compiler.Compile( GetExpression().ToUTF8().data(), m_ucode.get(), &preflightContext );
+
+    m_dependencies = ok ? 0 : DEP_OTHER;
+
+    for( const LIBEVAL::UOP* op : m_ucode->GetOps() )
+    {
+        const LIBEVAL::VAR_REF* ref = op->GetRef();
+
+        if( op->IsFuncCall() )
+            m_dependencies |= DEP_OTHER;
+        else if( !ref )
+            continue;
+        else if( dynamic_cast<const PCB_EXPR_NETCLASS_REF*>( ref ) )
+            m_dependencies |= DEP_NETCLASS;
+        else if( dynamic_cast<const PCB_EXPR_NETNAME_REF*>( ref ) )
+            m_dependencies |= DEP_NETNAME;
+        else if( dynamic_cast<const PCB_EXPR_TYPE_REF*>( ref ) )
+            m_dependencies |= DEP_TYPE;
+        else
+            m_dependencies |= DEP_OTHER;
+    }
+
     return ok;
 }
 
@@ -46,9 +46,26 @@ public:
     void SetExpression( const wxString& aExpression ) { m_expression = aExpression; }
     wxString GetExpression() const { return m_expression; }
 
+    /**
+     * What the condition reads from the items it is evaluated for.
+     */
+    enum DEPENDENCY
+    {
+        DEP_NETCLASS = 0x01,    ///< A.NetClass or B.NetClass
+        DEP_NETNAME  = 0x02,    ///< A.NetName or B.NetName
+        DEP_TYPE     = 0x04,    ///< A.Type or B.Type
+        DEP_OTHER    = 0x08     ///< any other property, the layer or a function call
+    };
+
+    /**
+     * @return a mask of DEPENDENCY flags, computed by Compile().
+     */
+    int GetDependencies() const { return m_dependencies; }
+
 private:
     wxString                        m_expression;
     std::unique_ptr<PCB_EXPR_UCODE> m_ucode;
+    int                             m_dependencies;
 };
 
 
@@ -23,6 +23,7 @@
 
 #include <drc/drc_engine.h>
 #include <drc/drc_item.h>
+#include <drc/drc_rtree.h>
 #include <drc/drc_test_provider.h>
 #include <pcb_track.h>
 #include <footprint.h>
@@ -142,6 +143,18 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
     BOARD *brd = m_drcEngine->GetBoard();
     std::bitset<MAX_STRUCT_TYPE_ID> typeMask;
     int n = 0;
+    int skipped = 0;
+
+    // Items outside the test region of an incremental run are neither visited nor counted
+    std::function<bool( BOARD_ITEM* )> func =
+            [&]( BOARD_ITEM* aItem ) -> bool
+            {
+                if( m_drcEngine->IsInTestRegion( aItem ) )
+                    return aFunc( aItem );
+
+                skipped++;
+                return true;
+            };
 
     if( s_allBasicItems.size() == 0 )
     {
@@ -174,17 +187,17 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
         {
             if( typeMask[ PCB_TRACE_T ] && item->Type() == PCB_TRACE_T )
             {
-                aFunc( item );
+                func( item );
                 n++;
             }
             else if( typeMask[ PCB_VIA_T ] && item->Type() == PCB_VIA_T )
             {
-                aFunc( item );
+                func( item );
                 n++;
             }
             else if( typeMask[ PCB_ARC_T ] && item->Type() == PCB_ARC_T )
             {
-                aFunc( item );
+                func( item );
                 n++;
             }
         }
@@ -196,29 +209,29 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
         {
             if( typeMask[ PCB_DIMENSION_T ] && BaseType( item->Type() ) == PCB_DIMENSION_T )
             {
-                if( !aFunc( item ) )
-                    return n;
+                if( !func( item ) )
+                    return n - skipped;
 
                 n++;
             }
             else if( typeMask[ PCB_SHAPE_T ] && item->Type() == PCB_SHAPE_T )
             {
-                if( !aFunc( item ) )
-                    return n;
+                if( !func( item ) )
+                    return n - skipped;
 
                 n++;
             }
             else if( typeMask[ PCB_TEXT_T ] && item->Type() == PCB_TEXT_T )
             {
-                if( !aFunc( item ) )
-                    return n;
+                if( !func( item ) )
+                    return n - skipped;
 
                 n++;
             }
             else if( typeMask[ PCB_TARGET_T ] && item->Type() == PCB_TARGET_T )
             {
-                if( !aFunc( item ) )
-                    return n;
+                if( !func( item ) )
+                    return n - skipped;
 
                 n++;
             }
@@ -231,8 +244,8 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
         {
             if( ( item->GetLayerSet() & aLayers ).any() )
             {
-                if( !aFunc( item ) )
-                    return n;
+                if( !func( item ) )
+                    return n - skipped;
 
                 n++;
             }
@@ -245,16 +258,16 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
         {
             if( ( footprint->Reference().GetLayerSet() & aLayers ).any() )
             {
-                if( !aFunc( &footprint->Reference() ) )
-                    return n;
+                if( !func( &footprint->Reference() ) )
+                    return n - skipped;
 
                 n++;
             }
 
             if( ( footprint->Value().GetLayerSet() & aLayers ).any() )
             {
-                if( !aFunc( &footprint->Value() ) )
-                    return n;
+                if( !func( &footprint->Value() ) )
+                    return n - skipped;
 
                 n++;
             }
@@ -268,8 +281,8 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
                 if( ( pad->GetDrillSizeX() > 0 && pad->GetDrillSizeY() > 0 )
                         || ( pad->GetLayerSet() & aLayers ).any() )
                 {
-                    if( !aFunc( pad ) )
-                        return n;
+                    if( !func( pad ) )
+                        return n - skipped;
 
                     n++;
                 }
@@ -282,22 +295,22 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
             {
                 if( typeMask[ PCB_DIMENSION_T ] && BaseType( dwg->Type() ) == PCB_DIMENSION_T )
                 {
-                    if( !aFunc( dwg ) )
-                        return n;
+                    if( !func( dwg ) )
+                        return n - skipped;
 
                     n++;
                 }
                 else if( typeMask[ PCB_FP_TEXT_T ] && dwg->Type() == PCB_FP_TEXT_T )
                 {
-                    if( !aFunc( dwg ) )
-                        return n;
+                    if( !func( dwg ) )
+                        return n - skipped;
 
                     n++;
                 }
                 else if( typeMask[ PCB_FP_SHAPE_T ] && dwg->Type() == PCB_FP_SHAPE_T )
                 {
-                    if( !aFunc( dwg ) )
-                        return n;
+                    if( !func( dwg ) )
+                        return n - skipped;
 
                     n++;
                 }
@@ -310,8 +323,8 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
             {
                 if( (zone->GetLayerSet() & aLayers).any() )
                 {
-                    if( !aFunc( zone ) )
-                        return n;
+                    if( !func( zone ) )
+                        return n - skipped;
 
                     n++;
                 }
@@ -320,14 +333,14 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
 
         if( typeMask[ PCB_FOOTPRINT_T ] )
         {
-            if( !aFunc( footprint ) )
-                return n;
+            if( !func( footprint ) )
+                return n - skipped;
 
             n++;
         }
     }
 
-    return n;
+    return n - skipped;
 }
 
 
@@ -348,3 +361,67 @@ bool DRC_TEST_PROVIDER::isInvisibleText( const BOARD_ITEM* aItem ) const
 
     return false;
 }
+
+
+DRC_RTREE* DRC_TEST_PROVIDER::getSharedIndex( const std::vector<KICAD_T>& aTypes, LSET aLayers,
+                                              int* aItemCount )
+{
+    DRC_ENGINE::SHARED_INDEX& index = m_drcEngine->GetSharedIndex( aTypes );
+    LSET                      missing = aLayers & ~index.layers;
+    int                       count = -1;
+
+    for( const std::pair<LSET, int>& known : index.itemCounts )
+    {
+        if( known.first == aLayers )
+            count = known.second;
+    }
+
+    if( count < 0 )
+    {
+        count = forEachGeometryItem( aTypes, aLayers,
+                                     []( BOARD_ITEM* item ) -> bool
+                                     {
+                                         return true;
+                                     } );
+
+        index.itemCounts.emplace_back( aLayers, count );
+    }
+
+    if( aItemCount )
+        *aItemCount = count;
+
+    if( missing.none() )
+        return index.tree.get();
+
+    // This is the number of tests between 2 calls to the progress bar
+    int delta = 50;
+    int ii = 0;
+
+    forEachGeometryItem( aTypes, missing,
+            [&]( BOARD_ITEM* item ) -> bool
+            {
+                if( !reportProgress( ii++, count, delta ) )
+                    return false;
+
+                LSET layers = item->GetLayerSet();
+
+                // Special-case pad holes which pierce all the copper layers
+                if( item->Type() == PCB_PAD_T )
+                {
+                    PAD* pad = static_cast<PAD*>( item );
+
+                    if( pad->GetDrillSizeX() > 0 && pad->GetDrillSizeY() > 0 )
+                        layers |= LSET::AllCuMask();
+                }
+
+                for( PCB_LAYER_ID layer : LSET( layers & missing ).Seq() )
+                    index.tree->Insert( item, layer );
+
+                return true;
+            } );
+
+    index.tree->Build();
+    index.layers |= missing;
+
+    return index.tree.get();
+}
@@ -32,6 +32,7 @@
 #include <set>
 
 class DRC_ENGINE;
+class DRC_RTREE;
 class DRC_TEST_PROVIDER;
 
 class DRC_TEST_PROVIDER_REGISTRY
@@ -89,10 +90,33 @@ public:
     virtual const wxString GetName() const;
     virtual const wxString GetDescription() const;
 
+    /**
+     * Providers which only test items against their neighbours can be limited to a region of
+     * the board (see DRC_ENGINE::RunIncrementalTests()).  They skip the items for which
+     * DRC_ENGINE::IsInTestRegion() is false, and return here the errors they report.
+     *
+     * @return the errors reported, or an empty set if the provider must test the whole board.
+     */
+    virtual std::set<int> GetRegionErrorCodes() const { return {}; }
+
 protected:
     int forEachGeometryItem( const std::vector<KICAD_T>& aTypes, LSET aLayers,
                              const std::function<bool(BOARD_ITEM*)>& aFunc );
 
+    /**
+     * Fetch the spatial index of the items of \a aTypes on \a aLayers, building (or extending)
+     * it on first use.  The index is shared with the other providers of the run and owned by
+     * the engine.
+     *
+     * Items are indexed on each of their layers, with drilled pads on all copper layers.  The
+     * shapes aren't inflated by any clearance: search with DRC_RTREE::QueryColliding(), which
+     * inflates the query instead.
+     *
+     * @param aItemCount [out] is optional, and receives the number of items on \a aLayers.
+     */
+    DRC_RTREE* getSharedIndex( const std::vector<KICAD_T>& aTypes, LSET aLayers,
+                               int* aItemCount = nullptr );
+
     virtual void reportAux( wxString fmt, ... );
     virtual void reportViolation( std::shared_ptr<DRC_ITEM>& item, const wxPoint& aMarkerPos );
     virtual bool reportProgress( int aCount, int aSize, int aDelta );
@@ -30,6 +30,7 @@
 #include <pcb_track.h>
 #include <zone.h>
 
+#include <geometry/packed_rtree.h>
 #include <geometry/seg.h>
 #include <geometry/shape_poly_set.h>
 #include <geometry/shape_segment.h>
@@ -41,6 +42,10 @@
 #include <drc/drc_test_provider_clearance_base.h>
 #include <pcb_dimension.h>
 
+#include <atomic>
+#include <future>
+#include <thread>
+
 /*
     Copper clearance test. Checks all copper items (pads, vias, tracks, drawings, zones) for their
     electrical clearance.
@@ -58,7 +63,8 @@ class DRC_TEST_PROVIDER_COPPER_CLEARANCE : public DRC_TEST_PROVIDER_CLEARANCE_BA
 public:
     DRC_TEST_PROVIDER_COPPER_CLEARANCE () :
             DRC_TEST_PROVIDER_CLEARANCE_BASE(),
-            m_drcEpsilon( 0 )
+            m_drcEpsilon( 0 ),
+            m_copperTree( nullptr )
     {
     }
 
@@ -78,6 +84,12 @@ public:
         return "Tests copper item clearance";
     }
 
+    virtual std::set<int> GetRegionErrorCodes() const override
+    {
+        return { DRCE_CLEARANCE, DRCE_HOLE_CLEARANCE, DRCE_TRACKS_CROSSING, DRCE_ZONES_INTERSECT,
+                 DRCE_SHORTING_ITEMS };
+    }
+
 private:
     bool testTrackAgainstItem( PCB_TRACK* track, SHAPE* trackShape, PCB_LAYER_ID layer,
                                BOARD_ITEM* other );
@@ -93,7 +105,7 @@ private:
     void testItemAgainstZone( BOARD_ITEM* aItem, ZONE* aZone, PCB_LAYER_ID aLayer );
 
 private:
-    DRC_RTREE          m_copperTree;
+    DRC_RTREE*         m_copperTree;      ///< shared with other providers; owned by the engine
     int                m_drcEpsilon;
 
     std::vector<ZONE*> m_copperZones;
@@ -125,7 +137,9 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::Run()
     {
         if( ( zone->GetLayerSet() & LSET::AllCuMask() ).any() && !zone->GetIsRuleArea() )
         {
-            m_copperZones.push_back( zone );
+            if( m_drcEngine->IsInTestRegion( zone ) )
+                m_copperZones.push_back( zone );
+
             m_largestClearance = std::max( m_largestClearance, zone->GetLocalClearance() );
         }
     }
@@ -139,7 +153,9 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::Run()
         {
             if( ( zone->GetLayerSet() & LSET::AllCuMask() ).any() && !zone->GetIsRuleArea() )
             {
-                m_copperZones.push_back( zone );
+                if( m_drcEngine->IsInTestRegion( zone ) )
+                    m_copperZones.push_back( zone );
+
                 m_largestClearance = std::max( m_largestClearance, zone->GetLocalClearance() );
             }
         }
@@ -147,46 +163,6 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::Run()
 
     reportAux( "Worst clearance : %d nm", m_largestClearance );
 
-    // This is the number of tests between 2 calls to the progress bar
-    size_t delta = 50;
-    size_t count = 0;
-    size_t ii = 0;
-
-    m_copperTree.clear();
-
-    auto countItems =
-            [&]( BOARD_ITEM* item ) -> bool
-            {
-                ++count;
-                return true;
-            };
-
-    auto addToCopperTree =
-            [&]( BOARD_ITEM* item ) -> bool
-            {
-                if( !reportProgress( ii++, count, delta ) )
-                    return false;
-
-                LSET layers = item->GetLayerSet();
-
-                // Special-case pad holes which pierce all the copper layers
-                if( item->Type() == PCB_PAD_T )
-                {
-                    PAD* pad = static_cast<PAD*>( item );
-
-                    if( pad->GetDrillSizeX() > 0 && pad->GetDrillSizeY() > 0 )
-                        layers |= LSET::AllCuMask();
-                }
-
-                for( PCB_LAYER_ID layer : layers.Seq() )
-                {
-                    if( IsCopperLayer( layer ) )
-                        m_copperTree.Insert( item, layer, m_largestClearance );
-                }
-
-                return true;
-            };
-
     if( !reportPhase( _( "Gathering copper items..." ) ) )
         return false;   // DRC cancelled
 
@@ -195,8 +171,9 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::Run()
         PCB_TEXT_T, PCB_FP_TEXT_T, PCB_DIMENSION_T
     };
 
-    forEachGeometryItem( itemTypes, LSET::AllCuMask(), countItems );
-    forEachGeometryItem( itemTypes, LSET::AllCuMask(), addToCopperTree );
+    int count = 0;
+
+    m_copperTree = getSharedIndex( itemTypes, LSET::AllCuMask(), &count );
 
     reportAux( "Testing %d copper items and %d zones...", count, m_copperZones.size() );
 
@@ -263,6 +240,8 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackAgainstItem( PCB_TRACK* track,
     int            actual;
     VECTOR2I       pos;
 
+    DRC_DISTANCE_CACHE& distanceCache = m_drcEngine->GetDistanceCache();
+
     if( other->Type() == PCB_PAD_T )
     {
         PAD* pad = static_cast<PAD*>( other );
@@ -299,7 +278,9 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackAgainstItem( PCB_TRACK* track,
 
         std::shared_ptr<SHAPE> otherShape = DRC_ENGINE::GetShape( other, layer );
 
-        if( trackShape->Collide( otherShape.get(), clearance - m_drcEpsilon, &actual, &pos ) )
+        if( distanceCache.Collide( track, trackShape, DRC_SHAPE_TYPE::EFFECTIVE_SHAPE,
+                                   other, otherShape.get(), DRC_SHAPE_TYPE::DRC_SHAPE,
+                                   layer, clearance - m_drcEpsilon, &actual, &pos ) )
         {
             std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_CLEARANCE );
 
@@ -346,8 +327,10 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackAgainstItem( PCB_TRACK* track,
 
             if( constraint.GetSeverity() != RPT_SEVERITY_IGNORE && clearance > 0 )
             {
-                if( trackShape->Collide( holeShape.get(), std::max( 0, clearance - m_drcEpsilon ),
-                                         &actual, &pos ) )
+                if( distanceCache.Collide( track, trackShape, DRC_SHAPE_TYPE::EFFECTIVE_SHAPE,
+                                           other, holeShape.get(), DRC_SHAPE_TYPE::HOLE, layer,
+                                           std::max( 0, clearance - m_drcEpsilon ),
+                                           &actual, &pos ) )
                 {
                     std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_HOLE_CLEARANCE );
 
@@ -515,11 +498,14 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackClearances()
         if( !reportProgress( ii++, m_board->Tracks().size(), delta ) )
             break;
 
+        if( !m_drcEngine->IsInTestRegion( track ) )
+            continue;
+
         for( PCB_LAYER_ID layer : track->GetLayerSet().Seq() )
         {
             std::shared_ptr<SHAPE> trackShape = track->GetEffectiveShape( layer );
 
-            m_copperTree.QueryColliding( track, layer, layer,
+            m_copperTree->QueryColliding( track, layer, layer,
                     // Filter:
                     [&]( BOARD_ITEM* other ) -> bool
                     {
@@ -636,6 +622,8 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
     int                    actual;
     VECTOR2I               pos;
 
+    DRC_DISTANCE_CACHE& distanceCache = m_drcEngine->GetDistanceCache();
+
     if( otherPad && pad->SameLogicalPadAs( otherPad ) )
     {
         // If pads are equivalent (ie: from the same footprint with the same pad number)...
@@ -667,8 +655,10 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
 
         if( constraint.GetSeverity() != RPT_SEVERITY_IGNORE && clearance > 0 )
         {
-            if( padShape->Collide( otherShape.get(), std::max( 0, clearance - m_drcEpsilon ),
-                                   &actual, &pos ) )
+            if( distanceCache.Collide( pad, padShape, DRC_SHAPE_TYPE::DRC_SHAPE,
+                                       other, otherShape.get(), DRC_SHAPE_TYPE::DRC_SHAPE,
+                                       layer, std::max( 0, clearance - m_drcEpsilon ),
+                                       &actual, &pos ) )
             {
                 std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_CLEARANCE );
 
@@ -698,9 +688,12 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
 
     if( testHoles && otherPad && pad->FlashLayer( layer ) && otherPad->GetDrillSize().x )
     {
-        if( clearance > 0 && padShape->Collide( otherPad->GetEffectiveHoleShape(),
-                                                std::max( 0, clearance - m_drcEpsilon ),
-                                                &actual, &pos ) )
+        if( clearance > 0
+                && distanceCache.Collide( pad, padShape, DRC_SHAPE_TYPE::DRC_SHAPE,
+                                          otherPad, otherPad->GetEffectiveHoleShape(),
+                                          DRC_SHAPE_TYPE::HOLE, layer,
+                                          std::max( 0, clearance - m_drcEpsilon ),
+                                          &actual, &pos ) )
         {
             std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_HOLE_CLEARANCE );
 
@@ -720,9 +713,12 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
 
     if( testHoles && otherPad && otherPad->FlashLayer( layer ) && pad->GetDrillSize().x )
     {
-        if( clearance >= 0 && otherShape->Collide( pad->GetEffectiveHoleShape(),
-                                                   std::max( 0, clearance - m_drcEpsilon ),
-                                                   &actual, &pos ) )
+        if( clearance >= 0
+                && distanceCache.Collide( other, otherShape.get(), DRC_SHAPE_TYPE::DRC_SHAPE,
+                                          pad, pad->GetEffectiveHoleShape(),
+                                          DRC_SHAPE_TYPE::HOLE, layer,
+                                          std::max( 0, clearance - m_drcEpsilon ),
+                                          &actual, &pos ) )
         {
             std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_HOLE_CLEARANCE );
 
@@ -745,9 +741,11 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
         pos = otherVia->GetPosition();
         otherShape.reset( new SHAPE_SEGMENT( pos, pos, otherVia->GetDrill() ) );
 
-        if( clearance > 0 && padShape->Collide( otherShape.get(),
-                                                std::max( 0, clearance - m_drcEpsilon ),
-                                                &actual, &pos ) )
+        if( clearance > 0
+                && distanceCache.Collide( pad, padShape, DRC_SHAPE_TYPE::DRC_SHAPE,
+                                          otherVia, otherShape.get(), DRC_SHAPE_TYPE::HOLE,
+                                          layer, std::max( 0, clearance - m_drcEpsilon ),
+                                          &actual, &pos ) )
         {
             std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_HOLE_CLEARANCE );
 
@@ -789,11 +787,14 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadClearances( )
             if( !reportProgress( ii++, count, delta ) )
                 break;
 
+            if( !m_drcEngine->IsInTestRegion( pad ) )
+                continue;
+
             for( PCB_LAYER_ID layer : pad->GetLayerSet().Seq() )
             {
                 std::shared_ptr<SHAPE> padShape = DRC_ENGINE::GetShape( pad, layer );
 
-                m_copperTree.QueryColliding( pad, layer, layer,
+                m_copperTree->QueryColliding( pad, layer, layer,
                         // Filter:
                         [&]( BOARD_ITEM* other ) -> bool
                         {
@@ -836,168 +837,293 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testZonesToZones()
 
     SHAPE_POLY_SET  buffer;
     SHAPE_POLY_SET* boardOutline = nullptr;
-    DRC_CONSTRAINT  constraint;
-    int             zone2zoneClearance;
 
     if( m_board->GetBoardPolygonOutlines( buffer ) )
         boardOutline = &buffer;
 
+    // The smoothed outline of a zone on one layer, with an index of its edges
+    struct ZONE_OUTLINE
+    {
+        PCB_LAYER_ID      layer = UNDEFINED_LAYER;
+        ZONE*             zone = nullptr;
+        SHAPE_POLY_SET    poly;
+        BOX2I             bbox;
+        std::vector<SEG>  segments;
+        PACKED_RTREE<int> segmentTree;
+    };
+
+    struct ZONE_PAIR
+    {
+        ZONE_OUTLINE*          a;
+        ZONE_OUTLINE*          b;
+        DRC_CONSTRAINT         constraint;
+        int                    clearance;
+
+        std::vector<VECTOR2I>  aCornersInB;
+        std::vector<VECTOR2I>  bCornersInA;
+        std::map<wxPoint, int> conflictPoints;
+    };
+
+    std::atomic<bool> cancelled( false );
+
+    // Run aTask for each index in [0, aCount) on all cores, reporting progress meanwhile.
+    // Returns false if cancelled.
+    auto runParallel =
+            [&]( size_t aCount, const std::function<void( size_t )>& aTask ) -> bool
+            {
+                std::atomic<size_t> next( 0 );
+                std::atomic<size_t> done( 0 );
+
+                auto worker =
+                        [&]() -> size_t
+                        {
+                            for( size_t i = next++; i < aCount && !cancelled; i = next++ )
+                            {
+                                aTask( i );
+                                done++;
+                            }
+
+                            return 1;
+                        };
+
+                size_t threadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                       aCount );
+
+                if( threadCount <= 1 )
+                {
+                    worker();
+                }
+                else
+                {
+                    std::vector<std::future<size_t>> returns( threadCount );
+
+                    for( size_t ii = 0; ii < threadCount; ++ii )
+                        returns[ii] = std::async( std::launch::async, worker );
+
+                    for( size_t ii = 0; ii < threadCount; ++ii )
+                    {
+                        // Here we balance returns with a 100ms timeout to allow UI updating
+                        std::future_status status;
+
+                        do
+                        {
+                            if( !cancelled && !reportProgress( done, aCount, 1 ) )
+                                cancelled = true;
+
+                            status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
+                        } while( status != std::future_status::ready );
+                    }
+                }
+
+                return !cancelled;
+            };
+
+    // Smooth the zone outlines, and index their edges
+    std::vector<std::unique_ptr<ZONE_OUTLINE>> outlines;
+
     for( int layer_id = F_Cu; layer_id <= B_Cu; ++layer_id )
     {
         PCB_LAYER_ID layer = static_cast<PCB_LAYER_ID>( layer_id );
-        std::vector<SHAPE_POLY_SET> smoothed_polys;
-        smoothed_polys.resize( m_copperZones.size() );
 
         // Skip over layers not used on the current board
         if( !m_board->IsLayerEnabled( layer ) )
             continue;
 
-        for( size_t ii = 0; ii < m_copperZones.size(); ii++ )
+        for( ZONE* zone : m_copperZones )
         {
-            if( m_copperZones[ii]->IsOnLayer( layer ) )
-                m_copperZones[ii]->BuildSmoothedPoly( smoothed_polys[ii], layer, boardOutline );
+            // rule areas may overlap at will
+            if( zone->IsOnLayer( layer ) && !zone->GetIsRuleArea() )
+            {
+                outlines.push_back( std::make_unique<ZONE_OUTLINE>() );
+                outlines.back()->layer = layer;
+                outlines.back()->zone = zone;
+            }
         }
+    }
+
+    bool ok = runParallel( outlines.size(),
+            [&]( size_t aIndex )
+            {
+                ZONE_OUTLINE& outline = *outlines[aIndex];
 
-        // iterate through all areas
-        for( size_t ia = 0; ia < m_copperZones.size(); ia++ )
+                outline.zone->BuildSmoothedPoly( outline.poly, outline.layer, boardOutline );
+                outline.bbox = outline.poly.BBox();
+
+                for( auto it = outline.poly.CIterateSegmentsWithHoles(); it; it++ )
+                {
+                    const SEG& seg = *it;
+                    int        min[2] = { std::min( seg.A.x, seg.B.x ),
+                                          std::min( seg.A.y, seg.B.y ) };
+                    int        max[2] = { std::max( seg.A.x, seg.B.x ),
+                                          std::max( seg.A.y, seg.B.y ) };
+
+                    outline.segmentTree.Insert( min, max, (int) outline.segments.size() );
+                    outline.segments.push_back( seg );
+                }
+
+                outline.segmentTree.Build();
+            } );
+
+    if( !ok )
+        return;
+
+    // Collect the pairs which can collide.  Outlines are grouped by layer, in zone order.
+    std::vector<ZONE_PAIR> pairs;
+
+    for( size_t ia = 0; ia < outlines.size(); ia++ )
+    {
+        ZONE_OUTLINE* outlineA = outlines[ia].get();
+        ZONE*         zoneA = outlineA->zone;
+
+        for( size_t ia2 = ia + 1; ia2 < outlines.size(); ia2++ )
         {
-            if( !reportProgress( layer_id * m_copperZones.size() + ia, B_Cu * m_copperZones.size(), delta ) )
-                break;
+            ZONE_OUTLINE* outlineB = outlines[ia2].get();
+            ZONE*         zoneB = outlineB->zone;
 
-            ZONE* zoneA = m_copperZones[ia];
+            // test for same layer
+            if( outlineB->layer != outlineA->layer )
+                break;
 
-            if( !zoneA->IsOnLayer( layer ) )
+            // Test for same net
+            if( zoneA->GetNetCode() == zoneB->GetNetCode() && zoneA->GetNetCode() >= 0 )
                 continue;
 
-            for( size_t ia2 = ia + 1; ia2 < m_copperZones.size(); ia2++ )
-            {
-                ZONE* zoneB = m_copperZones[ia2];
-
-                // test for same layer
-                if( !zoneB->IsOnLayer( layer ) )
-                    continue;
+            // test for different priorities
+            if( zoneA->GetPriority() != zoneB->GetPriority() )
+                continue;
 
-                // Test for same net
-                if( zoneA->GetNetCode() == zoneB->GetNetCode() && zoneA->GetNetCode() >= 0 )
-                    continue;
+            // Get clearance used in zone to zone test.
+            DRC_CONSTRAINT constraint = m_drcEngine->EvalRules( CLEARANCE_CONSTRAINT, zoneA,
+                                                                zoneB, outlineA->layer );
+            int            clearance = constraint.GetValue().Min();
 
-                // test for different priorities
-                if( zoneA->GetPriority() != zoneB->GetPriority() )
-                    continue;
+            if( constraint.GetSeverity() == RPT_SEVERITY_IGNORE )
+                continue;
 
-                // rule areas may overlap at will
-                if( zoneA->GetIsRuleArea() || zoneB->GetIsRuleArea() )
-                    continue;
+            BOX2I bboxA = outlineA->bbox;
 
-                // Examine a candidate zone: compare zoneB to zoneA
+            if( !bboxA.Inflate( clearance ).Intersects( outlineB->bbox ) )
+                continue;
 
-                // Get clearance used in zone to zone test.
-                constraint = m_drcEngine->EvalRules( CLEARANCE_CONSTRAINT, zoneA, zoneB, layer );
-                zone2zoneClearance = constraint.GetValue().Min();
+            pairs.push_back( { outlineA, outlineB, constraint, clearance } );
+        }
+    }
 
-                if( constraint.GetSeverity() == RPT_SEVERITY_IGNORE )
-                    continue;
+    ok = runParallel( pairs.size(),
+            [&]( size_t aIndex )
+            {
+                ZONE_PAIR&          pair = pairs[aIndex];
+                const ZONE_OUTLINE& a = *pair.a;
+                const ZONE_OUTLINE& b = *pair.b;
 
                 // test for some corners of zoneA inside zoneB
-                for( auto iterator = smoothed_polys[ia].IterateWithHoles(); iterator; iterator++ )
+                for( auto iterator = a.poly.CIterateWithHoles(); iterator; iterator++ )
                 {
-                    VECTOR2I currentVertex = *iterator;
-                    wxPoint pt( currentVertex.x, currentVertex.y );
-
-                    if( smoothed_polys[ia2].Contains( currentVertex ) )
-                    {
-                        std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_ZONES_INTERSECT );
-                        drce->SetItems( zoneA, zoneB );
-                        drce->SetViolatingRule( constraint.GetParentRule() );
-
-                        reportViolation( drce, pt );
-                    }
+                    if( b.bbox.Contains( *iterator ) && b.poly.Contains( *iterator ) )
+                        pair.aCornersInB.push_back( *iterator );
                 }
 
                 // test for some corners of zoneB inside zoneA
-                for( auto iterator = smoothed_polys[ia2].IterateWithHoles(); iterator; iterator++ )
+                for( auto iterator = b.poly.CIterateWithHoles(); iterator; iterator++ )
                 {
-                    VECTOR2I currentVertex = *iterator;
-                    wxPoint pt( currentVertex.x, currentVertex.y );
+                    if( a.bbox.Contains( *iterator ) && a.poly.Contains( *iterator ) )
+                        pair.bCornersInA.push_back( *iterator );
+                }
 
-                    if( smoothed_polys[ia].Contains( currentVertex ) )
-                    {
-                        std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_ZONES_INTERSECT );
-                        drce->SetItems( zoneB, zoneA );
-                        drce->SetViolatingRule( constraint.GetParentRule() );
+                // Test each segment of zoneA against the segments of zoneB near it
+                for( const SEG& refSegment : a.segments )
+                {
+                    int min[2] = { std::min( refSegment.A.x, refSegment.B.x ) - pair.clearance,
+                                   std::min( refSegment.A.y, refSegment.B.y ) - pair.clearance };
+                    int max[2] = { std::max( refSegment.A.x, refSegment.B.x ) + pair.clearance,
+                                   std::max( refSegment.A.y, refSegment.B.y ) + pair.clearance };
 
-                        reportViolation( drce, pt );
-                    }
+                    auto visitor =
+                            [&]( int aTestIndex ) -> bool
+                            {
+                                const SEG& testSegment = b.segments[aTestIndex];
+                                wxPoint    pt;
+
+                                int d = GetClearanceBetweenSegments(
+                                        testSegment.A.x, testSegment.A.y,
+                                        testSegment.B.x, testSegment.B.y, 0,
+                                        refSegment.A.x, refSegment.A.y,
+                                        refSegment.B.x, refSegment.B.y, 0,
+                                        pair.clearance, &pt.x, &pt.y );
+
+                                if( d < pair.clearance )
+                                {
+                                    auto it = pair.conflictPoints.find( pt );
+
+                                    if( it != pair.conflictPoints.end() )
+                                        it->second = std::min( it->second, d );
+                                    else
+                                        pair.conflictPoints[ pt ] = d;
+                                }
+
+                                return true;
+                            };
+
+                    b.segmentTree.Search( min, max, visitor );
                 }
+            } );
 
-                // Iterate through all the segments of refSmoothedPoly
-                std::map<wxPoint, int> conflictPoints;
+    if( !ok )
+        return;
 
-                for( auto refIt = smoothed_polys[ia].IterateSegmentsWithHoles(); refIt; refIt++ )
-                {
-                    // Build ref segment
-                    SEG refSegment = *refIt;
+    // Report in pair order, so that the results don't depend on the threads' timing
+    for( size_t ii = 0; ii < pairs.size(); ii++ )
+    {
+        if( !reportProgress( ii, pairs.size(), delta ) )
+            return;
 
-                    // Iterate through all the segments in smoothed_polys[ia2]
-                    for( auto testIt = smoothed_polys[ia2].IterateSegmentsWithHoles(); testIt; testIt++ )
-                    {
-                        // Build test segment
-                        SEG testSegment = *testIt;
-                        wxPoint pt;
-
-                        int ax1, ay1, ax2, ay2;
-                        ax1 = refSegment.A.x;
-                        ay1 = refSegment.A.y;
-                        ax2 = refSegment.B.x;
-                        ay2 = refSegment.B.y;
-
-                        int bx1, by1, bx2, by2;
-                        bx1 = testSegment.A.x;
-                        by1 = testSegment.A.y;
-                        bx2 = testSegment.B.x;
-                        by2 = testSegment.B.y;
-
-                        int d = GetClearanceBetweenSegments( bx1, by1, bx2, by2, 0,
-                                                             ax1, ay1, ax2, ay2, 0,
-                                                             zone2zoneClearance, &pt.x, &pt.y );
-
-                        if( d < zone2zoneClearance )
-                        {
-                            if( conflictPoints.count( pt ) )
-                                conflictPoints[ pt ] = std::min( conflictPoints[ pt ], d );
-                            else
-                                conflictPoints[ pt ] = d;
-                        }
-                    }
-                }
+        ZONE_PAIR& pair = pairs[ii];
+        ZONE*      zoneA = pair.a->zone;
+        ZONE*      zoneB = pair.b->zone;
 
-                for( const std::pair<const wxPoint, int>& conflict : conflictPoints )
-                {
-                    int actual = conflict.second;
-                    std::shared_ptr<DRC_ITEM> drce;
+        for( const VECTOR2I& corner : pair.aCornersInB )
+        {
+            std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_ZONES_INTERSECT );
+            drce->SetItems( zoneA, zoneB );
+            drce->SetViolatingRule( pair.constraint.GetParentRule() );
 
-                    if( actual <= 0 )
-                    {
-                        drce = DRC_ITEM::Create( DRCE_ZONES_INTERSECT );
-                    }
-                    else
-                    {
-                        drce = DRC_ITEM::Create( DRCE_CLEARANCE );
+            reportViolation( drce, (wxPoint) corner );
+        }
 
-                        m_msg.Printf( _( "(%s clearance %s; actual %s)" ),
-                                      constraint.GetName(),
-                                      MessageTextFromValue( userUnits(), zone2zoneClearance ),
-                                      MessageTextFromValue( userUnits(), conflict.second ) );
+        for( const VECTOR2I& corner : pair.bCornersInA )
+        {
+            std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_ZONES_INTERSECT );
+            drce->SetItems( zoneB, zoneA );
+            drce->SetViolatingRule( pair.constraint.GetParentRule() );
 
-                        drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + m_msg );
-                    }
+            reportViolation( drce, (wxPoint) corner );
+        }
 
-                    drce->SetItems( zoneA, zoneB );
-                    drce->SetViolatingRule( constraint.GetParentRule() );
+        for( const std::pair<const wxPoint, int>& conflict : pair.conflictPoints )
+        {
+            int actual = conflict.second;
+            std::shared_ptr<DRC_ITEM> drce;
 
-                    reportViolation( drce, conflict.first );
-                }
+            if( actual <= 0 )
+            {
+                drce = DRC_ITEM::Create( DRCE_ZONES_INTERSECT );
             }
+            else
+            {
+                drce = DRC_ITEM::Create( DRCE_CLEARANCE );
+
+                m_msg.Printf( _( "(%s clearance %s; actual %s)" ),
+                              pair.constraint.GetName(),
+                              MessageTextFromValue( userUnits(), pair.clearance ),
+                              MessageTextFromValue( userUnits(), conflict.second ) );
+
+                drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + m_msg );
+            }
+
+            drce->SetItems( zoneA, zoneB );
+            drce->SetViolatingRule( pair.constraint.GetParentRule() );
+
+            reportViolation( drce, conflict.first );
         }
     }
 }
@@ -148,7 +148,8 @@ bool DRC_TEST_PROVIDER_COURTYARD_CLEARANCE::testCourtyardClearances()
     if( !reportPhase( _( "Checking footprints for overlapping courtyards..." ) ) )
         return false;   // DRC cancelled
 
-    int ii = 0;
+    DRC_DISTANCE_CACHE& distanceCache = m_drcEngine->GetDistanceCache();
+    int                 ii = 0;
 
     for( auto itA = m_board->Footprints().begin(); itA != m_board->Footprints().end(); itA++ )
     {
@@ -201,7 +202,9 @@ bool DRC_TEST_PROVIDER_COURTYARD_CLEARANCE::testCourtyardClearances()
 
                 if( constraint.GetSeverity() != RPT_SEVERITY_IGNORE && clearance >= 0 )
                 {
-                    if( frontA.Collide( &frontB, clearance, &actual, &pos ) )
+                    if( distanceCache.Collide( { fpA, &frontA, DRC_SHAPE_TYPE::COURTYARD, F_CrtYd },
+                                               { fpB, &frontB, DRC_SHAPE_TYPE::COURTYARD, F_CrtYd },
+                                               clearance, &actual, &pos ) )
                     {
                         auto drce = DRC_ITEM::Create( DRCE_OVERLAPPING_FOOTPRINTS );
 
@@ -230,7 +233,9 @@ bool DRC_TEST_PROVIDER_COURTYARD_CLEARANCE::testCourtyardClearances()
 
                 if( constraint.GetSeverity() != RPT_SEVERITY_IGNORE && clearance >= 0 )
                 {
-                    if( backA.Collide( &backB, clearance, &actual, &pos ) )
+                    if( distanceCache.Collide( { fpA, &backA, DRC_SHAPE_TYPE::COURTYARD, B_CrtYd },
+                                               { fpB, &backB, DRC_SHAPE_TYPE::COURTYARD, B_CrtYd },
+                                               clearance, &actual, &pos ) )
                     {
                         auto drce = DRC_ITEM::Create( DRCE_OVERLAPPING_FOOTPRINTS );
 
@@ -270,8 +275,18 @@ bool DRC_TEST_PROVIDER_COURTYARD_CLEARANCE::testCourtyardClearances()
                         const SHAPE_POLY_SET& front = footprint->GetPolyCourtyard( F_CrtYd );
                         const SHAPE_POLY_SET& back = footprint->GetPolyCourtyard( B_CrtYd );
 
-                        if( ( front.OutlineCount() > 0 && front.Collide( hole, 0 ) )
-                            || ( back.OutlineCount() > 0 && back.Collide( hole, 0 ) ) )
+                        auto collides =
+                                [&]( const SHAPE_POLY_SET& aCourtyard, PCB_LAYER_ID aLayer )
+                                {
+                                    return aCourtyard.OutlineCount() > 0
+                                           && distanceCache.Collide(
+                                                   { footprint, &aCourtyard,
+                                                     DRC_SHAPE_TYPE::COURTYARD, aLayer },
+                                                   { pad, hole, DRC_SHAPE_TYPE::HOLE, aLayer },
+                                                   0, nullptr, nullptr );
+                                };
+
+                        if( collides( front, F_CrtYd ) || collides( back, B_CrtYd ) )
                         {
                             std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( errorCode );
                             drce->SetItems( pad, footprint );
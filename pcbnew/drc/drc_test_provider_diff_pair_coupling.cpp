@@ -27,12 +27,11 @@
 #include <drc/drc_rule.h>
 #include <drc/drc_test_provider.h>
 #include <drc/drc_length_report.h>
+#include <drc/drc_net_topology.h>
 #include <drc/drc_rtree.h>
 
 #include <geometry/shape_segment.h>
 
-#include <connectivity/connectivity_data.h>
-#include <connectivity/from_to_cache.h>
 
 #include <view/view_overlay.h>
 
@@ -178,6 +177,27 @@ struct DIFF_PAIR_ITEMS
     int totalLengthP;
 };
 
+/**
+ * @return the length of the tracks and arcs of \a aItems, all on \a aNetCode.
+ */
+static int routedLength( const DRC_NET_TOPOLOGY& aTopology, int aNetCode,
+                         const std::set<BOARD_CONNECTED_ITEM*>& aItems )
+{
+    std::vector<BOARD_CONNECTED_ITEM*> others;
+
+    // fixme: include vias
+    double length = aTopology.Sum( aNetCode, aItems, &others ).trackLength;
+
+    for( BOARD_CONNECTED_ITEM* item : others )
+    {
+        if( item->Type() == PCB_TRACE_T || item->Type() == PCB_ARC_T )
+            length += static_cast<PCB_TRACK*>( item )->GetLength();
+    }
+
+    return KiROUND( length );
+}
+
+
 static void extractDiffPairCoupledItems( DIFF_PAIR_ITEMS& aDp, DRC_RTREE& aTree )
 {
     for( BOARD_CONNECTED_ITEM* itemP : aDp.itemsP )
@@ -311,7 +331,8 @@ bool test::DRC_TEST_PROVIDER_DIFF_PAIR_COUPLING::Run()
                 return true;
             };
 
-    m_board->GetConnectivity()->GetFromToCache()->Rebuild( m_board );
+    // Also rebuilds the from-to cache used by the rule conditions
+    const DRC_NET_TOPOLOGY& topology = m_drcEngine->GetNetTopology();
 
     forEachGeometryItem( { PCB_TRACE_T, PCB_VIA_T, PCB_ARC_T }, LSET::AllCuMask(),
                          evaluateDpConstraints );
@@ -336,6 +357,8 @@ bool test::DRC_TEST_PROVIDER_DIFF_PAIR_COUPLING::Run()
     forEachGeometryItem( { PCB_TRACE_T, PCB_VIA_T, PCB_PAD_T, PCB_ZONE_T, PCB_ARC_T },
                          LSET::AllCuMask(), addToTree );
 
+    copperTree.Build();
+
 
     reportAux( wxString::Format( _("DPs evaluated:") ) );
 
@@ -366,19 +389,8 @@ bool test::DRC_TEST_PROVIDER_DIFF_PAIR_COUPLING::Run()
         OPT<DRC_CONSTRAINT> maxUncoupledConstraint =
                 it.first.parentRule->FindConstraint( DIFF_PAIR_MAX_UNCOUPLED_CONSTRAINT );
 
-        for( BOARD_CONNECTED_ITEM* item : it.second.itemsN )
-        {
-            // fixme: include vias
-            if( PCB_TRACK* track = dyn_cast<PCB_TRACK*>( item ) )
-                it.second.totalLengthN += track->GetLength();
-        }
-
-        for( BOARD_CONNECTED_ITEM* item : it.second.itemsP )
-        {
-            // fixme: include vias
-            if( PCB_TRACK* track = dyn_cast<PCB_TRACK*>( item ) )
-                it.second.totalLengthP += track->GetLength();
-        }
+        it.second.totalLengthN = routedLength( topology, it.first.netN, it.second.itemsN );
+        it.second.totalLengthP = routedLength( topology, it.first.netP, it.second.itemsP );
 
         for( auto& cpair : it.second.coupled )
         {
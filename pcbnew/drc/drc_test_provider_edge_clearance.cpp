@@ -68,9 +68,18 @@ public:
         return "Tests items vs board edge clearance";
     }
 
+    virtual std::set<int> GetRegionErrorCodes() const override
+    {
+        return { DRCE_EDGE_CLEARANCE, DRCE_SILK_CLEARANCE };
+    }
+
 private:
     bool testAgainstEdge( BOARD_ITEM* item, SHAPE* itemShape, BOARD_ITEM* other,
                           DRC_CONSTRAINT_T aConstraintType, PCB_DRC_CODE aErrorCode );
+
+    ///< Index of each edge among the edges cloned from the same outline item, which share
+    ///< its KIID and geometry revision
+    std::map<BOARD_ITEM*, int> m_edgeIndices;
 };
 
 
@@ -88,7 +97,14 @@ bool DRC_TEST_PROVIDER_EDGE_CLEARANCE::testAgainstEdge( BOARD_ITEM* item, SHAPE*
 
     if( constraint.GetSeverity() != RPT_SEVERITY_IGNORE && minClearance >= 0 )
     {
-        if( itemShape->Collide( edgeShape.get(), minClearance, &actual, &pos ) )
+        // The item's shape is fetched for no layer in particular, and the edge's for Edge_Cuts
+        DRC_ITEM_SHAPE itemKey = { item, itemShape, DRC_SHAPE_TYPE::EFFECTIVE_SHAPE,
+                                   UNDEFINED_LAYER };
+        DRC_ITEM_SHAPE edgeKey = { edge, edgeShape.get(), DRC_SHAPE_TYPE::EFFECTIVE_SHAPE,
+                                   Edge_Cuts, m_edgeIndices[ edge ] };
+
+        if( m_drcEngine->GetDistanceCache().Collide( itemKey, edgeKey, minClearance, &actual,
+                                                     &pos ) )
         {
             std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( aErrorCode );
 
@@ -209,8 +225,14 @@ bool DRC_TEST_PROVIDER_EDGE_CLEARANCE::Run()
                          queryBoardOutlineItems );
     forEachGeometryItem( s_allBasicItemsButZones, LSET::AllLayersMask(), queryBoardGeometryItems );
 
+    std::map<KIID, int> edgeCounts;
+
+    m_edgeIndices.clear();
+
     for( const std::unique_ptr<PCB_SHAPE>& edge : edges )
     {
+        m_edgeIndices[ edge.get() ] = edgeCounts[ edge->m_Uuid ]++;
+
         for( PCB_LAYER_ID layer : { Edge_Cuts, Margin } )
         {
             if( edge->IsOnLayer( layer ) )
@@ -218,6 +240,8 @@ bool DRC_TEST_PROVIDER_EDGE_CLEARANCE::Run()
         }
     }
 
+    edgesTree.Build();
+
     wxString val;
     wxGetEnv( "WXTRACE", &val );
 
@@ -276,6 +300,8 @@ bool DRC_TEST_PROVIDER_EDGE_CLEARANCE::Run()
         }
     }
 
+    m_edgeIndices.clear();
+
     reportRuleStatistics();
 
     return true;
@@ -66,6 +66,11 @@ public:
         return "Tests hole to hole spacing";
     }
 
+    virtual std::set<int> GetRegionErrorCodes() const override
+    {
+        return { DRCE_DRILLED_HOLES_TOO_CLOSE, DRCE_DRILLED_HOLES_COLOCATED };
+    }
+
 private:
     bool testHoleAgainstHole( BOARD_ITEM* aItem, SHAPE_CIRCLE* aHole, BOARD_ITEM* aOther );
 
@@ -168,6 +173,8 @@ bool DRC_TEST_PROVIDER_HOLE_TO_HOLE::Run()
 
     forEachGeometryItem( { PCB_PAD_T, PCB_VIA_T }, LSET::AllLayersMask(), addToHoleTree );
 
+    m_holeTree.Build();
+
     std::map< std::pair<BOARD_ITEM*, BOARD_ITEM*>, int> checkedPairs;
 
     for( PCB_TRACK* track : m_board->Tracks() )
@@ -181,7 +188,7 @@ bool DRC_TEST_PROVIDER_HOLE_TO_HOLE::Run()
             return false;   // DRC cancelled
 
         // We only care about mechanically drilled (ie: non-laser) holes
-        if( via->GetViaType() == VIATYPE::THROUGH )
+        if( via->GetViaType() == VIATYPE::THROUGH && m_drcEngine->IsInTestRegion( via ) )
         {
             std::shared_ptr<SHAPE_CIRCLE> holeShape = getDrilledHoleShape( via );
 
@@ -226,7 +233,8 @@ bool DRC_TEST_PROVIDER_HOLE_TO_HOLE::Run()
                 return false;   // DRC cancelled
 
             // We only care about drilled (ie: round) holes
-            if( pad->GetDrillSize().x && pad->GetDrillSize().x == pad->GetDrillSize().y )
+            if( pad->GetDrillSize().x && pad->GetDrillSize().x == pad->GetDrillSize().y
+                    && m_drcEngine->IsInTestRegion( pad ) )
             {
                 std::shared_ptr<SHAPE_CIRCLE> holeShape = getDrilledHoleShape( pad );
 
@@ -293,16 +301,17 @@ bool DRC_TEST_PROVIDER_HOLE_TO_HOLE::testHoleAgainstHole( BOARD_ITEM* aItem, SHA
     }
     else if( reportHole2Hole )
     {
-        int actual = ( aHole->GetCenter() - otherHole->GetCenter() ).EuclideanNorm();
-        actual = std::max( 0, actual - aHole->GetRadius() - otherHole->GetRadius() );
-
         auto constraint = m_drcEngine->EvalRules( HOLE_TO_HOLE_CONSTRAINT, aItem, aOther,
                                                   UNDEFINED_LAYER /* holes pierce all layers */ );
         int  minClearance = constraint.GetValue().Min() - epsilon;
+        int  actual = 0;
 
+        // Holes pierce all layers, so their results are stored on UNDEFINED_LAYER
         if( constraint.GetSeverity() != RPT_SEVERITY_IGNORE
-                && minClearance >= 0
-                && actual < minClearance )
+                && minClearance > 0
+                && m_drcEngine->GetDistanceCache().Collide(
+                        aItem, aHole, DRC_SHAPE_TYPE::HOLE, aOther, otherHole.get(),
+                        DRC_SHAPE_TYPE::HOLE, UNDEFINED_LAYER, minClearance, &actual, nullptr ) )
         {
             std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_DRILLED_HOLES_TOO_CLOSE );
 
@@ -27,6 +27,7 @@
 #include <drc/drc_rule.h>
 #include <drc/drc_test_provider.h>
 #include <drc/drc_length_report.h>
+#include <drc/drc_net_topology.h>
 
 #include <connectivity/connectivity_data.h>
 #include <connectivity/from_to_cache.h>
@@ -249,9 +250,9 @@ bool DRC_TEST_PROVIDER_MATCHED_LENGTH::runInternal( bool aDelayReportMode )
                 return true;
             };
 
-    auto ftCache = m_board->GetConnectivity()->GetFromToCache();
-
-    ftCache->Rebuild( m_board );
+    // Also rebuilds the from-to cache used by the rule conditions
+    const DRC_NET_TOPOLOGY& topology = m_drcEngine->GetNetTopology();
+    auto                    ftCache = m_board->GetConnectivity()->GetFromToCache();
 
     forEachGeometryItem( { PCB_TRACE_T, PCB_VIA_T, PCB_ARC_T }, LSET::AllCuMask(),
                          evaluateLengthConstraints );
@@ -280,14 +281,30 @@ bool DRC_TEST_PROVIDER_MATCHED_LENGTH::runInternal( bool aDelayReportMode )
             ent.fromItem = nullptr;
             ent.toItem = nullptr;
 
+            // Tracks, arcs and vias are added up from the cumulative lengths of their chains,
+            // a run of consecutive items at a time
+            std::vector<BOARD_CONNECTED_ITEM*> others;
+            DRC_NET_TOPOLOGY::TOTALS           totals = topology.Sum( nitem.first, nitem.second,
+                                                                      &others );
+
+            ent.viaCount = totals.viaCount;
+            ent.totalRoute = KiROUND( totals.trackLength );
+
             for( BOARD_CONNECTED_ITEM* citem : nitem.second )
             {
                 if( citem->Type() == PCB_VIA_T )
                 {
-                    ent.viaCount++;
                     ent.totalVia += computeViaThruLength( static_cast<PCB_VIA*>( citem ),
                                                           nitem.second );
                 }
+            }
+
+            for( BOARD_CONNECTED_ITEM* citem : others )
+            {
+                if( citem->Type() == PCB_VIA_T )
+                {
+                    ent.viaCount++;
+                }
                 else if( citem->Type() == PCB_TRACE_T )
                 {
                     ent.totalRoute += static_cast<PCB_TRACK*>( citem )->GetLength();
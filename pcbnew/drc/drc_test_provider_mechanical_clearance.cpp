@@ -50,7 +50,8 @@ class DRC_TEST_PROVIDER_MECHANICAL_CLEARANCE : public DRC_TEST_PROVIDER_CLEARANC
 {
 public:
     DRC_TEST_PROVIDER_MECHANICAL_CLEARANCE () :
-            DRC_TEST_PROVIDER_CLEARANCE_BASE()
+            DRC_TEST_PROVIDER_CLEARANCE_BASE(),
+            m_itemTree( nullptr )
     {
     }
 
@@ -70,6 +71,11 @@ public:
         return "Tests item clearances irrespective of nets";
     }
 
+    virtual std::set<int> GetRegionErrorCodes() const override
+    {
+        return { DRCE_CLEARANCE, DRCE_HOLE_CLEARANCE };
+    }
+
 private:
     bool testItemAgainstItem( BOARD_ITEM* item, SHAPE* itemShape, PCB_LAYER_ID layer,
                               BOARD_ITEM* other );
@@ -82,7 +88,7 @@ private:
     void testZoneLayer( ZONE* aZone, PCB_LAYER_ID aLayer, DRC_CONSTRAINT& aConstraint );
 
 private:
-    DRC_RTREE                m_itemTree;
+    DRC_RTREE*               m_itemTree;     ///< shared with other providers; owned by the engine
     std::vector<BOARD_ITEM*> m_items;
     std::vector<ZONE*>       m_zones;
 };
@@ -91,7 +97,7 @@ private:
 bool DRC_TEST_PROVIDER_MECHANICAL_CLEARANCE::Run()
 {
     m_board = m_drcEngine->GetBoard();
-    m_itemTree.clear();
+    m_itemTree = nullptr;
     m_zones.clear();
     m_items.clear();
 
@@ -114,7 +120,9 @@ bool DRC_TEST_PROVIDER_MECHANICAL_CLEARANCE::Run()
     {
         if( !zone->GetIsRuleArea() )
         {
-            m_zones.push_back( zone );
+            if( m_drcEngine->IsInTestRegion( zone ) )
+                m_zones.push_back( zone );
+
             m_largestClearance = std::max( m_largestClearance, zone->GetLocalClearance() );
         }
     }
@@ -128,7 +136,9 @@ bool DRC_TEST_PROVIDER_MECHANICAL_CLEARANCE::Run()
         {
             if( !zone->GetIsRuleArea() )
             {
-                m_zones.push_back( zone );
+                if( m_drcEngine->IsInTestRegion( zone ) )
+                    m_zones.push_back( zone );
+
                 m_largestClearance = std::max( m_largestClearance, zone->GetLocalClearance() );
             }
         }
@@ -141,38 +151,6 @@ bool DRC_TEST_PROVIDER_MECHANICAL_CLEARANCE::Run()
     size_t count = 0;
     size_t ii = 0;
 
-    auto countItems =
-            [&]( BOARD_ITEM* item ) -> bool
-            {
-                ++count;
-                return true;
-            };
-
-    auto addToItemTree =
-            [&]( BOARD_ITEM* item ) -> bool
-            {
-                if( !reportProgress( ii++, count, delta ) )
-                    return false;
-
-                m_items.push_back( item );
-
-                LSET layers = item->GetLayerSet();
-
-                // Special-case pad holes which pierce all the copper layers
-                if( item->Type() == PCB_PAD_T )
-                {
-                    PAD* pad = static_cast<PAD*>( item );
-
-                    if( pad->GetDrillSizeX() > 0 && pad->GetDrillSizeY() > 0 )
-                        layers |= LSET::AllCuMask();
-                }
-
-                for( PCB_LAYER_ID layer : layers.Seq() )
-                    m_itemTree.Insert( item, layer, m_largestClearance );
-
-                return true;
-            };
-
     if( !reportPhase( _( "Gathering items..." ) ) )
         return false;   // DRC cancelled
 
@@ -181,8 +159,14 @@ bool DRC_TEST_PROVIDER_MECHANICAL_CLEARANCE::Run()
         PCB_TEXT_T, PCB_FP_TEXT_T, PCB_DIMENSION_T
     };
 
-    forEachGeometryItem( itemTypes, LSET::AllLayersMask(), countItems );
-    forEachGeometryItem( itemTypes, LSET::AllLayersMask(), addToItemTree );
+    m_itemTree = getSharedIndex( itemTypes, LSET::AllLayersMask() );
+
+    forEachGeometryItem( itemTypes, LSET::AllLayersMask(),
+            [&]( BOARD_ITEM* item ) -> bool
+            {
+                m_items.push_back( item );
+                return true;
+            } );
 
     std::map< std::pair<BOARD_ITEM*, BOARD_ITEM*>, int> checkedPairs;
 
@@ -191,7 +175,7 @@ bool DRC_TEST_PROVIDER_MECHANICAL_CLEARANCE::Run()
             {
                 std::shared_ptr<SHAPE> itemShape = item->GetEffectiveShape( layer );
 
-                m_itemTree.QueryColliding( item, layer, layer,
+                m_itemTree->QueryColliding( item, layer, layer,
                         // Filter:
                         [&]( BOARD_ITEM* other ) -> bool
                         {
@@ -569,6 +553,7 @@ bool DRC_TEST_PROVIDER_MECHANICAL_CLEARANCE::testItemAgainstItem( BOARD_ITEM* it
     int            actual;
     VECTOR2I       pos;
 
+    DRC_DISTANCE_CACHE&    distanceCache = m_drcEngine->GetDistanceCache();
     std::shared_ptr<SHAPE> otherShape = DRC_ENGINE::GetShape( other, layer );
 
     if( testClearance )
@@ -579,7 +564,9 @@ bool DRC_TEST_PROVIDER_MECHANICAL_CLEARANCE::testItemAgainstItem( BOARD_ITEM* it
 
     if( constraint.GetSeverity() != RPT_SEVERITY_IGNORE && clearance > 0 )
     {
-        if( itemShape->Collide( otherShape.get(), clearance, &actual, &pos ) )
+        if( distanceCache.Collide( item, itemShape, DRC_SHAPE_TYPE::EFFECTIVE_SHAPE,
+                                   other, otherShape.get(), DRC_SHAPE_TYPE::DRC_SHAPE,
+                                   layer, clearance, &actual, &pos ) )
         {
             std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_CLEARANCE );
 
@@ -643,7 +630,10 @@ bool DRC_TEST_PROVIDER_MECHANICAL_CLEARANCE::testItemAgainstItem( BOARD_ITEM* it
 
         if( constraint.GetSeverity() != RPT_SEVERITY_IGNORE && clearance > 0 )
         {
-            if( itemHoleShape && itemHoleShape->Collide( otherShape.get(), clearance, &actual, &pos ) )
+            if( itemHoleShape
+                    && distanceCache.Collide( item, itemHoleShape.get(), DRC_SHAPE_TYPE::HOLE,
+                                              other, otherShape.get(), DRC_SHAPE_TYPE::DRC_SHAPE,
+                                              layer, clearance, &actual, &pos ) )
             {
                 std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_HOLE_CLEARANCE );
 
@@ -659,7 +649,10 @@ bool DRC_TEST_PROVIDER_MECHANICAL_CLEARANCE::testItemAgainstItem( BOARD_ITEM* it
                 reportViolation( drce, (wxPoint) pos );
             }
 
-            if( otherHoleShape && otherHoleShape->Collide( itemShape, clearance, &actual, &pos ) )
+            if( otherHoleShape
+                    && distanceCache.Collide( other, otherHoleShape.get(), DRC_SHAPE_TYPE::HOLE,
+                                              item, itemShape, DRC_SHAPE_TYPE::EFFECTIVE_SHAPE,
+                                              layer, clearance, &actual, &pos ) )
             {
                 std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_HOLE_CLEARANCE );
 
@@ -216,6 +216,9 @@ void DRC_TEST_PROVIDER_SOLDER_MASK::buildRTrees()
     m_tesselatedTree->Insert( solderMask, F_Mask );
     m_tesselatedTree->Insert( solderMask, B_Mask );
 
+    m_tesselatedTree->Build();
+    m_itemTree->Build();
+
     m_checkedPairs.clear();
 }
 
@@ -371,7 +374,13 @@ void DRC_TEST_PROVIDER_SOLDER_MASK::testItemAgainstItems( BOARD_ITEM* aItem,
                 else if( otherVia )
                     clearance += otherVia->GetSolderMaskExpansion();
 
-                if( itemShape->Collide( otherShape.get(), clearance, &actual, &pos ) )
+                DRC_ITEM_SHAPE itemKey = { aItem, itemShape.get(),
+                                           DRC_SHAPE_TYPE::EFFECTIVE_SHAPE, aRefLayer };
+                DRC_ITEM_SHAPE otherKey = { other, otherShape.get(),
+                                            DRC_SHAPE_TYPE::EFFECTIVE_SHAPE, aTargetLayer };
+
+                if( m_drcEngine->GetDistanceCache().Collide( itemKey, otherKey, clearance,
+                                                             &actual, &pos ) )
                 {
                     auto drce = DRC_ITEM::Create( DRCE_SOLDERMASK_BRIDGE );
 
@@ -0,0 +1,175 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef ITEM_PAIR_CACHE_H
+#define ITEM_PAIR_CACHE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+class BOARD_ITEM;
+
+
+/**
+ * A memo of a boolean predicate over pairs of board items (such as "is B inside rule area A"),
+ * safe to use from several threads at once.
+ *
+ * Results are stored in independently locked shards, and each thread also keeps a small
+ * direct-mapped table of the results it used last, which it reads without locking.  Both
+ * are tagged with a generation number: Invalidate() moves the cache to a new generation, which
+ * makes every older result, including those in the per-thread tables, unreachable.
+ *
+ * Generations are unique across all caches, so per-thread entries can't be confused with
+ * those of a cache which used to live at the same address.
+ */
+class ITEM_PAIR_CACHE
+{
+public:
+    ITEM_PAIR_CACHE() :
+            m_generation( newGeneration() )
+    {}
+
+    /**
+     * @return the cached result for ( \a a, \a b ), calling \a aCompute for it (without holding
+     *         any lock) if there is none.
+     */
+    template <typename FUNC>
+    bool Get( const BOARD_ITEM* a, const BOARD_ITEM* b, FUNC&& aCompute )
+    {
+        uint64_t      generation = m_generation.load( std::memory_order_acquire );
+        LOCAL_ENTRY&  local = localEntry( a, b );
+
+        if( local.cache == this && local.a == a && local.b == b && local.generation == generation )
+            return local.result;
+
+        KEY    key = { a, b };
+        SHARD& shard = m_shards[ KEY_HASH()( key ) % SHARD_COUNT ];
+        bool   result;
+
+        {
+            std::lock_guard<std::mutex> lock( shard.mutex );
+            auto                        it = shard.results.find( key );
+
+            if( it != shard.results.end() && it->second.generation == generation )
+            {
+                local = { this, a, b, generation, it->second.result };
+                return it->second.result;
+            }
+        }
+
+        result = aCompute();
+
+        {
+            std::lock_guard<std::mutex> lock( shard.mutex );
+
+            // Drop results computed from a board state which has been invalidated meanwhile
+            if( m_generation.load( std::memory_order_acquire ) == generation )
+                shard.results[ key ] = { generation, result };
+        }
+
+        local = { this, a, b, generation, result };
+        return result;
+    }
+
+    /**
+     * Forget all results.  Must be called whenever the items or their geometry may have
+     * changed, and in particular before an item address can be reused for another item.
+     */
+    void Invalidate()
+    {
+        m_generation.store( newGeneration(), std::memory_order_release );
+
+        for( SHARD& shard : m_shards )
+        {
+            std::lock_guard<std::mutex> lock( shard.mutex );
+            shard.results.clear();
+        }
+    }
+
+private:
+    struct KEY
+    {
+        const BOARD_ITEM* a;
+        const BOARD_ITEM* b;
+
+        bool operator==( const KEY& aOther ) const { return a == aOther.a && b == aOther.b; }
+    };
+
+    struct KEY_HASH
+    {
+        size_t operator()( const KEY& aKey ) const
+        {
+            size_t h = std::hash<const void*>()( aKey.a );
+            size_t g = std::hash<const void*>()( aKey.b );
+
+            return h ^ ( g + 0x9e3779b9 + ( h << 6 ) + ( h >> 2 ) );
+        }
+    };
+
+    struct RESULT
+    {
+        uint64_t generation;
+        bool     result;
+    };
+
+    struct SHARD
+    {
+        std::mutex                                mutex;
+        std::unordered_map<KEY, RESULT, KEY_HASH> results;
+    };
+
+    struct LOCAL_ENTRY
+    {
+        const ITEM_PAIR_CACHE* cache;
+        const BOARD_ITEM*      a;
+        const BOARD_ITEM*      b;
+        uint64_t               generation;
+        bool                   result;
+    };
+
+    static constexpr size_t SHARD_COUNT = 32;
+    static constexpr size_t LOCAL_SIZE = 256;     // power of 2
+
+    LOCAL_ENTRY& localEntry( const BOARD_ITEM* a, const BOARD_ITEM* b ) const
+    {
+        thread_local std::array<LOCAL_ENTRY, LOCAL_SIZE> entries{};
+
+        size_t h = KEY_HASH()( { a, b } ) ^ std::hash<const void*>()( this );
+        return entries[ ( h ^ ( h >> 16 ) ) & ( LOCAL_SIZE - 1 ) ];
+    }
+
+    static uint64_t newGeneration()
+    {
+        static std::atomic<uint64_t> s_next( 1 );
+        return s_next.fetch_add( 1, std::memory_order_relaxed );
+    }
+
+    std::atomic<uint64_t>           m_generation;
+    std::array<SHARD, SHARD_COUNT>  m_shards;
+};
+
+#endif // ITEM_PAIR_CACHE_H
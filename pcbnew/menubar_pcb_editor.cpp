@@ -360,6 +360,7 @@ void PCB_EDIT_FRAME::ReCreateMenuBar()
     routeMenu->AppendSeparator();
     routeMenu->Add( PCB_ACTIONS::routeSingleTrack );
     routeMenu->Add( PCB_ACTIONS::routeDiffPair );
+    routeMenu->Add( PCB_ACTIONS::routeBus );
 
     routeMenu->AppendSeparator();
     routeMenu->Add( PCB_ACTIONS::routerTuneSingleTrace );
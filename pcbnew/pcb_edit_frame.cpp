@@ -789,6 +789,7 @@ void PCB_EDIT_FRAME::setupUIConditions()
     CURRENT_EDIT_TOOL( PCB_ACTIONS::placeFootprint );
     CURRENT_EDIT_TOOL( PCB_ACTIONS::routeSingleTrack);
     CURRENT_EDIT_TOOL( PCB_ACTIONS::routeDiffPair );
+    CURRENT_EDIT_TOOL( PCB_ACTIONS::routeBus );
     CURRENT_EDIT_TOOL( PCB_ACTIONS::routerTuneDiffPair );
     CURRENT_EDIT_TOOL( PCB_ACTIONS::routerTuneDiffPairSkew );
     CURRENT_EDIT_TOOL( PCB_ACTIONS::routerTuneSingleTrace );
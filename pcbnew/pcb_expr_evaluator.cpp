@@ -222,11 +222,8 @@ bool isInsideCourtyard( BOARD_ITEM* aItem, const EDA_RECT& aItemBBox,
     if( !aFootprint )
         return false;
 
-    BOARD*                              board = aItem->GetBoard();
-    std::unique_lock<std::mutex>        cacheLock( board->m_CachesMutex );
-    std::pair<BOARD_ITEM*, BOARD_ITEM*> key( aFootprint, aItem );
-
-    std::map< std::pair<BOARD_ITEM*, BOARD_ITEM*>, bool >* cache;
+    BOARD*           board = aItem->GetBoard();
+    ITEM_PAIR_CACHE* cache;
 
     switch( aSide )
     {
@@ -235,15 +232,12 @@ bool isInsideCourtyard( BOARD_ITEM* aItem, const EDA_RECT& aItemBBox,
     default:   cache = &board->m_InsideCourtyardCache;  break;
     }
 
-    auto i = cache->find( key );
-
-    if( i != cache->end() )
-        return i->second;
-
-    bool res = calcIsInsideCourtyard( aItem, aItemBBox, aItemShape, aCtx, aFootprint, aSide );
-
-    (*cache)[ key ] = res;
-    return res;
+    return cache->Get( aFootprint, aItem,
+                       [&]()
+                       {
+                           return calcIsInsideCourtyard( aItem, aItemBBox, aItemShape, aCtx,
+                                                         aFootprint, aSide );
+                       } );
 };
 
 
@@ -547,19 +541,24 @@ bool calcIsInsideArea( BOARD_ITEM* aItem, const EDA_RECT& aItemBBox, PCB_EXPR_CO
         if( !zone->IsFilled() )
             return false;
 
-        DRC_RTREE* zoneRTree = board->m_CopperZoneRTrees[ zone ].get();
-
-        std::vector<SHAPE*> shapes;
+        auto       it = board->m_CopperZoneRTrees.find( zone );
+        DRC_RTREE* zoneRTree = it != board->m_CopperZoneRTrees.end() ? it->second.get() : nullptr;
 
-        if( zoneRTree )
+        for( PCB_LAYER_ID layer : aArea->GetLayerSet().Seq() )
         {
-            for( PCB_LAYER_ID layer : aArea->GetLayerSet().Seq() )
+            if( aCtx->GetLayer() == layer || aCtx->GetLayer() == UNDEFINED_LAYER )
             {
-                if( aCtx->GetLayer() == layer || aCtx->GetLayer() == UNDEFINED_LAYER )
+                if( zoneRTree )
                 {
                     if( zoneRTree->QueryColliding( aItemBBox, &areaOutline, layer ) )
                         return true;
                 }
+                else if( zone->IsOnLayer( layer ) )
+                {
+                    // Zones outside the region of an incremental DRC run have no tree
+                    if( zone->GetFilledPolysList( layer ).Collide( &areaOutline ) )
+                        return true;
+                }
             }
         }
 
@@ -585,18 +584,14 @@ bool isInsideArea( BOARD_ITEM* aItem, const EDA_RECT& aItemBBox, PCB_EXPR_CONTEX
     if( !aArea || aArea == aItem || aArea->GetParent() == aItem )
         return false;
 
-    BOARD*                              board = aArea->GetBoard();
-    std::unique_lock<std::mutex>        cacheLock( board->m_CachesMutex );
-    std::pair<BOARD_ITEM*, BOARD_ITEM*> key( aArea, aItem );
-    auto                                i = board->m_InsideAreaCache.find( key );
-
-    if( i != board->m_InsideAreaCache.end() )
-        return i->second;
+    BOARD* board = aArea->GetBoard();
 
-    bool isInside = calcIsInsideArea( aItem, aItemBBox, aCtx, aArea );
-
-    board->m_InsideAreaCache[ key ] = isInside;
-    return isInside;
+    return board->m_InsideAreaCache.Get( aArea, aItem,
+                                         [&]()
+                                         {
+                                             return calcIsInsideArea( aItem, aItemBBox, aCtx,
+                                                                      aArea );
+                                         } );
 }
 
 
@@ -1044,6 +1039,38 @@ LIBEVAL::VALUE PCB_EXPR_NETCLASS_REF::GetValue( LIBEVAL::CONTEXT* aCtx )
 }
 
 
+void PCB_EXPR_NETCLASS_REF::FetchValue( LIBEVAL::CONTEXT* aCtx, LIBEVAL::VALUE& aResult )
+{
+    static const wxString defaultName( NETCLASS::Default );
+    static const wxString noName;
+
+    BOARD_ITEM* item = GetObject( aCtx );
+
+    if( !item || !item->IsConnected() )
+    {
+        aResult.Clear();
+        return;
+    }
+
+    // Zones override GetNetClassName() for rule areas
+    if( item->Type() == PCB_ZONE_T || item->Type() == PCB_FP_ZONE_T )
+    {
+        aResult.Set( GetValue( aCtx ) );
+        return;
+    }
+
+    // Same as GetNetClassName(), but assigned from the netclass's own string rather than
+    // through a copy
+    NETINFO_ITEM* net = static_cast<BOARD_CONNECTED_ITEM*>( item )->GetNet();
+    NETCLASS*     netclass = net ? net->GetNetClass() : nullptr;
+
+    if( netclass )
+        aResult.Set( netclass->GetName() );
+    else
+        aResult.Set( net ? defaultName : noName );
+}
+
+
 LIBEVAL::VALUE PCB_EXPR_NETNAME_REF::GetValue( LIBEVAL::CONTEXT* aCtx )
 {
     BOARD_ITEM* item = GetObject( aCtx );
@@ -1058,6 +1085,24 @@ LIBEVAL::VALUE PCB_EXPR_NETNAME_REF::GetValue( LIBEVAL::CONTEXT* aCtx )
 }
 
 
+void PCB_EXPR_NETNAME_REF::FetchValue( LIBEVAL::CONTEXT* aCtx, LIBEVAL::VALUE& aResult )
+{
+    static const wxString noName;
+
+    BOARD_ITEM* item = GetObject( aCtx );
+
+    if( !item || !item->IsConnected() )
+    {
+        aResult.Clear();
+        return;
+    }
+
+    NETINFO_ITEM* net = static_cast<BOARD_CONNECTED_ITEM*>( item )->GetNet();
+
+    aResult.Set( net ? net->GetNetname() : noName );
+}
+
+
 LIBEVAL::VALUE PCB_EXPR_TYPE_REF::GetValue( LIBEVAL::CONTEXT* aCtx )
 {
     BOARD_ITEM* item = GetObject( aCtx );
@@ -1069,6 +1114,17 @@ LIBEVAL::VALUE PCB_EXPR_TYPE_REF::GetValue( LIBEVAL::CONTEXT* aCtx )
 }
 
 
+void PCB_EXPR_TYPE_REF::FetchValue( LIBEVAL::CONTEXT* aCtx, LIBEVAL::VALUE& aResult )
+{
+    BOARD_ITEM* item = GetObject( aCtx );
+
+    if( !item )
+        aResult.Clear();
+    else
+        aResult.Set( ENUM_MAP<KICAD_T>::Instance().ToString( item->Type() ) );
+}
+
+
 LIBEVAL::FUNC_CALL_REF PCB_EXPR_UCODE::CreateFuncCall( const wxString& aName )
 {
     PCB_EXPR_BUILTIN_FUNCTIONS& registry = PCB_EXPR_BUILTIN_FUNCTIONS::Instance();
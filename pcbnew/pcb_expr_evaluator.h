@@ -131,6 +131,7 @@ public:
     }
 
     LIBEVAL::VALUE GetValue( LIBEVAL::CONTEXT* aCtx ) override;
+    void FetchValue( LIBEVAL::CONTEXT* aCtx, LIBEVAL::VALUE& aResult ) override;
 };
 
 
@@ -146,6 +147,7 @@ public:
     }
 
     LIBEVAL::VALUE GetValue( LIBEVAL::CONTEXT* aCtx ) override;
+    void FetchValue( LIBEVAL::CONTEXT* aCtx, LIBEVAL::VALUE& aResult ) override;
 };
 
 
@@ -160,6 +162,7 @@ public:
     }
 
     LIBEVAL::VALUE GetValue( LIBEVAL::CONTEXT* aCtx ) override;
+    void FetchValue( LIBEVAL::CONTEXT* aCtx, LIBEVAL::VALUE& aResult ) override;
 };
 
 
@@ -40,6 +40,7 @@
 #include <cstdlib>
 #include <drc/drc_engine.h>
 #include <drc/drc_item.h>
+#include <drc/drc_report_stream.h>
 #include <fp_lib_table.h>
 #include <ignore.h>
 #include <io_mgr.h>
@@ -52,6 +53,7 @@
 #include <settings/settings_manager.h>
 #include <specctra.h>
 #include <project/project_local_settings.h>
+#include <router/pns_autorouter.h>
 #include <wildcards_and_files_ext.h>
 #include <locale_io.h>
 #include <wx/app.h>
@@ -439,11 +441,12 @@ bool IsActionRunning()
 }
 
 
-bool WriteDRCReport( BOARD* aBoard, const wxString& aFileName, EDA_UNITS aUnits,
-                     bool aReportAllTrackErrors )
+/**
+ * @return the board's DRC engine, initialized with the project rules, or nullptr if the rules
+ *         can't be loaded.
+ */
+static std::shared_ptr<DRC_ENGINE> initDRCEngine( BOARD* aBoard )
 {
-    wxCHECK( aBoard, false );
-
     BOARD_DESIGN_SETTINGS& bds = aBoard->GetDesignSettings();
     std::shared_ptr<DRC_ENGINE> engine = bds.m_DRCEngine;
 
@@ -453,7 +456,7 @@ bool WriteDRCReport( BOARD* aBoard, const wxString& aFileName, EDA_UNITS aUnits,
         engine = bds.m_DRCEngine;
     }
 
-    wxCHECK( engine, false );
+    wxCHECK( engine, nullptr );
 
     wxFileName fn = aBoard->GetFileName();
     fn.SetExt( DesignRulesFileExtension );
@@ -465,9 +468,24 @@ bool WriteDRCReport( BOARD* aBoard, const wxString& aFileName, EDA_UNITS aUnits,
     }
     catch( PARSE_ERROR& )
     {
-        return false;
+        return nullptr;
     }
 
+    return engine;
+}
+
+
+bool WriteDRCReport( BOARD* aBoard, const wxString& aFileName, EDA_UNITS aUnits,
+                     bool aReportAllTrackErrors )
+{
+    wxCHECK( aBoard, false );
+
+    BOARD_DESIGN_SETTINGS&      bds = aBoard->GetDesignSettings();
+    std::shared_ptr<DRC_ENGINE> engine = initDRCEngine( aBoard );
+
+    if( !engine )
+        return false;
+
     std::vector<std::shared_ptr<DRC_ITEM>> footprints;
     std::vector<std::shared_ptr<DRC_ITEM>> unconnected;
     std::vector<std::shared_ptr<DRC_ITEM>> violations;
@@ -542,3 +560,73 @@ bool WriteDRCReport( BOARD* aBoard, const wxString& aFileName, EDA_UNITS aUnits,
 
     return true;
 }
+
+
+int StreamDRCReport( BOARD* aBoard, const wxString& aFileName, EDA_UNITS aUnits,
+                     bool aReportAllTrackErrors )
+{
+    wxCHECK( aBoard, -1 );
+
+    std::shared_ptr<DRC_ENGINE> engine = initDRCEngine( aBoard );
+
+    if( !engine )
+        return -1;
+
+    DRC_REPORT_STREAM stream( aBoard, aUnits );
+
+    if( !stream.Open( aFileName ) )
+        return -1;
+
+    engine->SetProgressReporter( nullptr );
+
+    engine->SetViolationHandler(
+            [&]( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )
+            {
+                stream.Report( aItem, aPos );
+            } );
+
+    engine->RunTests( aUnits, aReportAllTrackErrors, false );
+    engine->ClearViolationHandler();
+
+    int count = stream.GetCount();
+
+    return stream.Close() ? count : -1;
+}
+
+
+wxString ProfileDRC( BOARD* aBoard, bool aReportAllTrackErrors )
+{
+    wxCHECK( aBoard, wxEmptyString );
+
+    std::shared_ptr<DRC_ENGINE> engine = initDRCEngine( aBoard );
+
+    if( !engine )
+        return wxEmptyString;
+
+    engine->SetProgressReporter( nullptr );
+    engine->SetViolationHandler( []( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos ) {} );
+    engine->SetProfiling( true );
+
+    engine->RunTests( EDA_UNITS::MILLIMETRES, aReportAllTrackErrors, false );
+
+    engine->SetProfiling( false );
+    engine->ClearViolationHandler();
+
+    return engine->GetProfile().ToJSON();
+}
+
+
+int Autoroute( BOARD* aBoard, int aThreads, int aPasses )
+{
+    wxCHECK( aBoard, -1 );
+
+    if( !initDRCEngine( aBoard ) )
+        return -1;
+
+    PNS_AUTOROUTER autorouter( aBoard );
+
+    autorouter.SetThreadCount( aThreads );
+    autorouter.SetPassCount( aPasses );
+
+    return autorouter.Run();
+}
@@ -185,4 +185,54 @@ bool IsActionRunning();
 bool WriteDRCReport( BOARD* aBoard, const wxString& aFileName, EDA_UNITS aUnits,
                      bool aReportAllTrackErrors );
 
+/**
+ * Run the DRC check on the given board and write the violations to a JSON Lines file (one
+ * JSON object per violation) as they are found.  Unlike WriteDRCReport(), the violations are
+ * not kept in memory, so this is suited to boards with very large violation counts.
+ *
+ * Like WriteDRCReport(), this requires that the project for the board be loaded, and does not
+ * fill zones.
+ *
+ * @param aBoard is a valid loaded board.
+ * @param aFileName is the full path and name of the report file to write.
+ * @param aUnits is the units to use for the violation positions.
+ * @param aReportAllTrackErrors controls whether all errors or just the first error is reported
+ *                              for each track.
+ * @return the number of violations written, or -1 if the rules can't be loaded or the file
+ *         can't be written.
+ */
+int StreamDRCReport( BOARD* aBoard, const wxString& aFileName, EDA_UNITS aUnits,
+                     bool aReportAllTrackErrors );
+
+/**
+ * Run the DRC check on the given board and return the timings of the run: wall and CPU time
+ * and R-tree searches of each test provider, and the number of evaluations of each rule and
+ * the time spent in its expressions.
+ *
+ * Like WriteDRCReport(), this requires that the project for the board be loaded, and does not
+ * fill zones.
+ *
+ * @param aBoard is a valid loaded board.
+ * @param aReportAllTrackErrors controls whether all errors or just the first error is reported
+ *                              for each track.
+ * @return the profile as a JSON document, or an empty string if the rules can't be loaded.
+ */
+wxString ProfileDRC( BOARD* aBoard, bool aReportAllTrackErrors );
+
+/**
+ * Route the unconnected items of the given board with the push and shove router, and add the
+ * new tracks and vias to the board.  Independent areas of the board are routed in parallel,
+ * and the connections left unrouted are retried after ripping up the autorouted tracks in
+ * their way.  The board can be saved with SaveBoard() afterwards.
+ *
+ * Like WriteDRCReport(), this requires that the project for the board be loaded, as the
+ * routing follows its design rules, and does not fill zones.
+ *
+ * @param aBoard is a valid loaded board.
+ * @param aThreads is the number of threads to route with, 0 for one per core.
+ * @param aPasses is the number of rip-up and retry passes.
+ * @return the number of connections left unrouted, or -1 if the rules can't be loaded.
+ */
+int Autoroute( BOARD* aBoard, int aThreads = 0, int aPasses = 4 );
+
 #endif      // __PCBNEW_SCRIPTING_HELPERS_H
@@ -127,6 +127,7 @@ HANDLE_EXCEPTIONS(PLUGIN::FootprintDelete)
 
 HANDLE_EXCEPTIONS(LoadBoard)
 HANDLE_EXCEPTIONS(WriteDRCReport)
+HANDLE_EXCEPTIONS(StreamDRCReport)
 %include <pcbnew_scripting_helpers.h>
 
 
@@ -0,0 +1,825 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <future>
+#include <thread>
+
+#include <wx/log.h>
+
+#include <board.h>
+#include <board_design_settings.h>
+#include <connectivity/connectivity_algo.h>
+#include <connectivity/connectivity_data.h>
+#include <connectivity/connectivity_items.h>
+#include <convert_to_biu.h>
+#include <geometry/direction45.h>
+#include <math/util.h>
+#include <pcb_track.h>
+
+#include "pns_autorouter.h"
+#include "pns_kicad_iface.h"
+#include "pns_node.h"
+#include "pns_placement_algo.h"
+#include "pns_router.h"
+#include "pns_routing_settings.h"
+#include "pns_segment.h"
+#include "pns_sizes_settings.h"
+
+
+/**
+ * Router interface of the autorouter.  Instead of committing the changes of the router to the
+ * board, it keeps them aside until they are merged: the board must not change while other
+ * routers read it.
+ */
+class PNS_AUTOROUTER_IFACE : public PNS_KICAD_IFACE_BASE
+{
+public:
+    PNS_AUTOROUTER_IFACE( BOARD* aBoard, const std::set<BOARD_ITEM*>& aRoutedItems ) :
+            m_rippable( aRoutedItems )
+    {
+        SetBoard( aBoard );
+    }
+
+    ~PNS_AUTOROUTER_IFACE()
+    {
+        for( BOARD_ITEM* item : m_added )
+            delete item;
+
+        for( BOARD_ITEM* item : m_garbage )
+            delete item;
+
+        delete m_ruleResolver;
+    }
+
+    void AddItem( PNS::ITEM* aItem ) override
+    {
+        if( BOARD_CONNECTED_ITEM* newBI = createBoardItem( aItem ) )
+        {
+            aItem->SetParent( newBI );
+            m_added.push_back( newBI );
+            m_rippable.insert( newBI );
+        }
+    }
+
+    void UpdateItem( PNS::ITEM* aItem ) override
+    {
+        BOARD_ITEM* parent = aItem->Parent();
+
+        if( !parent || aItem->OfKind( PNS::ITEM::SOLID_T ) )
+            return;
+
+        if( std::find( m_added.begin(), m_added.end(), parent ) == m_added.end() )
+        {
+            // The item is on the board: replace it with an updated copy when merging
+            BOARD_ITEM* copy = static_cast<BOARD_ITEM*>( parent->Clone() );
+
+            m_removed.push_back( parent );
+            m_added.push_back( copy );
+
+            if( m_rippable.erase( parent ) )
+                m_rippable.insert( copy );
+
+            aItem->SetParent( copy );
+            parent = copy;
+        }
+
+        updateBoardItem( aItem, parent );
+    }
+
+    void RemoveItem( PNS::ITEM* aItem ) override
+    {
+        BOARD_ITEM* parent = aItem->Parent();
+
+        if( !parent || aItem->OfKind( PNS::ITEM::SOLID_T ) )
+            return;
+
+        auto it = std::find( m_added.begin(), m_added.end(), parent );
+
+        // Items of this router which never reached the board may still be referenced by the
+        // router's caches, so they are only freed with the interface
+        if( it != m_added.end() )
+        {
+            m_added.erase( it );
+            m_garbage.push_back( parent );
+        }
+        else
+        {
+            m_removed.push_back( parent );
+        }
+
+        m_rippable.erase( parent );
+    }
+
+    ///< @return true if \a aItem has been autorouted, and may be ripped up.
+    bool IsRippable( BOARD_ITEM* aItem ) const { return m_rippable.count( aItem ) > 0; }
+
+    const std::vector<BOARD_ITEM*>& Added() const { return m_added; }
+    const std::vector<BOARD_ITEM*>& Removed() const { return m_removed; }
+
+    ///< Forget the changes, once they are merged into the board.
+    void ReleaseChanges()
+    {
+        m_added.clear();
+        m_removed.clear();
+    }
+
+private:
+    std::vector<BOARD_ITEM*> m_added;       ///< new items, not on the board yet
+    std::vector<BOARD_ITEM*> m_removed;     ///< board items to remove
+    std::vector<BOARD_ITEM*> m_garbage;     ///< new items removed again
+    std::set<BOARD_ITEM*>    m_rippable;
+};
+
+
+/**
+ * @return the item of \a aWorld anchored at \a aPos: the one made from \a aParent, or the one
+ *         which replaced it if it has been shoved.
+ */
+static PNS::ITEM* findAnchor( PNS::NODE* aWorld, BOARD_CONNECTED_ITEM* aParent,
+                              const VECTOR2I& aPos, int aNet )
+{
+    if( aParent )
+    {
+        if( PNS::ITEM* item = aWorld->FindItemByParent( aParent ) )
+            return item;
+    }
+
+    std::set<PNS::ITEM*> items;
+
+    aWorld->AllItemsInNet( aNet, items, PNS::ITEM::SOLID_T | PNS::ITEM::VIA_T
+                                                | PNS::ITEM::SEGMENT_T | PNS::ITEM::ARC_T );
+
+    for( PNS::ITEM* item : items )
+    {
+        for( int i = 0; i < item->AnchorCount(); i++ )
+        {
+            if( item->Anchor( i ) == aPos )
+                return item;
+        }
+    }
+
+    return nullptr;
+}
+
+
+static void initRouter( PNS::ROUTER& aRouter, PNS::ROUTING_SETTINGS& aSettings,
+                        PNS_AUTOROUTER_IFACE* aIface )
+{
+    // Nobody waits for the result, so shoves may take all the time they need
+    aSettings.SetAnytimeShove( false );
+
+    aRouter.SetInterface( aIface );
+    aRouter.ClearWorld();
+    aRouter.SetMode( PNS::PNS_MODE_ROUTE_SINGLE );
+    aRouter.LoadSettings( &aSettings );
+}
+
+
+PNS_AUTOROUTER::PNS_AUTOROUTER( BOARD* aBoard ) :
+        m_board( aBoard ),
+        m_threadCount( 0 ),
+        m_passCount( 4 ),
+        m_maxRipUps( 3 ),
+        m_clearance( 0 ),
+        m_routedCount( 0 ),
+        m_unroutedCount( 0 )
+{
+}
+
+
+PNS_AUTOROUTER::~PNS_AUTOROUTER()
+{
+}
+
+
+int PNS_AUTOROUTER::Run()
+{
+    m_clearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
+    m_copperLayers.clear();
+
+    for( LSEQ seq = m_board->GetEnabledLayers().CuStack(); seq; ++seq )
+        m_copperLayers.push_back( *seq );
+
+    buildConnections();
+    buildRegions();
+
+    int threads = m_threadCount > 0 ? m_threadCount : (int) std::thread::hardware_concurrency();
+
+    threads = std::min<int>( threads, m_regions.size() );
+
+    std::vector<int> pending;
+
+    if( threads > 1 )
+    {
+        std::vector<WORKER> workers;
+
+        routeRegions( threads, workers );
+
+        for( WORKER& worker : workers )
+        {
+            mergeChanges( worker.iface.get() );
+            pending.insert( pending.end(), worker.deferred.begin(), worker.deferred.end() );
+        }
+
+        // connections are ordered shortest first
+        std::sort( pending.begin(), pending.end() );
+    }
+    else
+    {
+        for( int i = 0; i < (int) m_connections.size(); i++ )
+            pending.push_back( i );
+    }
+
+    if( !pending.empty() )
+    {
+        std::unique_ptr<PNS_AUTOROUTER_IFACE> iface =
+                std::make_unique<PNS_AUTOROUTER_IFACE>( m_board, m_routedItems );
+
+        {
+            PNS::ROUTING_SETTINGS settings( nullptr, "" );
+            PNS::ROUTER           router( true );
+
+            initRouter( router, settings, iface.get() );
+            router.SyncWorld();
+
+            for( int pass = 0; pass < m_passCount && !pending.empty(); pass++ )
+            {
+                std::vector<int> unrouted;
+
+                routeConnections( &router, iface.get(), pending, nullptr, unrouted );
+
+                wxLogTrace( "PNS", "autorouter pass %d: %d of %d connections left", pass,
+                            (int) unrouted.size(), (int) pending.size() );
+
+                bool progress = unrouted.size() < pending.size();
+
+                pending = std::move( unrouted );
+
+                if( !progress )
+                    break;
+            }
+        }
+
+        mergeChanges( iface.get() );
+    }
+
+    m_routedCount = 0;
+
+    for( const CONNECTION& conn : m_connections )
+    {
+        if( conn.routed )
+            m_routedCount++;
+    }
+
+    m_unroutedCount = (int) m_connections.size() - m_routedCount;
+
+    m_board->BuildConnectivity();
+
+    return m_unroutedCount;
+}
+
+
+void PNS_AUTOROUTER::buildConnections()
+{
+    std::vector<CN_EDGE> edges;
+
+    m_connections.clear();
+    m_netConnections.clear();
+
+    m_board->BuildConnectivity();
+    m_board->GetConnectivity()->GetUnconnectedEdges( edges );
+
+    for( const CN_EDGE& edge : edges )
+    {
+        BOARD_CONNECTED_ITEM* source = edge.GetSourceNode()->Parent();
+        BOARD_CONNECTED_ITEM* target = edge.GetTargetNode()->Parent();
+        bool                  routable = true;
+
+        for( BOARD_CONNECTED_ITEM* item : { source, target } )
+        {
+            switch( item->Type() )
+            {
+            case PCB_PAD_T:
+            case PCB_TRACE_T:
+            case PCB_ARC_T:
+            case PCB_VIA_T:
+                break;
+
+            default:
+                // zones are left to the zone filler
+                routable = false;
+                break;
+            }
+        }
+
+        if( !routable || source->GetNetCode() <= 0 )
+            continue;
+
+        CONNECTION conn;
+
+        conn.net = source->GetNetCode();
+        conn.start = edge.GetSourcePos();
+        conn.end = edge.GetTargetPos();
+        conn.startParent = source;
+        conn.endParent = target;
+        conn.routed = false;
+        conn.ripUps = 0;
+
+        // Leave room for a detour around the obstacles in the way
+        int margin = ( conn.end - conn.start ).EuclideanNorm() / 2 + Millimeter2iu( 1 );
+
+        conn.area = BOX2I( conn.start, conn.end - conn.start );
+        conn.area.Normalize();
+        conn.area.Inflate( margin );
+
+        m_connections.push_back( conn );
+    }
+
+    std::sort( m_connections.begin(), m_connections.end(),
+               []( const CONNECTION& aA, const CONNECTION& aB )
+               {
+                   return ( aA.end - aA.start ).SquaredEuclideanNorm()
+                          < ( aB.end - aB.start ).SquaredEuclideanNorm();
+               } );
+
+    for( int i = 0; i < (int) m_connections.size(); i++ )
+        m_netConnections[ m_connections[i].net ].push_back( i );
+}
+
+
+void PNS_AUTOROUTER::buildRegions()
+{
+    m_regions.clear();
+
+    for( int i = 0; i < (int) m_connections.size(); i++ )
+    {
+        REGION region;
+
+        region.fence = m_connections[i].area;
+        region.connections.push_back( i );
+        m_regions.push_back( region );
+    }
+
+    // Merge the regions with overlapping fences, until there are none left.  Merging grows
+    // the fences, so it may take a few sweeps.
+    bool merged = true;
+
+    while( merged )
+    {
+        merged = false;
+
+        std::sort( m_regions.begin(), m_regions.end(),
+                   []( const REGION& aA, const REGION& aB )
+                   {
+                       return aA.fence.GetLeft() < aB.fence.GetLeft();
+                   } );
+
+        std::vector<REGION> result;
+
+        for( REGION& region : m_regions )
+        {
+            REGION* overlapping = nullptr;
+
+            for( REGION& candidate : result )
+            {
+                if( candidate.fence.GetRight() >= region.fence.GetLeft()
+                        && candidate.fence.Intersects( region.fence ) )
+                {
+                    overlapping = &candidate;
+                    break;
+                }
+            }
+
+            if( overlapping )
+            {
+                overlapping->fence.Merge( region.fence );
+                overlapping->connections.insert( overlapping->connections.end(),
+                                                 region.connections.begin(),
+                                                 region.connections.end() );
+                merged = true;
+            }
+            else
+            {
+                result.push_back( std::move( region ) );
+            }
+        }
+
+        m_regions = std::move( result );
+    }
+
+    // Start with the biggest regions to balance the threads, and route the connections of
+    // each shortest first
+    for( REGION& region : m_regions )
+        std::sort( region.connections.begin(), region.connections.end() );
+
+    std::sort( m_regions.begin(), m_regions.end(),
+               []( const REGION& aA, const REGION& aB )
+               {
+                   return aA.connections.size() > aB.connections.size();
+               } );
+}
+
+
+void PNS_AUTOROUTER::routeRegions( int aThreads, std::vector<WORKER>& aWorkers )
+{
+    std::atomic<size_t>            nextRegion( 0 );
+    std::vector<std::future<void>> returns( aThreads );
+
+    aWorkers.resize( aThreads );
+
+    auto route_lambda =
+            [this, &nextRegion]( WORKER* aWorker )
+            {
+                aWorker->iface = std::make_unique<PNS_AUTOROUTER_IFACE>( m_board,
+                                                                         m_routedItems );
+
+                PNS::ROUTING_SETTINGS settings( nullptr, "" );
+                PNS::ROUTER           router( true );
+
+                initRouter( router, settings, aWorker->iface.get() );
+
+                {
+                    std::lock_guard<std::mutex> lock( m_syncMutex );
+                    router.SyncWorld();
+                }
+
+                for( size_t i = nextRegion++; i < m_regions.size(); i = nextRegion++ )
+                {
+                    routeConnections( &router, aWorker->iface.get(), m_regions[i].connections,
+                                      &m_regions[i].fence, aWorker->deferred );
+                }
+            };
+
+    for( int ii = 0; ii < aThreads; ++ii )
+        returns[ii] = std::async( std::launch::async, route_lambda, &aWorkers[ii] );
+
+    for( int ii = 0; ii < aThreads; ++ii )
+        returns[ii].wait();
+}
+
+
+void PNS_AUTOROUTER::routeConnections( PNS::ROUTER* aRouter, PNS_AUTOROUTER_IFACE* aIface,
+                                       const std::vector<int>& aConnections,
+                                       const BOX2I* aFence, std::vector<int>& aUnrouted )
+{
+    std::deque<int>  queue( aConnections.begin(), aConnections.end() );
+    std::vector<int> failed;
+
+    while( !queue.empty() )
+    {
+        int         idx = queue.front();
+        CONNECTION& conn = m_connections[idx];
+
+        queue.pop_front();
+
+        if( conn.routed )
+            continue;
+
+        if( routeConnection( aRouter, aIface, conn, aFence ) )
+        {
+            conn.routed = true;
+            continue;
+        }
+
+        // Make room by ripping up the autorouted nets in the way, and route them again
+        // afterwards
+        std::vector<int> requeued;
+
+        if( ripUpBlockers( aRouter, aIface, conn, aFence, requeued )
+                && routeConnection( aRouter, aIface, conn, aFence ) )
+        {
+            conn.routed = true;
+        }
+        else
+        {
+            failed.push_back( idx );
+        }
+
+        queue.insert( queue.end(), requeued.begin(), requeued.end() );
+    }
+
+    std::sort( failed.begin(), failed.end() );
+    failed.erase( std::unique( failed.begin(), failed.end() ), failed.end() );
+
+    for( int idx : failed )
+    {
+        if( !m_connections[idx].routed )
+            aUnrouted.push_back( idx );
+    }
+}
+
+
+bool PNS_AUTOROUTER::routeConnection( PNS::ROUTER* aRouter, PNS_AUTOROUTER_IFACE* aIface,
+                                      const CONNECTION& aConn, const BOX2I* aFence )
+{
+    PNS::NODE* world = aRouter->GetWorld();
+    PNS::ITEM* startItem = findAnchor( world, aConn.startParent, aConn.start, aConn.net );
+    PNS::ITEM* endItem = findAnchor( world, aConn.endParent, aConn.end, aConn.net );
+
+    if( !startItem || !endItem )
+        return false;
+
+    std::vector<int> startLayers;
+    std::vector<int> endLayers;
+
+    for( int layer : m_copperLayers )
+    {
+        if( startItem->Layers().Overlaps( layer ) )
+            startLayers.push_back( layer );
+
+        if( endItem->Layers().Overlaps( layer ) )
+            endLayers.push_back( layer );
+    }
+
+    // Walking around leaves the other tracks in place, so it is tried first
+    for( PNS::PNS_MODE mode : { PNS::RM_Walkaround, PNS::RM_Shove } )
+    {
+        aRouter->Settings().SetMode( mode );
+
+        for( int layer : startLayers )
+        {
+            if( endItem->Layers().Overlaps( layer )
+                    && routeOnLayers( aRouter, aIface, aConn, startItem, endItem, layer, layer,
+                                      aFence ) )
+            {
+                return true;
+            }
+        }
+    }
+
+    for( PNS::PNS_MODE mode : { PNS::RM_Walkaround, PNS::RM_Shove } )
+    {
+        aRouter->Settings().SetMode( mode );
+
+        for( int startLayer : startLayers )
+        {
+            for( int endLayer : endLayers )
+            {
+                if( startLayer != endLayer
+                        && routeOnLayers( aRouter, aIface, aConn, startItem, endItem, startLayer,
+                                          endLayer, aFence ) )
+                {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+
+bool PNS_AUTOROUTER::routeOnLayers( PNS::ROUTER* aRouter, PNS_AUTOROUTER_IFACE* aIface,
+                                    const CONNECTION& aConn, PNS::ITEM* aStartItem,
+                                    PNS::ITEM* aEndItem, int aStartLayer, int aEndLayer,
+                                    const BOX2I* aFence )
+{
+    PNS::SIZES_SETTINGS sizes;
+
+    aIface->SetStartLayer( aStartLayer );
+    aIface->ImportSizes( sizes, aStartItem, aConn.net );
+
+    if( aStartLayer != aEndLayer )
+    {
+        sizes.SetViaType( VIATYPE::THROUGH );
+        sizes.AddLayerPair( aStartLayer, aEndLayer );
+    }
+
+    aRouter->UpdateSizes( sizes );
+
+    if( !aRouter->StartRouting( aConn.start, aStartItem, aStartLayer ) )
+    {
+        aRouter->StopRouting();
+        return false;
+    }
+
+    bool ok = true;
+
+    if( aStartLayer != aEndLayer )
+    {
+        // Change layers through a via at the first of a few points along the connection
+        // the trace reaches
+        VECTOR2I delta = aConn.end - aConn.start;
+
+        ok = false;
+        aRouter->ToggleViaPlacement();
+
+        for( double t : { 0.5, 0.25, 0.75 } )
+        {
+            VECTOR2I viaPos( aConn.start.x + KiROUND( delta.x * t ),
+                             aConn.start.y + KiROUND( delta.y * t ) );
+
+            aRouter->Move( viaPos, nullptr );
+
+            if( aRouter->Placer()->CurrentEnd() == viaPos )
+            {
+                // Fixing the trace at the via continues the routing from it
+                aRouter->FixRoute( viaPos, nullptr );
+                ok = aRouter->SwitchLayer( aEndLayer );
+                break;
+            }
+        }
+    }
+
+    if( ok )
+    {
+        aRouter->Move( aConn.end, aEndItem );
+
+        ok = aRouter->Placer()->CurrentEnd() == aConn.end
+                && aRouter->FixRoute( aConn.end, aEndItem, true )
+                && insideFence( aRouter, aFence );
+    }
+
+    if( ok )
+        aRouter->CommitRouting();
+    else
+        aRouter->StopRouting();
+
+    return ok;
+}
+
+
+bool PNS_AUTOROUTER::insideFence( PNS::ROUTER* aRouter, const BOX2I* aFence ) const
+{
+    if( !aFence )
+        return true;
+
+    PNS::NODE::ITEM_VECTOR removed;
+    PNS::NODE::ITEM_VECTOR added;
+
+    aRouter->Placer()->CurrentNode( true )->GetUpdatedItems( removed, added );
+
+    // Keeping the changed items a clearance away from the fence keeps them out of reach of
+    // the routers of the other regions
+    for( const PNS::NODE::ITEM_VECTOR& items : { removed, added } )
+    {
+        for( const PNS::ITEM* item : items )
+        {
+            if( !aFence->Contains( item->Shape()->BBox( m_clearance ) ) )
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool PNS_AUTOROUTER::ripUpBlockers( PNS::ROUTER* aRouter, PNS_AUTOROUTER_IFACE* aIface,
+                                    const CONNECTION& aConn, const BOX2I* aFence,
+                                    std::vector<int>& aRequeued )
+{
+    PNS::NODE* world = aRouter->GetWorld();
+    PNS::ITEM* startItem = findAnchor( world, aConn.startParent, aConn.start, aConn.net );
+
+    if( !startItem )
+        return false;
+
+    auto inScope =
+            [&]( const CONNECTION& aOther )
+            {
+                return !aFence || aFence->Contains( aOther.area );
+            };
+
+    // Find the autorouted nets crossing the direct path, on the layers the connection can
+    // start on
+    SHAPE_LINE_CHAIN path = DIRECTION_45().BuildInitialTrace( aConn.start, aConn.end );
+    std::set<int>    nets;
+
+    for( int layer : m_copperLayers )
+    {
+        if( !startItem->Layers().Overlaps( layer ) )
+            continue;
+
+        for( int i = 0; i < path.SegmentCount(); i++ )
+        {
+            PNS::SEGMENT          probe( path.CSegment( i ), aConn.net );
+            PNS::NODE::OBSTACLES obstacles;
+
+            probe.SetWidth( aRouter->Sizes().TrackWidth() );
+            probe.SetLayer( layer );
+
+            world->QueryColliding( &probe, obstacles, PNS::ITEM::SEGMENT_T | PNS::ITEM::ARC_T
+                                                              | PNS::ITEM::VIA_T );
+
+            for( const PNS::OBSTACLE& obstacle : obstacles )
+            {
+                if( obstacle.m_item->Net() != aConn.net
+                        && aIface->IsRippable( obstacle.m_item->Parent() ) )
+                {
+                    nets.insert( obstacle.m_item->Net() );
+                }
+            }
+        }
+    }
+
+    PNS::NODE* branch = world->Branch();
+    bool       rippedUp = false;
+
+    for( int net : nets )
+    {
+        auto netConnections = m_netConnections.find( net );
+
+        if( netConnections == m_netConnections.end() )
+            continue;
+
+        std::vector<int> connections;
+        bool             canRipUp = true;
+
+        for( int idx : netConnections->second )
+        {
+            const CONNECTION& other = m_connections[idx];
+
+            // the connections of the other regions belong to other threads
+            if( inScope( other ) && other.routed )
+            {
+                connections.push_back( idx );
+                canRipUp = canRipUp && other.ripUps < m_maxRipUps;
+            }
+        }
+
+        if( !canRipUp )
+            continue;
+
+        std::set<PNS::ITEM*> items;
+
+        world->AllItemsInNet( net, items, PNS::ITEM::SEGMENT_T | PNS::ITEM::ARC_T
+                                                  | PNS::ITEM::VIA_T );
+
+        for( PNS::ITEM* item : items )
+        {
+            if( aIface->IsRippable( item->Parent() )
+                    && ( !aFence || aFence->Contains( item->Shape()->BBox() ) ) )
+            {
+                branch->Remove( item );
+                rippedUp = true;
+            }
+        }
+
+        for( int idx : connections )
+        {
+            m_connections[idx].routed = false;
+            m_connections[idx].ripUps++;
+            aRequeued.push_back( idx );
+        }
+    }
+
+    if( rippedUp )
+        aRouter->CommitRouting( branch );
+    else
+        delete branch;
+
+    return rippedUp;
+}
+
+
+void PNS_AUTOROUTER::mergeChanges( PNS_AUTOROUTER_IFACE* aIface )
+{
+    std::set<BOARD_ITEM*> removed( aIface->Removed().begin(), aIface->Removed().end() );
+
+    // The ends of the connections may be tracks replaced by their shoved copies
+    for( CONNECTION& conn : m_connections )
+    {
+        if( removed.count( conn.startParent ) )
+            conn.startParent = nullptr;
+
+        if( removed.count( conn.endParent ) )
+            conn.endParent = nullptr;
+    }
+
+    for( BOARD_ITEM* item : aIface->Removed() )
+    {
+        m_routedItems.erase( item );
+        m_board->Remove( item );
+        delete item;
+    }
+
+    for( BOARD_ITEM* item : aIface->Added() )
+    {
+        item->ClearFlags();
+        m_board->Add( item, ADD_MODE::APPEND );
+
+        if( aIface->IsRippable( item ) )
+            m_routedItems.insert( item );
+    }
+
+    aIface->ReleaseChanges();
+}
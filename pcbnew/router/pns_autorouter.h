@@ -0,0 +1,169 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_AUTOROUTER_H
+#define __PNS_AUTOROUTER_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include <math/box2.h>
+#include <math/vector2d.h>
+
+class BOARD;
+class BOARD_ITEM;
+class BOARD_CONNECTED_ITEM;
+class PNS_AUTOROUTER_IFACE;
+
+namespace PNS
+{
+    class ITEM;
+    class ROUTER;
+}
+
+
+/**
+ * Headless batch router: routes the unconnected ratsnest edges of a board with the P&S
+ * router, without any tool, view or commit.
+ *
+ * The edges are routed shortest first.  Edges whose neighbourhoods don't overlap are gathered
+ * into regions, which are routed on several threads, each running a ROUTER of its own.  The
+ * routing of a region is fenced in its neighbourhood, so that the results of all the threads
+ * can be merged into the board afterwards.  The edges a region can't route are then routed on
+ * the whole board, in a few passes of rip-up and retry of the autorouted tracks in their way.
+ *
+ * The DRC engine of the board must be initialized with its rules.
+ */
+class PNS_AUTOROUTER
+{
+public:
+    PNS_AUTOROUTER( BOARD* aBoard );
+    ~PNS_AUTOROUTER();
+
+    ///< Set the number of threads routing regions, 0 for one per core.
+    void SetThreadCount( int aThreads ) { m_threadCount = aThreads; }
+
+    ///< Set the number of rip-up and retry passes over the edges the regions left unrouted.
+    void SetPassCount( int aPasses ) { m_passCount = aPasses; }
+
+    ///< Set how many times the tracks of an edge may be ripped up for other edges.
+    void SetMaxRipUps( int aRipUps ) { m_maxRipUps = aRipUps; }
+
+    /**
+     * Route the unconnected edges of the board, and add the new tracks and vias to it.
+     *
+     * @return the number of edges left unrouted.
+     */
+    int Run();
+
+    int GetRoutedCount() const { return m_routedCount; }
+    int GetUnroutedCount() const { return m_unroutedCount; }
+
+private:
+    struct CONNECTION
+    {
+        int                   net;
+        VECTOR2I              start;
+        VECTOR2I              end;
+        BOARD_CONNECTED_ITEM* startParent;
+        BOARD_CONNECTED_ITEM* endParent;
+        BOX2I                 area;         ///< where the routing is expected to stay
+        bool                  routed;
+        int                   ripUps;
+    };
+
+    struct REGION
+    {
+        BOX2I            fence;
+        std::vector<int> connections;
+    };
+
+    ///< A ROUTER of a thread and the board changes it made.
+    struct WORKER
+    {
+        std::unique_ptr<PNS_AUTOROUTER_IFACE> iface;
+        std::vector<int>                      deferred;   ///< connections left to the passes
+    };
+
+    ///< Collect the unconnected edges of the board.
+    void buildConnections();
+
+    ///< Gather the connections into regions whose fences don't overlap.
+    void buildRegions();
+
+    ///< Route the regions with \a aThreads workers.
+    void routeRegions( int aThreads, std::vector<WORKER>& aWorkers );
+
+    ///< Route \a aConnections, with rip-up and retry, keeping the changes inside \a aFence.
+    void routeConnections( PNS::ROUTER* aRouter, PNS_AUTOROUTER_IFACE* aIface,
+                           const std::vector<int>& aConnections, const BOX2I* aFence,
+                           std::vector<int>& aUnrouted );
+
+    /**
+     * Route a single connection, on a common layer of its ends if they have one, or else
+     * through a via.  The routing is undone if it doesn't reach the end, or changes items
+     * outside of \a aFence.
+     */
+    bool routeConnection( PNS::ROUTER* aRouter, PNS_AUTOROUTER_IFACE* aIface,
+                          const CONNECTION& aConn, const BOX2I* aFence );
+
+    bool routeOnLayers( PNS::ROUTER* aRouter, PNS_AUTOROUTER_IFACE* aIface,
+                        const CONNECTION& aConn, PNS::ITEM* aStartItem, PNS::ITEM* aEndItem,
+                        int aStartLayer, int aEndLayer, const BOX2I* aFence );
+
+    ///< @return true if the routing in progress only changed items inside \a aFence.
+    bool insideFence( PNS::ROUTER* aRouter, const BOX2I* aFence ) const;
+
+    /**
+     * Rip up the autorouted tracks of the nets blocking \a aConn, inside \a aFence.
+     *
+     * @return true if anything was ripped up.
+     */
+    bool ripUpBlockers( PNS::ROUTER* aRouter, PNS_AUTOROUTER_IFACE* aIface,
+                        const CONNECTION& aConn, const BOX2I* aFence,
+                        std::vector<int>& aRequeued );
+
+    ///< Apply the board changes of \a aIface.
+    void mergeChanges( PNS_AUTOROUTER_IFACE* aIface );
+
+    BOARD*                                m_board;
+    int                                   m_threadCount;
+    int                                   m_passCount;
+    int                                   m_maxRipUps;
+    int                                   m_clearance;    ///< the biggest clearance of the board
+    std::vector<int>                      m_copperLayers;
+
+    std::vector<CONNECTION>               m_connections;
+    std::map<int, std::vector<int>>       m_netConnections;
+    std::vector<REGION>                   m_regions;
+
+    ///< Autorouted items already merged into the board, which later passes may rip up.
+    std::set<BOARD_ITEM*>                 m_routedItems;
+
+    ///< Serializes reading the board into the worlds of the workers.
+    std::mutex                            m_syncMutex;
+
+    int                                   m_routedCount;
+    int                                   m_unroutedCount;
+};
+
+#endif    // __PNS_AUTOROUTER_H
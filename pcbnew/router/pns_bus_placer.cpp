@@ -0,0 +1,569 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <numeric>
+#include <set>
+
+#include <geometry/direction45.h>
+
+#include "pns_bus_placer.h"
+#include "pns_optimizer.h"
+#include "pns_router.h"
+#include "pns_shove.h"
+#include "pns_topology.h"
+#include "pns_utils.h"
+#include "pns_walkaround.h"
+
+namespace PNS {
+
+BUS_PLACER::BUS_PLACER( ROUTER* aRouter ) :
+    PLACEMENT_ALGO( aRouter )
+{
+    m_leader = 0;
+    m_world = nullptr;
+    m_currentNode = nullptr;
+    m_lastNode = nullptr;
+    m_currentLayer = 0;
+    m_startDiagonal = false;
+    m_fitOk = false;
+    m_idle = true;
+}
+
+
+BUS_PLACER::~BUS_PLACER()
+{}
+
+
+bool BUS_PLACER::Start( const VECTOR2I& aP, ITEM* aStartItem )
+{
+    m_world = Router()->GetWorld();
+    m_currentNode = m_world;
+
+    ITEM_SET items( m_startItems );
+
+    if( aStartItem && !items.Contains( aStartItem ) )
+        items.Prepend( aStartItem );
+
+    if( items.Empty() )
+    {
+        Router()->SetFailureReason( _( "Cannot start a bus in the middle of nowhere." ) );
+        return false;
+    }
+
+    std::set<int> nets;
+
+    m_members.clear();
+    m_leader = 0;
+
+    for( ITEM* item : items.Items() )
+    {
+        OPT_VECTOR2I anchor = DanglingAnchor( m_world, item );
+
+        if( !anchor )
+        {
+            wxString netName = m_world->GetRuleResolver()->NetName( item->Net() );
+
+            Router()->SetFailureReason( wxString::Format( _( "Can't find a suitable starting "
+                                                             "point for net \"%s\"." ),
+                                                          netName ) );
+            return false;
+        }
+
+        if( !nets.insert( item->Net() ).second )
+        {
+            Router()->SetFailureReason( _( "Each trace of a bus must belong to a different "
+                                           "net." ) );
+            return false;
+        }
+
+        MEMBER member;
+
+        member.start = *anchor;
+        member.offset = 0;
+        member.trace.SetNet( item->Net() );
+
+        if( item == aStartItem )
+            m_leader = (int) m_members.size();
+
+        m_members.push_back( member );
+    }
+
+    // Without an item under the cursor, the nearest trace leads
+    if( !aStartItem )
+    {
+        for( size_t i = 1; i < m_members.size(); i++ )
+        {
+            if( ( m_members[i].start - aP ).SquaredEuclideanNorm()
+                    < ( m_members[m_leader].start - aP ).SquaredEuclideanNorm() )
+            {
+                m_leader = (int) i;
+            }
+        }
+    }
+
+    m_currentEnd = aP;
+    m_fitOk = false;
+
+    initPlacement();
+
+    return true;
+}
+
+
+void BUS_PLACER::initPlacement()
+{
+    m_idle = false;
+
+    NODE* world = Router()->GetWorld();
+
+    world->KillChildren();
+    NODE* rootNode = world->Branch();
+
+    m_world = rootNode;
+    m_lastNode = nullptr;
+    m_currentNode = rootNode;
+
+    for( MEMBER& member : m_members )
+    {
+        member.trace.Clear();
+        member.trace.SetWidth( m_sizes.TrackWidth() );
+        member.trace.SetLayer( m_currentLayer );
+    }
+
+    m_shove = std::make_unique<SHOVE>( m_currentNode, Router() );
+}
+
+
+int BUS_PLACER::pitch( const MEMBER& aA, const MEMBER& aB ) const
+{
+    int clearance = std::max( m_currentNode->GetClearance( &aA.trace, &aB.trace ),
+                              m_currentNode->GetClearance( &aB.trace, &aA.trace ) );
+
+    return ( aA.trace.Width() + aB.trace.Width() ) / 2 + clearance + PNS_HULL_MARGIN;
+}
+
+
+bool BUS_PLACER::buildFormation( const VECTOR2I& aP )
+{
+    const MEMBER& leader = m_members[m_leader];
+
+    if( aP == leader.start )
+    {
+        for( MEMBER& member : m_members )
+            member.trace.Clear();
+
+        return false;
+    }
+
+    DIRECTION_45::CORNER_MODE cornerMode = Settings().GetCornerMode();
+    SHAPE_LINE_CHAIN          leaderPath = DIRECTION_45().BuildInitialTrace( leader.start, aP,
+                                                                             m_startDiagonal,
+                                                                             cornerMode );
+
+    // The bus is laid out across the direction the leading trace arrives at the cursor from
+    VECTOR2I dir = DIRECTION_45( leaderPath.CSegment( -1 ) ).ToVector();
+    VECTOR2I across( -dir.y, dir.x );
+
+    // Keep the traces in the order of their starts, so that they don't cross each other
+    std::vector<int> order( m_members.size() );
+    std::iota( order.begin(), order.end(), 0 );
+
+    std::stable_sort( order.begin(), order.end(),
+                      [&]( int a, int b )
+                      {
+                          return ( m_members[a].start - leader.start ).Dot( across )
+                                    < ( m_members[b].start - leader.start ).Dot( across );
+                      } );
+
+    int leaderRank = std::find( order.begin(), order.end(), m_leader ) - order.begin();
+
+    m_members[m_leader].offset = 0;
+
+    for( int rank = leaderRank + 1; rank < (int) order.size(); rank++ )
+    {
+        const MEMBER& prev = m_members[order[rank - 1]];
+        m_members[order[rank]].offset = prev.offset + pitch( prev, m_members[order[rank]] );
+    }
+
+    for( int rank = leaderRank - 1; rank >= 0; rank-- )
+    {
+        const MEMBER& next = m_members[order[rank + 1]];
+        m_members[order[rank]].offset = next.offset - pitch( next, m_members[order[rank]] );
+    }
+
+    for( int i = 0; i < (int) m_members.size(); i++ )
+    {
+        MEMBER&  member = m_members[i];
+        VECTOR2I end = aP + across.Resize( member.offset );
+
+        if( i == m_leader )
+            member.trace.SetShape( leaderPath );
+        else if( end == member.start )
+            member.trace.Clear();
+        else
+            member.trace.SetShape( DIRECTION_45().BuildInitialTrace( member.start, end,
+                                                                     m_startDiagonal,
+                                                                     cornerMode ) );
+    }
+
+    return true;
+}
+
+
+bool BUS_PLACER::checkCollisions() const
+{
+    for( size_t i = 0; i < m_members.size(); i++ )
+    {
+        const LINE& trace = m_members[i].trace;
+
+        if( !trace.SegmentCount() )
+            continue;
+
+        if( m_currentNode->CheckColliding( &trace ) )
+            return false;
+
+        for( size_t j = i + 1; j < m_members.size(); j++ )
+        {
+            if( m_members[j].trace.SegmentCount()
+                    && trace.Collide( &m_members[j].trace, m_currentNode ) )
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+bool BUS_PLACER::rhMarkObstacles()
+{
+    m_fitOk = checkCollisions();
+
+    return m_fitOk;
+}
+
+
+bool BUS_PLACER::rhWalkOnly()
+{
+    // Walk the traces from the leading one outwards, each one around the obstacles and the
+    // traces already walked.
+    std::vector<int> order( m_members.size() );
+    std::iota( order.begin(), order.end(), 0 );
+
+    std::stable_sort( order.begin(), order.end(),
+                      [&]( int a, int b )
+                      {
+                          return std::abs( m_members[a].offset ) < std::abs( m_members[b].offset );
+                      } );
+
+    NODE* walkNode = m_currentNode->Branch();
+    bool  ok = true;
+
+    for( int idx : order )
+    {
+        LINE& trace = m_members[idx].trace;
+
+        if( !trace.SegmentCount() )
+            continue;
+
+        if( walkNode->CheckColliding( &trace ) )
+        {
+            WALKAROUND walkaround( walkNode, Router() );
+
+            walkaround.SetSolidsOnly( false );
+            walkaround.SetDebugDecorator( Dbg() );
+            walkaround.SetLogger( Logger() );
+            walkaround.SetIterationLimit( Settings().WalkaroundIterationLimit() );
+
+            WALKAROUND::RESULT wr = walkaround.Route( trace );
+
+            bool cwOk = wr.statusCw == WALKAROUND::DONE;
+            bool ccwOk = wr.statusCcw == WALKAROUND::DONE;
+
+            if( cwOk && ( !ccwOk || wr.lineCw.CLine().Length() < wr.lineCcw.CLine().Length() ) )
+                trace.SetShape( wr.lineCw.CLine() );
+            else if( ccwOk )
+                trace.SetShape( wr.lineCcw.CLine() );
+            else
+                ok = false;
+        }
+
+        LINE placed( trace );
+        walkNode->Add( placed );
+    }
+
+    delete walkNode;
+
+    m_fitOk = ok;
+
+    return m_fitOk;
+}
+
+
+bool BUS_PLACER::rhShoveOnly()
+{
+    m_currentNode = m_shove->CurrentNode();
+    m_fitOk = false;
+
+    ITEM_SET head;
+
+    for( MEMBER& member : m_members )
+    {
+        if( member.trace.SegmentCount() )
+            head.Add( &member.trace );
+    }
+
+    if( head.Empty() )
+        return false;
+
+    SHOVE::SHOVE_STATUS status = m_shove->ShoveMultiLines( head );
+
+    m_currentNode = m_shove->CurrentNode();
+
+    if( status == SHOVE::SH_OK )
+        m_fitOk = checkCollisions();
+
+    return m_fitOk;
+}
+
+
+void BUS_PLACER::optimizeGroup()
+{
+    NODE*             groupNode = m_currentNode->Branch();
+    std::vector<LINE> placed;
+
+    placed.reserve( m_members.size() );
+
+    for( const MEMBER& member : m_members )
+    {
+        placed.emplace_back( member.trace );
+
+        if( member.trace.SegmentCount() )
+            groupNode->Add( placed.back() );
+    }
+
+    for( size_t i = 0; i < m_members.size(); i++ )
+    {
+        LINE& trace = m_members[i].trace;
+
+        if( !trace.SegmentCount() )
+            continue;
+
+        groupNode->Remove( placed[i] );
+
+        OPTIMIZER::Optimize( &trace, OPTIMIZER::MERGE_SEGMENTS, groupNode );
+
+        placed[i] = trace;
+        groupNode->Add( placed[i] );
+    }
+
+    delete groupNode;
+}
+
+
+bool BUS_PLACER::route( const VECTOR2I& aP )
+{
+    if( !buildFormation( aP ) )
+        return false;
+
+    switch( Settings().Mode() )
+    {
+    case RM_MarkObstacles: rhMarkObstacles(); break;
+    case RM_Walkaround:    rhWalkOnly();      break;
+    case RM_Shove:         rhShoveOnly();     break;
+    default:                                  break;
+    }
+
+    // One optimization pass for the whole group, once it fits
+    if( m_fitOk )
+        optimizeGroup();
+
+    return m_fitOk;
+}
+
+
+bool BUS_PLACER::Move( const VECTOR2I& aP, ITEM* aEndItem )
+{
+    m_fitOk = false;
+
+    delete m_lastNode;
+    m_lastNode = nullptr;
+
+    bool retval = route( aP );
+
+    m_lastNode = m_currentNode->Branch();
+    m_currentEnd = aP;
+
+    updateLeadingRatLines();
+
+    return retval;
+}
+
+
+bool BUS_PLACER::FixRoute( const VECTOR2I& aP, ITEM* aEndItem, bool aForceFinish )
+{
+    if( !m_fitOk && !Settings().AllowDRCViolations() )
+        return false;
+
+    if( !HasPlacedAnything() )
+        return false;
+
+    TOPOLOGY topo( m_lastNode );
+
+    for( MEMBER& member : m_members )
+    {
+        if( !member.trace.SegmentCount() )
+            continue;
+
+        LINE committed( member.trace );
+
+        m_lastNode->Add( committed );
+        topo.SimplifyLine( &committed );
+
+        member.start = member.trace.CPoint( -1 );
+    }
+
+    CommitPlacement();
+
+    if( aForceFinish )
+    {
+        m_idle = true;
+        return true;
+    }
+
+    initPlacement();
+    return false;
+}
+
+
+bool BUS_PLACER::AbortPlacement()
+{
+    m_world->KillChildren();
+    return true;
+}
+
+
+bool BUS_PLACER::HasPlacedAnything() const
+{
+    for( const MEMBER& member : m_members )
+    {
+        if( member.trace.SegmentCount() )
+            return true;
+    }
+
+    return false;
+}
+
+
+bool BUS_PLACER::CommitPlacement()
+{
+    if( m_lastNode )
+        Router()->CommitRouting( m_lastNode );
+
+    m_lastNode = nullptr;
+    m_currentNode = nullptr;
+    return true;
+}
+
+
+bool BUS_PLACER::SetLayer( int aLayer )
+{
+    if( !m_idle )
+        return false;
+
+    m_currentLayer = aLayer;
+    return true;
+}
+
+
+const ITEM_SET BUS_PLACER::Traces()
+{
+    ITEM_SET traces;
+
+    for( MEMBER& member : m_members )
+        traces.Add( &member.trace );
+
+    return traces;
+}
+
+
+const std::vector<int> BUS_PLACER::CurrentNets() const
+{
+    std::vector<int> nets;
+
+    for( const MEMBER& member : m_members )
+        nets.push_back( member.trace.Net() );
+
+    return nets;
+}
+
+
+NODE* BUS_PLACER::CurrentNode( bool aLoopsRemoved ) const
+{
+    if( m_lastNode )
+        return m_lastNode;
+
+    return m_currentNode;
+}
+
+
+void BUS_PLACER::FlipPosture()
+{
+    m_startDiagonal = !m_startDiagonal;
+
+    if( !m_idle )
+        Move( m_currentEnd, nullptr );
+}
+
+
+void BUS_PLACER::UpdateSizes( const SIZES_SETTINGS& aSizes )
+{
+    m_sizes = aSizes;
+
+    if( !m_idle )
+    {
+        for( MEMBER& member : m_members )
+            member.trace.SetWidth( m_sizes.TrackWidth() );
+    }
+}
+
+
+void BUS_PLACER::GetModifiedNets( std::vector<int>& aNets ) const
+{
+    for( const MEMBER& member : m_members )
+        aNets.push_back( member.trace.Net() );
+}
+
+
+void BUS_PLACER::updateLeadingRatLines()
+{
+    TOPOLOGY topo( m_lastNode );
+
+    for( MEMBER& member : m_members )
+    {
+        SHAPE_LINE_CHAIN ratLine;
+
+        if( member.trace.SegmentCount() && topo.LeadingRatLine( &member.trace, ratLine ) )
+            m_router->GetInterface()->DisplayRatline( ratLine, 1 );
+    }
+}
+
+}
@@ -0,0 +1,196 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_BUS_PLACER_H
+#define __PNS_BUS_PLACER_H
+
+#include <memory>
+#include <vector>
+
+#include <math/vector2d.h>
+
+#include "pns_sizes_settings.h"
+#include "pns_node.h"
+#include "pns_line.h"
+#include "pns_algo_base.h"
+#include "pns_itemset.h"
+
+#include "pns_placement_algo.h"
+
+namespace PNS {
+
+class ROUTER;
+class SHOVE;
+
+
+/**
+ * Bus placement algorithm.
+ *
+ * Routes a group of traces of different nets at once.  The cursor leads the trace started from
+ * the item under it, and the other traces follow it side by side, spaced by their width and
+ * clearance.  All the traces are shoved or walked around in the same NODE branch, and the group
+ * is optimized and committed as a whole.
+ */
+class BUS_PLACER : public PLACEMENT_ALGO
+{
+public:
+    BUS_PLACER( ROUTER* aRouter );
+    ~BUS_PLACER();
+
+    /**
+     * Set the items the traces of the bus start from, one per net: pads, vias or dangling track
+     * ends.  Must be called before Start().
+     */
+    void SetStartItems( const ITEM_SET& aStartItems ) { m_startItems = aStartItems; }
+
+    /**
+     * Start routing the bus at point \a aP.  The trace of \a aStartItem follows the cursor; it
+     * is added to the bus if it isn't one of the start items.
+     */
+    bool Start( const VECTOR2I& aP, ITEM* aStartItem ) override;
+
+    /**
+     * Move the end of the leading trace to the point \a aP, and the ends of the others
+     * alongside it.
+     */
+    bool Move( const VECTOR2I& aP, ITEM* aEndItem ) override;
+
+    /**
+     * Commit all the traces of the bus to the parent node.  Routing continues from their ends
+     * unless \a aForceFinish is set.
+     *
+     * @return true if the bus has been finished.  May return false if the routing result is
+     *         violating design rules.  In such cases, the traces are only committed if
+     *         #Settings.CanViolateDRC() is on.
+     */
+    bool FixRoute( const VECTOR2I& aP, ITEM* aEndItem, bool aForceFinish ) override;
+
+    /// @copydoc PLACEMENT_ALGO::CommitPlacement()
+    bool CommitPlacement() override;
+
+    /// @copydoc PLACEMENT_ALGO::AbortPlacement()
+    bool AbortPlacement() override;
+
+    /// @copydoc PLACEMENT_ALGO::HasPlacedAnything()
+    bool HasPlacedAnything() const override;
+
+    /**
+     * Set the routing layer.  The layer of a bus can't be changed while routing, as it takes no
+     * vias.
+     */
+    bool SetLayer( int aLayer ) override;
+
+    /**
+     * Return the traces of the bus.
+     */
+    const ITEM_SET Traces() override;
+
+    const VECTOR2I& CurrentEnd() const override
+    {
+        return m_currentEnd;
+    }
+
+    /**
+     * Return the net codes of the traces, in the order of the start items.
+     */
+    const std::vector<int> CurrentNets() const override;
+
+    int CurrentLayer() const override
+    {
+        return m_currentLayer;
+    }
+
+    NODE* CurrentNode( bool aLoopsRemoved = false ) const override;
+
+    void FlipPosture() override;
+
+    void UpdateSizes( const SIZES_SETTINGS& aSizes ) override;
+
+    void GetModifiedNets( std::vector<int>& aNets ) const override;
+
+private:
+    struct MEMBER
+    {
+        VECTOR2I start;         ///< where the trace starts
+        int      offset;        ///< signed distance of its end from the cursor, across the bus
+        LINE     trace;
+    };
+
+    ///< Initialize placement of the traces from the current member starts.
+    void initPlacement();
+
+    /**
+     * Lay the traces in formation: the leading one from its start to \a aP, and every other
+     * one to a point beside \a aP, perpendicular to the last segment of the leading trace and
+     * in the same order as the starts.
+     *
+     * @return false if there is nothing to route.
+     */
+    bool buildFormation( const VECTOR2I& aP );
+
+    ///< Minimum distance between the centerlines of the traces of two members.
+    int pitch( const MEMBER& aA, const MEMBER& aB ) const;
+
+    bool route( const VECTOR2I& aP );
+
+    ///< route step, mark obstacles mode
+    bool rhMarkObstacles();
+
+    ///< route step, walk around mode
+    bool rhWalkOnly();
+
+    ///< route step, shove mode
+    bool rhShoveOnly();
+
+    ///< Check the traces against the current node and against each other.
+    bool checkCollisions() const;
+
+    ///< Optimize each trace, keeping the other traces of the bus as obstacles.
+    void optimizeGroup();
+
+    void updateLeadingRatLines();
+
+    ITEM_SET            m_startItems;
+    std::vector<MEMBER> m_members;
+    int                 m_leader;           ///< index of the member following the cursor
+
+    ///< pointer to world to search colliding items
+    NODE*               m_world;
+
+    ///< Current world state
+    NODE*               m_currentNode;
+
+    ///< Postprocessed world state
+    NODE*               m_lastNode;
+
+    ///< The shove engine
+    std::unique_ptr<SHOVE> m_shove;
+
+    SIZES_SETTINGS      m_sizes;
+
+    VECTOR2I            m_currentEnd;
+    int                 m_currentLayer;
+    bool                m_startDiagonal;
+    bool                m_fitOk;
+    bool                m_idle;
+};
+
+}
+
+#endif    // __PNS_BUS_PLACER_H
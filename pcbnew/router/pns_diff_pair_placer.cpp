@@ -26,6 +26,7 @@
 #include "pns_solid.h"
 #include "pns_topology.h"
 #include "pns_debug_decorator.h"
+#include "pns_utils.h"
 
 namespace PNS {
 
@@ -430,37 +431,6 @@ bool DIFF_PAIR_PLACER::SetLayer( int aLayer )
 }
 
 
-OPT_VECTOR2I getDanglingAnchor( NODE* aNode, ITEM* aItem )
-{
-    switch( aItem->Kind() )
-    {
-    case ITEM::VIA_T:
-    case ITEM::SOLID_T:
-        return aItem->Anchor( 0 );
-
-    case ITEM::ARC_T:
-    case ITEM::SEGMENT_T:
-    {
-        SEGMENT* s = static_cast<SEGMENT*>( aItem );
-
-        JOINT* jA = aNode->FindJoint( aItem->Anchor( 0 ), aItem );
-        JOINT* jB = aNode->FindJoint( aItem->Anchor( 1 ), aItem );
-
-        if( jA && jA->LinkCount() == 1 )
-            return s->Seg().A;
-        else if( jB && jB->LinkCount() == 1 )
-            return s->Seg().B;
-        else
-            return OPT_VECTOR2I();
-    }
-
-    default:
-        return OPT_VECTOR2I();
-    }
-}
-
-
-
 bool DIFF_PAIR_PLACER::FindDpPrimitivePair( NODE* aWorld, const VECTOR2I& aP, ITEM* aItem,
                                             DP_PRIMITIVE_PAIR& aPair, wxString* aErrorMsg )
 {
@@ -482,7 +452,7 @@ bool DIFF_PAIR_PLACER::FindDpPrimitivePair( NODE* aWorld, const VECTOR2I& aP, IT
     int refNet = aItem->Net();
     int coupledNet = ( refNet == netP ) ? netN : netP;
 
-    OPT_VECTOR2I refAnchor = getDanglingAnchor( aWorld, aItem );
+    OPT_VECTOR2I refAnchor = DanglingAnchor( aWorld, aItem );
     ITEM* primRef = aItem;
 
     if( !refAnchor )
@@ -507,7 +477,7 @@ bool DIFF_PAIR_PLACER::FindDpPrimitivePair( NODE* aWorld, const VECTOR2I& aP, IT
     {
         if( item->Kind() == aItem->Kind() )
         {
-            OPT_VECTOR2I anchor = getDanglingAnchor( aWorld, item );
+            OPT_VECTOR2I anchor = DanglingAnchor( aWorld, item );
 
             if( !anchor )
                 continue;
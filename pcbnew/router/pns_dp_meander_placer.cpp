@@ -392,13 +392,7 @@ bool DP_MEANDER_PLACER::CheckFit( MEANDER_SHAPE* aShape )
     if( m_currentNode->CheckColliding( &l1 ) )
         return false;
 
-    if( m_currentNode->CheckColliding( &l2 ) )
-        return false;
-
-    int w = aShape->Width();
-    int clearance = w + m_settings.m_spacing;
-
-    return m_result.CheckSelfIntersections( aShape, clearance );
+    return !m_currentNode->CheckColliding( &l2 );
 }
 
 
@@ -29,11 +29,22 @@ void INDEX::Add( ITEM* aItem )
 {
     const LAYER_RANGE& range = aItem->Layers();
 
-    if( m_subIndices.size() <= static_cast<size_t>( range.End() ) )
-        m_subIndices.resize( 2 * range.End() + 1 ); // +1 handles the 0 case
-
-    for( int i = range.Start(); i <= range.End(); ++i )
-        m_subIndices[i].Add( aItem );
+    if( m_useGrid )
+    {
+        if( m_gridSubIndices.size() <= static_cast<size_t>( range.End() ) )
+            m_gridSubIndices.resize( 2 * range.End() + 1 ); // +1 handles the 0 case
+
+        for( int i = range.Start(); i <= range.End(); ++i )
+            m_gridSubIndices[i].Add( aItem );
+    }
+    else
+    {
+        if( m_subIndices.size() <= static_cast<size_t>( range.End() ) )
+            m_subIndices.resize( 2 * range.End() + 1 ); // +1 handles the 0 case
+
+        for( int i = range.Start(); i <= range.End(); ++i )
+            m_subIndices[i].Add( aItem );
+    }
 
     m_allItems.insert( aItem );
     int net = aItem->Net();
@@ -47,11 +58,22 @@ void INDEX::Remove( ITEM* aItem )
 {
     const LAYER_RANGE& range = aItem->Layers();
 
-    if( m_subIndices.size() <= static_cast<size_t>( range.End() ) )
-        return;
-
-    for( int i = range.Start(); i <= range.End(); ++i )
-        m_subIndices[i].Remove( aItem );
+    if( m_useGrid )
+    {
+        if( m_gridSubIndices.size() <= static_cast<size_t>( range.End() ) )
+            return;
+
+        for( int i = range.Start(); i <= range.End(); ++i )
+            m_gridSubIndices[i].Remove( aItem );
+    }
+    else
+    {
+        if( m_subIndices.size() <= static_cast<size_t>( range.End() ) )
+            return;
+
+        for( int i = range.Start(); i <= range.End(); ++i )
+            m_subIndices[i].Remove( aItem );
+    }
 
     m_allItems.erase( aItem );
     int net = aItem->Net();
@@ -22,12 +22,14 @@
 #ifndef __PNS_INDEX_H
 #define __PNS_INDEX_H
 
+#include <cassert>
 #include <deque>
 #include <list>
 #include <map>
 #include <unordered_set>
 
 #include <layer_ids.h>
+#include <geometry/shape_grid_index.h>
 #include <geometry/shape_index.h>
 
 #include "pns_item.h"
@@ -41,15 +43,33 @@ namespace PNS {
  * Custom spatial index, holding our board items and allowing for very fast searches. Items
  * are assigned to separate R-Tree subindices depending on their type and spanned layers, reducing
  * overlap and improving search time.
+ *
+ * The subindices can be uniform grids instead (see SetUseGrid()), which are much cheaper to
+ * update than R-Trees, at the cost of slower searches over large areas.
  **/
 class INDEX
 {
 public:
     typedef std::list<ITEM*>            NET_ITEMS_LIST;
     typedef SHAPE_INDEX<ITEM*>          ITEM_SHAPE_INDEX;
+    typedef SHAPE_GRID_INDEX<ITEM*>     ITEM_GRID_INDEX;
     typedef std::unordered_set<ITEM*>   ITEM_SET;
 
-    INDEX(){};
+    INDEX() :
+        m_useGrid( false )
+    {};
+
+    /**
+     * Store the items in uniform grids instead of R-Trees.  Can only be changed while the index
+     * is empty.
+     */
+    void SetUseGrid( bool aUseGrid )
+    {
+        assert( m_allItems.empty() );
+        m_useGrid = aUseGrid;
+    }
+
+    bool UsesGrid() const { return m_useGrid; }
 
     /**
      * Adds item to the spatial index.
@@ -123,14 +143,24 @@ private:
 
 private:
     std::deque<ITEM_SHAPE_INDEX>  m_subIndices;
+    std::deque<ITEM_GRID_INDEX>   m_gridSubIndices;
     std::map<int, NET_ITEMS_LIST> m_netMap;
     ITEM_SET                      m_allItems;
+    bool                          m_useGrid;
 };
 
 
 template<class Visitor>
 int INDEX::querySingle( std::size_t aIndex, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor ) const
 {
+    if( m_useGrid )
+    {
+        if( aIndex >= m_gridSubIndices.size() )
+            return 0;
+
+        return m_gridSubIndices[aIndex].Query( aShape, aMinDistance, aVisitor );
+    }
+
     if( aIndex >= m_subIndices.size() )
         return 0;
 
@@ -155,7 +185,9 @@ int INDEX::Query( const SHAPE* aShape, int aMinDistance, Visitor& aVisitor ) con
 {
     int total = 0;
 
-    for( std::size_t i = 0; i < m_subIndices.size(); ++i )
+    std::size_t count = m_useGrid ? m_gridSubIndices.size() : m_subIndices.size();
+
+    for( std::size_t i = 0; i < count; ++i )
         total += querySingle( i, aShape, aMinDistance, aVisitor );
 
     return total;
@@ -29,7 +29,8 @@ typedef VECTOR2I::extended_type ecoord;
 
 namespace PNS {
 
-bool ITEM::collideSimple( const ITEM* aOther, const NODE* aNode, bool aDifferentNetsOnly ) const
+bool ITEM::collideSimple( const ITEM* aOther, const NODE* aNode, bool aDifferentNetsOnly,
+                          COLLISION& aResult ) const
 {
     const ROUTER_IFACE* iface = ROUTER::GetInstance()->GetInterface();
     const SHAPE*        shapeA = Shape();
@@ -94,13 +95,13 @@ bool ITEM::collideSimple( const ITEM* aOther, const NODE* aNode, bool aDifferent
 
         if( holeA && holeA->Collide( shapeB, holeClearance + lineWidthB ) )
         {
-            Mark( Marker() | MK_HOLE );
+            aResult.holeA = this;
             return true;
         }
 
         if( holeB && holeB->Collide( shapeA, holeClearance + lineWidthA ) )
         {
-            aOther->Mark( aOther->Marker() | MK_HOLE );
+            aResult.holeB = aOther;
             return true;
         }
 
@@ -110,8 +111,8 @@ bool ITEM::collideSimple( const ITEM* aOther, const NODE* aNode, bool aDifferent
 
             if( holeA->Collide( holeB, holeToHoleClearance ) )
             {
-                Mark( Marker() | MK_HOLE );
-                aOther->Mark( aOther->Marker() | MK_HOLE );
+                aResult.holeA = this;
+                aResult.holeB = aOther;
                 return true;
             }
         }
@@ -130,8 +131,28 @@ bool ITEM::collideSimple( const ITEM* aOther, const NODE* aNode, bool aDifferent
 
 bool ITEM::Collide( const ITEM* aOther, const NODE* aNode, bool aDifferentNetsOnly ) const
 {
-    if( collideSimple( aOther, aNode, aDifferentNetsOnly ) )
-        return true;
+    COLLISION result = TestCollision( aOther, aNode, aDifferentNetsOnly );
+
+    if( result.holeA )
+        result.holeA->AddMarker( MK_HOLE );
+
+    if( result.holeB )
+        result.holeB->AddMarker( MK_HOLE );
+
+    return result.collides;
+}
+
+
+COLLISION ITEM::TestCollision( const ITEM* aOther, const NODE* aNode,
+                               bool aDifferentNetsOnly ) const
+{
+    COLLISION result;
+
+    if( collideSimple( aOther, aNode, aDifferentNetsOnly, result ) )
+    {
+        result.collides = true;
+        return result;
+    }
 
     // Special cases for "head" lines with vias attached at the end.  Note that this does not
     // support head-line-via to head-line-via collisions, but you can't route two independent
@@ -141,19 +162,34 @@ bool ITEM::Collide( const ITEM* aOther, const NODE* aNode, bool aDifferentNetsOn
     {
         const LINE* line = static_cast<const LINE*>( this );
 
-        if( line->EndsWithVia() && line->Via().collideSimple( aOther, aNode, aDifferentNetsOnly ) )
-            return true;
+        if( line->EndsWithVia()
+                && line->Via().collideSimple( aOther, aNode, aDifferentNetsOnly, result ) )
+        {
+            result.collides = true;
+            return result;
+        }
     }
 
     if( aOther->m_kind == LINE_T )
     {
         const LINE* line = static_cast<const LINE*>( aOther );
 
-        if( line->EndsWithVia() && line->Via().collideSimple( this, aNode, aDifferentNetsOnly ) )
-            return true;
+        if( line->EndsWithVia() )
+        {
+            // The via is the tested item here, so its hole is on the other side
+            COLLISION viaResult;
+
+            if( line->Via().collideSimple( this, aNode, aDifferentNetsOnly, viaResult ) )
+            {
+                result.collides = true;
+                result.holeA = viaResult.holeB;
+                result.holeB = viaResult.holeA;
+                return result;
+            }
+        }
     }
 
-    return false;
+    return result;
 }
 
 
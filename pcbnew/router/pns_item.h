@@ -23,6 +23,7 @@
 #ifndef __PNS_ITEM_H
 #define __PNS_ITEM_H
 
+#include <atomic>
 #include <memory>
 #include <math/vector2d.h>
 
@@ -36,6 +37,7 @@ class BOARD_ITEM;
 namespace PNS {
 
 class NODE;
+class ITEM;
 
 enum LineMarker {
     MK_HEAD         = ( 1 << 0 ),
@@ -46,6 +48,17 @@ enum LineMarker {
 };
 
 
+/**
+ * Outcome of ITEM::TestCollision(), with the items whose hole is the cause of the collision.
+ */
+struct COLLISION
+{
+    bool        collides = false;
+    const ITEM* holeA = nullptr;      ///< the tested item (or its via) if its hole collides
+    const ITEM* holeB = nullptr;      ///< the other item (or its via) if its hole collides
+};
+
+
 /**
  * Base class for PNS router board items.
  *
@@ -92,13 +105,30 @@ public:
         m_kind = aOther.m_kind;
         m_parent = aOther.m_parent;
         m_owner = aOther.m_owner; // fixme: wtf this was null?
-        m_marker = aOther.m_marker;
+        m_marker = aOther.m_marker.load();
         m_rank = aOther.m_rank;
         m_routable = aOther.m_routable;
         m_isVirtual = aOther.m_isVirtual;
         m_isCompoundShapePrimitive = aOther.m_isCompoundShapePrimitive;
     }
 
+    ITEM& operator=( const ITEM& aOther )
+    {
+        m_layers = aOther.m_layers;
+        m_net = aOther.m_net;
+        m_movable = aOther.m_movable;
+        m_kind = aOther.m_kind;
+        m_parent = aOther.m_parent;
+        m_owner = aOther.m_owner;
+        m_marker = aOther.m_marker.load();
+        m_rank = aOther.m_rank;
+        m_routable = aOther.m_routable;
+        m_isVirtual = aOther.m_isVirtual;
+        m_isCompoundShapePrimitive = aOther.m_isCompoundShapePrimitive;
+
+        return *this;
+    }
+
     virtual ~ITEM();
 
     /**
@@ -194,6 +224,13 @@ public:
      */
     bool Collide( const ITEM* aOther, const NODE* aNode, bool aDifferentNetsOnly = true ) const;
 
+    /**
+     * Check for a collision like Collide(), but return the items colliding through their hole
+     * instead of marking them with MK_HOLE, so that the result can be memoized.
+     */
+    COLLISION TestCollision( const ITEM* aOther, const NODE* aNode,
+                             bool aDifferentNetsOnly = true ) const;
+
     /**
      * Return the geometrical shape of the item. Used for collision detection and spatial indexing.
      */
@@ -211,6 +248,13 @@ public:
     virtual void Unmark( int aMarker = -1 ) const { m_marker &= ~aMarker; }
     virtual int Marker() const { return m_marker; }
 
+    /**
+     * Add \a aMarker to the markers of the item.  Collision tests mark their items this way;
+     * unlike Mark( Marker() | aMarker ), it is atomic for the items stored in a NODE, which
+     * several threads may test at once.
+     */
+    virtual void AddMarker( int aMarker ) const { m_marker |= aMarker; }
+
     virtual void SetRank( int aRank ) { m_rank = aRank; }
     virtual int Rank() const { return m_rank; }
 
@@ -241,7 +285,8 @@ public:
     bool IsCompoundShapePrimitive() const { return m_isCompoundShapePrimitive; }
 
 private:
-    bool collideSimple( const ITEM* aOther, const NODE* aNode, bool aDifferentNetsOnly ) const;
+    bool collideSimple( const ITEM* aOther, const NODE* aNode, bool aDifferentNetsOnly,
+                        COLLISION& aResult ) const;
 
 protected:
     PnsKind       m_kind;
@@ -252,7 +297,7 @@ protected:
 
     bool          m_movable;
     int           m_net;
-    mutable int   m_marker;
+    mutable std::atomic<int> m_marker;
     int           m_rank;
     bool          m_routable;
     bool          m_isVirtual;
@@ -49,7 +49,11 @@
 
 #include <wx/log.h>
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
 
 #include <advanced_config.h>
 
@@ -94,8 +98,55 @@ public:
     void ClearCacheForItem( const PNS::ITEM* aItem ) override;
 
 private:
+    typedef std::pair<const PNS::ITEM*, const PNS::ITEM*> ITEM_PAIR;
+
+    ///< Constraint type, layer, then the parent, kind and net of each item.
+    typedef std::tuple<int, int, const BOARD_ITEM*, int, int,
+                       const BOARD_ITEM*, int, int> NET_PAIR_KEY;
+
+    ///< The dummy items and clearance caches of one thread.
+    struct THREAD_STATE
+    {
+        THREAD_STATE( BOARD* aBoard ) :
+                dummyTracks{ { aBoard }, { aBoard } },
+                dummyArcs{ { aBoard }, { aBoard } },
+                dummyVias{ { aBoard }, { aBoard } }
+        {}
+
+        PCB_TRACK                   dummyTracks[2];
+        PCB_ARC                     dummyArcs[2];
+        PCB_VIA                     dummyVias[2];
+
+        std::map<ITEM_PAIR, int>    clearanceCache;
+        std::map<ITEM_PAIR, int>    holeClearanceCache;
+        std::map<ITEM_PAIR, int>    holeToHoleClearanceCache;
+        std::map<NET_PAIR_KEY, int> netPairCache;
+    };
+
+    /**
+     * Return the dummy items and caches of the calling thread.
+     *
+     * The walkaround queries clearances from two threads at once.  Each thread gets its own
+     * state, so queries don't lock: only the first query of a thread on this resolver does.
+     */
+    THREAD_STATE& threadState();
+
     int holeRadius( const PNS::ITEM* aItem ) const;
 
+    /**
+     * Return the cache slot for a clearance of \a aType between \a aA and \a aB.
+     *
+     * Items with a parent are cached by address in \a aItemCache.  The result for an item
+     * without a parent (a track being routed) only depends on its kind, net and layer, so
+     * those are cached by net pair: this way the many temporary items created while shoving
+     * share their rule evaluations, and a reused address can't hit a stale entry.
+     *
+     * @param aFound is set to true if the slot already holds the clearance.
+     */
+    int* clearanceSlot( THREAD_STATE& aState, std::map<ITEM_PAIR, int>& aItemCache,
+                        PNS::CONSTRAINT_TYPE aType, const PNS::ITEM* aA, const PNS::ITEM* aB,
+                        int aLayer, bool& aFound );
+
     /**
      * Checks for netnamed differential pairs.
      * This accepts nets named suffixed by 'P', 'N', '+', '-', as well as additional
@@ -110,25 +161,26 @@ private:
 private:
     PNS::ROUTER_IFACE* m_routerIface;
     BOARD*             m_board;
-    PCB_TRACK          m_dummyTracks[2];
-    PCB_ARC            m_dummyArcs[2];
-    PCB_VIA            m_dummyVias[2];
     int                m_clearanceEpsilon;
 
-    std::map<std::pair<const PNS::ITEM*, const PNS::ITEM*>, int> m_clearanceCache;
-    std::map<std::pair<const PNS::ITEM*, const PNS::ITEM*>, int> m_holeClearanceCache;
-    std::map<std::pair<const PNS::ITEM*, const PNS::ITEM*>, int> m_holeToHoleClearanceCache;
+    /// Unique across all resolvers, so that a thread can't mistake the state it last used for
+    /// one of a resolver which used to live at the same address.
+    uint64_t           m_generation;
+
+    std::mutex                                                m_threadStatesMutex;
+    std::map<std::thread::id, std::unique_ptr<THREAD_STATE>>  m_threadStates;
 };
 
 
 PNS_PCBNEW_RULE_RESOLVER::PNS_PCBNEW_RULE_RESOLVER( BOARD* aBoard,
                                                     PNS::ROUTER_IFACE* aRouterIface ) :
     m_routerIface( aRouterIface ),
-    m_board( aBoard ),
-    m_dummyTracks{ { aBoard }, { aBoard } },
-    m_dummyArcs{ { aBoard }, { aBoard } },
-    m_dummyVias{ { aBoard }, { aBoard } }
+    m_board( aBoard )
 {
+    static std::atomic<uint64_t> s_nextGeneration( 1 );
+
+    m_generation = s_nextGeneration.fetch_add( 1, std::memory_order_relaxed );
+
     if( aBoard )
         m_clearanceEpsilon = aBoard->GetDesignSettings().GetDRCEpsilon();
     else
@@ -141,6 +193,31 @@ PNS_PCBNEW_RULE_RESOLVER::~PNS_PCBNEW_RULE_RESOLVER()
 }
 
 
+PNS_PCBNEW_RULE_RESOLVER::THREAD_STATE& PNS_PCBNEW_RULE_RESOLVER::threadState()
+{
+    struct LAST_STATE
+    {
+        uint64_t      generation;
+        THREAD_STATE* state;
+    };
+
+    thread_local LAST_STATE last = { 0, nullptr };
+
+    if( last.generation == m_generation )
+        return *last.state;
+
+    std::lock_guard<std::mutex> lock( m_threadStatesMutex );
+
+    std::unique_ptr<THREAD_STATE>& state = m_threadStates[ std::this_thread::get_id() ];
+
+    if( !state )
+        state = std::make_unique<THREAD_STATE>( m_board );
+
+    last = { m_generation, state.get() };
+    return *state;
+}
+
+
 int PNS_PCBNEW_RULE_RESOLVER::holeRadius( const PNS::ITEM* aItem ) const
 {
     if( aItem->Kind() == PNS::ITEM::SOLID_T )
@@ -231,6 +308,7 @@ bool PNS_PCBNEW_RULE_RESOLVER::QueryConstraint( PNS::CONSTRAINT_TYPE aType,
     default:                                      return false; // should not happen
     }
 
+    THREAD_STATE&  state = threadState();
     BOARD_ITEM*    parentA = aItemA ? aItemA->Parent() : nullptr;
     BOARD_ITEM*    parentB = aItemB ? aItemB->Parent() : nullptr;
     DRC_CONSTRAINT hostConstraint;
@@ -240,10 +318,10 @@ bool PNS_PCBNEW_RULE_RESOLVER::QueryConstraint( PNS::CONSTRAINT_TYPE aType,
     {
         switch( aItemA->Kind() )
         {
-        case PNS::ITEM::ARC_T:     parentA = &m_dummyArcs[0];   break;
-        case PNS::ITEM::VIA_T:     parentA = &m_dummyVias[0];   break;
-        case PNS::ITEM::SEGMENT_T: parentA = &m_dummyTracks[0]; break;
-        case PNS::ITEM::LINE_T:    parentA = &m_dummyTracks[0]; break;
+        case PNS::ITEM::ARC_T:     parentA = &state.dummyArcs[0];   break;
+        case PNS::ITEM::VIA_T:     parentA = &state.dummyVias[0];   break;
+        case PNS::ITEM::SEGMENT_T: parentA = &state.dummyTracks[0]; break;
+        case PNS::ITEM::LINE_T:    parentA = &state.dummyTracks[0]; break;
         default: break;
         }
 
@@ -258,10 +336,10 @@ bool PNS_PCBNEW_RULE_RESOLVER::QueryConstraint( PNS::CONSTRAINT_TYPE aType,
     {
         switch( aItemB->Kind() )
         {
-        case PNS::ITEM::ARC_T:     parentB = &m_dummyArcs[1];   break;
-        case PNS::ITEM::VIA_T:     parentB = &m_dummyVias[1];   break;
-        case PNS::ITEM::SEGMENT_T: parentB = &m_dummyTracks[1]; break;
-        case PNS::ITEM::LINE_T:    parentB = &m_dummyTracks[1]; break;
+        case PNS::ITEM::ARC_T:     parentB = &state.dummyArcs[1];   break;
+        case PNS::ITEM::VIA_T:     parentB = &state.dummyVias[1];   break;
+        case PNS::ITEM::SEGMENT_T: parentB = &state.dummyTracks[1]; break;
+        case PNS::ITEM::LINE_T:    parentB = &state.dummyTracks[1]; break;
         default: break;
         }
 
@@ -301,26 +379,71 @@ bool PNS_PCBNEW_RULE_RESOLVER::QueryConstraint( PNS::CONSTRAINT_TYPE aType,
 
 void PNS_PCBNEW_RULE_RESOLVER::ClearCacheForItem( const PNS::ITEM* aItem )
 {
-    m_clearanceCache.erase( std::make_pair( aItem, nullptr ) );
+    // Called between routing operations, while no walk is using the thread states
+    std::lock_guard<std::mutex> lock( m_threadStatesMutex );
+
+    for( std::pair<const std::thread::id, std::unique_ptr<THREAD_STATE>>& state : m_threadStates )
+        state.second->clearanceCache.erase( std::make_pair( aItem, nullptr ) );
+}
+
+
+static int clearanceLayer( const PNS::ITEM* aA, const PNS::ITEM* aB )
+{
+    if( !aA->Layers().IsMultilayer() || !aB || aB->Layers().IsMultilayer() )
+        return aA->Layer();
+    else
+        return aB->Layer();
+}
+
+
+int* PNS_PCBNEW_RULE_RESOLVER::clearanceSlot( THREAD_STATE& aState,
+                                              std::map<ITEM_PAIR, int>& aItemCache,
+                                              PNS::CONSTRAINT_TYPE aType, const PNS::ITEM* aA,
+                                              const PNS::ITEM* aB, int aLayer, bool& aFound )
+{
+    if( aA->Parent() && ( !aB || aB->Parent() ) )
+    {
+        auto ins = aItemCache.emplace( ITEM_PAIR( aA, aB ), 0 );
+        aFound = !ins.second;
+        return &ins.first->second;
+    }
+
+    // A parentless item is evaluated as one of the dummy items, which only get its net and
+    // layer.  Lines are evaluated as tracks.
+    auto itemKind =
+            []( const PNS::ITEM* aItem )
+            {
+                if( !aItem || aItem->Parent() )
+                    return 0;
+
+                return aItem->Kind() == PNS::ITEM::LINE_T ? (int) PNS::ITEM::SEGMENT_T
+                                                          : (int) aItem->Kind();
+            };
+
+    NET_PAIR_KEY key( (int) aType, aLayer,
+                      aA->Parent(), itemKind( aA ), aA->Parent() ? 0 : aA->Net(),
+                      aB ? aB->Parent() : nullptr, itemKind( aB ),
+                      aB && !aB->Parent() ? aB->Net() : 0 );
+
+    auto ins = aState.netPairCache.emplace( key, 0 );
+    aFound = !ins.second;
+    return &ins.first->second;
 }
 
 
 int PNS_PCBNEW_RULE_RESOLVER::Clearance( const PNS::ITEM* aA, const PNS::ITEM* aB )
 {
-    std::pair<const PNS::ITEM*, const PNS::ITEM*> key( aA, aB );
-    auto it = m_clearanceCache.find( key );
+    THREAD_STATE& state = threadState();
+    int           layer = clearanceLayer( aA, aB );
+    bool          found;
+    int*          slot = clearanceSlot( state, state.clearanceCache,
+                                        PNS::CONSTRAINT_TYPE::CT_CLEARANCE, aA, aB, layer, found );
 
-    if( it != m_clearanceCache.end() )
-        return it->second;
+    if( found )
+        return *slot;
 
     PNS::CONSTRAINT constraint;
     int rv = 0;
-    int layer;
-
-    if( !aA->Layers().IsMultilayer() || !aB || aB->Layers().IsMultilayer() )
-        layer = aA->Layer();
-    else
-        layer = aB->Layer();
 
     if( isCopper( aA ) && ( !aB || isCopper( aB ) ) )
     {
@@ -337,57 +460,53 @@ int PNS_PCBNEW_RULE_RESOLVER::Clearance( const PNS::ITEM* aA, const PNS::ITEM* a
         }
     }
 
-    m_clearanceCache[ key ] = rv;
+    *slot = rv;
     return rv;
 }
 
 
 int PNS_PCBNEW_RULE_RESOLVER::HoleClearance( const PNS::ITEM* aA, const PNS::ITEM* aB )
 {
-    std::pair<const PNS::ITEM*, const PNS::ITEM*> key( aA, aB );
-    auto it = m_holeClearanceCache.find( key );
+    THREAD_STATE& state = threadState();
+    int           layer = clearanceLayer( aA, aB );
+    bool          found;
+    int*          slot = clearanceSlot( state, state.holeClearanceCache,
+                                        PNS::CONSTRAINT_TYPE::CT_HOLE_CLEARANCE, aA, aB, layer,
+                                        found );
 
-    if( it != m_holeClearanceCache.end() )
-        return it->second;
+    if( found )
+        return *slot;
 
     PNS::CONSTRAINT constraint;
     int rv = 0;
-    int layer;
-
-    if( !aA->Layers().IsMultilayer() || !aB || aB->Layers().IsMultilayer() )
-        layer = aA->Layer();
-    else
-        layer = aB->Layer();
 
     if( QueryConstraint( PNS::CONSTRAINT_TYPE::CT_HOLE_CLEARANCE, aA, aB, layer, &constraint ) )
         rv = constraint.m_Value.Min() - m_clearanceEpsilon;
 
-    m_holeClearanceCache[ key ] = rv;
+    *slot = rv;
     return rv;
 }
 
 
 int PNS_PCBNEW_RULE_RESOLVER::HoleToHoleClearance( const PNS::ITEM* aA, const PNS::ITEM* aB )
 {
-    std::pair<const PNS::ITEM*, const PNS::ITEM*> key( aA, aB );
-    auto it = m_holeToHoleClearanceCache.find( key );
+    THREAD_STATE& state = threadState();
+    int           layer = clearanceLayer( aA, aB );
+    bool          found;
+    int*          slot = clearanceSlot( state, state.holeToHoleClearanceCache,
+                                        PNS::CONSTRAINT_TYPE::CT_HOLE_TO_HOLE, aA, aB, layer,
+                                        found );
 
-    if( it != m_holeToHoleClearanceCache.end() )
-        return it->second;
+    if( found )
+        return *slot;
 
     PNS::CONSTRAINT constraint;
     int rv = 0;
-    int layer;
-
-    if( !aA->Layers().IsMultilayer() || !aB || aB->Layers().IsMultilayer() )
-        layer = aA->Layer();
-    else
-        layer = aB->Layer();
 
     if( QueryConstraint( PNS::CONSTRAINT_TYPE::CT_HOLE_TO_HOLE, aA, aB, layer, &constraint ) )
         rv = constraint.m_Value.Min() - m_clearanceEpsilon;
 
-    m_holeToHoleClearanceCache[ key ] = rv;
+    *slot = rv;
     return rv;
 }
 
@@ -1502,18 +1621,14 @@ void PNS_KICAD_IFACE_BASE::UpdateItem( PNS::ITEM* aItem )
 }
 
 
-void PNS_KICAD_IFACE::UpdateItem( PNS::ITEM* aItem )
+void PNS_KICAD_IFACE_BASE::updateBoardItem( PNS::ITEM* aItem, BOARD_ITEM* aBoardItem )
 {
-    BOARD_ITEM* board_item = aItem->Parent();
-
-    m_commit->Modify( board_item );
-
     switch( aItem->Kind() )
     {
     case PNS::ITEM::ARC_T:
     {
         PNS::ARC*        arc = static_cast<PNS::ARC*>( aItem );
-        PCB_ARC*         arc_board = static_cast<PCB_ARC*>( board_item );
+        PCB_ARC*         arc_board = static_cast<PCB_ARC*>( aBoardItem );
         const SHAPE_ARC* arc_shape = static_cast<const SHAPE_ARC*>( arc->Shape() );
         arc_board->SetStart( wxPoint( arc_shape->GetP0() ) );
         arc_board->SetEnd( wxPoint( arc_shape->GetP1() ) );
@@ -1525,7 +1640,7 @@ void PNS_KICAD_IFACE::UpdateItem( PNS::ITEM* aItem )
     case PNS::ITEM::SEGMENT_T:
     {
         PNS::SEGMENT* seg = static_cast<PNS::SEGMENT*>( aItem );
-        PCB_TRACK*    track = static_cast<PCB_TRACK*>( board_item );
+        PCB_TRACK*    track = static_cast<PCB_TRACK*>( aBoardItem );
         const SEG&    s = seg->Seg();
         track->SetStart( wxPoint( s.A.x, s.A.y ) );
         track->SetEnd( wxPoint( s.B.x, s.B.y ) );
@@ -1535,7 +1650,7 @@ void PNS_KICAD_IFACE::UpdateItem( PNS::ITEM* aItem )
 
     case PNS::ITEM::VIA_T:
     {
-        PCB_VIA*  via_board = static_cast<PCB_VIA*>( board_item );
+        PCB_VIA*  via_board = static_cast<PCB_VIA*>( aBoardItem );
         PNS::VIA* via = static_cast<PNS::VIA*>( aItem );
         via_board->SetPosition( wxPoint( via->Pos().x, via->Pos().y ) );
         via_board->SetWidth( via->Diameter() );
@@ -1548,18 +1663,29 @@ void PNS_KICAD_IFACE::UpdateItem( PNS::ITEM* aItem )
         break;
     }
 
-    case PNS::ITEM::SOLID_T:
+    default:
+        break;
+    }
+}
+
+
+void PNS_KICAD_IFACE::UpdateItem( PNS::ITEM* aItem )
+{
+    BOARD_ITEM* board_item = aItem->Parent();
+
+    m_commit->Modify( board_item );
+
+    if( aItem->Kind() == PNS::ITEM::SOLID_T )
     {
         PAD*     pad = static_cast<PAD*>( aItem->Parent() );
         VECTOR2I pos = static_cast<PNS::SOLID*>( aItem )->Pos();
 
         m_fpOffsets[ pad ].p_old = pad->GetPosition();
         m_fpOffsets[ pad ].p_new = pos;
-        break;
     }
-
-    default:
-        break;
+    else
+    {
+        updateBoardItem( aItem, board_item );
     }
 }
 
@@ -1570,10 +1696,8 @@ void PNS_KICAD_IFACE_BASE::AddItem( PNS::ITEM* aItem )
 }
 
 
-void PNS_KICAD_IFACE::AddItem( PNS::ITEM* aItem )
+BOARD_CONNECTED_ITEM* PNS_KICAD_IFACE_BASE::createBoardItem( PNS::ITEM* aItem )
 {
-    BOARD_CONNECTED_ITEM* newBI = nullptr;
-
     switch( aItem->Kind() )
     {
     case PNS::ITEM::ARC_T:
@@ -1583,8 +1707,7 @@ void PNS_KICAD_IFACE::AddItem( PNS::ITEM* aItem )
         new_arc->SetWidth( arc->Width() );
         new_arc->SetLayer( ToLAYER_ID( arc->Layers().Start() ) );
         new_arc->SetNetCode( std::max<int>( 0, arc->Net() ) );
-        newBI = new_arc;
-        break;
+        return new_arc;
     }
 
     case PNS::ITEM::SEGMENT_T:
@@ -1597,27 +1720,25 @@ void PNS_KICAD_IFACE::AddItem( PNS::ITEM* aItem )
         track->SetWidth( seg->Width() );
         track->SetLayer( ToLAYER_ID( seg->Layers().Start() ) );
         track->SetNetCode( seg->Net() > 0 ? seg->Net() : 0 );
-        newBI = track;
-        break;
+        return track;
     }
 
     case PNS::ITEM::VIA_T:
     {
-        PCB_VIA*  via_board = new PCB_VIA( m_board );
-        PNS::VIA* via = static_cast<PNS::VIA*>( aItem );
-        via_board->SetPosition( wxPoint( via->Pos().x, via->Pos().y ) );
-        via_board->SetWidth( via->Diameter() );
-        via_board->SetDrill( via->Drill() );
-        via_board->SetNetCode( via->Net() > 0 ? via->Net() : 0 );
-        via_board->SetViaType( via->ViaType() ); // MUST be before SetLayerPair()
-        via_board->SetIsFree( via->IsFree() );
-        via_board->SetLayerPair( ToLAYER_ID( via->Layers().Start() ),
-                                 ToLAYER_ID( via->Layers().End() ) );
-        newBI = via_board;
-        break;
+        PCB_VIA* via_board = new PCB_VIA( m_board );
+        updateBoardItem( aItem, via_board );
+        return via_board;
     }
 
-    case PNS::ITEM::SOLID_T:
+    default:
+        return nullptr;
+    }
+}
+
+
+void PNS_KICAD_IFACE::AddItem( PNS::ITEM* aItem )
+{
+    if( aItem->Kind() == PNS::ITEM::SOLID_T )
     {
         PAD*   pad = static_cast<PAD*>( aItem->Parent() );
         VECTOR2I pos = static_cast<PNS::SOLID*>( aItem )->Pos();
@@ -1626,11 +1747,7 @@ void PNS_KICAD_IFACE::AddItem( PNS::ITEM* aItem )
         return;
     }
 
-    default:
-        break;
-    }
-
-    if( newBI )
+    if( BOARD_CONNECTED_ITEM* newBI = createBoardItem( aItem ) )
     {
         //newBI->SetLocalRatsnestVisible( m_dispOptions->m_ShowGlobalRatsnest );
         aItem->SetParent( newBI );
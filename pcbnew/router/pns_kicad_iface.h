@@ -31,6 +31,7 @@ class PNS_PCBNEW_DEBUG_DECORATOR;
 
 class BOARD;
 class BOARD_COMMIT;
+class BOARD_CONNECTED_ITEM;
 class PCB_DISPLAY_OPTIONS;
 class PCB_TOOL_BASE;
 class FOOTPRINT;
@@ -96,6 +97,12 @@ protected:
     bool syncZone( PNS::NODE* aWorld, ZONE* aZone, SHAPE_POLY_SET* aBoardOutline );
     bool inheritTrackWidth( PNS::ITEM* aItem, int* aInheritedWidth );
 
+    ///< Create a board track, arc or via matching \a aItem, not yet added to the board.
+    BOARD_CONNECTED_ITEM* createBoardItem( PNS::ITEM* aItem );
+
+    ///< Copy the geometry of track, arc or via \a aItem to its board counterpart.
+    void updateBoardItem( PNS::ITEM* aItem, BOARD_ITEM* aBoardItem );
+
 protected:
     PNS::NODE* m_world;
     BOARD*     m_board;
@@ -201,6 +201,7 @@ public:
     virtual void Mark( int aMarker ) const override;
     virtual void Unmark( int aMarker = -1 ) const override;
     virtual int Marker() const override;
+    virtual void AddMarker( int aMarker ) const override { Mark( Marker() | aMarker ); }
 
     void SetBlockingObstacle( ITEM* aObstacle ) { m_blockingObstacle = aObstacle; }
     ITEM* GetBlockingObstacle() const { return m_blockingObstacle; }
@@ -772,22 +772,18 @@ bool LINE_PLACER::rhShoveOnly( const VECTOR2I& aP, LINE& aNewHead )
 
     m_currentNode = m_shove->CurrentNode();
 
-    if( status == SHOVE::SH_OK  || status == SHOVE::SH_HEAD_MODIFIED )
+    if( m_shove->HasPendingShove() )
     {
-        if( status == SHOVE::SH_HEAD_MODIFIED )
-            l2 = m_shove->NewHead();
-
-        optimizer.SetWorld( m_currentNode );
-
-        int effortLevel = OPTIMIZER::MERGE_OBTUSE;
-
-        if( Settings().SmartPads() && !m_mouseTrailTracer.IsManuallyForced() )
-            effortLevel = OPTIMIZER::SMART_PADS;
-
-        optimizer.SetEffortLevel( effortLevel );
+        // Out of time: the shove keeps the world of its last completed shove, and routeStep()
+        // the head that goes with it, which is the best state so far.  Refine() finishes the
+        // job if the cursor stays here.
+        m_refineHead = l2;
+        m_refineEnd = aP;
+    }
 
-        optimizer.SetCollisionMask( ITEM::ANY_T );
-        optimizer.Optimize( &l2 );
+    if( status == SHOVE::SH_OK  || status == SHOVE::SH_HEAD_MODIFIED )
+    {
+        optimizeShovedHead( l2, status == SHOVE::SH_HEAD_MODIFIED );
 
         aNewHead = l2;
 
@@ -809,6 +805,25 @@ bool LINE_PLACER::rhShoveOnly( const VECTOR2I& aP, LINE& aNewHead )
 }
 
 
+void LINE_PLACER::optimizeShovedHead( LINE& aHead, bool aHeadModified )
+{
+    if( aHeadModified )
+        aHead = m_shove->NewHead();
+
+    OPTIMIZER optimizer( m_currentNode );
+
+    int effortLevel = OPTIMIZER::MERGE_OBTUSE;
+
+    if( Settings().SmartPads() && !m_mouseTrailTracer.IsManuallyForced() )
+        effortLevel = OPTIMIZER::SMART_PADS;
+
+    optimizer.SetEffortLevel( effortLevel );
+
+    optimizer.SetCollisionMask( ITEM::ANY_T );
+    optimizer.Optimize( &aHead );
+}
+
+
 bool LINE_PLACER::routeHead( const VECTOR2I& aP, LINE& aNewHead )
 {
     switch( Settings().Mode() )
@@ -1205,12 +1220,7 @@ void LINE_PLACER::initPlacement()
 
 bool LINE_PLACER::Move( const VECTOR2I& aP, ITEM* aEndItem )
 {
-    LINE current;
     VECTOR2I p = aP;
-    int eiDepth = -1;
-
-    if( aEndItem && aEndItem->Owner() )
-        eiDepth = static_cast<NODE*>( aEndItem->Owner() )->Depth();
 
     if( m_lastNode )
     {
@@ -1222,7 +1232,20 @@ bool LINE_PLACER::Move( const VECTOR2I& aP, ITEM* aEndItem )
 
     bool reachesEnd = route( p );
 
-    current = Trace();
+    updateLastNode( reachesEnd );
+
+    m_mouseTrailTracer.AddTrailPoint( aP );
+    return true;
+}
+
+
+void LINE_PLACER::updateLastNode( bool aReachesEnd )
+{
+    LINE current = Trace();
+    int  eiDepth = -1;
+
+    if( m_endItem && m_endItem->Owner() )
+        eiDepth = static_cast<NODE*>( m_endItem->Owner() )->Depth();
 
     if( !current.PointCount() )
         m_currentEnd = m_p_start;
@@ -1232,19 +1255,64 @@ bool LINE_PLACER::Move( const VECTOR2I& aP, ITEM* aEndItem )
     NODE* latestNode = m_currentNode;
     m_lastNode = latestNode->Branch();
 
-    if( reachesEnd
+    if( aReachesEnd
             && eiDepth >= 0
-            && aEndItem && latestNode->Depth() >= eiDepth
+            && m_endItem && latestNode->Depth() >= eiDepth
             && current.SegmentCount() )
     {
-        SplitAdjacentSegments( m_lastNode, aEndItem, current.CPoint( -1 ) );
+        SplitAdjacentSegments( m_lastNode, m_endItem, current.CPoint( -1 ) );
 
         if( Settings().RemoveLoops() )
             removeLoops( m_lastNode, current );
     }
 
     updateLeadingRatLine();
-    m_mouseTrailTracer.AddTrailPoint( aP );
+}
+
+
+bool LINE_PLACER::RefinementPending() const
+{
+    return m_shove && m_shove->HasPendingShove();
+}
+
+
+bool LINE_PLACER::Refine()
+{
+    if( !RefinementPending() )
+        return false;
+
+    // The postprocessed state is a branch of the best state so far, which the shove drops
+    // once it completes if the head no longer needs it
+    if( m_lastNode )
+    {
+        delete m_lastNode;
+        m_lastNode = nullptr;
+    }
+
+    SHOVE::SHOVE_STATUS status = m_shove->ResumeShove();
+
+    if( status != SHOVE::SH_OK && status != SHOVE::SH_HEAD_MODIFIED )
+    {
+        // Still pending or failed: keep the best state so far
+        updateLastNode( m_head.PointCount() && m_head.CPoint( -1 ) == m_refineEnd );
+        return false;
+    }
+
+    LINE newHead( m_refineHead );
+
+    m_currentNode = m_shove->CurrentNode();
+
+    optimizeShovedHead( newHead, status == SHOVE::SH_HEAD_MODIFIED );
+
+    // Same as a successful routeStep(), minus the retries needed to follow the mouse trail
+    m_head = newHead;
+    m_last_head = m_head;
+
+    if( Settings().FollowMouse() && !optimizeTailHeadTransition() )
+        mergeHead();
+
+    updateLastNode( m_head.PointCount() && m_head.CPoint( -1 ) == m_refineEnd );
+
     return true;
 }
 
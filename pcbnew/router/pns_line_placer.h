@@ -98,6 +98,17 @@ public:
      */
     bool Move( const VECTOR2I& aP, ITEM* aEndItem ) override;
 
+    /**
+     * Resume the shove of the last Move() if it ran out of time, and adopt its result once it
+     * completes.  Until then, the trace stays the best one so far: the one of the last move
+     * whose shove completed.
+     *
+     * @return true if the routed trace has changed.
+     */
+    bool Refine() override;
+
+    bool RefinementPending() const override;
+
     /**
      * Commit the currently routed track to the parent node taking \a aP as the final end point
      * and \a aEndItem as the final anchor (if provided).
@@ -220,6 +231,14 @@ private:
      */
     void updateLeadingRatLine();
 
+    /**
+     * Update the current end and rebuild the postprocessed world state from the current one
+     * after routing the trace.
+     *
+     * @param aReachesEnd true if the trace has reached the end item.
+     */
+    void updateLastNode( bool aReachesEnd );
+
     /**
      * Set the board to route.
      */
@@ -313,6 +332,9 @@ private:
     ///< Route step shove mode.
     bool rhShoveOnly( const VECTOR2I& aP, LINE& aNewHead );
 
+    ///< Optimize the head of the trace after a successful shove.
+    void optimizeShovedHead( LINE& aHead, bool aHeadModified );
+
     ///< Route step mark obstacles mode.
     bool rhMarkObstacles( const VECTOR2I& aP, LINE& aNewHead );
 
@@ -337,6 +359,9 @@ private:
 
     std::unique_ptr<SHOVE> m_shove; ///< The shove engine
 
+    LINE           m_refineHead;    ///< head of the trace being shoved by a suspended shove
+    VECTOR2I       m_refineEnd;     ///< routing destination of the suspended shove
+
     NODE*          m_currentNode;   ///< Current world state
     NODE*          m_lastNode;      ///< Postprocessed world state (including marked collisions &
                                     ///< removed loops)
@@ -30,6 +30,15 @@
 
 namespace PNS {
 
+std::atomic<bool> MEANDERED_LINE::s_fitMemo( true );
+
+
+void MEANDERED_LINE::SetFitMemo( bool aMemo )
+{
+    s_fitMemo = aMemo;
+}
+
+
 const MEANDER_SETTINGS& MEANDER_SHAPE::Settings() const
 {
     return m_placer->MeanderSettings();
@@ -58,6 +67,7 @@ void MEANDERED_LINE::MeanderSegment( const SEG& aBase, bool aSide, int aBaseInde
     bool started = false;
 
     m_last = aBase.A;
+    m_fitCache.clear();
 
     do
     {
@@ -65,6 +75,7 @@ void MEANDERED_LINE::MeanderSegment( const SEG& aBase, bool aSide, int aBaseInde
 
         m.SetBaselineOffset( m_baselineOffset );
         m.SetBaseIndex( aBaseIndex );
+        m.m_line = this;
 
         double thr = (double) m.spacing();
 
@@ -429,6 +440,29 @@ bool MEANDERED_LINE::CheckSelfIntersections( MEANDER_SHAPE* aShape, int aClearan
 }
 
 
+bool MEANDERED_LINE::CheckFit( MEANDER_SHAPE* aShape )
+{
+    if( !CheckSelfIntersections( aShape, aShape->Width() + Settings().m_spacing ) )
+        return false;
+
+    if( !s_fitMemo )
+        return m_placer->CheckFit( aShape );
+
+    FIT_KEY key( aShape->Type(), aShape->Side(), aShape->m_p0.x, aShape->m_p0.y,
+                 aShape->Amplitude() );
+
+    auto it = m_fitCache.find( key );
+
+    if( it != m_fitCache.end() )
+        return it->second;
+
+    bool fits = m_placer->CheckFit( aShape );
+
+    m_fitCache[key] = fits;
+    return fits;
+}
+
+
 bool MEANDER_SHAPE::Fit( MEANDER_TYPE aType, const SEG& aSeg, const VECTOR2I& aP, bool aSide )
 {
     const MEANDER_SETTINGS& st = Settings();
@@ -456,6 +490,8 @@ bool MEANDER_SHAPE::Fit( MEANDER_TYPE aType, const SEG& aSeg, const VECTOR2I& aP
 
         m1.SetBaselineOffset( m_baselineOffset );
         m2.SetBaselineOffset( m_baselineOffset );
+        m1.m_line = m_line;
+        m2.m_line = m_line;
 
         bool c1 = m1.Fit( prim1, aSeg, aP, aSide );
         bool c2 = false;
@@ -516,7 +552,7 @@ bool MEANDER_SHAPE::Fit( MEANDER_TYPE aType, const SEG& aSeg, const VECTOR2I& aP
 
         updateBaseSegment();
 
-        if( m_placer->CheckFit( this ) )
+        if( m_line ? m_line->CheckFit( this ) : m_placer->CheckFit( this ) )
             return true;
     }
 
@@ -627,6 +663,7 @@ void MEANDER_SHAPE::MakeArc( const SHAPE_ARC& aArc1, const SHAPE_ARC& aArc2 )
 
 void MEANDERED_LINE::AddMeander( MEANDER_SHAPE* aShape )
 {
+    aShape->m_line = nullptr;
     m_last = aShape->BaseSegment().B;
     m_meanders.push_back( aShape );
 }
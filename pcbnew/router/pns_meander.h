@@ -23,6 +23,11 @@
 #ifndef __PNS_MEANDER_H
 #define __PNS_MEANDER_H
 
+#include <atomic>
+#include <map>
+#include <tuple>
+#include <vector>
+
 #include <math/vector2d.h>
 
 #include <geometry/shape.h>
@@ -129,6 +134,7 @@ public:
         m_baseIndex = 0;
         m_currentTarget = nullptr;
         m_meanCornerRadius = 0;
+        m_line = nullptr;
     }
 
     /**
@@ -376,6 +382,9 @@ private:
 
     ///< The line the turtle is drawing on.
     SHAPE_LINE_CHAIN* m_currentTarget;
+
+    ///< The meandered line the meander is being fitted to, if any.
+    MEANDERED_LINE* m_line;
 };
 
 
@@ -500,20 +509,45 @@ public:
      */
     bool CheckSelfIntersections( MEANDER_SHAPE* aShape, int aClearance );
 
+    /**
+     * Check if the given shape can be placed on the current line: it must not collide with the
+     * board, nor with the other meanders of the line.  The outcome of the board check is
+     * memoized for the segment being meandered, as the meanders fitted next to each other
+     * check the same turns several times.
+     *
+     * @param aShape the shape to check.
+     * @return true, if the shape fits.
+     */
+    bool CheckFit( MEANDER_SHAPE* aShape );
+
+    /**
+     * Choose whether the board checks of CheckFit() are memoized (the default).  Both give the
+     * same meanders; this is for counting the board checks the memo saves.
+     */
+    static void SetFitMemo( bool aMemo );
+
     /**
      * @return the current meandering settings.
      */
     const MEANDER_SETTINGS& Settings() const;
 
 private:
+    ///< Type, side, start point and amplitude of a meander fitted on the current segment.
+    typedef std::tuple<int, bool, int, int, int> FIT_KEY;
+
     VECTOR2I m_last;
 
     MEANDER_PLACER_BASE* m_placer;
     std::vector<MEANDER_SHAPE*> m_meanders;
 
+    ///< Memoized board checks of the meanders fitted on the current segment.
+    std::map<FIT_KEY, bool> m_fitCache;
+
     bool m_dual;
     int m_width;
     int m_baselineOffset;
+
+    static std::atomic<bool> s_fitMemo;
 };
 
 }
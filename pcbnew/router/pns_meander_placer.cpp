@@ -239,13 +239,7 @@ bool MEANDER_PLACER::CheckFit( MEANDER_SHAPE* aShape )
 {
     LINE l( m_originLine, aShape->CLine( 0 ) );
 
-    if( m_currentNode->CheckColliding( &l ) )
-        return false;
-
-    int w = aShape->Width();
-    int clearance = w + m_settings.m_spacing;
-
-    return m_result.CheckSelfIntersections( aShape, clearance );
+    return !m_currentNode->CheckColliding( &l );
 }
 
 
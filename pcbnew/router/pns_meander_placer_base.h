@@ -101,8 +101,8 @@ public:
     virtual void UpdateSettings( const MEANDER_SETTINGS& aSettings);
 
     /**
-     * Checks if it's OK to place the shape aShape (i.e. if it doesn't cause DRC violations
-     * or collide with other meanders).
+     * Checks if it's OK to place the shape aShape (i.e. if it doesn't cause DRC violations).
+     * Collisions with the other meanders are checked by MEANDERED_LINE::CheckFit().
      *
      * @param aShape the shape to check.
      * @return true if the shape fits.
@@ -20,6 +20,8 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <atomic>
+#include <mutex>
 #include <vector>
 #include <cassert>
 #include <utility>
@@ -31,6 +33,8 @@
 
 #include <wx/log.h>
 
+#include <hash_eda.h>
+
 #include "pns_arc.h"
 #include "pns_item.h"
 #include "pns_itemset.h"
@@ -48,19 +52,38 @@
 namespace PNS {
 
 #ifdef DEBUG
+// several routers may allocate nodes at once (see ROUTER::SetThreadInstance())
 static std::unordered_set<NODE*> allocNodes;
+static std::mutex                allocNodesMutex;
 #endif
 
+static std::atomic<int64_t> s_createdNodes( 0 );
+static std::atomic<int64_t> s_liveNodes( 0 );
+static std::atomic<int64_t> s_peakLiveNodes( 0 );
+
 NODE::NODE()
 {
     m_depth = 0;
     m_root = this;
     m_parent = nullptr;
+    m_base = nullptr;
+    m_baseDepth = 0;
     m_maxClearance = 800000;    // fixme: depends on how thick traces are.
     m_ruleResolver = nullptr;
     m_index = new INDEX;
+    m_revision = 0;
+    m_uid = s_createdNodes.fetch_add( 1, std::memory_order_relaxed ) + 1;
+
+    int64_t live = s_liveNodes.fetch_add( 1, std::memory_order_relaxed ) + 1;
+    int64_t peak = s_peakLiveNodes.load( std::memory_order_relaxed );
+
+    while( live > peak
+           && !s_peakLiveNodes.compare_exchange_weak( peak, live, std::memory_order_relaxed ) )
+    {
+    }
 
 #ifdef DEBUG
+    std::lock_guard<std::mutex> lock( allocNodesMutex );
     allocNodes.insert( this );
 #endif
 }
@@ -75,13 +98,17 @@ NODE::~NODE()
     }
 
 #ifdef DEBUG
-    if( allocNodes.find( this ) == allocNodes.end() )
     {
-        wxLogTrace( "PNS", "attempting to free an already-free'd node." );
-        assert( false );
-    }
+        std::lock_guard<std::mutex> lock( allocNodesMutex );
+
+        if( allocNodes.find( this ) == allocNodes.end() )
+        {
+            wxLogTrace( "PNS", "attempting to free an already-free'd node." );
+            assert( false );
+        }
 
-    allocNodes.erase( this );
+        allocNodes.erase( this );
+    }
 #endif
 
     m_joints.clear();
@@ -96,6 +123,33 @@ NODE::~NODE()
     unlinkParent();
 
     delete m_index;
+
+    s_liveNodes.fetch_sub( 1, std::memory_order_relaxed );
+}
+
+
+int64_t NODE::GetCreatedCount()
+{
+    return s_createdNodes.load( std::memory_order_relaxed );
+}
+
+
+int64_t NODE::GetLiveCount()
+{
+    return s_liveNodes.load( std::memory_order_relaxed );
+}
+
+
+int64_t NODE::GetPeakLiveCount()
+{
+    return s_peakLiveNodes.load( std::memory_order_relaxed );
+}
+
+
+void NODE::ResetPeakLiveCount()
+{
+    s_peakLiveNodes.store( s_liveNodes.load( std::memory_order_relaxed ),
+                           std::memory_order_relaxed );
 }
 
 
@@ -135,6 +189,12 @@ int NODE::GetHoleToHoleClearance( const ITEM* aA, const ITEM* aB ) const
 }
 
 
+void NODE::SetUseGridIndex( bool aUseGrid )
+{
+    m_index->SetUseGrid( aUseGrid );
+}
+
+
 NODE* NODE::Branch()
 {
     NODE* child = new NODE;
@@ -143,31 +203,90 @@ NODE* NODE::Branch()
 
     child->m_depth = m_depth + 1;
     child->m_parent = this;
+    child->m_base = this;
+    child->m_baseDepth = m_baseDepth + 1;
     child->m_ruleResolver = m_ruleResolver;
     child->m_root = isRoot() ? this : m_root;
     child->m_maxClearance = m_maxClearance;
+    child->m_index->SetUseGrid( m_index->UsesGrid() );
 
-    // Immediate offspring of the root branch needs not copy anything. For the rest, deep-copy
-    // joints, overridden item maps and pointers to stored items.
-    if( !isRoot() )
+    // Nothing is copied: the child shares the items and joints of its ancestors, and only
+    // stores what changes in it.  Queries walk the chain of base nodes though, so past a few
+    // levels the child gets a copy of the branch state and is based on the root again.
+    if( child->m_baseDepth > MAX_BASE_DEPTH )
+        child->flatten();
+
+    return child;
+}
+
+
+void NODE::detachChildren()
+{
+    if( isRoot() )
+        return;
+
+    for( NODE* child : m_children )
     {
-        JOINT_MAP::iterator j;
+        if( child->m_base == this )
+            child->flatten();
+    }
+}
 
-        for( ITEM* item : *m_index )
-            child->m_index->Add( item );
 
-        child->m_joints = m_joints;
-        child->m_override = m_override;
+void NODE::flatten()
+{
+    touch();
+
+    std::unordered_set<JOINT::HASH_TAG, JOINT::JOINT_TAG_HASH> tags;
+
+    for( const TagJointPair& j : m_joints )
+        tags.insert( j.first );
+
+    for( NODE* node = m_base; node && !node->isRoot(); node = node->m_base )
+    {
+        for( ITEM* item : *node->m_index )
+        {
+            if( !Overrides( item ) )
+                m_index->Add( item );
+        }
+
+        // Joints stored nearer this node hide the ones with the same tag further up
+        for( const TagJointPair& j : node->m_joints )
+        {
+            if( !tags.count( j.first ) )
+                m_joints.insert( j );
+        }
+
+        for( const TagJointPair& j : node->m_joints )
+            tags.insert( j.first );
     }
 
-#if 0
-    wxLogTrace( "PNS", "%d items, %d joints, %d overrides",
-                child->m_index->Size(),
-                (int) child->m_joints.size(),
-                (int) child->m_override.size() );
-#endif
+    std::unordered_set<ITEM*> overrides;
 
-    return child;
+    for( NODE* node = this; node; node = node->m_base )
+    {
+        for( ITEM* item : node->m_override )
+        {
+            if( m_root->m_index->Contains( item ) )
+                overrides.insert( item );
+        }
+    }
+
+    m_override = std::move( overrides );
+    m_base = m_root;
+    m_baseDepth = 1;
+}
+
+
+bool NODE::Overrides( ITEM* aItem ) const
+{
+    for( const NODE* node = this; node; node = node->m_base )
+    {
+        if( node->m_override.find( aItem ) != node->m_override.end() )
+            return true;
+    }
+
+    return false;
 }
 
 
@@ -210,6 +329,7 @@ bool OBSTACLE_VISITOR::visit( ITEM* aCandidate )
 struct NODE::DEFAULT_OBSTACLE_VISITOR : public OBSTACLE_VISITOR
 {
     OBSTACLES& m_tab;
+    NODE*      m_world;             ///< node the query is made on, holding the collision memo
 
     int        m_kindMask;          ///<  (solids, vias, segments, etc...)
     int        m_limitCount;
@@ -220,6 +340,7 @@ struct NODE::DEFAULT_OBSTACLE_VISITOR : public OBSTACLE_VISITOR
                               bool aDifferentNetsOnly ) :
         OBSTACLE_VISITOR( aItem ),
         m_tab( aTab ),
+        m_world( nullptr ),
         m_kindMask( aKindMask ),
         m_limitCount( -1 ),
         m_matchCount( 0 ),
@@ -244,7 +365,10 @@ struct NODE::DEFAULT_OBSTACLE_VISITOR : public OBSTACLE_VISITOR
         if( visit( aCandidate ) )
             return true;
 
-        if( !aCandidate->Collide( m_item, m_node, m_differentNetsOnly ) )
+        COLLISION_RESULT collision = m_world->collideMemoized( aCandidate, m_item,
+                                                               m_differentNetsOnly );
+
+        if( !collision.collides )
             return true;
 
         OBSTACLE obs;
@@ -252,6 +376,8 @@ struct NODE::DEFAULT_OBSTACLE_VISITOR : public OBSTACLE_VISITOR
         obs.m_item = aCandidate;
         obs.m_head = m_item;
         obs.m_distFirst = INT_MAX;
+        obs.m_itemHole = collision.holeObstacle;
+        obs.m_headHole = collision.holeItem;
         m_tab.push_back( obs );
 
         m_matchCount++;
@@ -264,6 +390,113 @@ struct NODE::DEFAULT_OBSTACLE_VISITOR : public OBSTACLE_VISITOR
 };
 
 
+bool NODE::COLLISION_KEY::operator==( const COLLISION_KEY& aOther ) const
+{
+    return obstacle == aOther.obstacle && parent == aOther.parent && kind == aOther.kind
+           && net == aOther.net && layerStart == aOther.layerStart
+           && layerEnd == aOther.layerEnd && a == aOther.a && b == aOther.b
+           && width == aOther.width && holeRadius == aOther.holeRadius
+           && differentNetsOnly == aOther.differentNetsOnly;
+}
+
+
+std::size_t NODE::COLLISION_KEY_HASH::operator()( const COLLISION_KEY& aKey ) const
+{
+    return hash_val( aKey.obstacle, aKey.net, aKey.a.x, aKey.a.y, aKey.b.x, aKey.b.y,
+                     aKey.width, aKey.layerStart );
+}
+
+
+NODE::COLLISION_RESULT NODE::collideMemoized( const ITEM* aObstacle, const ITEM* aItem,
+                                              bool aDifferentNetsOnly )
+{
+    auto directTest =
+            [&]()
+            {
+                COLLISION        collision = aObstacle->TestCollision( aItem, this,
+                                                                      aDifferentNetsOnly );
+                COLLISION_RESULT result;
+
+                result.collides = collision.collides;
+                result.holeObstacle = collision.holeA != nullptr;
+                result.holeItem = collision.holeB != nullptr;
+                return result;
+            };
+
+    COLLISION_KEY key;
+
+    // Only segments and vias are memoized: they are what shove and optimizer test over and over,
+    // and a few scalars describe them fully.  Lines also test their vias, see ITEM::Collide().
+    if( const SEGMENT* seg = dyn_cast<const SEGMENT*>( aItem ) )
+    {
+        key.a = seg->Seg().A;
+        key.b = seg->Seg().B;
+        key.width = seg->Width();
+        key.holeRadius = 0;
+    }
+    else if( const VIA* via = dyn_cast<const VIA*>( aItem ) )
+    {
+        key.a = via->Pos();
+        key.b = via->Pos();
+        key.width = via->Diameter();
+        key.holeRadius = via->Hole()->GetRadius();
+    }
+    else
+    {
+        return directTest();
+    }
+
+    key.obstacle = aObstacle;
+    key.parent = aItem->Parent();
+    key.kind = aItem->Kind();
+    key.net = aItem->Net();
+    key.layerStart = aItem->Layers().Start();
+    key.layerEnd = aItem->Layers().End();
+    key.differentNetsOnly = aDifferentNetsOnly;
+
+    // Each thread keeps the memos of the nodes it queried last, so that concurrent queries (see
+    // WALKAROUND) don't contend for them
+    thread_local COLLISION_MEMO memos[COLLISION_MEMO_NODES];
+    thread_local uint64_t       useCount = 0;
+
+    COLLISION_MEMO* memo = &memos[0];
+
+    for( COLLISION_MEMO& candidate : memos )
+    {
+        if( candidate.nodeUid == m_uid )
+        {
+            memo = &candidate;
+            break;
+        }
+
+        if( candidate.lastUse < memo->lastUse )
+            memo = &candidate;
+    }
+
+    if( memo->nodeUid != m_uid || memo->revision != m_revision
+            || memo->rootRevision != m_root->m_revision
+            || memo->results.size() > 100000 / COLLISION_MEMO_NODES )
+    {
+        memo->results.clear();
+        memo->nodeUid = m_uid;
+        memo->revision = m_revision;
+        memo->rootRevision = m_root->m_revision;
+    }
+
+    memo->lastUse = ++useCount;
+
+    auto it = memo->results.find( key );
+
+    if( it != memo->results.end() )
+        return it->second;
+
+    COLLISION_RESULT result = directTest();
+
+    memo->results.emplace( key, result );
+    return result;
+}
+
+
 int NODE::QueryColliding( const ITEM* aItem, NODE::OBSTACLES& aObstacles, int aKindMask,
                           int aLimitCount, bool aDifferentNetsOnly )
 {
@@ -274,20 +507,26 @@ int NODE::QueryColliding( const ITEM* aItem, NODE::OBSTACLES& aObstacles, int aK
     DEFAULT_OBSTACLE_VISITOR visitor( aObstacles, aItem, aKindMask, aDifferentNetsOnly );
 
 #ifdef DEBUG
-    assert( allocNodes.find( this ) != allocNodes.end() );
+    {
+        std::lock_guard<std::mutex> lock( allocNodesMutex );
+        assert( allocNodes.find( this ) != allocNodes.end() );
+    }
 #endif
 
     visitor.SetCountLimit( aLimitCount );
     visitor.SetWorld( this, nullptr );
+    visitor.m_world = this;
 
     // first, look for colliding items in the local index
     m_index->Query( aItem, m_maxClearance, visitor );
 
-    // if we haven't found enough items, look in the root branch as well.
-    if( !isRoot() && ( visitor.m_matchCount < aLimitCount || aLimitCount < 0 ) )
+    // if we haven't found enough items, look in the branches this one is based on as well.
+    for( NODE* node = m_base;
+         node && ( visitor.m_matchCount < aLimitCount || aLimitCount < 0 );
+         node = node->m_base )
     {
-        visitor.SetWorld( m_root, this );
-        m_root->m_index->Query( aItem, m_maxClearance, visitor );
+        visitor.SetWorld( node, this );
+        node->m_index->Query( aItem, m_maxClearance, visitor );
     }
 
     return aObstacles.size();
@@ -329,8 +568,10 @@ NODE::OPT_OBSTACLE NODE::NearestObstacle( const LINE* aLine, int aKindMask,
                     nearest.m_item = obstacle;
                     nearest.m_hull = hull;
 
-                    obstacle->Mark( isHole ? obstacle->Marker() | MK_HOLE
-                                           : obstacle->Marker() & ~MK_HOLE );
+                    if( isHole )
+                        obstacle->AddMarker( MK_HOLE );
+                    else
+                        obstacle->Unmark( MK_HOLE );
                 }
             };
 
@@ -526,14 +767,14 @@ const ITEM_SET NODE::HitTest( const VECTOR2I& aPoint ) const
 
     m_index->Query( &s, m_maxClearance, visitor );
 
-    if( !isRoot() )    // fixme: could be made cleaner
+    for( NODE* node = m_base; node; node = node->m_base )
     {
-        ITEM_SET items_root;
-        visitor.SetWorld( m_root, nullptr );
-        HIT_VISITOR  visitor_root( items_root, aPoint );
-        m_root->m_index->Query( &s, m_maxClearance, visitor_root );
+        ITEM_SET items_base;
+        HIT_VISITOR  visitor_base( items_base, aPoint );
+        visitor_base.SetWorld( node, nullptr );
+        node->m_index->Query( &s, m_maxClearance, visitor_base );
 
-        for( ITEM* item : items_root.Items() )
+        for( ITEM* item : items_base.Items() )
         {
             if( !Overrides( item ) )
                 items.Add( item );
@@ -546,6 +787,9 @@ const ITEM_SET NODE::HitTest( const VECTOR2I& aPoint ) const
 
 void NODE::addSolid( SOLID* aSolid )
 {
+    detachChildren();
+    touch();
+
     if( aSolid->IsRoutable() )
         linkJoint( aSolid->Pos(), aSolid->Layers(), aSolid->Net(), aSolid );
 
@@ -562,6 +806,9 @@ void NODE::Add( std::unique_ptr< SOLID > aSolid )
 
 void NODE::addVia( VIA* aVia )
 {
+    detachChildren();
+    touch();
+
     linkJoint( aVia->Pos(), aVia->Layers(), aVia->Net(), aVia );
 
     m_index->Add( aVia );
@@ -629,6 +876,9 @@ void NODE::Add( LINE& aLine, bool aAllowRedundant )
 
 void NODE::addSegment( SEGMENT* aSeg )
 {
+    detachChildren();
+    touch();
+
     linkJoint( aSeg->Seg().A, aSeg->Layers(), aSeg->Net(), aSeg );
     linkJoint( aSeg->Seg().B, aSeg->Layers(), aSeg->Net(), aSeg );
 
@@ -656,6 +906,9 @@ bool NODE::Add( std::unique_ptr< SEGMENT > aSegment, bool aAllowRedundant )
 
 void NODE::addArc( ARC* aArc )
 {
+    detachChildren();
+    touch();
+
     linkJoint( aArc->Anchor( 0 ), aArc->Layers(), aArc->Net(), aArc );
     linkJoint( aArc->Anchor( 1 ), aArc->Layers(), aArc->Net(), aArc );
 
@@ -701,16 +954,17 @@ void NODE::Add( std::unique_ptr< ITEM > aItem, bool aAllowRedundant )
 
 void NODE::doRemove( ITEM* aItem )
 {
-    // case 1: removing an item that is stored in the root node from any branch:
-    // mark it as overridden, but do not remove
-    if( aItem->BelongsTo( m_root ) && !isRoot() )
-        m_override.insert( aItem );
+    touch();
 
-    // case 2: the item belongs to this branch or a parent, non-root branch,
-    // or the root itself and we are the root: remove from the index
-    else if( !aItem->BelongsTo( m_root ) || isRoot() )
+    // case 1: the item is stored in this branch: remove it from the index
+    if( m_index->Contains( aItem ) || isRoot() )
         m_index->Remove( aItem );
 
+    // case 2: removing an item stored in a branch this one is based on (or in the root):
+    // mark it as overridden, but do not remove
+    else
+        m_override.insert( aItem );
+
     // the item belongs to this particular branch: un-reference it
     if( aItem->BelongsTo( this ) )
     {
@@ -747,6 +1001,9 @@ void NODE::rebuildJoint( JOINT* aJoint, ITEM* aItem )
     tag.net = net;
     tag.pos = aJoint->Pos();
 
+    // the joint may still be shared with the branches this one is based on
+    localizeJoints( tag );
+
     bool split;
 
     do
@@ -815,6 +1072,7 @@ void NODE::Replace( LINE& aOldLine, LINE& aNewLine )
 
 void NODE::Remove( SOLID* aSolid )
 {
+    detachChildren();
     removeSolidIndex( aSolid );
     doRemove( aSolid );
 }
@@ -822,6 +1080,7 @@ void NODE::Remove( SOLID* aSolid )
 
 void NODE::Remove( VIA* aVia )
 {
+    detachChildren();
     removeViaIndex( aVia );
     doRemove( aVia );
 }
@@ -829,6 +1088,7 @@ void NODE::Remove( VIA* aVia )
 
 void NODE::Remove( SEGMENT* aSegment )
 {
+    detachChildren();
     removeSegmentIndex( aSegment );
     doRemove( aSegment );
 }
@@ -836,6 +1096,7 @@ void NODE::Remove( SEGMENT* aSegment )
 
 void NODE::Remove( ARC* aArc )
 {
+    detachChildren();
     removeArcIndex( aArc );
     doRemove( aArc );
 }
@@ -1147,10 +1408,11 @@ JOINT* NODE::FindJoint( const VECTOR2I& aPos, int aLayer, int aNet )
 
     JOINT_MAP::iterator f = m_joints.find( tag ), end = m_joints.end();
 
-    if( f == end && !isRoot() )
+    // joints not touched in this branch are shared with the nearest branch storing them
+    for( NODE* node = m_base; f == end && node; node = node->m_base )
     {
-        end = m_root->m_joints.end();
-        f = m_root->m_joints.find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
+        end = node->m_joints.end();
+        f = node->m_joints.find( tag );
     }
 
     if( f == end )
@@ -1170,6 +1432,8 @@ JOINT* NODE::FindJoint( const VECTOR2I& aPos, int aLayer, int aNet )
 
 void NODE::LockJoint( const VECTOR2I& aPos, const ITEM* aItem, bool aLock )
 {
+    detachChildren();
+
     JOINT& jt = touchJoint( aPos, aItem->Layers(), aItem->Net() );
     jt.Lock( aLock );
 }
@@ -1182,20 +1446,12 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     tag.pos = aPos;
     tag.net = aNet;
 
-    // try to find the joint in this node.
-    JOINT_MAP::iterator f = m_joints.find( tag );
+    // not found in this node? copy the joints from the nearest branch storing them.
+    localizeJoints( tag );
 
+    JOINT_MAP::iterator f;
     std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range;
 
-    // not found and we are not root? find in the root and copy results here.
-    if( f == m_joints.end() && !isRoot() )
-    {
-        range = m_root->m_joints.equal_range( tag );
-
-        for( f = range.first; f != range.second; ++f )
-            m_joints.insert( *f );
-    }
-
     // now insert and combine overlapping joints
     JOINT jt( aPos, aLayers, aNet );
 
@@ -1226,6 +1482,27 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
 }
 
 
+void NODE::localizeJoints( const JOINT::HASH_TAG& aTag )
+{
+    if( m_joints.find( aTag ) != m_joints.end() )
+        return;
+
+    for( NODE* node = m_base; node; node = node->m_base )
+    {
+        std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range =
+                node->m_joints.equal_range( aTag );
+
+        if( range.first == range.second )
+            continue;
+
+        for( JOINT_MAP::iterator f = range.first; f != range.second; ++f )
+            m_joints.insert( *f );
+
+        return;
+    }
+}
+
+
 void JOINT::Dump() const
 {
     wxLogTrace( "PNS", "joint layers %d-%d, net %d, pos %s, links: %d",
@@ -1341,17 +1618,34 @@ void NODE::GetUpdatedItems( ITEM_VECTOR& aRemoved, ITEM_VECTOR& aAdded )
     if( isRoot() )
         return;
 
-    if( m_override.size() )
-        aRemoved.reserve( m_override.size() );
+    for( NODE* node = this; node; node = node->m_base )
+    {
+        for( ITEM* item : node->m_override )
+        {
+            if( m_root->m_index->Contains( item ) )
+                aRemoved.push_back( item );
+        }
+    }
 
-    if( m_index->Size() )
-        aAdded.reserve( m_index->Size() );
+    collectBranchItems( aAdded );
+}
+
+
+void NODE::collectBranchItems( ITEM_VECTOR& aItems )
+{
+    aItems.reserve( aItems.size() + m_index->Size() );
 
-    for( ITEM* item : m_override )
-        aRemoved.push_back( item );
+    for( ITEM* item : *m_index )
+        aItems.push_back( item );
 
-    for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
-        aAdded.push_back( *i );
+    for( NODE* node = m_base; node && !node->isRoot(); node = node->m_base )
+    {
+        for( ITEM* item : *node->m_index )
+        {
+            if( !Overrides( item ) )
+                aItems.push_back( item );
+        }
+    }
 }
 
 
@@ -1388,10 +1682,15 @@ void NODE::Commit( NODE* aNode )
     if( aNode->isRoot() )
         return;
 
-    for( ITEM* item : aNode->m_override )
+    ITEM_VECTOR removed;
+    ITEM_VECTOR added;
+
+    aNode->GetUpdatedItems( removed, added );
+
+    for( ITEM* item : removed )
         Remove( item );
 
-    for( ITEM* item : *aNode->m_index )
+    for( ITEM* item : added )
     {
         item->SetRank( -1 );
         item->Unmark();
@@ -1422,13 +1721,13 @@ void NODE::AllItemsInNet( int aNet, std::set<ITEM*>& aItems, int aKindMask )
         }
     }
 
-    if( !isRoot() )
+    for( NODE* node = m_base; node; node = node->m_base )
     {
-        INDEX::NET_ITEMS_LIST* l_root = m_root->m_index->GetItemsForNet( aNet );
+        INDEX::NET_ITEMS_LIST* l_base = node->m_index->GetItemsForNet( aNet );
 
-        if( l_root )
+        if( l_base )
         {
-            for( ITEM* item : *l_root )
+            for( ITEM* item : *l_base )
             {
                 if( !Overrides( item ) && item->OfKind( aKindMask ) && item->IsRoutable() )
                     aItems.insert( item );
@@ -1440,7 +1739,10 @@ void NODE::AllItemsInNet( int aNet, std::set<ITEM*>& aItems, int aKindMask )
 
 void NODE::ClearRanks( int aMarkerMask )
 {
-    for( ITEM* item : *m_index )
+    ITEM_VECTOR items;
+    collectBranchItems( items );
+
+    for( ITEM* item : items )
     {
         item->SetRank( -1 );
         item->Mark( item->Marker() & ~aMarkerMask );
@@ -1450,9 +1752,12 @@ void NODE::ClearRanks( int aMarkerMask )
 
 void NODE::RemoveByMarker( int aMarker )
 {
+    ITEM_VECTOR        items;
     std::vector<ITEM*> garbage;
 
-    for( ITEM* item : *m_index )
+    collectBranchItems( items );
+
+    for( ITEM* item : items )
     {
         if( item->Marker() & aMarker )
             garbage.emplace_back( item );
@@ -1540,31 +1845,28 @@ int NODE::QueryJoints( const BOX2I& aBox, std::vector<JOINT*>& aJoints, LAYER_RA
 
     aJoints.clear();
 
-    for( JOINT_MAP::value_type& j : m_joints )
-    {
-        if( !j.second.Layers().Overlaps( aLayerMask ) )
-            continue;
+    std::unordered_set<JOINT::HASH_TAG, JOINT::JOINT_TAG_HASH> tags;
 
-        if( aBox.Contains( j.second.Pos() ) && j.second.LinkCount( aKindMask ) )
+    for( NODE* node = this; node; node = node->m_base )
+    {
+        // Joints stored nearer this node hide the ones with the same tag further up
+        for( JOINT_MAP::value_type& j : node->m_joints )
         {
-            aJoints.push_back( &j.second );
-            n++;
-        }
-    }
+            if( node != this && tags.count( j.first ) )
+                continue;
 
-    if( isRoot() )
-        return n;
+            if( !j.second.Layers().Overlaps( aLayerMask ) )
+                continue;
 
-    for( JOINT_MAP::value_type& j : m_root->m_joints )
-    {
-        if( !Overrides( &j.second ) && j.second.Layers().Overlaps( aLayerMask ) )
-        {
             if( aBox.Contains( j.second.Pos() ) && j.second.LinkCount( aKindMask ) )
             {
                 aJoints.push_back( &j.second );
                 n++;
             }
         }
+
+        for( JOINT_MAP::value_type& j : node->m_joints )
+            tags.insert( j.first );
     }
 
     return n;
@@ -1577,14 +1879,21 @@ ITEM *NODE::FindItemByParent( const BOARD_ITEM* aParent )
     {
         const BOARD_CONNECTED_ITEM* cItem = static_cast<const BOARD_CONNECTED_ITEM*>( aParent );
 
-        INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( cItem->GetNetCode() );
-
-        if( l_cur )
+        for( NODE* node = this; node; node = node->m_base )
         {
-            for( ITEM* item : *l_cur )
+            // the root's items are only looked up from the root itself
+            if( node->isRoot() && node != this )
+                break;
+
+            INDEX::NET_ITEMS_LIST* l_cur = node->m_index->GetItemsForNet( cItem->GetNetCode() );
+
+            if( l_cur )
             {
-                if( item->Parent() == aParent )
-                    return item;
+                for( ITEM* item : *l_cur )
+                {
+                    if( item->Parent() == aParent && ( node == this || !Overrides( item ) ) )
+                        return item;
+                }
             }
         }
     }
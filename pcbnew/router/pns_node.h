@@ -25,6 +25,7 @@
 
 #include <vector>
 #include <list>
+#include <unordered_map>
 #include <unordered_set>
 #include <core/minoptmax.h>
 
@@ -109,6 +110,8 @@ struct OBSTACLE
     SHAPE_LINE_CHAIN m_hull;        ///< Hull of the colliding m_item
     VECTOR2I         m_ipFirst;     ///< First intersection between m_head and m_hull
     int              m_distFirst;   ///< ... and the distance thereof
+    bool             m_itemHole = false;    ///< m_item collides through its hole
+    bool             m_headHole = false;    ///< m_head collides through its hole
 };
 
 class OBSTACLE_VISITOR
@@ -170,6 +173,12 @@ public:
         m_maxClearance = aClearance;
     }
 
+    /**
+     * Index the items of this node and of its future branches in uniform grids instead of
+     * R-Trees.  Must be called while the node is still empty.
+     */
+    void SetUseGridIndex( bool aUseGrid );
+
     ///< Assign a clearance resolution function object.
     void SetRuleResolver( RULE_RESOLVER* aFunc )
     {
@@ -193,9 +202,36 @@ public:
         return m_depth;
     }
 
+    ///< Return (an upper bound of) the number of nodes queries on this one walk through before
+    ///< reaching the root.  Branching copies the state of the base nodes into branches that
+    ///< would be deeper than MAX_BASE_DEPTH.
+    int BaseDepth() const
+    {
+        return m_baseDepth;
+    }
+
+    static const int MAX_BASE_DEPTH = 8;
+
+    ///< Return the number of nodes (roots and branches) created so far, for profiling.
+    static int64_t GetCreatedCount();
+
+    ///< Return the number of nodes currently allocated, for profiling.
+    static int64_t GetLiveCount();
+
+    ///< Return the most nodes allocated at once since the last ResetPeakLiveCount().
+    static int64_t GetPeakLiveCount();
+
+    ///< Restart tracking the peak of GetPeakLiveCount() from the nodes allocated now.
+    static void ResetPeakLiveCount();
+
     /**
      * Find items colliding (closer than clearance) with the item \a aItem.
      *
+     * The outcome of each collision test of a segment or a via is memoized by the calling thread,
+     * for this node and a few others, until the contents of the node or of the root change, as
+     * shove and optimizer iterations repeat the same tests many times.  Unlike ITEM::Collide(), the query doesn't mark the
+     * items colliding through their hole; the obstacles tell it instead.
+     *
      * @param aItem item to check collisions against
      * @param aObstacles set of colliding objects found
      * @param aKindMask mask of obstacle types to take into account
@@ -292,6 +328,10 @@ public:
      * Create a lightweight copy (called branch) of self that tracks the changes (added/removed
      * items) wrs to the root.
      *
+     * Branching is O(1): the branch shares the items and joints of this node and of its
+     * ancestors, and stores only what changes in it. Modifying a non-root node that has
+     * branches copies its state into them first.
+     *
      * @note If there are any branches in use, their parents must **not** be deleted.
      *
      * @return the new branch.
@@ -380,11 +420,9 @@ public:
         return m_parent;
     }
 
-    ///< Check if this branch contains an updated version of the m_item from the root branch.
-    bool Overrides( ITEM* aItem ) const
-    {
-        return m_override.find( aItem ) != m_override.end();
-    }
+    ///< Check if this branch contains an updated version of the m_item from the root branch
+    ///< or from one of the branches it is based on.
+    bool Overrides( ITEM* aItem ) const;
 
     void FixupVirtualVias();
 
@@ -421,6 +459,18 @@ private:
     void releaseGarbage();
     void rebuildJoint( JOINT* aJoint, ITEM* aItem );
 
+    ///< Copy the joints with tag \a aTag from the nearest base node, if this one has none.
+    void localizeJoints( const JOINT::HASH_TAG& aTag );
+
+    ///< Make the branches based on this node independent of it, before it is modified.
+    void detachChildren();
+
+    ///< Copy the items and joints of the non-root base nodes into this one.
+    void flatten();
+
+    ///< Append the items visible in this branch that are not stored in the root.
+    void collectBranchItems( ITEM_VECTOR& aItems );
+
     bool isRoot() const
     {
         return m_parent == nullptr;
@@ -440,6 +490,63 @@ private:
 
 private:
     struct DEFAULT_OBSTACLE_VISITOR;
+
+    ///< Memoized collision test: the obstacle, and the properties of the tested segment or via
+    ///< the outcome depends on.
+    struct COLLISION_KEY
+    {
+        bool operator==( const COLLISION_KEY& aOther ) const;
+
+        const ITEM*       obstacle;
+        const BOARD_ITEM* parent;
+        int               kind;
+        int               net;
+        int               layerStart;
+        int               layerEnd;
+        VECTOR2I          a;                  ///< segment start or via position
+        VECTOR2I          b;                  ///< segment end
+        int               width;              ///< segment width or via diameter
+        int               holeRadius;
+        bool              differentNetsOnly;
+    };
+
+    struct COLLISION_KEY_HASH
+    {
+        std::size_t operator()( const COLLISION_KEY& aKey ) const;
+    };
+
+    struct COLLISION_RESULT
+    {
+        bool collides;
+        bool holeObstacle;                    ///< the obstacle collides through its hole
+        bool holeItem;                        ///< the tested item collides through its hole
+    };
+
+    ///< A collision memo of a thread, for the node and revisions it was built at.
+    struct COLLISION_MEMO
+    {
+        uint64_t nodeUid = 0;
+        uint64_t revision = 0;
+        uint64_t rootRevision = 0;
+        uint64_t lastUse = 0;                 ///< for evicting the least recently used memo
+        std::unordered_map<COLLISION_KEY, COLLISION_RESULT, COLLISION_KEY_HASH> results;
+    };
+
+    ///< Number of nodes each thread keeps a collision memo for.  Shove and optimizer go back
+    ///< and forth between a node and its branches, which would flush a single memo every time.
+    static const int COLLISION_MEMO_NODES = 8;
+
+    /**
+     * Test \a aItem against \a aObstacle, through the collision memo the calling thread keeps
+     * for this node when possible.  May be called from several threads at once; the items are
+     * not marked.
+     */
+    COLLISION_RESULT collideMemoized( const ITEM* aObstacle, const ITEM* aItem,
+                                      bool aDifferentNetsOnly );
+
+    ///< Mark the contents of this node as changed, invalidating the collision memos.
+    void touch() { m_revision++; }
+
     typedef std::unordered_multimap<JOINT::HASH_TAG, JOINT, JOINT::JOINT_TAG_HASH> JOINT_MAP;
     typedef JOINT_MAP::value_type TagJointPair;
 
@@ -448,10 +555,13 @@ private:
 
     NODE*           m_parent;           ///< node this node was branched from
     NODE*           m_root;             ///< root node of the whole hierarchy
+    NODE*           m_base;             ///< node the changes of this one are relative to
+                                        ///< (the parent, or the root once detached)
+    int             m_baseDepth;        ///< length of the chain of base nodes
     std::set<NODE*> m_children;         ///< list of nodes branched from this one
 
-    std::unordered_set<ITEM*> m_override;   ///< hash of root's items that have been changed
-                                            ///< in this node
+    std::unordered_set<ITEM*> m_override;   ///< hash of the base nodes' items that have been
+                                            ///< changed in this node
 
     int             m_maxClearance;     ///< worst case item-item clearance
     RULE_RESOLVER*  m_ruleResolver;     ///< Design rules resolver
@@ -460,6 +570,9 @@ private:
                                         ///< inheritance chain)
 
     std::unordered_set<ITEM*> m_garbageItems;
+
+    uint64_t        m_revision;         ///< incremented by every change of the contents
+    uint64_t        m_uid;              ///< never reused, tells the collision memos apart
 };
 
 }
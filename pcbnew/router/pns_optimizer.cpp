@@ -25,6 +25,8 @@
 
 #include <cmath>
 
+#include <hash_eda.h>
+
 #include "pns_arc.h"
 #include "pns_line.h"
 #include "pns_diff_pair.h"
@@ -109,6 +111,15 @@ bool COST_ESTIMATOR::IsBetter( const COST_ESTIMATOR& aOther, double aLengthToler
 }
 
 
+std::atomic<bool> OPTIMIZER::s_incrementalCosts( true );
+
+
+void OPTIMIZER::SetIncrementalCosts( bool aIncremental )
+{
+    s_incrementalCosts = aIncremental;
+}
+
+
 OPTIMIZER::OPTIMIZER( NODE* aWorld ) :
     m_world( aWorld ),
     m_collisionKindMask( ITEM::ANY_T ),
@@ -151,9 +162,20 @@ struct OPTIMIZER::CACHE_VISITOR
 };
 
 
+std::size_t OPTIMIZER::PATH_HASH::operator()( const std::vector<VECTOR2I>& aPath ) const
+{
+    std::size_t seed = aPath.size();
+
+    for( const VECTOR2I& p : aPath )
+        hash_combine( seed, p.x, p.y );
+
+    return seed;
+}
+
+
 void OPTIMIZER::cacheAdd( ITEM* aItem, bool aIsStatic = false )
 {
-    if( m_cacheTags.find( aItem ) != m_cacheTags.end() )
+    if( m_cacheTags.find( aItem ) != m_cacheTags.end() || m_cache.Size() >= MaxCachedItems )
         return;
 
     m_cache.Add( aItem );
@@ -197,12 +219,16 @@ void OPTIMIZER::ClearCache( bool aStaticOnly )
         return;
     }
 
-    for( auto i = m_cacheTags.begin(); i!= m_cacheTags.end(); ++i )
+    for( auto i = m_cacheTags.begin(); i != m_cacheTags.end(); )
     {
         if( i->second.m_isStatic )
         {
             m_cache.Remove( i->first );
-            m_cacheTags.erase( i->first );
+            i = m_cacheTags.erase( i );
+        }
+        else
+        {
+            ++i;
         }
     }
 }
@@ -408,9 +434,31 @@ bool KEEP_TOPOLOGY_CONSTRAINT::Check( int aVertex1, int aVertex2, const LINE* aO
 
 bool OPTIMIZER::checkColliding( ITEM* aItem, bool aUpdateCache )
 {
+    // The solids which have blocked an earlier attempt are likely to block this one too, and
+    // are much cheaper to test than the whole world.  They don't move while we optimize.
     CACHE_VISITOR v( aItem, m_world, m_collisionKindMask );
+    int           margin = m_world->GetMaxClearance();
+
+    if( aItem->Kind() == ITEM::LINE_T )
+        margin += static_cast<LINE*>( aItem )->Width() / 2;
+
+    m_cache.Query( aItem->Shape(), margin, v, false );
+
+    if( v.m_collidingItem )
+    {
+        m_cacheTags[v.m_collidingItem].m_hits++;
+        return true;
+    }
+
+    NODE::OPT_OBSTACLE obs = m_world->CheckColliding( aItem );
+
+    if( !obs )
+        return false;
+
+    if( aUpdateCache && obs->m_item->Kind() == ITEM::SOLID_T )
+        cacheAdd( obs->m_item, true );
 
-    return static_cast<bool>( m_world->CheckColliding( aItem ) );
+    return true;
 }
 
 
@@ -445,9 +493,25 @@ bool OPTIMIZER::checkConstraints( int aVertex1, int aVertex2, LINE* aOriginLine,
 
 bool OPTIMIZER::checkColliding( LINE* aLine, const SHAPE_LINE_CHAIN& aOptPath )
 {
+    if( !s_incrementalCosts )
+    {
+        LINE tmp( *aLine, aOptPath );
+        return checkColliding( &tmp );
+    }
+
+    // Neither the world nor the line change while the line is optimized, so a path tried
+    // again by a later pass or step keeps its collision status.
+    auto memo = m_pathCollisions.find( aOptPath.CPoints() );
+
+    if( memo != m_pathCollisions.end() )
+        return memo->second;
+
     LINE tmp( *aLine, aOptPath );
+    bool colliding = checkColliding( &tmp );
 
-    return checkColliding( &tmp );
+    m_pathCollisions.emplace( aOptPath.CPoints(), colliding );
+
+    return colliding;
 }
 
 
@@ -501,9 +565,7 @@ bool OPTIMIZER::mergeObtuse( LINE* aLine )
                     opt_path.Append( s1opt.B );
                     opt_path.Append( s2opt.B );
 
-                    LINE opt_track( *aLine, opt_path );
-
-                    if( !checkColliding( &opt_track ) )
+                    if( !checkColliding( aLine, opt_path ) )
                     {
                         current_path.Replace( s1.Index() + 1, s2.Index(), ip );
 
@@ -620,6 +682,8 @@ bool OPTIMIZER::Optimize( LINE* aLine, LINE* aResult, LINE* aRoot )
     bool hasArcs = aLine->ArcCount();
     bool rv = false;
 
+    m_pathCollisions.clear();
+
     if( (m_effortLevel & LIMIT_CORNER_COUNT) && aRoot )
     {
         const int angleMask = DIRECTION_45::ANG_OBTUSE;
@@ -679,13 +743,28 @@ bool OPTIMIZER::Optimize( LINE* aLine, LINE* aResult, LINE* aRoot )
 
 bool OPTIMIZER::mergeStep( LINE* aLine, SHAPE_LINE_CHAIN& aCurrentPath, int step )
 {
-    int n_segs = aCurrentPath.SegmentCount();
-
-    int cost_orig = COST_ESTIMATOR::CornerCost( aCurrentPath );
+    int  n_segs = aCurrentPath.SegmentCount();
+    bool incremental = s_incrementalCosts;
 
     if( aLine->SegmentCount() < 2 )
         return false;
 
+    // cornerCost[i] is the cost of the corners at vertices 1 to i, so that the cost of a
+    // candidate path is the original one corrected by the corners of the replaced window only.
+    std::vector<int> cornerCost( n_segs + 1, 0 );
+
+    for( int i = 1; i < n_segs; i++ )
+    {
+        cornerCost[i] = cornerCost[i - 1]
+                        + COST_ESTIMATOR::CornerCost( aCurrentPath.CSegment( i - 1 ),
+                                                      aCurrentPath.CSegment( i ) );
+    }
+
+    if( n_segs > 0 )
+        cornerCost[n_segs] = cornerCost[n_segs - 1];
+
+    int cost_orig = cornerCost[n_segs];
+
     DIRECTION_45 orig_start( aLine->CSegment( 0 ) );
     DIRECTION_45 orig_end( aLine->CSegment( -1 ) );
 
@@ -702,43 +781,71 @@ bool OPTIMIZER::mergeStep( LINE* aLine, SHAPE_LINE_CHAIN& aCurrentPath, int step
         const SEG s1    = aCurrentPath.CSegment( n );
         const SEG s2    = aCurrentPath.CSegment( n + step );
 
-        SHAPE_LINE_CHAIN path[2];
+        // The corners affected by the replacement: from the start of s1 to the end of s2
+        int windowStart = std::max( n - 1, 0 );
+        int windowEnd = std::min( n + step + 1, n_segs - 1 );
+        int windowCost = cornerCost[windowEnd] - cornerCost[windowStart];
+
+        SHAPE_LINE_CHAIN bypass[2];
+        SHAPE_LINE_CHAIN path[2];             // the whole candidate paths, if not incremental
         SHAPE_LINE_CHAIN* picked = nullptr;
         int cost[2];
 
         for( int i = 0; i < 2; i++ )
         {
-            SHAPE_LINE_CHAIN bypass = DIRECTION_45().BuildInitialTrace( s1.A, s2.B, i );
+            bypass[i] = DIRECTION_45().BuildInitialTrace( s1.A, s2.B, i );
             cost[i] = INT_MAX;
 
             bool ok = false;
 
-            if( !checkColliding( aLine, bypass ) )
+            if( !checkColliding( aLine, bypass[i] ) )
             {
                 //printf("Chk-constraints: %d %d\n", n, n+step+1 );
-                ok = checkConstraints ( n, n + step + 1, aLine, aCurrentPath, bypass );
+                ok = checkConstraints ( n, n + step + 1, aLine, aCurrentPath, bypass[i] );
             }
 
-            if( ok )
+            if( ok && !incremental )
             {
                 path[i] = aCurrentPath;
-                path[i].Replace( s1.Index(), s2.Index(), bypass );
+                path[i].Replace( s1.Index(), s2.Index(), bypass[i] );
                 path[i].Simplify();
                 cost[i] = COST_ESTIMATOR::CornerCost( path[i] );
             }
+            else if( ok )
+            {
+                // The bypass along with its neighbouring segments, to account for the corners
+                // it makes with them
+                SHAPE_LINE_CHAIN window;
+
+                if( n > 0 )
+                    window.Append( aCurrentPath.CPoint( n - 1 ) );
+
+                window.Append( bypass[i] );
+
+                if( n + step + 2 < aCurrentPath.PointCount() )
+                    window.Append( aCurrentPath.CPoint( n + step + 2 ) );
+
+                window.Simplify();
+                cost[i] = cost_orig - windowCost + COST_ESTIMATOR::CornerCost( window );
+            }
         }
 
         if( cost[0] < cost_orig && cost[0] < cost[1] )
-            picked = &path[0];
+            picked = incremental ? &bypass[0] : &path[0];
         else if( cost[1] < cost_orig )
-            picked = &path[1];
+            picked = incremental ? &bypass[1] : &path[1];
 
-        if( picked )
+        if( picked && !incremental )
         {
-            n_segs = aCurrentPath.SegmentCount();
             aCurrentPath = *picked;
             return true;
         }
+        else if( picked )
+        {
+            aCurrentPath.Replace( s1.Index(), s2.Index(), *picked );
+            aCurrentPath.Simplify();
+            return true;
+        }
     }
 
     return false;
@@ -953,6 +1060,62 @@ int OPTIMIZER::smartPadsSingle( LINE* aLine, ITEM* aPad, bool aEnd, int aEndVert
     BREAKOUT_LIST    breakouts = computeBreakouts( aLine->Width(), aPad, true );
     SHAPE_LINE_CHAIN line = ( aEnd ? aLine->CLine().Reverse() : aLine->CLine() );
     int              p_end = std::min( aEndVertex, std::min( 3, line.PointCount() - 1 ) );
+    long long int    lineLength = line.Length();
+
+    // A variant only replaces the first vertices of the line, up to p.  The corners of the rest
+    // of the line are evaluated once: tailCost[i] and tailForbidden[i] are the cost and the
+    // number of forbidden corners at vertices i and above.  This takes the rest of the line to
+    // be left alone by Simplify(), as it is in a whole variant; if it isn't, the variants are
+    // built and costed in full.
+    SHAPE_LINE_CHAIN simplified( line );
+    simplified.Simplify();
+
+    bool             incremental = s_incrementalCosts
+                                   && simplified.PointCount() == line.PointCount();
+    std::vector<int> tailCost( line.PointCount() + 1, 0 );
+    std::vector<int> tailForbidden( line.PointCount() + 1, 0 );
+
+    for( int i = line.SegmentCount() - 1; incremental && i >= 1; i-- )
+    {
+        const SEG prev = line.CSegment( i - 1 );
+        const SEG next = line.CSegment( i );
+
+        tailCost[i] = tailCost[i + 1] + COST_ESTIMATOR::CornerCost( prev, next );
+        tailForbidden[i] = tailForbidden[i + 1]
+                           + ( ( DIRECTION_45( prev ).Angle( DIRECTION_45( next ) )
+                                 & ForbiddenAngles ) ? 1 : 0 );
+    }
+
+    // Likewise for the collisions of its segments, which are checked on demand:
+    // tailColliding[i] tells if any of the segments from i onwards collides.
+    std::vector<bool> tailColliding( line.SegmentCount() + 1, false );
+    int               tailChecked = line.SegmentCount();
+
+    auto tailCollides =
+            [&]( int aFirstSegment ) -> bool
+            {
+                if( aFirstSegment >= line.SegmentCount() )
+                    return false;
+
+                for( ; tailChecked > aFirstSegment; tailChecked-- )
+                {
+                    int i = tailChecked - 1;
+
+                    if( tailColliding[i + 1] )
+                    {
+                        tailColliding[i] = true;
+                        continue;
+                    }
+
+                    SHAPE_LINE_CHAIN seg;
+                    seg.Append( line.CSegment( i ).A );
+                    seg.Append( line.CSegment( i ).B );
+
+                    tailColliding[i] = checkColliding( aLine, seg );
+                }
+
+                return tailColliding[aFirstSegment];
+            };
 
     // Start at 1 to find a potentially better breakout (0 is the pad connection)
     for( int p = 1; p <= p_end; p++ )
@@ -982,24 +1145,33 @@ int OPTIMIZER::smartPadsSingle( LINE* aLine, ITEM* aPad, bool aEnd, int aEndVert
                 if( ang1 & ForbiddenAngles )
                     continue;
 
-                if( breakout.Length() > line.Length() )
+                if( breakout.Length() > lineLength )
                     continue;
 
                 v = breakout;
                 v.Append( connect );
 
-                for( int i = p + 1; i < line.PointCount(); i++ )
-                    v.Append( line.CPoint( i ) );
+                if( incremental )
+                {
+                    // The new start of the line, up to the end of the segment leaving vertex p
+                    if( p + 1 < line.PointCount() )
+                        v.Append( line.CPoint( p + 1 ) );
+                }
+                else
+                {
+                    for( int i = p + 1; i < line.PointCount(); i++ )
+                        v.Append( line.CPoint( i ) );
+                }
 
                 LINE tmp( *aLine, v );
-                int cc = tmp.CountCorners( ForbiddenAngles );
+                int cc = tmp.CountCorners( ForbiddenAngles ) + tailForbidden[p + 1];
 
                 if( cc == 0 )
                 {
                     RtVariant vp;
                     std::get<0>( vp ) = p;
                     std::get<1>( vp ) = breakout.Length();
-                    std::get<2>( vp ) = aEnd ? v.Reverse() : v;
+                    std::get<2>( vp ) = ( aEnd && !incremental ) ? v.Reverse() : v;
                     std::get<2>( vp ).Simplify();
                     variants.push_back( vp );
                 }
@@ -1020,16 +1192,21 @@ int OPTIMIZER::smartPadsSingle( LINE* aLine, ITEM* aPad, bool aEnd, int aEndVert
 
     for( RtVariant& vp : variants )
     {
-        LINE tmp( *aLine, std::get<2>( vp ) );
-        int cost = COST_ESTIMATOR::CornerCost( std::get<2>( vp ) );
+        int p = std::get<0>( vp );
+        int cost = COST_ESTIMATOR::CornerCost( std::get<2>( vp ) ) + tailCost[p + 1];
         long long int len = std::get<1>( vp );
 
-        if( !checkColliding( &tmp ) )
+        if( cost < min_cost || ( cost == min_cost && len > max_length ) )
         {
-            if( cost < min_cost || ( cost == min_cost && len > max_length ) )
+            bool colliding = checkColliding( aLine, std::get<2>( vp ) );
+
+            if( incremental && !colliding )
+                colliding = tailCollides( p + 1 );
+
+            if( !colliding )
             {
                 l_best = std::get<2>( vp );
-                p_best = std::get<0>( vp );
+                p_best = p;
                 found  = true;
 
                 if( cost <= min_cost )
@@ -1040,6 +1217,17 @@ int OPTIMIZER::smartPadsSingle( LINE* aLine, ITEM* aPad, bool aEnd, int aEndVert
         }
     }
 
+    if( found && incremental )
+    {
+        for( int i = p_best + 2; i < line.PointCount(); i++ )
+            l_best.Append( line.CPoint( i ) );
+
+        if( aEnd )
+            l_best = l_best.Reverse();
+
+        l_best.Simplify();
+    }
+
     if( found )
     {
         aLine->SetShape( l_best );
@@ -1127,7 +1315,7 @@ bool OPTIMIZER::fanoutCleanup( LINE* aLine )
             LINE repl;
             repl = LINE( *aLine, l2 );
 
-            if( !m_world->CheckColliding( &repl ) )
+            if( !checkColliding( &repl ) )
             {
                 aLine->SetShape( repl.CLine() );
                 return true;
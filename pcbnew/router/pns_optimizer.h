@@ -23,8 +23,10 @@
 #ifndef __PNS_OPTIMIZER_H
 #define __PNS_OPTIMIZER_H
 
+#include <atomic>
 #include <unordered_map>
 #include <memory>
+#include <vector>
 
 #include <geometry/shape_index_list.h>
 #include <geometry/shape_line_chain.h>
@@ -119,8 +121,19 @@ public:
     bool Optimize( LINE* aLine, LINE* aResult = nullptr, LINE* aRoot = nullptr );
     bool Optimize( DIFF_PAIR* aPair );
 
+    /**
+     * Choose whether candidate paths are costed from the parts they change, with the collision
+     * status of the paths tried memoized (the default), or built and costed in full.  Both give
+     * the same results; this is for checking that they do.
+     */
+    static void SetIncrementalCosts( bool aIncremental );
+
+    void SetWorld( NODE* aNode )
+    {
+        m_world = aNode;
+        ClearCache();
+    }
 
-    void SetWorld( NODE* aNode ) { m_world = aNode; }
     void CacheRemove( ITEM* aItem );
     void ClearCache( bool aStaticOnly = false );
 
@@ -169,6 +182,11 @@ private:
         bool m_isStatic;
     };
 
+    struct PATH_HASH
+    {
+        std::size_t operator()( const std::vector<VECTOR2I>& aPath ) const;
+    };
+
     bool mergeObtuse( LINE* aLine );
     bool mergeFull( LINE* aLine );
     bool mergeColinear( LINE* aLine );
@@ -198,10 +216,16 @@ private:
     ITEM* findPadOrVia( int aLayer, int aNet, const VECTOR2I& aP ) const;
 
 private:
+    ///< Static obstacles (solids) which have blocked an optimization attempt
     SHAPE_INDEX_LIST<ITEM*>                m_cache;
     std::vector<OPT_CONSTRAINT*>           m_constraints;
     std::unordered_map<ITEM*, CACHED_ITEM> m_cacheTags;
 
+    ///< Collision status of the paths tried for the line being optimized
+    std::unordered_map<std::vector<VECTOR2I>, bool, PATH_HASH> m_pathCollisions;
+
+    static std::atomic<bool> s_incrementalCosts;
+
     NODE*               m_world;
     int                 m_collisionKindMask;
     int                 m_effortLevel;
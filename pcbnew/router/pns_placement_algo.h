@@ -67,6 +67,22 @@ public:
      */
     virtual bool Move( const VECTOR2I& aP, ITEM* aEndItem ) = 0;
 
+    /**
+     * Function Refine()
+     *
+     * Continues work left unfinished by the last Move() for lack of time, while the cursor
+     * doesn't move.
+     * @return true, if the routed items have changed.
+     */
+    virtual bool Refine() { return false; }
+
+    /**
+     * Function RefinementPending()
+     *
+     * @return true, if Refine() may improve the result of the last Move().
+     */
+    virtual bool RefinementPending() const { return false; }
+
     /**
      * Function FixRoute()
      *
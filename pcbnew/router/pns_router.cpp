@@ -19,8 +19,12 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <condition_variable>
 #include <cstdio>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include <view/view.h>
@@ -47,6 +51,7 @@
 #include "pns_component_dragger.h"
 #include "pns_topology.h"
 #include "pns_diff_pair_placer.h"
+#include "pns_bus_placer.h"
 #include "pns_meander_placer.h"
 #include "pns_meander_skew_placer.h"
 #include "pns_dp_meander_placer.h"
@@ -57,9 +62,90 @@ namespace PNS {
 // To be fixed sometime in the future.
 static ROUTER* theRouter;
 
-ROUTER::ROUTER()
+// overrides theRouter on threads running a router of their own
+static thread_local ROUTER* theThreadRouter = nullptr;
+
+/**
+ * A thread running the tasks posted to a router, in order.
+ */
+class ROUTER::WORKER
 {
-    theRouter = this;
+public:
+    WORKER( ROUTER* aRouter ) :
+            m_router( aRouter ),
+            m_quit( false ),
+            m_thread( &WORKER::run, this )
+    {}
+
+    ~WORKER()
+    {
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_quit = true;
+        }
+
+        m_wakeUp.notify_one();
+        m_thread.join();
+    }
+
+    std::future<void> Post( std::function<void()> aTask )
+    {
+        std::packaged_task<void()> task( std::move( aTask ) );
+        std::future<void>          ret = task.get_future();
+
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_tasks.push_back( std::move( task ) );
+        }
+
+        m_wakeUp.notify_one();
+        return ret;
+    }
+
+private:
+    void run()
+    {
+        SetThreadInstance( m_router );
+
+        while( true )
+        {
+            std::packaged_task<void()> task;
+
+            {
+                std::unique_lock<std::mutex> lock( m_mutex );
+
+                m_wakeUp.wait( lock,
+                               [this]()
+                               {
+                                   return m_quit || !m_tasks.empty();
+                               } );
+
+                if( m_tasks.empty() )
+                    return;
+
+                task = std::move( m_tasks.front() );
+                m_tasks.pop_front();
+            }
+
+            task();
+        }
+    }
+
+    ROUTER*                                 m_router;
+    std::mutex                              m_mutex;
+    std::condition_variable                 m_wakeUp;
+    std::deque<std::packaged_task<void()>>  m_tasks;
+    bool                                    m_quit;
+    std::thread                             m_thread;   ///< last, started once all is set up
+};
+
+
+ROUTER::ROUTER( bool aThreadInstance )
+{
+    if( aThreadInstance )
+        theThreadRouter = this;
+    else
+        theRouter = this;
 
     m_state = IDLE;
     m_mode = PNS_MODE_ROUTE_SINGLE;
@@ -77,14 +163,37 @@ ROUTER::ROUTER()
 
 ROUTER* ROUTER::GetInstance()
 {
-    return theRouter;
+    return theThreadRouter ? theThreadRouter : theRouter;
+}
+
+
+void ROUTER::SetThreadInstance( ROUTER* aRouter )
+{
+    theThreadRouter = aRouter;
+}
+
+
+std::future<void> ROUTER::RunOnWorker( std::function<void()> aTask )
+{
+    if( !m_worker )
+        m_worker = std::make_unique<WORKER>( this );
+
+    return m_worker->Post( std::move( aTask ) );
 }
 
 
 ROUTER::~ROUTER()
 {
     ClearWorld();
-    theRouter = nullptr;
+
+    // Stop the worker while the router is still whole
+    m_worker.reset();
+
+    if( theThreadRouter == this )
+        theThreadRouter = nullptr;
+    else if( theRouter == this )
+        theRouter = nullptr;
+
     delete m_logger;
 }
 
@@ -94,6 +203,10 @@ void ROUTER::SyncWorld()
     ClearWorld();
 
     m_world = std::make_unique<NODE>( );
+
+    if( m_settings )
+        m_world->SetUseGridIndex( m_settings->SpatialIndex() == SI_GRID );
+
     m_iface->SyncWorld( m_world.get() );
     m_world->FixupVirtualVias();
 }
@@ -370,7 +483,15 @@ bool ROUTER::isStartingPointRoutable( const VECTOR2I& aWhere, ITEM* aStartItem,
 
 bool ROUTER::StartRouting( const VECTOR2I& aP, ITEM* aStartItem, int aLayer )
 {
-    if( !isStartingPointRoutable( aP, aStartItem, aLayer ) )
+    return StartRouting( aP, ITEM_SET( aStartItem ), aLayer );
+}
+
+
+bool ROUTER::StartRouting( const VECTOR2I& aP, const ITEM_SET& aStartItems, int aLayer )
+{
+    ITEM* startItem = aStartItems.Empty() ? nullptr : aStartItems[0];
+
+    if( !isStartingPointRoutable( aP, startItem, aLayer ) )
         return false;
 
     m_forceMarkObstaclesMode = false;
@@ -385,6 +506,14 @@ bool ROUTER::StartRouting( const VECTOR2I& aP, ITEM* aStartItem, int aLayer )
         m_placer = std::make_unique<DIFF_PAIR_PLACER>( this );
         break;
 
+    case PNS_MODE_ROUTE_BUS:
+    {
+        std::unique_ptr<BUS_PLACER> busPlacer = std::make_unique<BUS_PLACER>( this );
+        busPlacer->SetStartItems( aStartItems );
+        m_placer = std::move( busPlacer );
+        break;
+    }
+
     case PNS_MODE_TUNE_SINGLE:
         m_placer = std::make_unique<MEANDER_PLACER>( this );
         break;
@@ -409,10 +538,10 @@ bool ROUTER::StartRouting( const VECTOR2I& aP, ITEM* aStartItem, int aLayer )
     if( m_logger )
     {
         m_logger->Clear();
-        m_logger->Log( LOGGER::EVT_START_ROUTE, aP, aStartItem );
+        m_logger->Log( LOGGER::EVT_START_ROUTE, aP, startItem );
     }
 
-    if( m_placer->Start( aP, aStartItem ) )
+    if( m_placer->Start( aP, startItem ) )
     {
         m_state = ROUTE_TRACK;
         return true;
@@ -584,6 +713,30 @@ void ROUTER::movePlacing( const VECTOR2I& aP, ITEM* aEndItem )
     m_iface->EraseView();
 
     m_placer->Move( aP, aEndItem );
+    displayPlacing();
+}
+
+
+bool ROUTER::RefineRoute()
+{
+    if( !RefinementPending() || !m_placer->Refine() )
+        return false;
+
+    m_iface->EraseView();
+    displayPlacing();
+
+    return true;
+}
+
+
+bool ROUTER::RefinementPending() const
+{
+    return m_state == ROUTE_TRACK && m_placer && m_placer->RefinementPending();
+}
+
+
+void ROUTER::displayPlacing()
+{
     ITEM_SET current = m_placer->Traces();
 
     for( const ITEM* item : current.CItems() )
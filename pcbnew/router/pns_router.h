@@ -22,6 +22,8 @@
 #ifndef __PNS_ROUTER_H
 #define __PNS_ROUTER_H
 
+#include <functional>
+#include <future>
 #include <list>
 #include <memory>
 #include <core/optional.h>
@@ -64,7 +66,8 @@ enum ROUTER_MODE {
     PNS_MODE_ROUTE_DIFF_PAIR,
     PNS_MODE_TUNE_SINGLE,
     PNS_MODE_TUNE_DIFF_PAIR,
-    PNS_MODE_TUNE_DIFF_PAIR_SKEW
+    PNS_MODE_TUNE_DIFF_PAIR_SKEW,
+    PNS_MODE_ROUTE_BUS
 };
 
 enum DRAG_MODE
@@ -124,7 +127,12 @@ public:
     };
 
 public:
-    ROUTER();
+    /**
+     * @param aThreadInstance makes the router the instance GetInstance() returns on the calling
+     *                        thread only, instead of on all threads.  This lets independent
+     *                        routers run on several threads at once.
+     */
+    ROUTER( bool aThreadInstance = false );
     ~ROUTER();
 
     void SetInterface( ROUTER_IFACE* aIface );
@@ -137,12 +145,45 @@ public:
 
     static ROUTER* GetInstance();
 
+    /**
+     * Make \a aRouter the instance GetInstance() returns on the calling thread, or clear the
+     * thread's instance if null.  Threads working for a thread instance must set it before
+     * touching its items.
+     */
+    static void SetThreadInstance( ROUTER* aRouter );
+
+    /**
+     * Run \a aTask on the worker thread of this router.  The thread is started on first use
+     * and kept until the router is destroyed, since starting one per task would cost about as
+     * much as a short walkaround.  Tasks run one at a time, and see this router as
+     * GetInstance().
+     */
+    std::future<void> RunOnWorker( std::function<void()> aTask );
+
     void ClearWorld();
     void SyncWorld();
 
     bool RoutingInProgress() const;
     bool StartRouting( const VECTOR2I& aP, ITEM* aItem, int aLayer );
+
+    /**
+     * Start routing from several items at once.  Only bus routing uses them all; the first
+     * item is the one the routing follows the cursor from.
+     */
+    bool StartRouting( const VECTOR2I& aP, const ITEM_SET& aStartItems, int aLayer );
+
     void Move( const VECTOR2I& aP, ITEM* aItem );
+
+    /**
+     * Let the placer finish the work its last move couldn't complete in time.  Meant to be
+     * called repeatedly while the cursor is idle, as long as RefinementPending() is true.  The
+     * placer shows the best state so far in the meantime.
+     *
+     * @return true if the routed items have changed (and have been redrawn).
+     */
+    bool RefineRoute();
+    bool RefinementPending() const;
+
     bool FixRoute( const VECTOR2I& aP, ITEM* aItem, bool aForceFinish = false );
     void BreakSegment( ITEM *aItem, const VECTOR2I& aP );
 
@@ -212,6 +253,7 @@ public:
 
 private:
     void movePlacing( const VECTOR2I& aP, ITEM* aItem );
+    void displayPlacing();
     void moveDragging( const VECTOR2I& aP, ITEM* aItem );
 
     void updateView( NODE* aNode, ITEM_SET& aCurrent, bool aDragging = false );
@@ -222,6 +264,8 @@ private:
     bool isStartingPointRoutable( const VECTOR2I& aWhere, ITEM* aItem, int aLayer );
 
 private:
+    class WORKER;
+
     BOX2I                           m_visibleViewArea;
     RouterState                     m_state;
 
@@ -244,6 +288,8 @@ private:
 
     wxString          m_toolStatusbarName;
     wxString          m_failureReason;
+
+    std::unique_ptr<WORKER> m_worker;
 };
 
 }
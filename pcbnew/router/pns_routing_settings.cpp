@@ -54,6 +54,8 @@ ROUTING_SETTINGS::ROUTING_SETTINGS( JSON_SETTINGS* aParent, const std::string& a
     m_walkaroundHugLengthThreshold = 1.5;
     m_autoPosture = true;
     m_fixAllSegments = true;
+    m_anytimeShove = true;
+    m_spatialIndex = SI_RTREE;
 
     m_params.emplace_back( new PARAM<int>( "mode", reinterpret_cast<int*>( &m_routingMode ),
             static_cast<int>( RM_Walkaround ) ) );
@@ -80,6 +82,11 @@ ROUTING_SETTINGS::ROUTING_SETTINGS( JSON_SETTINGS* aParent, const std::string& a
             },
             1000 ) );
 
+    m_params.emplace_back( new PARAM<bool>( "anytime_shove", &m_anytimeShove, true ) );
+
+    m_params.emplace_back( new PARAM<int>( "spatial_index",
+            reinterpret_cast<int*>( &m_spatialIndex ), static_cast<int>( SI_RTREE ) ) );
+
     m_params.emplace_back( new PARAM<int>( "walkaround_iteration_limit", &m_walkaroundIterationLimit, 40 ) );
     m_params.emplace_back( new PARAM<bool>( "jump_over_obstacles",       &m_jumpOverObstacles, false ) );
 
@@ -51,6 +51,13 @@ enum PNS_OPTIMIZATION_EFFORT
     OE_FULL = 2
 };
 
+///< Spatial index of the items of the world.
+enum PNS_SPATIAL_INDEX
+{
+    SI_RTREE = 0,           ///< R-Trees, fastest to search
+    SI_GRID                 ///< Uniform grids, fastest to update (shove)
+};
+
 /**
  * Contain all persistent settings of the router, such as the mode, optimization effort, etc.
  */
@@ -130,6 +137,16 @@ public:
 
     int ShoveIterationLimit() const;
     TIME_LIMIT ShoveTimeLimit() const;
+    void SetShoveTimeLimit( int aMilliseconds ) { m_shoveTimeLimit.Set( aMilliseconds ); }
+
+    ///< Return true if a shove running out of time is resumed while the cursor is idle,
+    ///< instead of being given up.
+    bool AnytimeShove() const { return m_anytimeShove; }
+    void SetAnytimeShove( bool aEnable ) { m_anytimeShove = aEnable; }
+
+    ///< Return the spatial index of the world.  A change applies from the next world sync.
+    PNS_SPATIAL_INDEX SpatialIndex() const { return m_spatialIndex; }
+    void SetSpatialIndex( PNS_SPATIAL_INDEX aIndex ) { m_spatialIndex = aIndex; }
 
     int WalkaroundIterationLimit() const { return m_walkaroundIterationLimit; };
     TIME_LIMIT WalkaroundTimeLimit() const;
@@ -170,11 +187,13 @@ private:
     bool m_optimizeEntireDraggedTrack;
     bool m_autoPosture;
     bool m_fixAllSegments;
+    bool m_anytimeShove;
 
     DIRECTION_45::CORNER_MODE m_cornerMode;
 
     PNS_MODE m_routingMode;
     PNS_OPTIMIZATION_EFFORT m_optimizerEffort;
+    PNS_SPATIAL_INDEX m_spatialIndex;
 
     int m_walkaroundIterationLimit;
     int m_shoveIterationLimit;
@@ -19,6 +19,7 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <atomic>
 #include <deque>
 #include <cassert>
 #include <math/box2.h>
@@ -48,6 +49,15 @@ typedef VECTOR2I::extended_type ecoord;
 
 namespace PNS {
 
+static std::atomic<int64_t> s_iterationCount( 0 );
+
+
+int64_t SHOVE::GetIterationCount()
+{
+    return s_iterationCount.load( std::memory_order_relaxed );
+}
+
+
 void SHOVE::replaceItems( ITEM* aOld, std::unique_ptr< ITEM > aNew )
 {
     OPT_BOX2I changed_area = ChangedArea( aOld, aNew.get() );
@@ -168,6 +178,8 @@ SHOVE::SHOVE( NODE* aWorld, ROUTER* aRouter ) :
     // Initialize other temporary variables:
     m_draggedVia = nullptr;
     m_iter = 0;
+    m_timeExpired = false;
+    m_pendingParent = nullptr;
     m_multiLineMode = false;
     m_restrictSpringbackTagId = 0;
     m_springbackDoNotTouchNode = nullptr;
@@ -780,14 +792,16 @@ SHOVE::SHOVE_STATUS SHOVE::onCollidingSolid( LINE& aCurrent, ITEM* aObstacle )
 
 
 /*
- * Pops NODE stackframes which no longer collide with aHeadSet.  Optionally sets aDraggedVia
- * to the dragged via of the last unpopped state.
+ * Pops NODE stackframes which no longer collide with aHeadSet (or, if aPop is false, only
+ * finds them).  Optionally sets aDraggedVia to the dragged via of the last unpopped state.
  */
-NODE* SHOVE::reduceSpringback( const ITEM_SET& aHeadSet, VIA_HANDLE& aDraggedVia )
+NODE* SHOVE::reduceSpringback( const ITEM_SET& aHeadSet, VIA_HANDLE& aDraggedVia, bool aPop )
 {
-    while( !m_nodeStack.empty() )
+    size_t depth = m_nodeStack.size();
+
+    while( depth > 0 )
     {
-        SPRINGBACK_TAG& spTag = m_nodeStack.back();
+        SPRINGBACK_TAG& spTag = m_nodeStack[depth - 1];
 
         // Prevent the springback algo from erasing NODEs that might contain items used by the ROUTER_TOOL/LINE_PLACER.
         // I noticed this can happen for the endItem provided to LINE_PLACER::Move() and cause a nasty crash.
@@ -801,8 +815,7 @@ NODE* SHOVE::reduceSpringback( const ITEM_SET& aHeadSet, VIA_HANDLE& aDraggedVia
             aDraggedVia = spTag.m_draggedVia;
             aDraggedVia.valid = true;
 
-            delete spTag.m_node;
-            m_nodeStack.pop_back();
+            depth--;
         }
         else
         {
@@ -810,7 +823,22 @@ NODE* SHOVE::reduceSpringback( const ITEM_SET& aHeadSet, VIA_HANDLE& aDraggedVia
         }
     }
 
-    return m_nodeStack.empty() ? m_root : m_nodeStack.back().m_node;
+    NODE* top = depth == 0 ? m_root : m_nodeStack[depth - 1].m_node;
+
+    if( aPop )
+        popSpringback( top );
+
+    return top;
+}
+
+
+void SHOVE::popSpringback( NODE* aTop )
+{
+    while( !m_nodeStack.empty() && m_nodeStack.back().m_node != aTop )
+    {
+        delete m_nodeStack.back().m_node;
+        m_nodeStack.pop_back();
+    }
 }
 
 
@@ -1353,12 +1381,10 @@ SHOVE::SHOVE_STATUS SHOVE::shoveIteration( int aIter )
  * long as they propagate further collisions, or until the iteration timeout or max iteration
  * count is reached.
  */
-SHOVE::SHOVE_STATUS SHOVE::shoveMainLoop()
+SHOVE::SHOVE_STATUS SHOVE::shoveMainLoop( bool aResume )
 {
     SHOVE_STATUS st = SH_OK;
 
-    m_affectedArea = OPT_BOX2I();
-
     PNS_DBG( Dbg(), Message, wxString::Format( "ShoveStart [root: %d jts, current: %d jts]",
                                                m_root->JointCount(),
                                                m_currentNode->JointCount() ) );
@@ -1366,11 +1392,17 @@ SHOVE::SHOVE_STATUS SHOVE::shoveMainLoop()
     int iterLimit = Settings().ShoveIterationLimit();
     TIME_LIMIT timeLimit = Settings().ShoveTimeLimit();
 
-    m_iter = 0;
+    m_timeExpired = false;
 
     timeLimit.Restart();
 
-    if( m_lineStack.empty() && m_draggedVia )
+    if( !aResume )
+    {
+        m_affectedArea = OPT_BOX2I();
+        m_iter = 0;
+    }
+
+    if( !aResume && m_lineStack.empty() && m_draggedVia )
     {
         // If we're shoving a free via then push a proxy LINE (with the via on the end) onto
         // the stack.
@@ -1385,12 +1417,22 @@ SHOVE::SHOVE_STATUS SHOVE::shoveMainLoop()
         st = shoveIteration( m_iter );
 
         m_iter++;
+        s_iterationCount.fetch_add( 1, std::memory_order_relaxed );
 
-        if( st == SH_INCOMPLETE || timeLimit.Expired() || m_iter >= iterLimit )
+        if( st == SH_INCOMPLETE || m_iter >= iterLimit )
         {
             st = SH_INCOMPLETE;
             break;
         }
+
+        if( !m_lineStack.empty() && timeLimit.Expired() )
+        {
+            // Unlike the iteration limit, running out of time doesn't mean the shove can't
+            // be completed: the caller may keep the current branch and resume it later.
+            m_timeExpired = true;
+            st = SH_INCOMPLETE;
+            break;
+        }
     }
 
     return st;
@@ -1417,6 +1459,8 @@ SHOVE::SHOVE_STATUS SHOVE::ShoveLines( const LINE& aCurrentHead )
 {
     SHOVE_STATUS st = SH_OK;
 
+    discardPendingShove();
+
     m_multiLineMode = false;
 
     PNS_DBG( Dbg(), Message,
@@ -1437,14 +1481,16 @@ SHOVE::SHOVE_STATUS SHOVE::ShoveLines( const LINE& aCurrentHead )
     m_logger.Clear();
 #endif
 
-    // Pop NODEs containing previous shoves which are no longer necessary
+    // Pop NODEs containing previous shoves which are no longer necessary.  In anytime mode they
+    // are only popped once the shove succeeds: until then, the last of them is the best state
+    // there is for the head to fall back on.
     //
     ITEM_SET headSet;
     headSet.Add( aCurrentHead );
 
     VIA_HANDLE dummyVia;
 
-    NODE* parent = reduceSpringback( headSet, dummyVia );
+    NODE* parent = reduceSpringback( headSet, dummyVia, !Settings().AnytimeShove() );
 
     // Create a new NODE to store this version of the world
     m_currentNode = parent->Branch();
@@ -1479,6 +1525,67 @@ SHOVE::SHOVE_STATUS SHOVE::ShoveLines( const LINE& aCurrentHead )
 
     st = shoveMainLoop();
 
+    if( m_timeExpired && Settings().AnytimeShove() )
+    {
+        // Keep the partially shoved branch aside and let the caller go on with the best state
+        // so far, i.e. the result of the last completed shove, until ResumeShove() completes it.
+        m_pendingParent = parent;
+        m_pendingHead = head;
+
+        PNS_DBG( Dbg(), Message, wxString::Format( "Shove suspended after %d iterations",
+                                                   m_iter ) );
+
+        return SH_INCOMPLETE;
+    }
+
+    return finishShoveLines( parent, head, st );
+}
+
+
+SHOVE::SHOVE_STATUS SHOVE::ResumeShove()
+{
+    if( !m_pendingParent )
+        return SH_NULL;
+
+    NODE* parent = m_pendingParent;
+    LINE  head = *m_pendingHead;
+
+    m_pendingParent = nullptr;
+    m_pendingHead = OPT_LINE();
+
+    SHOVE_STATUS st = shoveMainLoop( true );
+
+    if( m_timeExpired )
+    {
+        m_pendingParent = parent;
+        m_pendingHead = head;
+
+        return SH_INCOMPLETE;
+    }
+
+    return finishShoveLines( parent, head, st );
+}
+
+
+void SHOVE::discardPendingShove()
+{
+    if( !m_pendingParent )
+        return;
+
+    delete m_currentNode;
+
+    m_currentNode = m_pendingParent;
+    m_pendingParent = nullptr;
+    m_pendingHead = OPT_LINE();
+    m_newHead = OPT_LINE();
+}
+
+
+SHOVE::SHOVE_STATUS SHOVE::finishShoveLines( NODE* aParent, const LINE& aHead,
+                                             SHOVE_STATUS aStatus )
+{
+    SHOVE_STATUS st = aStatus;
+
     if( st == SH_OK )
     {
         runOptimizer( m_currentNode );
@@ -1486,7 +1593,7 @@ SHOVE::SHOVE_STATUS SHOVE::ShoveLines( const LINE& aCurrentHead )
         if( m_newHead )
             st = m_currentNode->CheckColliding( &( *m_newHead ) ) ? SH_INCOMPLETE : SH_HEAD_MODIFIED;
         else
-            st = m_currentNode->CheckColliding( &head ) ? SH_INCOMPLETE : SH_OK;
+            st = m_currentNode->CheckColliding( &aHead ) ? SH_INCOMPLETE : SH_OK;
     }
 
     m_currentNode->RemoveByMarker( MK_HEAD );
@@ -1496,22 +1603,24 @@ SHOVE::SHOVE_STATUS SHOVE::ShoveLines( const LINE& aCurrentHead )
 
     if( st == SH_OK || st == SH_HEAD_MODIFIED )
     {
+        // The shoves that the head no longer needs are only dropped now, see ShoveLines()
+        popSpringback( aParent );
         pushSpringback( m_currentNode, m_affectedArea, nullptr );
     }
     else
     {
         delete m_currentNode;
 
-        m_currentNode = parent;
+        m_currentNode = aParent;
         m_newHead = OPT_LINE();
     }
 
     if(m_newHead)
         m_newHead->Unmark();
 
-    if( m_newHead && head.EndsWithVia() )
+    if( m_newHead && aHead.EndsWithVia() )
     {
-        VIA v = head.Via();
+        VIA v = aHead.Via();
         v.SetPos( m_newHead->CPoint( -1 ) );
         m_newHead->AppendVia(v);
     }
@@ -1524,6 +1633,8 @@ SHOVE::SHOVE_STATUS SHOVE::ShoveMultiLines( const ITEM_SET& aHeadSet )
 {
     SHOVE_STATUS st = SH_OK;
 
+    discardPendingShove();
+
     m_multiLineMode = true;
 
     ITEM_SET headSet;
@@ -1627,6 +1738,8 @@ SHOVE::SHOVE_STATUS SHOVE::ShoveDraggingVia( const VIA_HANDLE aOldVia, const VEC
 {
     SHOVE_STATUS st = SH_OK;
 
+    discardPendingShove();
+
     m_lineStack.clear();
     m_optimizerQueue.clear();
     m_newHead = OPT_LINE();
@@ -1808,6 +1921,8 @@ const LINE SHOVE::NewHead() const
 
 void SHOVE::SetInitialLine( LINE& aInitial )
 {
+    discardPendingShove();
+
     m_root = m_root->Branch();
     m_root->Remove( aInitial );
 }
@@ -1815,6 +1930,8 @@ void SHOVE::SetInitialLine( LINE& aInitial )
 
 bool SHOVE::AddLockedSpringbackNode( NODE* aNode )
 {
+    discardPendingShove();
+
     SPRINGBACK_TAG sp;
     sp.m_node = aNode;
     sp.m_locked = true;
@@ -1826,6 +1943,8 @@ bool SHOVE::AddLockedSpringbackNode( NODE* aNode )
 
 bool SHOVE::RewindSpringbackTo( NODE* aNode )
 {
+    discardPendingShove();
+
     bool found = false;
 
     auto iter = m_nodeStack.begin();
@@ -1855,6 +1974,8 @@ bool SHOVE::RewindSpringbackTo( NODE* aNode )
 
 bool SHOVE::RewindToLastLockedNode()
 {
+    discardPendingShove();
+
     if( m_nodeStack.empty() )
         return false;
 
@@ -66,6 +66,22 @@ public:
     SHOVE_STATUS ShoveLines( const LINE& aCurrentHead );
     SHOVE_STATUS ShoveMultiLines( const ITEM_SET& aHeadSet );
 
+    /**
+     * Continue a line shove that ran out of time in anytime mode (see
+     * #ROUTING_SETTINGS::AnytimeShove()) for another #ROUTING_SETTINGS::ShoveTimeLimit().
+     *
+     * Until the shove completes, the current node stays the result of the last completed
+     * shove: the best state so far, which a failed shove doesn't change either.
+     *
+     * @return SH_OK or SH_HEAD_MODIFIED if the shove has completed, in which case its result
+     *         becomes the current node, SH_INCOMPLETE if it still hasn't or has failed (only
+     *         the former keeps it pending) and SH_NULL if there was nothing to resume.
+     */
+    SHOVE_STATUS ResumeShove();
+
+    ///< Return true if a line shove has been suspended and can be resumed by ResumeShove().
+    bool HasPendingShove() const { return m_pendingParent != nullptr; }
+
     SHOVE_STATUS ShoveDraggingVia( const VIA_HANDLE aOldVia, const VECTOR2I& aWhere,
                                    VIA_HANDLE& aNewVia );
     SHOVE_STATUS ShoveObstacleLine( const LINE& aCurLine, const LINE& aObstacleLine,
@@ -92,6 +108,9 @@ public:
     void DisablePostShoveOptimizations( int aMask );
     void SetSpringbackDoNotTouchNode( NODE *aNode );
 
+    ///< Return the number of shove iterations run by all SHOVE instances, for profiling.
+    static int64_t GetIterationCount();
+
 private:
     typedef std::vector<SHAPE_LINE_CHAIN> HULL_SET;
     typedef OPT<LINE> OPT_LINE;
@@ -120,7 +139,11 @@ private:
     SHOVE_STATUS shoveLineToHullSet( const LINE& aCurLine, const LINE& aObstacleLine,
                                      LINE& aResultLine, const HULL_SET& aHulls );
 
-    NODE* reduceSpringback( const ITEM_SET& aHeadSet, VIA_HANDLE& aDraggedVia );
+    NODE* reduceSpringback( const ITEM_SET& aHeadSet, VIA_HANDLE& aDraggedVia,
+                            bool aPop = true );
+
+    ///< Delete the nodes of the springback stack above \a aTop.
+    void popSpringback( NODE* aTop );
 
     bool pushSpringback( NODE* aNode, const OPT_BOX2I& aAffectedArea, VIA* aDraggedVia );
 
@@ -158,7 +181,13 @@ private:
     OPT_BOX2I                   m_affectedArea;
 
     SHOVE_STATUS shoveIteration( int aIter );
-    SHOVE_STATUS shoveMainLoop();
+    SHOVE_STATUS shoveMainLoop( bool aResume = false );
+
+    ///< Check the result of a line shove and push it on the springback stack if it is valid.
+    SHOVE_STATUS finishShoveLines( NODE* aParent, const LINE& aHead, SHOVE_STATUS aStatus );
+
+    ///< Free the branch of a suspended line shove, if any.
+    void discardPendingShove();
 
     int getClearance( const ITEM* aA, const ITEM* aB ) const;
     int getHoleClearance( const ITEM* aA, const ITEM* aB ) const;
@@ -181,6 +210,12 @@ private:
     VIA*                        m_draggedVia;
 
     int                         m_iter;
+    bool                        m_timeExpired;   ///< the last main loop ran out of time
+
+    ///< Parent of the branch of a suspended line shove, nullptr if there is none
+    NODE*                       m_pendingParent;
+    OPT_LINE                    m_pendingHead;
+
     int m_forceClearance;
     bool m_multiLineMode;
 
@@ -21,6 +21,7 @@
 
 #include "pns_utils.h"
 #include "pns_line.h"
+#include "pns_node.h"
 #include "pns_via.h"
 #include "pns_router.h"
 
@@ -354,4 +355,33 @@ void HullIntersection( const SHAPE_LINE_CHAIN& hull, const SHAPE_LINE_CHAIN& lin
     }
 }
 
+
+
+OPT_VECTOR2I DanglingAnchor( NODE* aNode, ITEM* aItem )
+{
+    switch( aItem->Kind() )
+    {
+    case ITEM::VIA_T:
+    case ITEM::SOLID_T:
+        return aItem->Anchor( 0 );
+
+    case ITEM::ARC_T:
+    case ITEM::SEGMENT_T:
+    {
+        JOINT* jA = aNode->FindJoint( aItem->Anchor( 0 ), aItem );
+        JOINT* jB = aNode->FindJoint( aItem->Anchor( 1 ), aItem );
+
+        if( jA && jA->LinkCount() == 1 )
+            return aItem->Anchor( 0 );
+        else if( jB && jB->LinkCount() == 1 )
+            return aItem->Anchor( 1 );
+        else
+            return OPT_VECTOR2I();
+    }
+
+    default:
+        return OPT_VECTOR2I();
+    }
+}
+
 }
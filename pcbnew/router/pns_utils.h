@@ -35,6 +35,7 @@ constexpr int HULL_MARGIN = 10;
 
 class ITEM;
 class LINE;
+class NODE;
 
 /** Various utility functions */
 
@@ -64,6 +65,14 @@ OPT_BOX2I ChangedArea( const LINE& aLineA, const LINE& aLineB );
 void HullIntersection( const SHAPE_LINE_CHAIN& hull, const SHAPE_LINE_CHAIN& line,
                        SHAPE_LINE_CHAIN::INTERSECTIONS& ips );
 
+/**
+ * Return the point of \a aItem a new trace may start from: the anchor of a via or a pad, or
+ * the end of a segment or an arc that no other item of \a aNode connects to.
+ *
+ * @return the anchor, or nothing if \a aItem is a track connected at both ends.
+ */
+OPT_VECTOR2I DanglingAnchor( NODE* aNode, ITEM* aItem );
+
 
 }
 
@@ -19,6 +19,8 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <future>
+
 #include <core/optional.h>
 
 #include <geometry/shape_line_chain.h>
@@ -31,9 +33,17 @@
 
 namespace PNS {
 
+std::atomic<bool> WALKAROUND::s_parallelWalks( true );
+
+
+void WALKAROUND::SetParallelWalks( bool aParallel )
+{
+    s_parallelWalks = aParallel;
+}
+
+
 void WALKAROUND::start( const LINE& aInitialPath )
 {
-    m_iteration = 0;
     m_iterationLimit = 50;
 }
 
@@ -53,7 +63,8 @@ NODE::OPT_OBSTACLE WALKAROUND::nearestObstacle( const LINE& aPath )
 }
 
 
-WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath, bool aWindingDirection )
+WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath, bool aWindingDirection,
+                                                      int aIteration )
 {
     OPT<OBSTACLE>& current_obs =
         aWindingDirection ? m_currentObstacle[0] : m_currentObstacle[1];
@@ -69,11 +80,11 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath, bool aWinding
 
     PNS_DBG( Dbg(), BeginGroup, "hull/walk" );
     char name[128];
-    snprintf( name, sizeof( name ), "hull-%s-%d", aWindingDirection ? "cw" : "ccw", m_iteration );
+    snprintf( name, sizeof( name ), "hull-%s-%d", aWindingDirection ? "cw" : "ccw", aIteration );
     PNS_DBG( Dbg(), AddLine, current_obs->m_hull, RED, 1, name );
-    snprintf( name, sizeof( name ), "path-%s-%d", aWindingDirection ? "cw" : "ccw", m_iteration );
+    snprintf( name, sizeof( name ), "path-%s-%d", aWindingDirection ? "cw" : "ccw", aIteration );
     PNS_DBG( Dbg(), AddLine, aPath.CLine(), GREEN, 1, name );
-    snprintf( name, sizeof( name ), "result-%s-%d", aWindingDirection ? "cw" : "ccw", m_iteration );
+    snprintf( name, sizeof( name ), "result-%s-%d", aWindingDirection ? "cw" : "ccw", aIteration );
     PNS_DBG( Dbg(), AddLine, path_walk, BLUE, 10000, name );
     PNS_DBG( Dbg(), Message, wxString::Format( "Stat cw %d", !!s_cw ) );
     PNS_DBGN( Dbg(), EndGroup );
@@ -95,11 +106,76 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath, bool aWinding
 }
 
 
+void WALKAROUND::walk( WALK_STATE& aState, bool aWindingDirection, bool aStopAtAlmostDone,
+                       long long aLengthLimit, std::atomic<int>* aDoneAt )
+{
+    for( int i = 0; i < m_iterationLimit && aState.stopIteration > i; i++ )
+    {
+        // The other walk was done at an earlier iteration; nothing from here on can change
+        // which path is picked.
+        if( aDoneAt && i > aDoneAt->load( std::memory_order_relaxed ) )
+            break;
+
+        if( aState.path.PointCount() == 0 )
+            aState.status = STUCK; // path is empty, can't continue
+        else
+            aState.status = singleStep( aState.path, aWindingDirection, i );
+
+        if( aState.status == DONE || aState.status == STUCK
+                || ( aStopAtAlmostDone && aState.status == ALMOST_DONE ) )
+        {
+            aState.stopIteration = i;
+
+            if( aDoneAt && aState.status == DONE )
+            {
+                int doneAt = aDoneAt->load();
+
+                while( i < doneAt && !aDoneAt->compare_exchange_weak( doneAt, i ) )
+                    ;
+            }
+        }
+        else if( aLengthLimit && aState.path.CLine().Length() > aLengthLimit )
+        {
+            break;
+        }
+    }
+}
+
+
+void WALKAROUND::walkBothDirections( WALK_STATE& aCw, WALK_STATE& aCcw, bool aStopAtAlmostDone,
+                                     long long aLengthLimit, bool aStopAtFirstDone )
+{
+    std::atomic<int>  doneAt( INT_MAX );
+    std::atomic<int>* stop = aStopAtFirstDone ? &doneAt : nullptr;
+
+    // Each walk keeps its own path and current obstacle, and only queries the world and the
+    // rule resolver.  Debug graphics are kept in order by walking on this thread.
+    bool parallel = s_parallelWalks && Router()
+                    && aCw.status == IN_PROGRESS && aCcw.status == IN_PROGRESS
+                    && !( Dbg() && Dbg()->IsDebugEnabled() );
+
+    if( parallel )
+    {
+        std::future<void> ccw = Router()->RunOnWorker(
+                [&]()
+                {
+                    walk( aCcw, false, aStopAtAlmostDone, aLengthLimit, stop );
+                } );
+
+        walk( aCw, true, aStopAtAlmostDone, aLengthLimit, stop );
+        ccw.get();
+    }
+    else
+    {
+        walk( aCw, true, aStopAtAlmostDone, aLengthLimit, stop );
+        walk( aCcw, false, aStopAtAlmostDone, aLengthLimit, stop );
+    }
+}
+
+
 const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
 {
-    LINE path_cw( aInitialPath ), path_ccw( aInitialPath );
     WALKAROUND_STATUS s_cw = IN_PROGRESS, s_ccw = IN_PROGRESS;
-    SHAPE_LINE_CHAIN best_path;
     RESULT result;
 
     // special case for via-in-the-middle-of-track placement
@@ -117,9 +193,6 @@ const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
     m_currentObstacle[0] = m_currentObstacle[1] = nearestObstacle( aInitialPath );
     m_recursiveBlockageCount = 0;
 
-    result.lineCw = aInitialPath;
-    result.lineCcw = aInitialPath;
-
     if( m_forceWinding )
     {
         s_cw = m_forceCw ? IN_PROGRESS : STUCK;
@@ -138,47 +211,14 @@ const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
     const int maxWalkDistFactor = 10;
     long long lengthLimit       = aInitialPath.CLine().Length() * maxWalkDistFactor;
 
-    while( m_iteration < m_iterationLimit )
-    {
-        if( s_cw != STUCK && s_cw != ALMOST_DONE )
-            s_cw = singleStep( path_cw, true );
+    WALK_STATE cw( aInitialPath, s_cw ), ccw( aInitialPath, s_ccw );
 
-        if( s_ccw != STUCK && s_ccw != ALMOST_DONE )
-            s_ccw = singleStep( path_ccw, false );
+    walkBothDirections( cw, ccw, true, lengthLimit, false );
 
-        if( s_cw != IN_PROGRESS )
-        {
-            result.lineCw = path_cw;
-            result.statusCw = s_cw;
-        }
-
-        if( s_ccw != IN_PROGRESS )
-        {
-            result.lineCcw = path_ccw;
-            result.statusCcw = s_ccw;
-        }
-
-        if( s_cw != IN_PROGRESS && s_ccw != IN_PROGRESS )
-            break;
-
-        // Safety valve
-        if( path_cw.Line().Length() > lengthLimit && path_ccw.Line().Length() > lengthLimit )
-            break;
-
-        m_iteration++;
-    }
-
-    if( s_cw == IN_PROGRESS )
-    {
-        result.lineCw = path_cw;
-        result.statusCw = ALMOST_DONE;
-    }
-
-    if( s_ccw == IN_PROGRESS )
-    {
-        result.lineCcw = path_ccw;
-        result.statusCcw = ALMOST_DONE;
-    }
+    result.lineCw = cw.path;
+    result.statusCw = cw.status == IN_PROGRESS ? ALMOST_DONE : cw.status;
+    result.lineCcw = ccw.path;
+    result.statusCcw = ccw.status == IN_PROGRESS ? ALMOST_DONE : ccw.status;
 
     if( result.lineCw.SegmentCount() < 1 || result.lineCw.CPoint( 0 ) != aInitialPath.CPoint( 0 ) )
     {
@@ -209,9 +249,7 @@ const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
 WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath, LINE& aWalkPath,
                                                  bool aOptimize )
 {
-    LINE path_cw( aInitialPath ), path_ccw( aInitialPath );
     WALKAROUND_STATUS s_cw = IN_PROGRESS, s_ccw = IN_PROGRESS;
-    SHAPE_LINE_CHAIN best_path;
 
     // special case for via-in-the-middle-of-track placement
     if( aInitialPath.PointCount() <= 1 )
@@ -242,19 +280,22 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath, LINE&
         m_forceSingleDirection = false;
     }
 
-    while( m_iteration < m_iterationLimit )
-    {
-        if( path_cw.PointCount() == 0 )
-            s_cw = STUCK; // cw path is empty, can't continue
+    WALK_STATE cw( aInitialPath, s_cw ), ccw( aInitialPath, s_ccw );
 
-        if( path_ccw.PointCount() == 0 )
-            s_ccw = STUCK; // ccw path is empty, can't continue
+    // Unless the longer path is wanted, the first walk to be done decides; the other one only
+    // needs to get as far as that iteration.
+    walkBothDirections( cw, ccw, false, 0, !m_forceLongerPath );
 
-        if( s_cw != STUCK )
-            s_cw = singleStep( path_cw, true );
+    // Replay the walks to pick the path the first direction to finish (or the shorter one, if
+    // they finish together) would have given.
+    const LINE& path_cw = cw.path;
+    const LINE& path_ccw = ccw.path;
+    int iteration = 0;
 
-        if( s_ccw != STUCK )
-            s_ccw = singleStep( path_ccw, false );
+    for( ; iteration < m_iterationLimit; iteration++ )
+    {
+        s_cw = cw.StatusAt( iteration );
+        s_ccw = ccw.StatusAt( iteration );
 
         if( ( s_cw == DONE && s_ccw == DONE ) || ( s_cw == STUCK && s_ccw == STUCK ) )
         {
@@ -278,11 +319,9 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath, LINE&
             aWalkPath = path_ccw;
             break;
         }
-
-        m_iteration++;
     }
 
-    if( m_iteration == m_iterationLimit )
+    if( iteration == m_iterationLimit )
     {
         int len_cw  = path_cw.CLine().Length();
         int len_ccw = path_ccw.CLine().Length();
@@ -22,6 +22,8 @@
 #ifndef __PNS_WALKAROUND_H
 #define __PNS_WALKAROUND_H
 
+#include <atomic>
+#include <climits>
 #include <set>
 
 #include "pns_line.h"
@@ -51,7 +53,6 @@ public:
         // Initialize other members, to avoid uninitialized variables.
         m_recursiveBlockageCount = 0;
         m_recursiveCollision[0] = m_recursiveCollision[1] = false;
-        m_iteration = 0;
         m_forceCw = false;
         m_forceUniqueWindingDirection = false;
     }
@@ -139,16 +140,66 @@ public:
 
     const RESULT Route( const LINE& aInitialPath );
 
+    /**
+     * Choose whether the two winding directions are walked concurrently (the default) or one
+     * after the other.  Both give the same paths; this is for measuring the difference.
+     */
+    static void SetParallelWalks( bool aParallel );
+
 private:
+    ///< State of the walk in one winding direction.
+    struct WALK_STATE
+    {
+        WALK_STATE( const LINE& aPath, WALKAROUND_STATUS aStatus ) :
+            path( aPath ),
+            status( aStatus ),
+            stopIteration( aStatus == IN_PROGRESS ? INT_MAX : -1 )
+        {}
+
+        ///< @return the status of the walk after iteration \a aIteration.
+        WALKAROUND_STATUS StatusAt( int aIteration ) const
+        {
+            return aIteration >= stopIteration ? status : IN_PROGRESS;
+        }
+
+        LINE              path;
+        WALKAROUND_STATUS status;
+        int               stopIteration;    ///< iteration the walk ended at
+    };
+
     void start( const LINE& aInitialPath );
 
-    WALKAROUND_STATUS singleStep( LINE& aPath, bool aWindingDirection );
+    WALKAROUND_STATUS singleStep( LINE& aPath, bool aWindingDirection, int aIteration );
     NODE::OPT_OBSTACLE nearestObstacle( const LINE& aPath );
 
+    /**
+     * Walk in one winding direction until the walk is over or the iteration limit is reached.
+     *
+     * @param aStopAtAlmostDone end the walk when the end of the path is inside an obstacle.
+     * @param aLengthLimit end the walk when the path gets longer than this (0 for no limit).
+     * @param aDoneAt if not null, the earliest iteration a walk was done at.  The walk lowers it
+     *                when it is done, and ends once it is past it.
+     */
+    void walk( WALK_STATE& aState, bool aWindingDirection, bool aStopAtAlmostDone,
+               long long aLengthLimit, std::atomic<int>* aDoneAt );
+
+    /**
+     * Walk in both winding directions.  The walks are independent, so unless visual debugging
+     * is enabled or parallel walks are off, the counter-clockwise one runs on the router's
+     * worker thread.
+     *
+     * @param aStopAtFirstDone end both walks once one of them is done, after the iteration it
+     *                         was done at.  The statuses up to that iteration are the same as
+     *                         if both walks had run to their end.
+     */
+    void walkBothDirections( WALK_STATE& aCw, WALK_STATE& aCcw, bool aStopAtAlmostDone,
+                             long long aLengthLimit, bool aStopAtFirstDone );
+
+    static std::atomic<bool> s_parallelWalks;
+
     NODE* m_world;
 
     int m_recursiveBlockageCount;
-    int m_iteration;
     int m_iterationLimit;
     int m_itemMask;
     bool m_forceSingleDirection, m_forceLongerPath;
@@ -168,10 +168,23 @@ static const TOOL_ACTION ACT_SwitchCornerMode( "pcbnew.InteractiveRouter.SwitchR
 #define _(s) wxGetTranslation((s))
 
 
+/// Sent by the refine timer while the cursor rests on a route that can still be refined
+static const TOOL_EVENT EVT_RefineRoute( TC_MESSAGE, TA_ACTION,
+                                         "pcbnew.InteractiveRouter.refineRoute" );
+
+/// Idle time before refining the route, in milliseconds
+static const int REFINE_ROUTE_DELAY = 50;
+
+
 ROUTER_TOOL::ROUTER_TOOL() :
         TOOL_BASE( "pcbnew.InteractiveRouter" ),
         m_lastTargetLayer( UNDEFINED_LAYER )
 {
+    m_refineTimer.Bind( wxEVT_TIMER,
+            [this]( wxTimerEvent& aEvent )
+            {
+                m_toolMgr->ProcessEvent( EVT_RefineRoute );
+            } );
 }
 
 
@@ -454,6 +467,7 @@ bool ROUTER_TOOL::Init()
 
     menu.AddItem( PCB_ACTIONS::routeSingleTrack,      notRoutingCond );
     menu.AddItem( PCB_ACTIONS::routeDiffPair,         notRoutingCond );
+    menu.AddItem( PCB_ACTIONS::routeBus,              notRoutingCond );
     menu.AddItem( ACT_EndTrack,                       SELECTION_CONDITIONS::ShowAlways );
     menu.AddItem( PCB_ACTIONS::routerUndoLastSegment, SELECTION_CONDITIONS::ShowAlways );
     menu.AddItem( PCB_ACTIONS::breakTrack,            notRoutingCond );
@@ -1090,7 +1104,24 @@ bool ROUTER_TOOL::prepareInteractive()
 
     m_router->UpdateSizes( sizes );
 
-    if( !m_router->StartRouting( m_startSnapPoint, m_startItem, routingLayer ) )
+    // The clicked item leads the bus, followed by the others selected when the tool started
+    PNS::ITEM_SET startItems( m_startItem );
+
+    if( m_router->Mode() == PNS::PNS_MODE_ROUTE_BUS )
+    {
+        for( const KIID& uuid : m_busMembers )
+        {
+            BOARD_CONNECTED_ITEM* member =
+                    dynamic_cast<BOARD_CONNECTED_ITEM*>( board()->GetItem( uuid ) );
+            PNS::ITEM*            item = member ? m_router->GetWorld()->FindItemByParent( member )
+                                                : nullptr;
+
+            if( item && item != m_startItem )
+                startItems.Add( item );
+        }
+    }
+
+    if( !m_router->StartRouting( m_startSnapPoint, startItems, routingLayer ) )
     {
         // It would make more sense to leave the net highlighted as the higher-contrast mode
         // makes the router clearances more visible.  However, since we just started routing
@@ -1172,6 +1203,12 @@ void ROUTER_TOOL::performRouting()
             updateEndItem( *evt );
             m_router->Move( m_endSnapPoint, m_endItem );
         }
+        else if( evt->Matches( EVT_RefineRoute ) )
+        {
+            // The shove of the last move has run out of time: go on with it in slices of
+            // the shove time limit for as long as the cursor doesn't move.
+            m_router->RefineRoute();
+        }
         else if( evt->IsAction( &PCB_ACTIONS::routerUndoLastSegment ) )
         {
             m_router->UndoLastSegment();
@@ -1258,8 +1295,14 @@ void ROUTER_TOOL::performRouting()
         {
             evt->SetPassEvent();
         }
+
+        if( m_router->RefinementPending() )
+            m_refineTimer.StartOnce( REFINE_ROUTE_DELAY );
+        else
+            m_refineTimer.Stop();
     }
 
+    m_refineTimer.Stop();
     m_router->CommitRouting();
 
     finishInteractive();
@@ -1360,6 +1403,27 @@ int ROUTER_TOOL::MainLoop( const TOOL_EVENT& aEvent )
             m_router->StopRouting();
     }
 
+    m_busMembers.clear();
+
+    if( mode == PNS::PNS_MODE_ROUTE_BUS )
+    {
+        for( EDA_ITEM* item : m_toolMgr->GetTool<PCB_SELECTION_TOOL>()->GetSelection() )
+        {
+            switch( item->Type() )
+            {
+            case PCB_PAD_T:
+            case PCB_VIA_T:
+            case PCB_TRACE_T:
+            case PCB_ARC_T:
+                m_busMembers.push_back( item->m_Uuid );
+                break;
+
+            default:
+                break;
+            }
+        }
+    }
+
     // Deselect all items
     m_toolMgr->RunAction( PCB_ACTIONS::selectionClear, true );
 
@@ -1440,7 +1504,8 @@ int ROUTER_TOOL::MainLoop( const TOOL_EVENT& aEvent )
         }
         else if( evt->IsClick( BUT_LEFT )
               || evt->IsAction( &PCB_ACTIONS::routeSingleTrack )
-              || evt->IsAction( &PCB_ACTIONS::routeDiffPair ) )
+              || evt->IsAction( &PCB_ACTIONS::routeDiffPair )
+              || evt->IsAction( &PCB_ACTIONS::routeBus ) )
         {
             updateStartItem( *evt );
 
@@ -2137,6 +2202,7 @@ void ROUTER_TOOL::setTransitions()
 
     Go( &ROUTER_TOOL::MainLoop,               PCB_ACTIONS::routeSingleTrack.MakeEvent() );
     Go( &ROUTER_TOOL::MainLoop,               PCB_ACTIONS::routeDiffPair.MakeEvent() );
+    Go( &ROUTER_TOOL::MainLoop,               PCB_ACTIONS::routeBus.MakeEvent() );
     Go( &ROUTER_TOOL::DpDimensionsDialog,     PCB_ACTIONS::routerDiffPairDialog.MakeEvent() );
     Go( &ROUTER_TOOL::SettingsDialog,         PCB_ACTIONS::routerSettingsDialog.MakeEvent() );
     Go( &ROUTER_TOOL::ChangeRouterMode,       PCB_ACTIONS::routerHighlightMode.MakeEvent() );
@@ -23,6 +23,12 @@
 #ifndef __ROUTER_TOOL_H
 #define __ROUTER_TOOL_H
 
+#include <vector>
+
+#include <wx/timer.h>
+
+#include <kiid.h>
+
 #include "pns_tool_base.h"
 
 class APIEXPORT ROUTER_TOOL : public PNS::TOOL_BASE
@@ -89,6 +95,12 @@ private:
     std::shared_ptr<ACTION_MENU> m_trackViaMenu;
 
     int                          m_lastTargetLayer;
+
+    ///< Items selected when the bus routing tool was started, to route the bus from.
+    std::vector<KIID>            m_busMembers;
+
+    ///< Restarted by every event while routing, refines the route once the cursor rests.
+    wxTimer                      m_refineTimer;
 };
 
 #endif
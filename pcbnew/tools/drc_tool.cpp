@@ -36,6 +36,8 @@
 #include <progress_reporter.h>
 #include <drc/drc_engine.h>
 #include <drc/drc_item.h>
+#include <pcb_marker.h>
+#include <view/view.h>
 #include <netlist_reader/pcb_netlist.h>
 
 DRC_TOOL::DRC_TOOL() :
@@ -202,6 +204,79 @@ void DRC_TOOL::RunTests( PROGRESS_REPORTER* aProgressReporter, bool aRefillZones
 }
 
 
+void DRC_TOOL::RunIncrementalTests( const std::vector<BOARD_ITEM*>& aChangedItems,
+                                    const std::vector<EDA_RECT>& aPreviousAreas,
+                                    const std::set<KIID>& aRemovedItems )
+{
+    if( m_drcRunning || !m_editFrame || !m_drcEngine || !m_drcEngine->RulesValid() )
+        return;
+
+    BOARD*                   board = m_editFrame->GetBoard();
+    BOARD_COMMIT             commit( m_editFrame );
+    std::vector<PCB_MARKER*> newMarkers;
+    std::vector<PCB_MARKER*> staleMarkers;
+    std::set<wxString>       exclusions;
+
+    m_drcRunning = true;
+
+    m_drcEngine->SetViolationHandler(
+            [&]( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )
+            {
+                newMarkers.push_back( new PCB_MARKER( aItem, aPos ) );
+            } );
+
+    m_drcEngine->RunIncrementalTests( m_editFrame->GetUserUnits(), aChangedItems,
+                                      aPreviousAreas, aRemovedItems );
+
+    m_drcEngine->ClearViolationHandler();
+
+    for( PCB_MARKER* marker : board->Markers() )
+    {
+        if( m_drcEngine->IsStaleMarker( marker ) )
+        {
+            if( marker->IsExcluded() )
+                exclusions.insert( marker->Serialize() );
+
+            staleMarkers.push_back( marker );
+        }
+    }
+
+    if( !staleMarkers.empty() || !newMarkers.empty() )
+    {
+        // The dialog's marker list may refer to the stale markers
+        if( m_drcDialog )
+            m_drcDialog->SetMarkersProvider( nullptr );
+
+        // The commit also drops the stale markers from the selection, if they are in it
+        for( PCB_MARKER* marker : staleMarkers )
+            commit.Remove( marker );
+
+        // Violations which were excluded before the edit stay excluded
+        for( PCB_MARKER* marker : newMarkers )
+        {
+            if( exclusions.count( marker->Serialize() ) )
+                marker->SetExcluded( true );
+
+            commit.Add( marker );
+        }
+
+        commit.Push( _( "DRC" ), false, false );
+
+        // Without an undo entry nothing else owns the removed markers
+        for( PCB_MARKER* marker : staleMarkers )
+            delete marker;
+
+        if( m_drcDialog )
+        {
+            m_drcDialog->SetMarkersProvider( new DRC_ITEMS_PROVIDER( board,
+                                                                     MARKER_BASE::MARKER_DRC ) );
+        }
+    }
+
+    m_drcRunning = false;
+}
+
+
 void DRC_TOOL::updatePointers()
 {
     // update my pointers, m_editFrame is the only unchangeable one
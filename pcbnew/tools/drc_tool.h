@@ -30,11 +30,15 @@
 #include <geometry/seg.h>
 #include <geometry/shape_poly_set.h>
 #include <memory>
+#include <set>
 #include <vector>
+#include <eda_rect.h>
+#include <kiid.h>
 #include <tools/pcb_tool_base.h>
 
 
 class PCB_EDIT_FRAME;
+class BOARD_ITEM;
 class DIALOG_DRC;
 class DRC_ITEM;
 class WX_PROGRESS_REPORTER;
@@ -83,6 +87,18 @@ public:
     void RunTests( PROGRESS_REPORTER* aProgressReporter, bool aRefillZones,
                    bool aReportAllTrackErrors, bool aTestFootprints );
 
+    /**
+     * Re-run the clearance tests around an edit of the board, replacing the markers they
+     * supersede and leaving all others alone.
+     *
+     * @param aChangedItems are the items added or modified by the edit.
+     * @param aPreviousAreas are the bounding boxes of modified and removed items before the edit.
+     * @param aRemovedItems are the ids of the items removed by the edit.
+     */
+    void RunIncrementalTests( const std::vector<BOARD_ITEM*>& aChangedItems,
+                              const std::vector<EDA_RECT>& aPreviousAreas,
+                              const std::set<KIID>& aRemovedItems );
+
     int PrevMarker( const TOOL_EVENT& aEvent );
     int NextMarker( const TOOL_EVENT& aEvent );
     int CrossProbe( const TOOL_EVENT& aEvent );
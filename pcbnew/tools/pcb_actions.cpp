@@ -1321,6 +1321,12 @@ TOOL_ACTION PCB_ACTIONS::routeDiffPair( "pcbnew.InteractiveRouter.DiffPair",
         _( "Route Differential Pair" ), _( "Route differential pairs" ),
         BITMAPS::ps_diff_pair, AF_ACTIVATE, (void*) PNS::PNS_MODE_ROUTE_DIFF_PAIR );
 
+TOOL_ACTION PCB_ACTIONS::routeBus( "pcbnew.InteractiveRouter.Bus",
+        AS_GLOBAL, 0, "",
+        _( "Route Bus" ),
+        _( "Route tracks from the selected pads, vias and track ends together" ),
+        BITMAPS::add_tracks, AF_ACTIVATE, (void*) PNS::PNS_MODE_ROUTE_BUS );
+
 TOOL_ACTION PCB_ACTIONS::routerSettingsDialog( "pcbnew.InteractiveRouter.SettingsDialog",
         AS_GLOBAL,
         MD_CTRL + MD_SHIFT + ',', LEGACY_HK_NAME( "Routing Options" ),
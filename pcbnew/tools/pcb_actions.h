@@ -177,6 +177,7 @@ public:
 
     /// Activation of the Push and Shove router (differential pair mode)
     static TOOL_ACTION routeDiffPair;
+    static TOOL_ACTION routeBus;
 
     /// Activation of the Push and Shove router (tune single line mode)
     static TOOL_ACTION routerTuneSingleTrace;
@@ -193,6 +193,9 @@ bool ZONE::UnFill()
     m_isFilled = false;
     m_fillFlags.clear();
 
+    if( change )
+        BumpGeometryRevision();
+
     return change;
 }
 
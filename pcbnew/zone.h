@@ -649,11 +649,13 @@ public:
     void CacheTriangulation( PCB_LAYER_ID aLayer = UNDEFINED_LAYER );
 
     /**
-     * Set the list of filled polygons.
+     * Set the list of filled polygons.  Refilling doesn't go through BOARD::OnItemChanged(),
+     * so this gives the zone a new geometry revision.
      */
     void SetFilledPolysList( PCB_LAYER_ID aLayer, const SHAPE_POLY_SET& aPolysList )
     {
         m_FilledPolysList[aLayer] = aPolysList;
+        BumpGeometryRevision();
     }
 
     /**
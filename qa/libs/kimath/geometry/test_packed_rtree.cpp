@@ -0,0 +1,164 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <geometry/packed_rtree.h>
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <random>
+#include <set>
+
+
+BOOST_AUTO_TEST_SUITE( PackedRTree )
+
+
+struct TEST_BOX
+{
+    int min[2];
+    int max[2];
+};
+
+
+static bool overlaps( const TEST_BOX& aA, const TEST_BOX& aB )
+{
+    return aA.min[0] <= aB.max[0] && aB.min[0] <= aA.max[0]
+           && aA.min[1] <= aB.max[1] && aB.min[1] <= aA.max[1];
+}
+
+
+static std::vector<TEST_BOX> randomBoxes( std::mt19937& aRng, int aCount, int aExtent,
+                                          int aMaxSize )
+{
+    std::uniform_int_distribution<int> pos( -aExtent, aExtent );
+    std::uniform_int_distribution<int> size( 0, aMaxSize );
+    std::vector<TEST_BOX>              boxes;
+
+    for( int ii = 0; ii < aCount; ii++ )
+    {
+        TEST_BOX box;
+        box.min[0] = pos( aRng );
+        box.min[1] = pos( aRng );
+        box.max[0] = box.min[0] + size( aRng );
+        box.max[1] = box.min[1] + size( aRng );
+        boxes.push_back( box );
+    }
+
+    return boxes;
+}
+
+
+BOOST_AUTO_TEST_CASE( Empty )
+{
+    PACKED_RTREE<int> tree;
+    tree.Build();
+
+    const int min[2] = { -100, -100 };
+    const int max[2] = { 100, 100 };
+
+    BOOST_CHECK( tree.empty() );
+    BOOST_CHECK_EQUAL( tree.Search( min, max, []( const int& ) { return true; } ), 0 );
+}
+
+
+/**
+ * Compare search results with a brute-force overlap test, for tree sizes around the node
+ * size boundaries.
+ */
+BOOST_AUTO_TEST_CASE( MatchesBruteForce )
+{
+    std::mt19937 rng( 1234 );
+
+    for( int count : { 1, 15, 16, 17, 256, 257, 5000 } )
+    {
+        BOOST_TEST_CONTEXT( "Item count " << count )
+        {
+            std::vector<TEST_BOX> boxes = randomBoxes( rng, count, 100000, 5000 );
+            std::vector<TEST_BOX> queries = randomBoxes( rng, 200, 100000, 20000 );
+
+            PACKED_RTREE<int> tree;
+
+            for( int ii = 0; ii < count; ii++ )
+                tree.Insert( boxes[ii].min, boxes[ii].max, ii );
+
+            tree.Build();
+
+            BOOST_CHECK( tree.IsBuilt() );
+            BOOST_CHECK_EQUAL( tree.size(), (size_t) count );
+
+            for( const TEST_BOX& query : queries )
+            {
+                std::set<int> expected;
+                std::set<int> found;
+
+                for( int ii = 0; ii < count; ii++ )
+                {
+                    if( overlaps( boxes[ii], query ) )
+                        expected.insert( ii );
+                }
+
+                auto visitor =
+                        [&]( int aItem ) -> bool
+                        {
+                            found.insert( aItem );
+                            return true;
+                        };
+
+                int visited = tree.Search( query.min, query.max, visitor );
+
+                BOOST_CHECK_EQUAL( visited, (int) expected.size() );
+                BOOST_CHECK( found == expected );
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( EarlyExit )
+{
+    PACKED_RTREE<int> tree;
+
+    for( int ii = 0; ii < 100; ii++ )
+    {
+        const int min[2] = { ii, 0 };
+        const int max[2] = { ii + 10, 10 };
+        tree.Insert( min, max, ii );
+    }
+
+    tree.Build();
+
+    const int min[2] = { 0, 0 };
+    const int max[2] = { 100, 10 };
+    int       calls = 0;
+
+    auto visitor =
+            [&]( int ) -> bool
+            {
+                return ++calls < 5;
+            };
+
+    BOOST_CHECK_EQUAL( tree.Search( min, max, visitor ), 5 );
+    BOOST_CHECK_EQUAL( calls, 5 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,131 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <geometry/shape_grid_index.h>
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <random>
+#include <set>
+
+
+BOOST_AUTO_TEST_SUITE( ShapeGridIndex )
+
+
+static std::vector<BOX2I> randomBoxes( std::mt19937& aRng, int aCount, int aExtent,
+                                       int aMaxSize )
+{
+    std::uniform_int_distribution<int> pos( -aExtent, aExtent );
+    std::uniform_int_distribution<int> size( 0, aMaxSize );
+    std::vector<BOX2I>                 boxes;
+
+    for( int ii = 0; ii < aCount; ii++ )
+    {
+        VECTOR2I origin( pos( aRng ), pos( aRng ) );
+        boxes.emplace_back( origin, VECTOR2I( size( aRng ), size( aRng ) ) );
+    }
+
+    return boxes;
+}
+
+
+static bool overlaps( const BOX2I& aA, const BOX2I& aB )
+{
+    return aA.GetX() <= aB.GetRight() && aB.GetX() <= aA.GetRight()
+           && aA.GetY() <= aB.GetBottom() && aB.GetY() <= aA.GetBottom();
+}
+
+
+/**
+ * Compare query results with a brute-force overlap test, with items around the origin (where
+ * the cell coordinates change sign), items spanning too many cells, and removed items.
+ */
+BOOST_AUTO_TEST_CASE( MatchesBruteForce )
+{
+    std::mt19937 rng( 1234 );
+
+    std::vector<BOX2I> boxes = randomBoxes( rng, 3000, 10000000, 3000000 );
+    std::vector<BOX2I> large = randomBoxes( rng, 20, 10000000, 60000000 );
+    std::vector<BOX2I> queries = randomBoxes( rng, 300, 10000000, 5000000 );
+
+    boxes.insert( boxes.end(), large.begin(), large.end() );
+
+    SHAPE_GRID_INDEX<int> grid;
+
+    for( int ii = 0; ii < (int) boxes.size(); ii++ )
+        grid.Add( ii, boxes[ii] );
+
+    for( int ii = 0; ii < (int) boxes.size(); ii += 3 )
+        grid.Remove( ii, boxes[ii] );
+
+    BOOST_CHECK_EQUAL( grid.Size(), boxes.size() - ( boxes.size() + 2 ) / 3 );
+
+    for( const BOX2I& query : queries )
+    {
+        std::set<int> expected;
+        std::multiset<int> found;
+
+        for( int ii = 0; ii < (int) boxes.size(); ii++ )
+        {
+            if( ii % 3 != 0 && overlaps( boxes[ii], query ) )
+                expected.insert( ii );
+        }
+
+        auto visitor =
+                [&]( int aItem ) -> bool
+                {
+                    found.insert( aItem );
+                    return true;
+                };
+
+        int visited = grid.Query( query, visitor );
+
+        BOOST_CHECK_EQUAL( visited, (int) expected.size() );
+        BOOST_CHECK( std::set<int>( found.begin(), found.end() ) == expected );
+        BOOST_CHECK_EQUAL( found.size(), expected.size() );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( EarlyExit )
+{
+    SHAPE_GRID_INDEX<int> grid;
+
+    for( int ii = 0; ii < 100; ii++ )
+        grid.Add( ii, BOX2I( VECTOR2I( ii * 100000, 0 ), VECTOR2I( 1000000, 1000000 ) ) );
+
+    int calls = 0;
+
+    auto visitor =
+            [&]( int ) -> bool
+            {
+                return ++calls < 5;
+            };
+
+    // Like RTree::Search(), the item that stopped the search isn't counted
+    BOOST_CHECK_EQUAL( grid.Query( BOX2I( VECTOR2I( 0, 0 ), VECTOR2I( 10000000, 1000000 ) ),
+                                   visitor ), 4 );
+    BOOST_CHECK_EQUAL( calls, 5 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -21,6 +21,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <type_traits>
+
 #include <geometry/shape_arc.h>
 #include <geometry/shape_line_chain.h>
 #include <trigo.h>
@@ -493,4 +495,51 @@ BOOST_AUTO_TEST_CASE( ReplaceChain )
 }
 
 
+// Moving a chain must carry the points, arc shapes and closure state across intact
+BOOST_AUTO_TEST_CASE( MoveKeepsArcs )
+{
+    SHAPE_LINE_CHAIN chain( { VECTOR2I( 0, 0 ), VECTOR2I( 0, 100000 ) } );
+    chain.Append( SHAPE_ARC( VECTOR2I( 0, 100000 ), VECTOR2I( 50000, 150000 ),
+                             VECTOR2I( 100000, 100000 ), 0 ) );
+    chain.SetClosed( true );
+
+    SHAPE_LINE_CHAIN reference( chain );
+    SHAPE_LINE_CHAIN moved( std::move( chain ) );
+
+    // A move leaves the source empty; a copy would leave it intact
+    BOOST_CHECK_EQUAL( chain.PointCount(), 0 );
+    BOOST_CHECK_EQUAL( chain.ArcCount(), 0 );
+
+    BOOST_CHECK( GEOM_TEST::IsOutlineValid( moved ) );
+    BOOST_CHECK_EQUAL( moved.PointCount(), reference.PointCount() );
+    BOOST_CHECK_EQUAL( moved.ArcCount(), reference.ArcCount() );
+    BOOST_CHECK_EQUAL( moved.IsClosed(), reference.IsClosed() );
+    BOOST_CHECK( moved.CompareGeometry( reference ) );
+
+    SHAPE_LINE_CHAIN assigned;
+    assigned = std::move( moved );
+
+    BOOST_CHECK_EQUAL( moved.PointCount(), 0 );
+
+    BOOST_CHECK( GEOM_TEST::IsOutlineValid( assigned ) );
+    BOOST_CHECK_EQUAL( assigned.ArcCount(), reference.ArcCount() );
+    BOOST_CHECK( assigned.CompareGeometry( reference ) );
+
+    static_assert( std::is_nothrow_move_constructible<SHAPE_LINE_CHAIN>::value,
+                   "vectors of line chains would copy them on reallocation" );
+
+    std::vector<SHAPE_LINE_CHAIN> chains;
+    chains.push_back( std::move( assigned ) );
+
+    const VECTOR2I* points = &chains[0].CPoint( 0 );
+
+    chains.reserve( 16 );
+
+    // A moved chain keeps its point buffer; a copied one would get a new one
+    BOOST_CHECK_EQUAL( &chains[0].CPoint( 0 ), points );
+    BOOST_CHECK( chains[0].CompareGeometry( reference ) );
+    BOOST_CHECK_EQUAL( chains[0].ArcCount(), reference.ArcCount() );
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -170,4 +170,102 @@ BOOST_AUTO_TEST_CASE( TestClearArcs )
     }
 }
 
+/**
+ * Inflate a polygon with InflateWithArcs() and check that every convex corner became an arc,
+ * that the hole shrank but survived and that the area matches the segment-based Inflate()
+ */
+BOOST_AUTO_TEST_CASE( TestInflateWithArcs )
+{
+    SHAPE_POLY_SET poly;
+
+    poly.NewOutline();
+    poly.Append( 0, 0 );
+    poly.Append( 1000000, 0 );
+    poly.Append( 1000000, 1000000 );
+    poly.Append( 500000, 400000 ); // concave corner: must not become an arc
+    poly.Append( 0, 1000000 );
+
+    poly.AddHole( SHAPE_LINE_CHAIN( { VECTOR2I( 400000, 100000 ), VECTOR2I( 600000, 100000 ),
+                                      VECTOR2I( 600000, 200000 ), VECTOR2I( 400000, 200000 ) },
+                                    true ) );
+
+    SHAPE_POLY_SET reference = poly;
+    reference.Inflate( 20000, 128 );
+
+    poly.InflateWithArcs( 20000, 100 );
+
+    BOOST_CHECK( GEOM_TEST::IsPolySetValid( poly ) );
+    BOOST_CHECK_EQUAL( poly.OutlineCount(), 1 );
+    BOOST_CHECK_EQUAL( poly.HoleCount( 0 ), 1 );
+    BOOST_CHECK_EQUAL( poly.Outline( 0 ).ArcCount(), 4 );
+    BOOST_CHECK_EQUAL( poly.Hole( 0, 0 ).ArcCount(), 0 );
+    BOOST_CHECK_CLOSE( poly.Area(), reference.Area(), 0.01 );
+}
+
+
+/**
+ * Expose the arc trimming used by InflateWithArcs()
+ */
+struct TRIMMABLE_CHAIN : public SHAPE_LINE_CHAIN
+{
+    using SHAPE_LINE_CHAIN::SHAPE_LINE_CHAIN;
+    using SHAPE_LINE_CHAIN::fitArcsToPoints;
+};
+
+
+/**
+ * Trim an arc whose surviving points run across the start of a closed chain and check that it
+ * is shrunk to the whole run rather than to the points nearest the ends of the chain
+ */
+BOOST_AUTO_TEST_CASE( TestFitArcCrossingChainStart )
+{
+    const double R = 1000000.0;
+
+    auto onCircle =
+            [&]( double aDegrees )
+            {
+                double a = aDegrees * M_PI / 180.0;
+                return VECTOR2I( KiROUND( R * cos( a ) ), KiROUND( R * sin( a ) ) );
+            };
+
+    // Clipper kept only the middle of this arc
+    std::vector<SHAPE_ARC> arcBuffer = { SHAPE_ARC( onCircle( -60 ), onCircle( 0 ),
+                                                    onCircle( 60 ), 0 ) };
+
+    std::vector<CLIPPER_Z_VALUE> zValues = { CLIPPER_Z_VALUE( { -1, -1 } ),
+                                             CLIPPER_Z_VALUE( { 0, -1 } ) };
+
+    SHAPE_LINE_CHAIN kept = SHAPE_ARC( onCircle( -30 ), onCircle( 0 ), onCircle( 30 ), 0 )
+                                    .ConvertToPolyline( 100 );
+
+    BOOST_REQUIRE_GE( kept.PointCount(), 4 );
+
+    // Start the path in the middle of the kept points so the arc wraps past vertex 0
+    int              split = kept.PointCount() / 2;
+    ClipperLib::Path path;
+
+    for( int ii = split; ii < kept.PointCount(); ii++ )
+        path.emplace_back( kept.CPoint( ii ).x, kept.CPoint( ii ).y, 1 );
+
+    path.emplace_back( -1000000, 1000000, 0 );
+    path.emplace_back( -1000000, -1000000, 0 );
+
+    for( int ii = 0; ii < split; ii++ )
+        path.emplace_back( kept.CPoint( ii ).x, kept.CPoint( ii ).y, 1 );
+
+    TRIMMABLE_CHAIN chain( path, zValues, arcBuffer );
+
+    BOOST_REQUIRE_EQUAL( chain.ArcCount(), 1 );
+    BOOST_REQUIRE( chain.IsPtOnArc( 0 ) );
+    BOOST_REQUIRE( chain.IsPtOnArc( chain.PointCount() - 1 ) );
+
+    chain.fitArcsToPoints();
+
+    BOOST_REQUIRE_EQUAL( chain.ArcCount(), 1 );
+    BOOST_CHECK_EQUAL( chain.Arc( 0 ).GetP0(), kept.CPoint( 0 ) );
+    BOOST_CHECK_EQUAL( chain.Arc( 0 ).GetP1(), kept.CPoint( -1 ) );
+    BOOST_CHECK_LE( ( chain.Arc( 0 ).GetCenter() - arcBuffer[0].GetCenter() ).EuclideanNorm(), 5 );
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,157 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <board.h>
+#include <pcb_track.h>
+#include <geometry/shape_segment.h>
+#include <drc/drc_distance_cache.h>
+
+
+struct DRC_DISTANCE_CACHE_FIXTURE
+{
+    DRC_DISTANCE_CACHE_FIXTURE()
+    {
+        m_trackA = new PCB_TRACK( &m_board );
+        m_trackA->SetStart( wxPoint( 0, 0 ) );
+        m_trackA->SetEnd( wxPoint( 1000000, 0 ) );
+        m_trackA->SetWidth( 200000 );
+        m_trackA->SetLayer( F_Cu );
+        m_board.Add( m_trackA );
+
+        // 300000 nm edge-to-edge from track A
+        m_trackB = new PCB_TRACK( &m_board );
+        m_trackB->SetStart( wxPoint( 0, 500000 ) );
+        m_trackB->SetEnd( wxPoint( 1000000, 500000 ) );
+        m_trackB->SetWidth( 200000 );
+        m_trackB->SetLayer( F_Cu );
+        m_board.Add( m_trackB );
+
+        m_cache.BeginRun( &m_board );
+    }
+
+    bool collide( int aClearance, int* aActual = nullptr, VECTOR2I* aLocation = nullptr )
+    {
+        std::shared_ptr<SHAPE> shapeA = m_trackA->GetEffectiveShape( F_Cu );
+        std::shared_ptr<SHAPE> shapeB = m_trackB->GetEffectiveShape( F_Cu );
+
+        return m_cache.Collide( m_trackA, shapeA.get(), DRC_SHAPE_TYPE::EFFECTIVE_SHAPE,
+                                m_trackB, shapeB.get(), DRC_SHAPE_TYPE::DRC_SHAPE,
+                                F_Cu, aClearance, aActual, aLocation );
+    }
+
+    BOARD              m_board;
+    PCB_TRACK*         m_trackA;
+    PCB_TRACK*         m_trackB;
+    DRC_DISTANCE_CACHE m_cache;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( DRCDistanceCache, DRC_DISTANCE_CACHE_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( AnswersMatchUncached )
+{
+    std::shared_ptr<SHAPE> shapeA = m_trackA->GetEffectiveShape( F_Cu );
+    std::shared_ptr<SHAPE> shapeB = m_trackB->GetEffectiveShape( F_Cu );
+
+    for( int pass = 0; pass < 2; pass++ )
+    {
+        for( int clearance : { 200000, 100000, 400000, 500000, 250000, 300000, 300001 } )
+        {
+            int      actual = -1, expectedActual = -1;
+            VECTOR2I location, expectedLocation;
+
+            bool expected = shapeA->Collide( shapeB.get(), clearance, &expectedActual,
+                                             &expectedLocation );
+
+            BOOST_TEST_CONTEXT( "Pass " << pass << ", clearance " << clearance )
+            {
+                BOOST_CHECK_EQUAL( collide( clearance, &actual, &location ), expected );
+
+                if( expected )
+                {
+                    BOOST_CHECK_EQUAL( actual, expectedActual );
+                    BOOST_CHECK( location == expectedLocation );
+                }
+            }
+        }
+    }
+
+    // One result per clearance, all of the second pass answered from the cache
+    BOOST_CHECK_EQUAL( m_cache.Size(), 7 );
+    BOOST_CHECK_EQUAL( m_cache.GetMissCount(), 7 );
+    BOOST_CHECK_EQUAL( m_cache.GetHitCount(), 7 );
+}
+
+
+BOOST_AUTO_TEST_CASE( ModifiedItemsAreRetested )
+{
+    BOOST_CHECK( !collide( 200000 ) );
+
+    m_trackB->Move( wxPoint( 0, -200000 ) );
+    m_board.OnItemChanged( m_trackB );
+
+    BOOST_CHECK( collide( 200000 ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( SubShapesAreKeptApart )
+{
+    // Two pieces of the same item, as the edge provider tests the segments of an outline
+    SHAPE_SEGMENT nearSeg( VECTOR2I( 0, 500000 ), VECTOR2I( 1000000, 500000 ), 200000 );
+    SHAPE_SEGMENT farSeg( VECTOR2I( 0, 5000000 ), VECTOR2I( 1000000, 5000000 ), 200000 );
+
+    std::shared_ptr<SHAPE> shapeA = m_trackA->GetEffectiveShape( F_Cu );
+
+    auto collideWith =
+            [&]( const SHAPE* aShape, int aSubShape )
+            {
+                return m_cache.Collide( { m_trackA, shapeA.get(), DRC_SHAPE_TYPE::EFFECTIVE_SHAPE,
+                                          F_Cu },
+                                        { m_trackB, aShape, DRC_SHAPE_TYPE::EFFECTIVE_SHAPE,
+                                          F_Cu, aSubShape },
+                                        400000, nullptr, nullptr );
+            };
+
+    BOOST_CHECK( collideWith( &nearSeg, 0 ) );
+    BOOST_CHECK( !collideWith( &farSeg, 1 ) );
+    BOOST_CHECK( collideWith( &nearSeg, 0 ) );
+    BOOST_CHECK_EQUAL( m_cache.Size(), 2 );
+}
+
+
+BOOST_AUTO_TEST_CASE( UnusedResultsAreDropped )
+{
+    BOOST_CHECK( !collide( 200000 ) );
+
+    m_cache.BeginRun( &m_board );
+    BOOST_CHECK_EQUAL( m_cache.Size(), 1 );
+
+    // Nothing used during the last run
+    m_cache.BeginRun( &m_board );
+    BOOST_CHECK_EQUAL( m_cache.Size(), 0 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
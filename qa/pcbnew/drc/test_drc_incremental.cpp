@@ -0,0 +1,168 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <board.h>
+#include <board_design_settings.h>
+#include <netinfo.h>
+#include <pcb_track.h>
+#include <pcb_marker.h>
+#include <drc/drc_item.h>
+#include <drc/drc_engine.h>
+#include <drc/drc_test_provider.h>
+
+
+struct DRC_INCREMENTAL_FIXTURE
+{
+    DRC_INCREMENTAL_FIXTURE() :
+            m_engine( &m_board, &m_board.GetDesignSettings() )
+    {
+        // Parallel tracks on separate nets; the default netclass asks for 0.2mm clearance, so
+        // tracks less than 0.4mm apart (center to center) collide.
+        const double ys[] = { 0.0, 0.5, 0.85, 2.0, 2.3, 3.5, 5.0, 5.3, 8.0 };
+
+        for( double y : ys )
+        {
+            int           code = m_tracks.size() + 1;
+            NETINFO_ITEM* net = new NETINFO_ITEM( &m_board, wxString::Format( "net%d", code ),
+                                                  code );
+            m_board.Add( net );
+
+            PCB_TRACK* track = new PCB_TRACK( &m_board );
+            track->SetStart( wxPoint( 0, Millimeter2iu( y ) ) );
+            track->SetEnd( wxPoint( Millimeter2iu( 10 ), Millimeter2iu( y ) ) );
+            track->SetWidth( Millimeter2iu( 0.2 ) );
+            track->SetLayer( F_Cu );
+            track->SetNet( net );
+            m_board.Add( track );
+
+            m_tracks.push_back( track );
+        }
+
+        m_engine.InitEngine( wxFileName() );
+
+        for( DRC_TEST_PROVIDER* provider : m_engine.GetTestProviders() )
+        {
+            std::set<int> codes = provider->GetRegionErrorCodes();
+            m_regionErrorCodes.insert( codes.begin(), codes.end() );
+        }
+
+        m_engine.SetViolationHandler(
+                [&]( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )
+                {
+                    m_markers.push_back( std::make_unique<PCB_MARKER>( aItem, aPos ) );
+                } );
+    }
+
+    /**
+     * @return the serialized markers for the errors incremental runs can re-test.
+     */
+    std::multiset<wxString> regionMarkers( const std::vector<PCB_MARKER*>& aMarkers )
+    {
+        std::multiset<wxString> result;
+
+        for( PCB_MARKER* marker : aMarkers )
+        {
+            if( m_regionErrorCodes.count( marker->GetRCItem()->GetErrorCode() ) )
+                result.insert( marker->Serialize() );
+        }
+
+        return result;
+    }
+
+    std::vector<PCB_MARKER*> takeMarkers()
+    {
+        std::vector<PCB_MARKER*> result;
+
+        for( std::unique_ptr<PCB_MARKER>& marker : m_markers )
+            result.push_back( marker.release() );
+
+        m_markers.clear();
+        return result;
+    }
+
+    BOARD                                    m_board;
+    DRC_ENGINE                               m_engine;
+    std::vector<PCB_TRACK*>                  m_tracks;
+    std::set<int>                            m_regionErrorCodes;
+    std::vector<std::unique_ptr<PCB_MARKER>> m_markers;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( DRCIncremental, DRC_INCREMENTAL_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( MatchesFullRun )
+{
+    m_engine.RunTests( EDA_UNITS::MILLIMETRES, true, false );
+
+    std::vector<PCB_MARKER*> before = takeMarkers();
+    BOOST_CHECK_EQUAL( regionMarkers( before ).size(), 3 );
+
+    // Move one track out of a collision and into another, and delete one of a colliding pair
+    PCB_TRACK* moved = m_tracks[3];
+    PCB_TRACK* removed = m_tracks[7];
+
+    std::vector<EDA_RECT> previousAreas = { moved->GetBoundingBox(), removed->GetBoundingBox() };
+
+    moved->Move( wxPoint( 0, Millimeter2iu( 1.25 ) ) );
+    m_board.OnItemChanged( moved );
+    m_board.Remove( removed );
+
+    m_engine.RunIncrementalTests( EDA_UNITS::MILLIMETRES, { moved }, previousAreas,
+                                  { removed->m_Uuid } );
+
+    std::vector<PCB_MARKER*> incremental = takeMarkers();
+    std::vector<PCB_MARKER*> kept;
+    int                      stale = 0;
+
+    for( PCB_MARKER* marker : before )
+    {
+        if( m_engine.IsStaleMarker( marker ) )
+            stale++;
+        else
+            kept.push_back( marker );
+    }
+
+    // The 2.0/2.3 and 5.0/5.3 collisions were re-tested; the 0.5/0.85 one was not
+    BOOST_CHECK_EQUAL( stale, 2 );
+    BOOST_CHECK_EQUAL( regionMarkers( incremental ).size(), 1 );
+
+    kept.insert( kept.end(), incremental.begin(), incremental.end() );
+
+    m_engine.RunTests( EDA_UNITS::MILLIMETRES, true, false );
+
+    std::vector<PCB_MARKER*> after = takeMarkers();
+
+    BOOST_CHECK( regionMarkers( kept ) == regionMarkers( after ) );
+
+    for( std::vector<PCB_MARKER*>* markers : { &before, &incremental, &after } )
+    {
+        for( PCB_MARKER* marker : *markers )
+            delete marker;
+    }
+
+    delete removed;
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,147 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <board.h>
+#include <footprint.h>
+#include <pad.h>
+#include <netinfo.h>
+#include <pcb_track.h>
+#include <drc/drc_net_topology.h>
+
+
+BOOST_AUTO_TEST_SUITE( DRCNetTopology )
+
+
+BOOST_AUTO_TEST_CASE( NetChains )
+{
+    BOARD         board;
+    NETINFO_ITEM* net = new NETINFO_ITEM( &board, "net1", 1 );
+    board.Add( net );
+
+    std::vector<PCB_TRACK*> tracks;
+
+    auto addTrack =
+            [&]( double x1, double y1, double x2, double y2 )
+            {
+                PCB_TRACK* track = new PCB_TRACK( &board );
+                track->SetStart( wxPoint( Millimeter2iu( x1 ), Millimeter2iu( y1 ) ) );
+                track->SetEnd( wxPoint( Millimeter2iu( x2 ), Millimeter2iu( y2 ) ) );
+                track->SetWidth( Millimeter2iu( 0.2 ) );
+                track->SetLayer( F_Cu );
+                track->SetNet( net );
+                board.Add( track );
+                tracks.push_back( track );
+            };
+
+    addTrack( 1, 0, 3, 0 );
+    addTrack( 0, 0, 1, 0 );
+    addTrack( 3, 0, 3, 4 );
+
+    PCB_VIA* via = new PCB_VIA( &board );
+    via->SetPosition( wxPoint( Millimeter2iu( 3 ), Millimeter2iu( 4 ) ) );
+    via->SetNet( net );
+    board.Add( via );
+
+    addTrack( 3, 4, 6, 4 );
+
+    FOOTPRINT* footprint = new FOOTPRINT( &board );
+    PAD*       pad = new PAD( footprint );
+    pad->SetPosition( wxPoint( 0, 0 ) );
+    pad->SetPadToDieLength( Millimeter2iu( 1.5 ) );
+    pad->SetNet( net );
+    footprint->Add( pad );
+    board.Add( footprint );
+
+    DRC_NET_TOPOLOGY topology( &board );
+    topology.Build();
+
+    const DRC_NET_TOPOLOGY::NET* topo = topology.GetNet( 1 );
+
+    BOOST_REQUIRE( topo );
+    BOOST_CHECK_EQUAL( topo->routedItems.size(), 5 );
+    BOOST_CHECK_EQUAL( topo->pads.size(), 1 );
+    BOOST_CHECK_EQUAL( topo->viaLength, DRC_NET_TOPOLOGY::ViaLength( &board, via ) );
+    BOOST_CHECK_EQUAL( topo->padToDieLength, Millimeter2iu( 1.5 ) );
+
+    // One chain from the pad, through the via, to the dangling end
+    BOOST_REQUIRE_EQUAL( topo->chains.size(), 1 );
+
+    const DRC_NET_TOPOLOGY::CHAIN& chain = topo->chains[0];
+    const std::vector<BOARD_CONNECTED_ITEM*> order = { tracks[1], tracks[0], tracks[2], via,
+                                                       tracks[3] };
+    const double lengths[] = { 1, 3, 7, 7, 10 };
+    const int    vias[] = { 0, 0, 0, 1, 1 };
+
+    BOOST_REQUIRE_EQUAL( chain.items.size(), order.size() );
+
+    for( size_t ii = 0; ii < order.size(); ++ii )
+    {
+        BOOST_CHECK( chain.items[ii] == order[ii] );
+        BOOST_CHECK_CLOSE( chain.cumulativeLength[ii], Millimeter2iu( lengths[ii] ), 1e-6 );
+        BOOST_CHECK_EQUAL( chain.cumulativeVias[ii], vias[ii] );
+    }
+
+    BOOST_CHECK_CLOSE( chain.Length(), Millimeter2iu( 10 ), 1e-6 );
+    BOOST_CHECK_EQUAL( chain.ViaCount(), 1 );
+    BOOST_CHECK_CLOSE( chain.Length( 2, 4 ), Millimeter2iu( 7 ), 1e-6 );
+
+    // Subsets are added up a run at a time, and what isn't on a chain is handed back
+    std::vector<BOARD_CONNECTED_ITEM*> others;
+    DRC_NET_TOPOLOGY::TOTALS           totals = topology.Sum( 1, { tracks[1], tracks[2], via,
+                                                                   pad }, &others );
+
+    BOOST_CHECK_CLOSE( totals.trackLength, Millimeter2iu( 5 ), 1e-6 );
+    BOOST_CHECK_EQUAL( totals.viaCount, 1 );
+    BOOST_REQUIRE_EQUAL( others.size(), 1 );
+    BOOST_CHECK( others[0] == pad );
+
+    BOOST_CHECK( topology.GetNet( 2 ) == nullptr );
+
+    // A branch splits the chains
+    addTrack( 3, 0, 3, -2 );
+    topology.Build();
+
+    topo = topology.GetNet( 1 );
+
+    BOOST_REQUIRE( topo );
+    BOOST_CHECK_EQUAL( topo->chains.size(), 3 );
+
+    double length = 0.0;
+    int    viaCount = 0;
+
+    for( const DRC_NET_TOPOLOGY::CHAIN& branch : topo->chains )
+    {
+        length += branch.Length();
+        viaCount += branch.ViaCount();
+    }
+
+    BOOST_CHECK_CLOSE( length, Millimeter2iu( 12 ), 1e-6 );
+    BOOST_CHECK_EQUAL( viaCount, 1 );
+
+    // Restricted to other nets, this one isn't computed
+    topology.Build( { 2 } );
+    BOOST_CHECK( topology.GetNet( 1 ) == nullptr );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
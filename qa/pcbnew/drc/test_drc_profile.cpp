@@ -0,0 +1,104 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <nlohmann/json.hpp>
+#include <board.h>
+#include <board_design_settings.h>
+#include <netinfo.h>
+#include <pcb_track.h>
+#include <drc/drc_item.h>
+#include <drc/drc_engine.h>
+#include <drc/drc_profile.h>
+
+
+struct DRC_PROFILE_FIXTURE
+{
+    DRC_PROFILE_FIXTURE() :
+            m_engine( &m_board, &m_board.GetDesignSettings() )
+    {
+        for( int ii = 0; ii < 2; ++ii )
+        {
+            NETINFO_ITEM* net = new NETINFO_ITEM( &m_board, wxString::Format( "net%d", ii + 1 ),
+                                                  ii + 1 );
+            m_board.Add( net );
+
+            PCB_TRACK* track = new PCB_TRACK( &m_board );
+            track->SetStart( wxPoint( 0, Millimeter2iu( 0.3 * ii ) ) );
+            track->SetEnd( wxPoint( Millimeter2iu( 10 ), Millimeter2iu( 0.3 * ii ) ) );
+            track->SetWidth( Millimeter2iu( 0.2 ) );
+            track->SetLayer( F_Cu );
+            track->SetNet( net );
+            m_board.Add( track );
+        }
+
+        m_engine.InitEngine( wxFileName() );
+        m_engine.SetViolationHandler( []( const std::shared_ptr<DRC_ITEM>&, wxPoint ) {} );
+    }
+
+    BOARD      m_board;
+    DRC_ENGINE m_engine;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( DRCProfile, DRC_PROFILE_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( NotProfiledByDefault )
+{
+    m_engine.RunTests( EDA_UNITS::MILLIMETRES, true, false );
+
+    BOOST_CHECK( m_engine.GetProfile().GetProviderStats().empty() );
+}
+
+
+BOOST_AUTO_TEST_CASE( ProviderStats )
+{
+    m_engine.SetProfiling( true );
+    m_engine.RunTests( EDA_UNITS::MILLIMETRES, true, false );
+
+    const std::vector<DRC_PROFILE::PROVIDER_STATS>& stats =
+            m_engine.GetProfile().GetProviderStats();
+
+    BOOST_CHECK_EQUAL( stats.size(), m_engine.GetTestProviders().size() );
+
+    int64_t queries = 0;
+
+    for( const DRC_PROFILE::PROVIDER_STATS& provider : stats )
+    {
+        BOOST_CHECK( !provider.name.IsEmpty() );
+        BOOST_CHECK_GE( provider.wallMs, 0.0 );
+        queries += provider.rtreeQueries;
+    }
+
+    // The copper clearance test at least searches for each track's neighbours
+    BOOST_CHECK_GE( queries, 2 );
+
+    nlohmann::json js = nlohmann::json::parse( m_engine.GetProfile().ToJSON().ToStdString() );
+
+    BOOST_CHECK_EQUAL( js["providers"].size(), stats.size() );
+    BOOST_CHECK_EQUAL( js["rtree_queries"].get<int64_t>(), queries );
+    BOOST_CHECK( js["rules"].is_array() );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
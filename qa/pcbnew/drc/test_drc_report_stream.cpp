@@ -0,0 +1,112 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <wx/filename.h>
+#include <board.h>
+#include <board_design_settings.h>
+#include <netinfo.h>
+#include <pcb_track.h>
+#include <drc/drc_item.h>
+#include <drc/drc_engine.h>
+#include <drc/drc_report_stream.h>
+
+
+BOOST_AUTO_TEST_SUITE( DRCReportStream )
+
+
+BOOST_AUTO_TEST_CASE( WritesOneLinePerViolation )
+{
+    BOARD      board;
+    DRC_ENGINE engine( &board, &board.GetDesignSettings() );
+
+    // Colliding pairs of tracks on separate nets (the default netclass asks for 0.2mm)
+    const double ys[] = { 0.0, 0.3, 2.0, 2.3, 4.0 };
+
+    for( double y : ys )
+    {
+        int           code = board.GetNetCount();
+        NETINFO_ITEM* net = new NETINFO_ITEM( &board, wxString::Format( "net%d", code ), code );
+        board.Add( net );
+
+        PCB_TRACK* track = new PCB_TRACK( &board );
+        track->SetStart( wxPoint( 0, Millimeter2iu( y ) ) );
+        track->SetEnd( wxPoint( Millimeter2iu( 10 ), Millimeter2iu( y ) ) );
+        track->SetWidth( Millimeter2iu( 0.2 ) );
+        track->SetLayer( F_Cu );
+        track->SetNet( net );
+        board.Add( track );
+    }
+
+    engine.InitEngine( wxFileName() );
+
+    wxString          path = wxFileName::CreateTempFileName( "drc_stream" );
+    DRC_REPORT_STREAM stream( &board, EDA_UNITS::MILLIMETRES );
+    int               reported = 0;
+
+    BOOST_REQUIRE( stream.Open( path ) );
+
+    engine.SetViolationHandler(
+            [&]( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )
+            {
+                stream.Report( aItem, aPos );
+                reported++;
+            } );
+
+    engine.RunTests( EDA_UNITS::MILLIMETRES, true, false );
+    engine.ClearViolationHandler();
+
+    BOOST_CHECK_EQUAL( stream.GetCount(), reported );
+    BOOST_CHECK( stream.Close() );
+
+    std::ifstream input( path.ToStdString() );
+    std::string   line;
+    int           lines = 0;
+    int           clearances = 0;
+
+    while( std::getline( input, line ) )
+    {
+        nlohmann::json js = nlohmann::json::parse( line );
+
+        BOOST_CHECK( js.contains( "severity" ) );
+        BOOST_CHECK( js.contains( "items" ) );
+
+        if( js["code"].get<int>() == DRCE_CLEARANCE )
+        {
+            clearances++;
+            BOOST_CHECK_EQUAL( js["type"].get<std::string>(), "clearance" );
+            BOOST_CHECK_EQUAL( js["items"].size(), 2 );
+        }
+
+        lines++;
+    }
+
+    BOOST_CHECK_EQUAL( lines, reported );
+    BOOST_CHECK_EQUAL( clearances, 2 );
+
+    wxRemoveFile( path );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
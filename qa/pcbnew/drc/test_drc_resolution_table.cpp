@@ -0,0 +1,230 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <fstream>
+#include <wx/filename.h>
+#include <board.h>
+#include <board_design_settings.h>
+#include <netclass.h>
+#include <netinfo.h>
+#include <pcb_track.h>
+#include <reporter.h>
+#include <drc/drc_rule.h>
+#include <drc/drc_engine.h>
+
+
+/**
+ * Three nets on two netclasses, with a track each on F_Cu and B_Cu.
+ *
+ * EvalRules() resolves constraints whose conditions read only nets, netclasses and types from
+ * its resolution tables; passing it a REPORTER makes it walk the rules one by one instead,
+ * which is the reference the table results are checked against.
+ */
+struct DRC_RESOLUTION_TABLE_FIXTURE
+{
+    DRC_RESOLUTION_TABLE_FIXTURE() :
+            m_engine( &m_board, &m_board.GetDesignSettings() )
+    {
+        NETCLASSES& netclasses = m_board.GetDesignSettings().GetNetClasses();
+
+        m_classA = std::make_shared<NETCLASS>( "A" );
+        m_classA->SetClearance( Millimeter2iu( 0.3 ) );
+        netclasses.Add( m_classA );
+
+        m_classB = std::make_shared<NETCLASS>( "B" );
+        m_classB->SetClearance( Millimeter2iu( 0.4 ) );
+        netclasses.Add( m_classB );
+
+        for( int ii = 0; ii < 3; ++ii )
+        {
+            NETINFO_ITEM* net = new NETINFO_ITEM( &m_board, wxString::Format( "net%d", ii + 1 ),
+                                                  ii + 1 );
+            net->SetNetClass( ii == 2 ? m_classB : m_classA );
+            m_board.Add( net );
+            m_nets.push_back( net );
+
+            for( PCB_LAYER_ID layer : { F_Cu, B_Cu } )
+            {
+                PCB_TRACK* track = new PCB_TRACK( &m_board );
+                track->SetStart( wxPoint( 0, Millimeter2iu( ii ) ) );
+                track->SetEnd( wxPoint( Millimeter2iu( 10 ), Millimeter2iu( ii ) ) );
+                track->SetWidth( Millimeter2iu( 0.2 ) );
+                track->SetLayer( layer );
+                track->SetNet( net );
+                m_board.Add( track );
+                m_tracks.push_back( track );
+            }
+        }
+
+        m_rulesPath = wxFileName( wxFileName::CreateTempFileName( "drc_rules" ) );
+    }
+
+    ~DRC_RESOLUTION_TABLE_FIXTURE()
+    {
+        wxRemoveFile( m_rulesPath.GetFullPath() );
+    }
+
+    void writeRules( const std::string& aRules )
+    {
+        std::ofstream output( m_rulesPath.GetFullPath().ToStdString() );
+        output << "(version 1)\n" << aRules;
+    }
+
+    /**
+     * Check every pair of tracks resolves to the same constraint through the table (twice, so
+     * both the filling and the reading path are covered) as through full evaluation.
+     */
+    void checkAgainstFullEvaluation( DRC_CONSTRAINT_T aType )
+    {
+        for( PCB_TRACK* a : m_tracks )
+        {
+            for( PCB_TRACK* b : m_tracks )
+            {
+                if( a == b )
+                    continue;
+
+                BOOST_TEST_CONTEXT( a->GetNetname() << " " << LayerName( a->GetLayer() ) << " / "
+                                    << b->GetNetname() << " " << LayerName( b->GetLayer() ) )
+                {
+                    DRC_CONSTRAINT full = m_engine.EvalRules( aType, a, b, a->GetLayer(),
+                                                              &NULL_REPORTER::GetInstance() );
+
+                    for( int pass = 0; pass < 2; ++pass )
+                    {
+                        DRC_CONSTRAINT table = m_engine.EvalRules( aType, a, b, a->GetLayer() );
+
+                        BOOST_CHECK_EQUAL( table.GetParentRule(), full.GetParentRule() );
+                        BOOST_CHECK_EQUAL( table.GetSeverity(), full.GetSeverity() );
+                        BOOST_CHECK_EQUAL( table.GetValue().HasMin(), full.GetValue().HasMin() );
+                        BOOST_CHECK_EQUAL( table.GetValue().Min(), full.GetValue().Min() );
+                        BOOST_CHECK_EQUAL( table.GetValue().Opt(), full.GetValue().Opt() );
+                        BOOST_CHECK_EQUAL( table.GetValue().Max(), full.GetValue().Max() );
+                    }
+                }
+            }
+        }
+    }
+
+    void checkAll()
+    {
+        checkAgainstFullEvaluation( CLEARANCE_CONSTRAINT );
+        checkAgainstFullEvaluation( TRACK_WIDTH_CONSTRAINT );
+        checkAgainstFullEvaluation( HOLE_CLEARANCE_CONSTRAINT );
+    }
+
+    int clearance( int aTrackA, int aTrackB )
+    {
+        return m_engine.EvalRules( CLEARANCE_CONSTRAINT, m_tracks[ aTrackA ], m_tracks[ aTrackB ],
+                                   m_tracks[ aTrackA ]->GetLayer() ).GetValue().Min();
+    }
+
+    BOARD                      m_board;
+    DRC_ENGINE                 m_engine;
+    NETCLASSPTR                m_classA;
+    NETCLASSPTR                m_classB;
+    std::vector<NETINFO_ITEM*> m_nets;
+    std::vector<PCB_TRACK*>    m_tracks;   ///< net1 F_Cu, net1 B_Cu, net2 F_Cu, ...
+    wxFileName                 m_rulesPath;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( DRCResolutionTable, DRC_RESOLUTION_TABLE_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( ImplicitRules )
+{
+    m_engine.InitEngine( wxFileName() );
+
+    checkAll();
+
+    BOOST_CHECK_EQUAL( clearance( 0, 2 ), Millimeter2iu( 0.3 ) );
+    BOOST_CHECK_EQUAL( clearance( 4, 0 ), Millimeter2iu( 0.4 ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( NetclassAssignmentChange )
+{
+    m_engine.InitEngine( wxFileName() );
+    checkAll();
+
+    // Moving a net to another netclass doesn't touch the board timestamp; the new netclass
+    // must still be seen, whether or not the rules are reloaded.
+    m_nets[0]->SetNetClass( m_classB );
+
+    checkAll();
+    BOOST_CHECK_EQUAL( clearance( 0, 2 ), Millimeter2iu( 0.4 ) );
+
+    m_engine.InitEngine( wxFileName() );
+
+    checkAll();
+    BOOST_CHECK_EQUAL( clearance( 0, 2 ), Millimeter2iu( 0.4 ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( NetclassClearanceChange )
+{
+    m_engine.InitEngine( wxFileName() );
+    checkAll();
+
+    // Netclass values reach the engine as implicit rules, which are rebuilt by InitEngine()
+    m_classA->SetClearance( Millimeter2iu( 0.6 ) );
+    m_engine.InitEngine( wxFileName() );
+
+    checkAll();
+    BOOST_CHECK_EQUAL( clearance( 0, 2 ), Millimeter2iu( 0.6 ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( RulesChange )
+{
+    writeRules( "(rule \"A to B\"\n"
+                "   (constraint clearance (min 0.5mm))\n"
+                "   (condition \"A.NetClass == 'A' && B.NetClass == 'B'\"))\n" );
+    m_engine.InitEngine( m_rulesPath );
+
+    checkAll();
+    BOOST_CHECK_EQUAL( clearance( 0, 4 ), Millimeter2iu( 0.5 ) );
+    BOOST_CHECK_EQUAL( clearance( 0, 2 ), Millimeter2iu( 0.3 ) );
+
+    // A net name condition switches the table to keying on nets
+    writeRules( "(rule \"net1 to net2\"\n"
+                "   (constraint clearance (min 0.7mm))\n"
+                "   (condition \"A.NetName == 'net1' && B.NetName == 'net2'\"))\n"
+                "(rule \"wide B\"\n"
+                "   (constraint track_width (min 0.25mm) (opt 0.3mm))\n"
+                "   (condition \"A.NetClass == 'B'\"))\n" );
+    m_engine.InitEngine( m_rulesPath );
+
+    checkAll();
+    BOOST_CHECK_EQUAL( clearance( 0, 2 ), Millimeter2iu( 0.7 ) );
+    BOOST_CHECK_EQUAL( clearance( 0, 4 ), Millimeter2iu( 0.4 ) );
+
+    // ... and the net assignment of an item is then part of the key
+    m_tracks[2]->SetNet( m_nets[2] );
+
+    checkAll();
+    BOOST_CHECK_EQUAL( clearance( 0, 2 ), Millimeter2iu( 0.4 ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,175 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <qa/pcbnew/board_test_utils.h>
+
+#include <algorithm>
+#include <tuple>
+
+#include <board.h>
+#include <board_design_settings.h>
+#include <connectivity/connectivity_data.h>
+#include <drc/drc_engine.h>
+#include <drc/drc_item.h>
+#include <pcb_track.h>
+#include <router/pns_autorouter.h>
+#include <settings/settings_manager.h>
+
+
+struct PNS_AUTOROUTER_TEST_FIXTURE
+{
+    ///< Type, net, layer, width, start and end of a track or via.
+    typedef std::tuple<int, int, int, int, int, int, int, int> TRACK_KEY;
+
+    PNS_AUTOROUTER_TEST_FIXTURE() :
+            m_settingsManager( true /* headless */ )
+    { }
+
+    ///< Load the board \a aRelPath from the QA data, without its tracks and vias.
+    void loadUnrouted( const wxString& aRelPath )
+    {
+        KI_TEST::LoadBoard( m_settingsManager, aRelPath, m_board );
+
+        TRACKS tracks = m_board->Tracks();
+
+        for( PCB_TRACK* track : tracks )
+        {
+            m_board->Remove( track );
+            delete track;
+        }
+
+        m_board->BuildConnectivity();
+    }
+
+    ///< @return the tracks and vias of the board, sorted so that two runs can be compared.
+    std::vector<TRACK_KEY> routedTracks() const
+    {
+        std::vector<TRACK_KEY> keys;
+
+        for( PCB_TRACK* track : m_board->Tracks() )
+        {
+            keys.emplace_back( track->Type(), track->GetNetCode(), track->GetLayer(),
+                               track->GetWidth(), track->GetStart().x, track->GetStart().y,
+                               track->GetEnd().x, track->GetEnd().y );
+        }
+
+        std::sort( keys.begin(), keys.end() );
+        return keys;
+    }
+
+    ///< @return the DRC errors of the board involving a track or a via.
+    int trackViolations()
+    {
+        BOARD_DESIGN_SETTINGS& bds = m_board->GetDesignSettings();
+        int                    count = 0;
+
+        bds.m_DRCSeverities[ DRCE_INVALID_OUTLINE ] = SEVERITY::RPT_SEVERITY_IGNORE;
+        bds.m_DRCSeverities[ DRCE_UNCONNECTED_ITEMS ] = SEVERITY::RPT_SEVERITY_IGNORE;
+
+        bds.m_DRCEngine->SetViolationHandler(
+                [&]( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )
+                {
+                    if( bds.GetSeverity( aItem->GetErrorCode() ) != SEVERITY::RPT_SEVERITY_ERROR )
+                        return;
+
+                    for( const KIID& id : { aItem->GetMainItemID(), aItem->GetAuxItemID() } )
+                    {
+                        BOARD_ITEM* item = m_board->GetItem( id );
+
+                        if( item && ( item->Type() == PCB_TRACE_T || item->Type() == PCB_ARC_T
+                                      || item->Type() == PCB_VIA_T ) )
+                        {
+                            BOOST_TEST_MESSAGE( aItem->GetErrorMessage() );
+                            count++;
+                            break;
+                        }
+                    }
+                } );
+
+        bds.m_DRCEngine->RunTests( EDA_UNITS::MILLIMETRES, true, false );
+
+        return count;
+    }
+
+    SETTINGS_MANAGER       m_settingsManager;
+    std::unique_ptr<BOARD> m_board;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( PNSAutorouter, PNS_AUTOROUTER_TEST_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( RoutesSmallBoard )
+{
+    loadUnrouted( "issue8883" );
+
+    int edges = (int) m_board->GetConnectivity()->GetUnconnectedCount();
+
+    BOOST_REQUIRE_GT( edges, 0 );
+
+    PNS_AUTOROUTER autorouter( m_board.get() );
+    autorouter.SetThreadCount( 1 );
+
+    int unrouted = autorouter.Run();
+
+    BOOST_CHECK_EQUAL( unrouted, autorouter.GetUnroutedCount() );
+    BOOST_CHECK_EQUAL( autorouter.GetRoutedCount() + unrouted, edges );
+    BOOST_CHECK_GT( autorouter.GetRoutedCount(), 0 );
+
+    // Routing an edge may connect others on the way, never the opposite
+    BOOST_CHECK_LE( (int) m_board->GetConnectivity()->GetUnconnectedCount(), unrouted );
+
+    BOOST_CHECK( !routedTracks().empty() );
+    BOOST_CHECK_EQUAL( trackViolations(), 0 );
+}
+
+
+BOOST_AUTO_TEST_CASE( SeveralThreadsRouteCleanly )
+{
+    int routed[2];
+    int unrouted[2];
+
+    for( int i = 0; i < 2; ++i )
+    {
+        loadUnrouted( "issue8883" );
+
+        PNS_AUTOROUTER autorouter( m_board.get() );
+        autorouter.SetThreadCount( i == 0 ? 1 : 4 );
+        autorouter.Run();
+
+        routed[i] = autorouter.GetRoutedCount();
+        unrouted[i] = autorouter.GetUnroutedCount();
+
+        BOOST_CHECK_EQUAL( trackViolations(), 0 );
+    }
+
+    // Which connections a region gets to route first depends on the thread schedule, so the
+    // counts may differ; the connections to route may not, and threading must not cost many
+    BOOST_CHECK_EQUAL( routed[0] + unrouted[0], routed[1] + unrouted[1] );
+    BOOST_CHECK_GT( routed[1], 0 );
+    BOOST_CHECK_GE( routed[1], routed[0] * 9 / 10 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
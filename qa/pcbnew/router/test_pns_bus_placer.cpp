@@ -0,0 +1,151 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <qa/pcbnew/board_test_utils.h>
+
+#include <board.h>
+#include <footprint.h>
+#include <pad.h>
+#include <pcb_track.h>
+#include <router/pns_kicad_iface.h>
+#include <router/pns_node.h>
+#include <router/pns_router.h>
+#include <router/pns_routing_settings.h>
+#include <router/pns_segment.h>
+#include <settings/settings_manager.h>
+
+
+struct PNS_BUS_PLACER_TEST_FIXTURE
+{
+    PNS_BUS_PLACER_TEST_FIXTURE() :
+            m_settingsManager( true /* headless */ ),
+            m_routingSettings( nullptr, "" )
+    { }
+
+    ///< Load \a aRelPath without its tracks, and set up a router on it.
+    void loadUnrouted( const wxString& aRelPath )
+    {
+        KI_TEST::LoadBoard( m_settingsManager, aRelPath, m_board );
+
+        TRACKS tracks = m_board->Tracks();
+
+        for( PCB_TRACK* track : tracks )
+        {
+            m_board->Remove( track );
+            delete track;
+        }
+
+        m_board->BuildConnectivity();
+
+        m_iface = std::make_unique<PNS_KICAD_IFACE_BASE>();
+        m_router = std::make_unique<PNS::ROUTER>();
+
+        m_iface->SetBoard( m_board.get() );
+        m_router->SetInterface( m_iface.get() );
+        m_router->ClearWorld();
+        m_router->LoadSettings( &m_routingSettings );
+        m_router->SyncWorld();
+        m_router->Sizes().SetTrackWidth( 200000 );
+    }
+
+    PNS::ITEM* padItem( const wxString& aReference, const wxString& aPadNumber )
+    {
+        FOOTPRINT* footprint = m_board->FindFootprintByReference( aReference );
+        PAD*       pad = footprint ? footprint->FindPadByNumber( aPadNumber ) : nullptr;
+
+        return pad ? m_router->GetWorld()->FindItemByParent( pad ) : nullptr;
+    }
+
+    SETTINGS_MANAGER                      m_settingsManager;
+    std::unique_ptr<BOARD>                m_board;
+    PNS::ROUTING_SETTINGS                 m_routingSettings;
+    std::unique_ptr<PNS_KICAD_IFACE_BASE> m_iface;
+    std::unique_ptr<PNS::ROUTER>          m_router;    ///< last, uses the interface and settings
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( PNSBusPlacer, PNS_BUS_PLACER_TEST_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( RoutesEveryMemberClear )
+{
+    loadUnrouted( "issue8883" );
+    m_router->SetMode( PNS::PNS_MODE_ROUTE_BUS );
+
+    for( PNS::PNS_MODE mode : { PNS::RM_Walkaround, PNS::RM_Shove } )
+    {
+        BOOST_TEST_CONTEXT( "Router mode " << mode )
+        {
+            m_routingSettings.SetMode( mode );
+            m_router->SyncWorld();
+
+            // Two pads of the top row of the LQFP, a millimetre apart, routed upwards
+            PNS::ITEM* lead = padItem( "IC2", "41" );
+            PNS::ITEM* other = padItem( "IC2", "43" );
+
+            BOOST_REQUIRE( lead && other );
+            BOOST_REQUIRE_NE( lead->Net(), other->Net() );
+
+            PNS::ITEM_SET members( lead );
+            members.Add( other );
+
+            VECTOR2I start = lead->Anchor( 0 );
+            VECTOR2I end = start - VECTOR2I( 0, 3000000 );
+
+            BOOST_REQUIRE( m_router->StartRouting( start, members, F_Cu ) );
+
+            m_router->Move( end, nullptr );
+
+            BOOST_CHECK( m_router->FixRoute( end, nullptr, true ) );
+            m_router->StopRouting();
+
+            PNS::NODE* world = m_router->GetWorld();
+
+            for( PNS::ITEM* member : { lead, other } )
+            {
+                std::set<PNS::ITEM*> segments;
+                world->AllItemsInNet( member->Net(), segments, PNS::ITEM::SEGMENT_T );
+
+                BOOST_CHECK( !segments.empty() );
+
+                bool startsAtPad = false;
+
+                for( PNS::ITEM* item : segments )
+                {
+                    const SEG& seg = static_cast<PNS::SEGMENT*>( item )->Seg();
+
+                    if( seg.A == member->Anchor( 0 ) || seg.B == member->Anchor( 0 ) )
+                        startsAtPad = true;
+
+                    BOOST_CHECK( !world->CheckColliding( item ) );
+                }
+
+                BOOST_CHECK( startsAtPad );
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,168 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <router/pns_itemset.h>
+#include <router/pns_meander.h>
+#include <router/pns_meander_placer_base.h>
+
+
+/**
+ * A placer with no router, whose board is a few obstacle segments.  It counts its board checks.
+ */
+class TEST_MEANDER_PLACER : public PNS::MEANDER_PLACER_BASE
+{
+public:
+    TEST_MEANDER_PLACER() :
+            PNS::MEANDER_PLACER_BASE( nullptr ),
+            m_checks( 0 )
+    { }
+
+    bool Start( const VECTOR2I& aP, PNS::ITEM* aStartItem ) override { return false; }
+    bool Move( const VECTOR2I& aP, PNS::ITEM* aEndItem ) override { return false; }
+
+    bool FixRoute( const VECTOR2I& aP, PNS::ITEM* aEndItem, bool aForceFinish ) override
+    {
+        return false;
+    }
+
+    const PNS::ITEM_SET Traces() override { return PNS::ITEM_SET(); }
+    const VECTOR2I& CurrentEnd() const override { return m_currentEnd; }
+    const std::vector<int> CurrentNets() const override { return std::vector<int>(); }
+    int CurrentLayer() const override { return 0; }
+    PNS::NODE* CurrentNode( bool aLoopsRemoved ) const override { return nullptr; }
+    const wxString TuningInfo( EDA_UNITS aUnits ) const override { return wxEmptyString; }
+    TUNING_STATUS TuningStatus() const override { return TUNED; }
+    int Clearance() override { return 200000; }
+
+    bool CheckFit( PNS::MEANDER_SHAPE* aShape ) override
+    {
+        m_checks++;
+        return Fits( aShape );
+    }
+
+    bool Fits( const PNS::MEANDER_SHAPE* aShape ) const
+    {
+        for( const SEG& obstacle : m_obstacles )
+        {
+            if( aShape->CLine( 0 ).Collide( obstacle, aShape->Width() / 2 + 200000 ) )
+                return false;
+        }
+
+        return true;
+    }
+
+    std::vector<SEG> m_obstacles;
+    int              m_checks;
+};
+
+
+/**
+ * Meander a U-turn, so that the meanders of the last segment come close to those of the first,
+ * with obstacles on both sides of the first segment, in the way of the larger meanders.
+ */
+struct PNS_MEANDER_TEST_FIXTURE
+{
+    PNS_MEANDER_TEST_FIXTURE()
+    {
+        m_placer.m_obstacles.emplace_back( VECTOR2I( 4000000, 700000 ),
+                                           VECTOR2I( 9000000, 700000 ) );
+        m_placer.m_obstacles.emplace_back( VECTOR2I( 6000000, -700000 ),
+                                           VECTOR2I( 12000000, -700000 ) );
+
+        m_base = { SEG( VECTOR2I( 0, 0 ), VECTOR2I( 20000000, 0 ) ),
+                   SEG( VECTOR2I( 20000000, 0 ), VECTOR2I( 20000000, 3000000 ) ),
+                   SEG( VECTOR2I( 20000000, 3000000 ), VECTOR2I( 0, 3000000 ) ) };
+    }
+
+    ~PNS_MEANDER_TEST_FIXTURE()
+    {
+        PNS::MEANDERED_LINE::SetFitMemo( true );
+    }
+
+    ///< Meander the base segments on \a aLine, and return the number of board checks it took.
+    int meander( PNS::MEANDERED_LINE& aLine, bool aMemo )
+    {
+        int checks = m_placer.m_checks;
+
+        PNS::MEANDERED_LINE::SetFitMemo( aMemo );
+        aLine.SetWidth( 200000 );
+
+        for( size_t i = 0; i < m_base.size(); i++ )
+        {
+            aLine.AddCorner( m_base[i].A );
+            aLine.MeanderSegment( m_base[i], i % 2 == 0, (int) i );
+            aLine.AddCorner( m_base[i].B );
+        }
+
+        return m_placer.m_checks - checks;
+    }
+
+    TEST_MEANDER_PLACER m_placer;
+    std::vector<SEG>    m_base;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( PNSMeander, PNS_MEANDER_TEST_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( MemoizedFitsMatchUnmemoizedFits )
+{
+    PNS::MEANDERED_LINE full( &m_placer );
+    PNS::MEANDERED_LINE memoized( &m_placer );
+
+    int fullChecks = meander( full, false );
+    int memoizedChecks = meander( memoized, true );
+
+    BOOST_TEST_MESSAGE( "board checks: " << fullChecks << " without the memo, " << memoizedChecks
+                        << " with it" );
+
+    // A turn is checked when probed by MT_CHECK_FINISH and again when placed
+    BOOST_CHECK_LT( memoizedChecks, fullChecks );
+    BOOST_REQUIRE_EQUAL( full.Meanders().size(), memoized.Meanders().size() );
+
+    int meanders = 0;
+
+    for( size_t i = 0; i < full.Meanders().size(); i++ )
+    {
+        const PNS::MEANDER_SHAPE* a = full.Meanders()[i];
+        const PNS::MEANDER_SHAPE* b = memoized.Meanders()[i];
+
+        BOOST_CHECK_EQUAL( a->Type(), b->Type() );
+        BOOST_CHECK_EQUAL( a->Amplitude(), b->Amplitude() );
+        BOOST_CHECK( a->CLine( 0 ).CompareGeometry( b->CLine( 0 ) ) );
+
+        if( b->Type() != PNS::MT_CORNER && b->Type() != PNS::MT_EMPTY )
+        {
+            // The memoized board checks must not let a colliding meander through
+            BOOST_CHECK( m_placer.Fits( b ) );
+            meanders++;
+        }
+    }
+
+    BOOST_CHECK_GT( meanders, 0 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
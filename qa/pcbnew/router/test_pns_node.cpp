@@ -0,0 +1,312 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <qa/pcbnew/board_test_utils.h>
+
+#include <board.h>
+#include <router/pns_kicad_iface.h>
+#include <router/pns_node.h>
+#include <router/pns_router.h>
+#include <router/pns_segment.h>
+#include <router/pns_via.h>
+#include <settings/settings_manager.h>
+
+
+/**
+ * Add a segment of net 1 from (aX, 0) to (aX + 1000, 0) to \a aNode.
+ */
+static PNS::SEGMENT* addSegment( PNS::NODE* aNode, int aX )
+{
+    std::unique_ptr<PNS::SEGMENT> seg =
+            std::make_unique<PNS::SEGMENT>( SEG( VECTOR2I( aX, 0 ), VECTOR2I( aX + 1000, 0 ) ), 1 );
+
+    seg->SetWidth( 100 );
+    seg->SetLayer( 0 );
+
+    PNS::SEGMENT* ret = seg.get();
+    aNode->Add( std::move( seg ) );
+    return ret;
+}
+
+
+static std::set<PNS::ITEM*> netItems( PNS::NODE* aNode )
+{
+    std::set<PNS::ITEM*> items;
+    aNode->AllItemsInNet( 1, items );
+    return items;
+}
+
+
+BOOST_AUTO_TEST_SUITE( PNSNode )
+
+
+BOOST_AUTO_TEST_CASE( BranchesSeeTheirBases )
+{
+    PNS::NODE     root;
+    PNS::SEGMENT* rootSeg = addSegment( &root, 0 );
+
+    PNS::NODE*    b1 = root.Branch();
+    PNS::SEGMENT* b1Seg = addSegment( b1, 1000 );
+    PNS::NODE*    b2 = b1->Branch();
+
+    BOOST_CHECK( netItems( b2 ) == std::set<PNS::ITEM*>( { rootSeg, b1Seg } ) );
+    BOOST_CHECK( netItems( &root ) == std::set<PNS::ITEM*>( { rootSeg } ) );
+
+    // The joint between the two segments is stored in b1, and found from b2
+    PNS::JOINT* joint = b2->FindJoint( VECTOR2I( 1000, 0 ), 0, 1 );
+
+    BOOST_REQUIRE( joint );
+    BOOST_CHECK_EQUAL( joint->LinkCount(), 2 );
+    BOOST_CHECK( root.FindJoint( VECTOR2I( 2000, 0 ), 0, 1 ) == nullptr );
+
+    BOOST_CHECK( b2->HitTest( VECTOR2I( 1500, 0 ) ).Contains( b1Seg ) );
+    BOOST_CHECK( !root.HitTest( VECTOR2I( 1500, 0 ) ).Contains( b1Seg ) );
+
+    root.KillChildren();
+}
+
+
+BOOST_AUTO_TEST_CASE( OverridesHideItemsDownTheChain )
+{
+    PNS::NODE     root;
+    PNS::SEGMENT* rootSeg = addSegment( &root, 0 );
+
+    PNS::NODE*    b1 = root.Branch();
+    b1->Remove( rootSeg );
+
+    PNS::NODE*    b2 = b1->Branch();
+    PNS::SEGMENT* b2Seg = addSegment( b2, 5000 );
+
+    BOOST_CHECK( b1->Overrides( rootSeg ) );
+    BOOST_CHECK( b2->Overrides( rootSeg ) );
+    BOOST_CHECK( netItems( b2 ) == std::set<PNS::ITEM*>( { b2Seg } ) );
+    BOOST_CHECK( !b2->HitTest( VECTOR2I( 500, 0 ) ).Contains( rootSeg ) );
+    BOOST_CHECK( netItems( &root ) == std::set<PNS::ITEM*>( { rootSeg } ) );
+
+    PNS::NODE::ITEM_VECTOR removed, added;
+    b2->GetUpdatedItems( removed, added );
+
+    BOOST_CHECK( removed == PNS::NODE::ITEM_VECTOR( { rootSeg } ) );
+    BOOST_CHECK( added == PNS::NODE::ITEM_VECTOR( { b2Seg } ) );
+
+    root.KillChildren();
+}
+
+
+BOOST_AUTO_TEST_CASE( DeepBranchesAreFlattened )
+{
+    PNS::NODE            root;
+    std::set<PNS::ITEM*> expected = { addSegment( &root, 0 ) };
+    PNS::NODE*           node = &root;
+    PNS::SEGMENT*        previous = nullptr;
+
+    // Each level adds a segment, and every other level removes the one added before it
+    for( int level = 1; level <= 3 * PNS::NODE::MAX_BASE_DEPTH; ++level )
+    {
+        node = node->Branch();
+
+        BOOST_CHECK_LE( node->BaseDepth(), PNS::NODE::MAX_BASE_DEPTH );
+        BOOST_CHECK_EQUAL( node->Depth(), level );
+
+        if( previous && level % 2 )
+        {
+            node->Remove( previous );
+            expected.erase( previous );
+        }
+
+        previous = addSegment( node, 2000 * level );
+        expected.insert( previous );
+
+        BOOST_CHECK( netItems( node ) == expected );
+    }
+
+    BOOST_CHECK( node->HitTest( VECTOR2I( 500, 0 ) ).Size() == 1 );
+    BOOST_CHECK( node->FindJoint( VECTOR2I( 2000 * 3 * PNS::NODE::MAX_BASE_DEPTH, 0 ), 0, 1 ) );
+
+    root.KillChildren();
+}
+
+
+BOOST_AUTO_TEST_CASE( ModifiedBasesDetachTheirChildren )
+{
+    PNS::NODE     root;
+    PNS::SEGMENT* rootSeg = addSegment( &root, 0 );
+
+    PNS::NODE*    b1 = root.Branch();
+    PNS::SEGMENT* oldSeg = addSegment( b1, 2000 );
+    PNS::NODE*    b2 = b1->Branch();
+
+    // Changing b1 must not change what b2 was branched from
+    b1->Remove( oldSeg );
+    b1->Remove( rootSeg );
+    PNS::SEGMENT* newSeg = addSegment( b1, 4000 );
+
+    BOOST_CHECK_EQUAL( b2->BaseDepth(), 1 );
+    BOOST_CHECK( netItems( b1 ) == std::set<PNS::ITEM*>( { newSeg } ) );
+    BOOST_CHECK( netItems( b2 ) == std::set<PNS::ITEM*>( { rootSeg, oldSeg } ) );
+    BOOST_CHECK( b2->FindJoint( VECTOR2I( 3000, 0 ), 0, 1 ) );
+    BOOST_CHECK( b2->FindJoint( VECTOR2I( 5000, 0 ), 0, 1 ) == nullptr );
+
+    root.KillChildren();
+}
+
+
+BOOST_AUTO_TEST_CASE( CollisionMemosAreKeptPerNode )
+{
+    PNS::NODE     root;
+    PNS::SEGMENT* rootSeg = addSegment( &root, 0 );
+
+    // Every other branch hides the segment; there are more branches than nodes a thread keeps
+    // a memo for, and the queries go round them twice
+    std::vector<PNS::NODE*> nodes = { &root };
+
+    for( int i = 0; i < 20; i++ )
+    {
+        nodes.push_back( root.Branch() );
+
+        if( i % 2 == 0 )
+            nodes.back()->Remove( rootSeg );
+    }
+
+    PNS::SEGMENT probe( SEG( VECTOR2I( 500, -500 ), VECTOR2I( 500, 500 ) ), 2 );
+    probe.SetWidth( 100 );
+    probe.SetLayer( 0 );
+
+    for( int pass = 0; pass < 2; pass++ )
+    {
+        for( size_t i = 0; i < nodes.size(); i++ )
+        {
+            PNS::NODE::OBSTACLES obstacles;
+            bool                 hidden = i > 0 && ( i - 1 ) % 2 == 0;
+
+            nodes[i]->QueryColliding( &probe, obstacles );
+
+            BOOST_CHECK_EQUAL( obstacles.empty(), hidden );
+        }
+    }
+
+    root.KillChildren();
+}
+
+
+struct PNS_NODE_BOARD_FIXTURE
+{
+    PNS_NODE_BOARD_FIXTURE() :
+            m_settingsManager( true /* headless */ )
+    { }
+
+    SETTINGS_MANAGER       m_settingsManager;
+    std::unique_ptr<BOARD> m_board;
+};
+
+
+/**
+ * Check \a aProbe against the items of all the nets of \a aWorld, once through QueryColliding()
+ * and its memo, and once directly.
+ */
+static void checkMemoizedCollisions( PNS::NODE* aWorld, int aNetCount, const PNS::ITEM* aProbe )
+{
+    PNS::NODE::OBSTACLES first, second;
+
+    aWorld->QueryColliding( aProbe, first );
+    aWorld->QueryColliding( aProbe, second );    // answered from the memo
+
+    BOOST_REQUIRE_EQUAL( first.size(), second.size() );
+
+    std::map<PNS::ITEM*, const PNS::OBSTACLE*> found;
+
+    for( size_t i = 0; i < first.size(); i++ )
+    {
+        BOOST_CHECK( first[i].m_item == second[i].m_item );
+        BOOST_CHECK_EQUAL( first[i].m_itemHole, second[i].m_itemHole );
+        BOOST_CHECK_EQUAL( first[i].m_headHole, second[i].m_headHole );
+
+        // The query doesn't mark the items
+        BOOST_CHECK( !( first[i].m_item->Marker() & PNS::MK_HOLE ) );
+
+        found[ first[i].m_item ] = &first[i];
+    }
+
+    for( int net = 0; net < aNetCount; net++ )
+    {
+        std::set<PNS::ITEM*> items;
+        aWorld->AllItemsInNet( net, items );
+
+        for( PNS::ITEM* item : items )
+        {
+            PNS::COLLISION direct = item->TestCollision( aProbe, aWorld );
+            auto           it = found.find( item );
+
+            BOOST_CHECK_EQUAL( direct.collides, it != found.end() );
+
+            if( direct.collides && it != found.end() )
+            {
+                BOOST_CHECK_EQUAL( direct.holeA != nullptr, it->second->m_itemHole );
+                BOOST_CHECK_EQUAL( direct.holeB != nullptr, it->second->m_headHole );
+            }
+        }
+    }
+}
+
+
+BOOST_FIXTURE_TEST_CASE( MemoizedCollisionsMatchDirectTests, PNS_NODE_BOARD_FIXTURE )
+{
+    KI_TEST::LoadBoard( m_settingsManager, "issue8883", m_board );
+
+    PNS_KICAD_IFACE_BASE iface;
+    PNS::ROUTER          router;
+
+    iface.SetBoard( m_board.get() );
+    router.SetInterface( &iface );
+    router.SyncWorld();
+
+    PNS::NODE* world = router.GetWorld();
+    int        netCount = m_board->GetNetCount();
+
+    // Probe next to every pad with a track and a via of no net, close enough to hit some pads
+    // and their holes, and some tracks
+    for( int net = 0; net < netCount; net++ )
+    {
+        std::set<PNS::ITEM*> solids;
+        world->AllItemsInNet( net, solids, PNS::ITEM::SOLID_T );
+
+        for( PNS::ITEM* solid : solids )
+        {
+            VECTOR2I     pos = solid->Anchor( 0 );
+            PNS::SEGMENT seg( SEG( pos + VECTOR2I( 300000, 0 ), pos + VECTOR2I( 300000, 1000000 ) ),
+                              -1 );
+            PNS::VIA     via( pos + VECTOR2I( 0, 500000 ), LAYER_RANGE( F_Cu, B_Cu ), 600000,
+                              300000 );
+
+            seg.SetWidth( 250000 );
+            seg.SetLayer( F_Cu );
+
+            checkMemoizedCollisions( world, netCount, &seg );
+            checkMemoizedCollisions( world, netCount, &via );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
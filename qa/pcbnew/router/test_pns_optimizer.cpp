@@ -0,0 +1,168 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <qa/pcbnew/board_test_utils.h>
+
+#include <board.h>
+#include <router/pns_kicad_iface.h>
+#include <router/pns_line.h>
+#include <router/pns_node.h>
+#include <router/pns_optimizer.h>
+#include <router/pns_router.h>
+#include <router/pns_segment.h>
+#include <router/pns_walkaround.h>
+#include <settings/settings_manager.h>
+
+
+/**
+ * The world of a board, its lines, and lines between the pads of each of its nets walked
+ * around the pads of the other nets, which leaves them many corners to optimize.
+ */
+struct PNS_OPTIMIZER_TEST_FIXTURE
+{
+    PNS_OPTIMIZER_TEST_FIXTURE() :
+            m_settingsManager( true /* headless */ )
+    {
+        KI_TEST::LoadBoard( m_settingsManager, "issue8883", m_board );
+
+        m_iface.SetBoard( m_board.get() );
+        m_router.SetInterface( &m_iface );
+        m_router.SyncWorld();
+
+        PNS::NODE* world = m_router.GetWorld();
+
+        for( int net = 1; net < (int) m_board->GetNetCount(); net++ )
+        {
+            std::set<PNS::ITEM*> segments, solids;
+            std::set<PNS::ITEM*> assembled;
+
+            world->AllItemsInNet( net, segments, PNS::ITEM::SEGMENT_T );
+            world->AllItemsInNet( net, solids, PNS::ITEM::SOLID_T );
+
+            for( PNS::ITEM* item : segments )
+            {
+                if( assembled.count( item ) )
+                    continue;
+
+                PNS::LINE line = world->AssembleLine( static_cast<PNS::SEGMENT*>( item ) );
+
+                for( PNS::LINKED_ITEM* link : line.Links() )
+                    assembled.insert( link );
+
+                addLine( line, line.CLine() );
+            }
+
+            std::vector<VECTOR2I> anchors;
+
+            for( PNS::ITEM* solid : solids )
+                anchors.push_back( solid->Anchor( 0 ) );
+
+            for( size_t i = 1; i < anchors.size(); i++ )
+            {
+                PNS::LINE        line, walked;
+                SHAPE_LINE_CHAIN chain;
+
+                chain.Append( anchors[i - 1] );
+                chain.Append( anchors[i] );
+
+                line.SetShape( chain );
+                line.SetWidth( 250000 );
+                line.SetLayer( F_Cu );
+                line.SetNet( net );
+
+                PNS::WALKAROUND walkaround( world, &m_router );
+
+                if( walkaround.Route( line, walked, false ) == PNS::WALKAROUND::DONE )
+                    addLine( line, walked.CLine() );
+            }
+        }
+    }
+
+    void addLine( const PNS::LINE& aBase, const SHAPE_LINE_CHAIN& aShape )
+    {
+        m_lines.emplace_back( aBase, aShape );
+        m_lines.back().ClearLinks();
+    }
+
+    ///< @return the shape of \a aLine once optimized in \a m_router's world.
+    SHAPE_LINE_CHAIN optimized( const PNS::LINE& aLine, int aEffortLevel, bool aIncremental )
+    {
+        PNS::LINE      line( aLine );
+        PNS::OPTIMIZER optimizer( m_router.GetWorld() );
+
+        PNS::OPTIMIZER::SetIncrementalCosts( aIncremental );
+
+        optimizer.SetEffortLevel( aEffortLevel );
+        optimizer.SetCollisionMask( PNS::ITEM::ANY_T );
+        optimizer.Optimize( &line );
+
+        return line.CLine();
+    }
+
+    ~PNS_OPTIMIZER_TEST_FIXTURE()
+    {
+        PNS::OPTIMIZER::SetIncrementalCosts( true );
+    }
+
+    SETTINGS_MANAGER       m_settingsManager;
+    std::unique_ptr<BOARD> m_board;
+    PNS_KICAD_IFACE_BASE   m_iface;
+    PNS::ROUTER            m_router;
+    std::vector<PNS::LINE> m_lines;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( PNSOptimizer, PNS_OPTIMIZER_TEST_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( IncrementalCostsMatchFullCosts )
+{
+    BOOST_REQUIRE( !m_lines.empty() );
+
+    int changed = 0;
+
+    for( int effort : { (int) PNS::OPTIMIZER::MERGE_SEGMENTS, (int) PNS::OPTIMIZER::SMART_PADS,
+                        PNS::OPTIMIZER::MERGE_OBTUSE | PNS::OPTIMIZER::SMART_PADS } )
+    {
+        for( size_t i = 0; i < m_lines.size(); i++ )
+        {
+            BOOST_TEST_CONTEXT( "effort " << effort << ", line " << i )
+            {
+                SHAPE_LINE_CHAIN full = optimized( m_lines[i], effort, false );
+                SHAPE_LINE_CHAIN incremental = optimized( m_lines[i], effort, true );
+
+                BOOST_CHECK( full.CPoints() == incremental.CPoints() );
+
+                if( full.CPoints() != m_lines[i].CLine().CPoints() )
+                    changed++;
+            }
+        }
+    }
+
+    // Make sure the lines gave the optimizer something to do
+    BOOST_CHECK_GT( changed, 0 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
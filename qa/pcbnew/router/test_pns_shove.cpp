@@ -0,0 +1,190 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <qa/pcbnew/board_test_utils.h>
+
+#include <algorithm>
+#include <tuple>
+
+#include <board.h>
+#include <router/pns_kicad_iface.h>
+#include <router/pns_line.h>
+#include <router/pns_node.h>
+#include <router/pns_router.h>
+#include <router/pns_routing_settings.h>
+#include <router/pns_segment.h>
+#include <router/pns_shove.h>
+#include <router/pns_via.h>
+#include <settings/settings_manager.h>
+
+
+struct PNS_SHOVE_TEST_FIXTURE
+{
+    ///< Kind, net, width and the two ends of an item added by a shove.
+    typedef std::tuple<int, int, int, int, int, int, int> ITEM_KEY;
+
+    PNS_SHOVE_TEST_FIXTURE() :
+            m_settingsManager( true /* headless */ ),
+            m_routingSettings( nullptr, "" )
+    {
+        KI_TEST::LoadBoard( m_settingsManager, "issue8883", m_board );
+
+        m_iface = std::make_unique<PNS_KICAD_IFACE_BASE>();
+        m_router = std::make_unique<PNS::ROUTER>();
+
+        m_iface->SetBoard( m_board.get() );
+        m_router->SetInterface( m_iface.get() );
+        m_router->ClearWorld();
+        m_router->LoadSettings( &m_routingSettings );
+        m_router->SyncWorld();
+    }
+
+    /**
+     * Shove \a aHead into the world, and collect the items the shove has changed.
+     *
+     * @param aTimeLimited if true, the shove runs out of time after each iteration, and is
+     *                     resumed until it is over.
+     * @param aResumes is incremented by the number of times the shove was resumed.
+     */
+    PNS::SHOVE::SHOVE_STATUS shove( const PNS::LINE& aHead, bool aTimeLimited,
+                                    std::vector<ITEM_KEY>& aAdded,
+                                    std::vector<const BOARD_ITEM*>& aRemoved, int& aResumes )
+    {
+        PNS::NODE* world = m_router->GetWorld();
+
+        m_routingSettings.SetAnytimeShove( true );
+        m_routingSettings.SetShoveTimeLimit( aTimeLimited ? 0 : 1000000 );
+
+        PNS::SHOVE                shove( world, m_router.get() );
+        PNS::SHOVE::SHOVE_STATUS status = shove.ShoveLines( aHead );
+
+        while( shove.HasPendingShove() )
+        {
+            // Until it is over, the world the shove gives is the one it started from
+            BOOST_CHECK( shove.CurrentNode() == world );
+
+            status = shove.ResumeShove();
+            aResumes++;
+        }
+
+        PNS::NODE::ITEM_VECTOR removed, added;
+        shove.CurrentNode()->GetUpdatedItems( removed, added );
+
+        for( PNS::ITEM* item : added )
+        {
+            if( PNS::SEGMENT* seg = dyn_cast<PNS::SEGMENT*>( item ) )
+            {
+                aAdded.emplace_back( item->Kind(), item->Net(), seg->Width(), seg->Seg().A.x,
+                                     seg->Seg().A.y, seg->Seg().B.x, seg->Seg().B.y );
+            }
+            else if( PNS::VIA* via = dyn_cast<PNS::VIA*>( item ) )
+            {
+                aAdded.emplace_back( item->Kind(), item->Net(), via->Diameter(), via->Pos().x,
+                                     via->Pos().y, via->Pos().x, via->Pos().y );
+            }
+        }
+
+        for( PNS::ITEM* item : removed )
+            aRemoved.push_back( item->Parent() );
+
+        std::sort( aAdded.begin(), aAdded.end() );
+        std::sort( aRemoved.begin(), aRemoved.end() );
+
+        world->KillChildren();
+
+        return status;
+    }
+
+    SETTINGS_MANAGER                      m_settingsManager;
+    std::unique_ptr<BOARD>                m_board;
+    PNS::ROUTING_SETTINGS                 m_routingSettings;
+    std::unique_ptr<PNS_KICAD_IFACE_BASE> m_iface;
+    std::unique_ptr<PNS::ROUTER>          m_router;    ///< last, uses the interface and settings
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( PNSShove, PNS_SHOVE_TEST_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( ResumedShovesMatchUnlimitedShoves )
+{
+    PNS::NODE* world = m_router->GetWorld();
+    int        resumes = 0;
+    int        completed = 0;
+    int        cases = 0;
+
+    // Shove a track of another net, running alongside each track of the board a track width
+    // away, into it
+    for( int net = 1; net < (int) m_board->GetNetCount() && cases < 50; net++ )
+    {
+        std::set<PNS::ITEM*> segments;
+        world->AllItemsInNet( net, segments, PNS::ITEM::SEGMENT_T );
+
+        for( PNS::ITEM* item : segments )
+        {
+            PNS::SEGMENT* seg = static_cast<PNS::SEGMENT*>( item );
+            VECTOR2I      dir = seg->Seg().B - seg->Seg().A;
+
+            if( dir.EuclideanNorm() < seg->Width() )
+                continue;
+
+            VECTOR2I         offset = dir.Perpendicular().Resize( seg->Width() );
+            SHAPE_LINE_CHAIN chain;
+            PNS::LINE        head;
+
+            chain.Append( seg->Seg().A + offset );
+            chain.Append( seg->Seg().B + offset );
+
+            head.SetShape( chain );
+            head.SetWidth( seg->Width() );
+            head.SetLayer( seg->Layer() );
+            head.SetNet( net == 1 ? 2 : 1 );
+
+            BOOST_TEST_CONTEXT( "net " << net << ", segment " << seg->Seg() )
+            {
+                std::vector<PNS_SHOVE_TEST_FIXTURE::ITEM_KEY> added[2];
+                std::vector<const BOARD_ITEM*>                removed[2];
+                PNS::SHOVE::SHOVE_STATUS                      status[2];
+
+                status[0] = shove( head, false, added[0], removed[0], resumes );
+                status[1] = shove( head, true, added[1], removed[1], resumes );
+
+                BOOST_CHECK_EQUAL( status[0], status[1] );
+                BOOST_CHECK( added[0] == added[1] );
+                BOOST_CHECK( removed[0] == removed[1] );
+
+                if( status[0] == PNS::SHOVE::SH_OK || status[0] == PNS::SHOVE::SH_HEAD_MODIFIED )
+                    completed++;
+            }
+
+            cases++;
+        }
+    }
+
+    BOOST_CHECK_GT( completed, 0 );
+    BOOST_CHECK_GT( resumes, 0 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,185 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <qa/pcbnew/board_test_utils.h>
+
+#include <board.h>
+#include <router/pns_kicad_iface.h>
+#include <router/pns_line.h>
+#include <router/pns_node.h>
+#include <router/pns_router.h>
+#include <router/pns_walkaround.h>
+#include <settings/settings_manager.h>
+
+
+/**
+ * The world of a board, and straight lines between the pads of each of its nets, most of them
+ * running into the pads of other nets.
+ */
+struct PNS_WALKAROUND_TEST_FIXTURE
+{
+    PNS_WALKAROUND_TEST_FIXTURE() :
+            m_settingsManager( true /* headless */ )
+    {
+        KI_TEST::LoadBoard( m_settingsManager, "issue8883", m_board );
+
+        m_iface.SetBoard( m_board.get() );
+        m_router.SetInterface( &m_iface );
+        m_router.SyncWorld();
+
+        PNS::NODE* world = m_router.GetWorld();
+
+        for( int net = 1; net < (int) m_board->GetNetCount(); net++ )
+        {
+            std::set<PNS::ITEM*> solids;
+            world->AllItemsInNet( net, solids, PNS::ITEM::SOLID_T );
+
+            std::vector<VECTOR2I> anchors;
+
+            for( PNS::ITEM* solid : solids )
+                anchors.push_back( solid->Anchor( 0 ) );
+
+            for( size_t i = 1; i < anchors.size(); i++ )
+            {
+                PNS::LINE        line;
+                SHAPE_LINE_CHAIN chain;
+
+                chain.Append( anchors[i - 1] );
+                chain.Append( anchors[i] );
+
+                line.SetShape( chain );
+                line.SetWidth( 250000 );
+                line.SetLayer( F_Cu );
+                line.SetNet( net );
+                m_lines.push_back( line );
+            }
+        }
+    }
+
+    ~PNS_WALKAROUND_TEST_FIXTURE()
+    {
+        PNS::WALKAROUND::SetParallelWalks( true );
+    }
+
+    /**
+     * Walk \a aLine around the obstacles of the world, without optimizing the result.
+     *
+     * @param aWinding 0 for both directions, 1 for clockwise only, -1 for counter-clockwise only.
+     */
+    PNS::WALKAROUND::WALKAROUND_STATUS walk( const PNS::LINE& aLine, PNS::LINE& aResult,
+                                             bool aParallel, int aWinding = 0,
+                                             bool aLongerPath = false )
+    {
+        PNS::WALKAROUND::SetParallelWalks( aParallel );
+
+        PNS::WALKAROUND walkaround( m_router.GetWorld(), &m_router );
+
+        walkaround.SetSolidsOnly( false );
+        walkaround.SetSingleDirection( aLongerPath );
+
+        if( aWinding )
+            walkaround.SetForceWinding( true, aWinding > 0 );
+
+        return walkaround.Route( aLine, aResult, false );
+    }
+
+    SETTINGS_MANAGER       m_settingsManager;
+    std::unique_ptr<BOARD> m_board;
+    PNS_KICAD_IFACE_BASE   m_iface;
+    PNS::ROUTER            m_router;
+    std::vector<PNS::LINE> m_lines;
+};
+
+
+static bool sameShape( const PNS::LINE& aA, const PNS::LINE& aB )
+{
+    if( aA.PointCount() != aB.PointCount() )
+        return false;
+
+    for( int i = 0; i < aA.PointCount(); i++ )
+    {
+        if( aA.CPoint( i ) != aB.CPoint( i ) )
+            return false;
+    }
+
+    return true;
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( PNSWalkaround, PNS_WALKAROUND_TEST_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( ParallelWalksMatchSerialWalks )
+{
+    BOOST_REQUIRE( !m_lines.empty() );
+
+    for( bool longerPath : { false, true } )
+    {
+        for( size_t i = 0; i < m_lines.size(); i++ )
+        {
+            BOOST_TEST_CONTEXT( "line " << i << ( longerPath ? ", longer path" : "" ) )
+            {
+                PNS::LINE serial, parallel;
+
+                auto serialStatus = walk( m_lines[i], serial, false, 0, longerPath );
+                auto parallelStatus = walk( m_lines[i], parallel, true, 0, longerPath );
+
+                BOOST_CHECK_EQUAL( serialStatus, parallelStatus );
+                BOOST_CHECK( sameShape( serial, parallel ) );
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( StoppedWalksPickAFinishedDirection )
+{
+    int done = 0;
+
+    // Once one walk is done, the other is stopped; the path picked must still be the complete
+    // path of one of the directions, as walked on its own.
+    for( size_t i = 0; i < m_lines.size(); i++ )
+    {
+        BOOST_TEST_CONTEXT( "line " << i )
+        {
+            PNS::LINE both, cw, ccw;
+
+            if( walk( m_lines[i], both, true ) != PNS::WALKAROUND::DONE )
+                continue;
+
+            done++;
+
+            auto cwStatus = walk( m_lines[i], cw, false, 1 );
+            auto ccwStatus = walk( m_lines[i], ccw, false, -1 );
+
+            BOOST_CHECK( ( cwStatus == PNS::WALKAROUND::DONE && sameShape( both, cw ) )
+                         || ( ccwStatus == PNS::WALKAROUND::DONE && sameShape( both, ccw ) ) );
+        }
+    }
+
+    BOOST_CHECK_GT( done, 0 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,129 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <board.h>
+#include <pcb_track.h>
+#include <item_pair_cache.h>
+
+#include <thread>
+
+
+struct ITEM_PAIR_CACHE_FIXTURE
+{
+    ITEM_PAIR_CACHE_FIXTURE() :
+            m_trackA( &m_board ),
+            m_trackB( &m_board )
+    {
+    }
+
+    BOARD           m_board;
+    PCB_TRACK       m_trackA;
+    PCB_TRACK       m_trackB;
+    ITEM_PAIR_CACHE m_cache;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ItemPairCache, ITEM_PAIR_CACHE_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( ComputesOncePerPair )
+{
+    int calls = 0;
+
+    auto compute =
+            [&]()
+            {
+                calls++;
+                return true;
+            };
+
+    BOOST_CHECK( m_cache.Get( &m_trackA, &m_trackB, compute ) );
+    BOOST_CHECK( m_cache.Get( &m_trackA, &m_trackB, compute ) );
+    BOOST_CHECK_EQUAL( calls, 1 );
+
+    // Pairs are ordered
+    BOOST_CHECK( m_cache.Get( &m_trackB, &m_trackA, compute ) );
+    BOOST_CHECK_EQUAL( calls, 2 );
+}
+
+
+BOOST_AUTO_TEST_CASE( InvalidateForgetsResults )
+{
+    BOOST_CHECK( m_cache.Get( &m_trackA, &m_trackB, []() { return true; } ) );
+
+    m_cache.Invalidate();
+
+    BOOST_CHECK( !m_cache.Get( &m_trackA, &m_trackB, []() { return false; } ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( ConcurrentUse )
+{
+    std::vector<PCB_TRACK*> tracks;
+
+    for( int ii = 0; ii < 50; ++ii )
+        tracks.push_back( new PCB_TRACK( &m_board ) );
+
+    auto expected =
+            [&]( int a, int b )
+            {
+                return ( a * 7 + b ) % 3 == 0;
+            };
+
+    std::atomic<int>         errors( 0 );
+    std::vector<std::thread> threads;
+
+    for( int t = 0; t < 4; ++t )
+    {
+        threads.emplace_back(
+                [&]()
+                {
+                    for( int pass = 0; pass < 10; ++pass )
+                    {
+                        for( int a = 0; a < 50; ++a )
+                        {
+                            for( int b = 0; b < 50; ++b )
+                            {
+                                bool result = m_cache.Get( tracks[a], tracks[b],
+                                                           [&]() { return expected( a, b ); } );
+
+                                if( result != expected( a, b ) )
+                                    errors++;
+                            }
+                        }
+                    }
+                } );
+    }
+
+    for( std::thread& thread : threads )
+        thread.join();
+
+    BOOST_CHECK_EQUAL( errors.load(), 0 );
+
+    for( PCB_TRACK* track : tracks )
+        delete track;
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
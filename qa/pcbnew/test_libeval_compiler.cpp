@@ -81,7 +81,9 @@ const static std::vector<EXPR_TO_TEST> introspectionExpressions = {
     { "A.Netclass + 1.0", false, VAL( 1.0 ) },
     { "A.type == 'Track' && B.type == 'Track' && A.layer == 'F.Cu'", false, VAL( 1.0 ) },
     { "(A.type == 'Track') && (B.type == 'Track') && (A.layer == 'F.Cu')", false, VAL( 1.0 ) },
-    { "A.type == 'Via' && A.isMicroVia()", false, VAL(0.0) }
+    { "A.type == 'Via' && A.isMicroVia()", false, VAL(0.0) },
+    { "A.NetClass == 'h*' && B.NetName == 'NET?'", false, VAL( 1.0 ) },
+    { "A.NetClass == 'o*' || B.NetName == 'net1'", false, VAL( 0.0 ) }
 };
 
 
@@ -177,6 +179,40 @@ BOOST_AUTO_TEST_CASE( IntrospectedProperties )
     {
         testEvalExpr( expr.expression, expr.expectedResult, expr.expectError, &trackA, &trackB );
     }
+
+    // Contexts with an error callback run on the stack interpreter, others on the register
+    // machine.  Both must agree, in either item order.
+    for( const auto& expr : introspectionExpressions )
+    {
+        PCB_EXPR_COMPILER compiler;
+        PCB_EXPR_UCODE    ucode;
+        PCB_EXPR_CONTEXT  preflightContext;
+
+        BOOST_TEST_MESSAGE( "Expr: '" << expr.expression.c_str() << "'" );
+
+        if( !compiler.Compile( expr.expression, &ucode, &preflightContext ) )
+            continue;
+
+        for( bool swap : { false, true } )
+        {
+            PCB_EXPR_CONTEXT vmContext;
+            PCB_EXPR_CONTEXT stackContext;
+
+            vmContext.SetItems( swap ? &trackB : &trackA, swap ? &trackA : &trackB );
+            stackContext.SetItems( swap ? &trackB : &trackA, swap ? &trackA : &trackB );
+            stackContext.SetErrorCallback( []( const wxString&, int ) {} );
+
+            LIBEVAL::VALUE vmResult = *ucode.Run( &vmContext );
+            LIBEVAL::VALUE stackResult = *ucode.Run( &stackContext );
+
+            BOOST_CHECK_EQUAL( vmResult.GetType(), stackResult.GetType() );
+
+            if( stackResult.GetType() == LIBEVAL::VT_STRING )
+                BOOST_CHECK_EQUAL( vmResult.AsString(), stackResult.AsString() );
+            else
+                BOOST_CHECK_EQUAL( vmResult.AsDouble(), stackResult.AsDouble() );
+        }
+    }
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,192 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Times rule condition evaluation on the register machine against the stack interpreter, and
+ * counts the heap allocations each makes per evaluation.
+ *
+ * Usage: qa_pcbnew_tools libeval_compiler_bench [iterations]
+ */
+
+#include <wx/wx.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include <qa_utils/utility_registry.h>
+
+#include "board.h"
+#include "pcb_track.h"
+
+#include <pcb_expr_evaluator.h>
+
+#include <profile.h>
+
+
+static const char* expressions[] =
+{
+    "A.NetClass == 'HV'",
+    "A.NetClass == 'HV' && B.NetClass == 'otherClass'",
+    "A.Type == 'Via' && A.isMicroVia()",
+    "A.NetName == 'net1' || B.NetName == 'net1'",
+    "A.Width > B.Width",
+    "A.Width + B.Width > 1mm",
+    "A.NetClass == 'H*' && !(B.NetClass == 'HV') && A.Layer == 'F.Cu'",
+    "A.existsOnLayer('F.Cu') && A.NetClass != B.NetClass"
+};
+
+
+// Every allocation in the tools binary is counted, which is only read around the timed runs
+static std::atomic<int64_t> s_allocations( 0 );
+
+
+void* operator new( std::size_t aSize )
+{
+    s_allocations.fetch_add( 1, std::memory_order_relaxed );
+
+    if( void* ptr = std::malloc( aSize ? aSize : 1 ) )
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+
+void operator delete( void* aPtr ) noexcept
+{
+    std::free( aPtr );
+}
+
+
+static double timeRuns( PCB_EXPR_UCODE& aCode, BOARD_ITEM* a, BOARD_ITEM* b, int aIterations,
+                        bool aStackInterpreter, double* aSum, double* aAllocsPerRun )
+{
+    // One untimed run first, so the per-thread registers have grown to fit
+    {
+        PCB_EXPR_CONTEXT ctx( F_Cu );
+        ctx.SetItems( a, b );
+        aCode.Run( &ctx );
+    }
+
+    int64_t    allocations = s_allocations.load( std::memory_order_relaxed );
+    PROF_TIMER timer;
+
+    for( int ii = 0; ii < aIterations; ++ii )
+    {
+        PCB_EXPR_CONTEXT ctx( F_Cu );
+
+        // Contexts with an error callback are always run on the stack interpreter
+        if( aStackInterpreter )
+            ctx.SetErrorCallback( []( const wxString&, int ) {} );
+
+        ctx.SetItems( a, b );
+        *aSum += aCode.Run( &ctx )->AsDouble();
+    }
+
+    timer.Stop();
+
+    *aAllocsPerRun = double( s_allocations.load( std::memory_order_relaxed ) - allocations )
+                     / std::max( aIterations, 1 );
+
+    return timer.msecs();
+}
+
+
+enum LIBEVAL_BENCH_RET_CODES
+{
+    RESULTS_DIFFER = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+static int libeval_compiler_bench_main( int argc, char *argv[] )
+{
+    int iterations = argc > 1 ? atoi( argv[1] ) : 1000000;
+
+    PROPERTY_MANAGER& propMgr = PROPERTY_MANAGER::Instance();
+    propMgr.Rebuild();
+
+    BOARD brd;
+
+    NETCLASSPTR netclass1( new NETCLASS( "HV" ) );
+    NETCLASSPTR netclass2( new NETCLASS( "otherClass" ) );
+
+    NETINFO_ITEM* net1info = new NETINFO_ITEM( &brd, "net1", 1 );
+    NETINFO_ITEM* net2info = new NETINFO_ITEM( &brd, "net2", 2 );
+
+    net1info->SetNetClass( netclass1 );
+    net2info->SetNetClass( netclass2 );
+
+    PCB_TRACK trackA( &brd );
+    PCB_TRACK trackB( &brd );
+
+    trackA.SetNet( net1info );
+    trackB.SetNet( net2info );
+
+    trackA.SetLayer( F_Cu );
+    trackB.SetLayer( F_Cu );
+
+    trackA.SetWidth( Mils2iu( 10 ) );
+    trackB.SetWidth( Mils2iu( 20 ) );
+
+    bool differ = false;
+
+    printf( "%-66s %10s %10s %12s %12s\n", "expression", "stack (ms)", "vm (ms)",
+            "stack allocs", "vm allocs" );
+
+    for( const char* expr : expressions )
+    {
+        PCB_EXPR_COMPILER compiler;
+        PCB_EXPR_UCODE    ucode;
+        PCB_EXPR_CONTEXT  preflightContext( F_Cu );
+
+        if( !compiler.Compile( expr, &ucode, &preflightContext ) )
+        {
+            printf( "%-66s compile error\n", expr );
+            continue;
+        }
+
+        double stackSum = 0.0;
+        double vmSum = 0.0;
+        double stackAllocs = 0.0;
+        double vmAllocs = 0.0;
+        double stackTime = timeRuns( ucode, &trackA, &trackB, iterations, true, &stackSum,
+                                     &stackAllocs );
+        double vmTime = timeRuns( ucode, &trackA, &trackB, iterations, false, &vmSum,
+                                  &vmAllocs );
+
+        printf( "%-66s %10.1f %10.1f %12.2f %12.2f%s\n", expr, stackTime, vmTime, stackAllocs,
+                vmAllocs, stackSum == vmSum ? "" : "  RESULTS DIFFER" );
+
+        differ |= stackSum != vmSum;
+    }
+
+    return differ ? LIBEVAL_BENCH_RET_CODES::RESULTS_DIFFER : KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "libeval_compiler_bench",
+        "Time rule conditions on the register machine and the stack interpreter",
+        libeval_compiler_bench_main,
+} );
@@ -0,0 +1,145 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <convert_basic_shapes_to_polygon.h>
+#include <convert_to_biu.h>
+#include <geometry/shape_poly_set.h>
+#include <profile.h>
+
+#include <pcbnew_utils/board_file_utils.h>
+
+#include <qa_utils/utility_registry.h>
+
+#include <board.h>
+#include <zone.h>
+
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+
+enum POLY_FRACTURE_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+/**
+ * Build a square "ground pour" with aHolesPerSide x aHolesPerSide round antipads, jittered so
+ * that holes do not share scanlines.
+ */
+static SHAPE_POLY_SET buildHoleyPour( int aHolesPerSide )
+{
+    const int pitch = 1000000;
+    const int size = aHolesPerSide * pitch;
+
+    std::mt19937   rng( 42 );
+    SHAPE_POLY_SET pour;
+    SHAPE_POLY_SET antipads;
+
+    pour.NewOutline();
+    pour.Append( 0, 0 );
+    pour.Append( size, 0 );
+    pour.Append( size, size );
+    pour.Append( 0, size );
+
+    for( int i = 0; i < aHolesPerSide; i++ )
+    {
+        for( int j = 0; j < aHolesPerSide; j++ )
+        {
+            wxPoint center( i * pitch + pitch / 2 + int( rng() % 200000 ) - 100000,
+                            j * pitch + pitch / 2 + int( rng() % 200000 ) - 100000 );
+
+            TransformCircleToPolygon( antipads, center, 300000, ARC_HIGH_DEF, ERROR_OUTSIDE );
+        }
+    }
+
+    pour.BooleanSubtract( antipads, SHAPE_POLY_SET::PM_FAST );
+
+    return pour;
+}
+
+
+static void fractureAndReport( SHAPE_POLY_SET& aPoly, const std::string& aName )
+{
+    int holes = 0;
+
+    for( int ii = 0; ii < aPoly.OutlineCount(); ii++ )
+        holes += aPoly.HoleCount( ii );
+
+    PROF_TIMER timer( aName + ": fracture of " + std::to_string( holes ) + " holes, "
+                      + std::to_string( aPoly.FullPointCount() ) + " vertices" );
+
+    aPoly.Fracture( SHAPE_POLY_SET::PM_FAST );
+
+    timer.Show( std::cout );
+}
+
+
+int polygon_fracture_main( int argc, char* argv[] )
+{
+    // With no argument or a number, benchmark a synthetic pour.  Otherwise load a board and
+    // re-fracture the fill of every zone layer.
+    if( argc < 2 || std::isdigit( (unsigned char) argv[1][0] ) )
+    {
+        int holesPerSide = argc < 2 ? 100 : std::atoi( argv[1] );
+
+        if( holesPerSide <= 0 )
+            return KI_TEST::RET_CODES::BAD_CMDLINE;
+
+        SHAPE_POLY_SET pour = buildHoleyPour( holesPerSide );
+        fractureAndReport( pour, "synthetic pour" );
+
+        return KI_TEST::RET_CODES::OK;
+    }
+
+    auto brd = KI_TEST::ReadBoardFromFileOrStream( argv[1] );
+
+    if( !brd )
+        return POLY_FRACTURE_RET_CODES::LOAD_FAILED;
+
+    PROF_TIMER total( "all zones" );
+
+    for( ZONE* zone : brd->Zones() )
+    {
+        for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+        {
+            SHAPE_POLY_SET poly = zone->GetFilledPolysList( layer );
+
+            poly.Unfracture( SHAPE_POLY_SET::PM_FAST );
+            fractureAndReport( poly, std::string( zone->GetZoneName().mb_str() ) );
+        }
+    }
+
+    total.Show( std::cout );
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "polygon_fracture",
+        "Benchmark SHAPE_POLY_SET::Fracture on heavily holed polygons",
+        polygon_fracture_main,
+} );
@@ -0,0 +1,408 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Headless P&S router benchmark: replays ROUTER_TOOL event logs against their boards, without
+ * any UI or debug decorator, and reports the latency of each event along with the shove
+ * iterations, NODE allocations and memory it took.
+ *
+ * The sessions are given either as log/board file pairs, or as a corpus file listing one
+ * "log board" pair per line (paths relative to the corpus file, '#' starts a comment).  See
+ * qa/data/pns/corpus.txt.
+ *
+ * "-i rtree" or "-i grid" overrides the spatial index of the world, to compare the two.
+ *
+ * "-w serial" walks around obstacles in one winding direction after the other instead of in
+ * both at once, to measure what the concurrent walks gain.
+ *
+ * "-l ms" and "-p nodes" make the run fail if the p99 latency or the peak of live NODEs of all
+ * the sessions exceed these limits.  The qa_pns_replay test only uses "-p": the peak is the same
+ * on every machine, the latency is not.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include <wx/filename.h>
+#include <wx/init.h>
+#include <wx/textfile.h>
+#include <wx/tokenzr.h>
+
+#include <pgm_base.h>
+#include <property_mgr.h>
+
+#include <router/pns_shove.h>
+#include <router/pns_walkaround.h>
+
+#include "pns_log.h"
+
+using namespace PNS;
+
+
+struct REPLAY_SESSION
+{
+    wxString logFile;
+    wxString boardFile;
+};
+
+
+struct REPLAY_STATS
+{
+    REPLAY_STATS() :
+            shoveIterations( 0 ),
+            nodesCreated( 0 ),
+            peakLiveNodes( 0 ),
+            residentGrowthKb( 0 )
+    {}
+
+    void Merge( const REPLAY_STATS& aOther )
+    {
+        latencies.insert( latencies.end(), aOther.latencies.begin(), aOther.latencies.end() );
+        shoveIterations += aOther.shoveIterations;
+        nodesCreated += aOther.nodesCreated;
+        peakLiveNodes = std::max( peakLiveNodes, aOther.peakLiveNodes );
+        residentGrowthKb += aOther.residentGrowthKb;
+    }
+
+    std::vector<double> latencies;      ///< wall time of each event, in milliseconds
+    int64_t             shoveIterations;
+    int64_t             nodesCreated;
+    int64_t             peakLiveNodes;
+    long                residentGrowthKb;
+};
+
+
+/**
+ * @return the resident set size of the process in kB, or 0 if it is not known.
+ */
+static long residentKb()
+{
+#ifdef __linux__
+    long  pages = 0;
+    FILE* f = fopen( "/proc/self/statm", "r" );
+
+    if( !f )
+        return 0;
+
+    if( fscanf( f, "%*ld %ld", &pages ) != 1 )
+        pages = 0;
+
+    fclose( f );
+
+    return pages * ( sysconf( _SC_PAGESIZE ) / 1024 );
+#else
+    return 0;
+#endif
+}
+
+
+/**
+ * @return the \a aFraction percentile of the sorted \a aValues (nearest rank).
+ */
+static double percentile( const std::vector<double>& aValues, double aFraction )
+{
+    if( aValues.empty() )
+        return 0.0;
+
+    size_t rank = (size_t) std::ceil( aFraction * aValues.size() );
+
+    return aValues[ std::min( std::max<size_t>( rank, 1 ), aValues.size() ) - 1 ];
+}
+
+
+static bool replaySession( const REPLAY_SESSION& aSession, int aSpatialIndex,
+                           REPLAY_STATS& aStats )
+{
+    PNS_LOG_FILE log;
+
+    if( !log.Load( (const char*) aSession.logFile.c_str(),
+                   (const char*) aSession.boardFile.c_str() ) )
+    {
+        printf( "failed to load %s / %s\n", (const char*) aSession.logFile.c_str(),
+                (const char*) aSession.boardFile.c_str() );
+        return false;
+    }
+
+    std::unique_ptr<PNS_KICAD_IFACE_BASE> iface( new PNS_KICAD_IFACE_BASE );
+    std::unique_ptr<ROUTER>               router( new ROUTER );
+
+    iface->SetBoard( log.GetBoard().get() );
+    router->SetInterface( iface.get() );
+    router->ClearWorld();
+    router->SetMode( PNS_MODE_ROUTE_SINGLE );
+
+    if( aSpatialIndex >= 0 )
+        log.GetRoutingSettings()->SetSpatialIndex( (PNS_SPATIAL_INDEX) aSpatialIndex );
+
+    // The settings pick the spatial index of the world, so they go first
+    router->LoadSettings( log.GetRoutingSettings() );
+    router->SyncWorld();
+    router->Sizes().SetTrackWidth( 250000 );
+
+    long    residentStart = residentKb();
+    int64_t shoveStart = SHOVE::GetIterationCount();
+    int64_t nodesStart = NODE::GetCreatedCount();
+
+    NODE::ResetPeakLiveCount();
+
+    for( const PNS_LOG_FILE::EVENT_ENTRY& evt : log.Events() )
+    {
+        // Resolving the logged item is part of the replay, not of the routing
+        BOARD_CONNECTED_ITEM* parent = log.ItemById( evt );
+        ITEM*                 item = parent ? router->GetWorld()->FindItemByParent( parent )
+                                            : nullptr;
+
+        auto start = std::chrono::steady_clock::now();
+
+        switch( evt.type )
+        {
+        case LOGGER::EVT_START_ROUTE:
+            router->StartRouting( evt.p, item, item ? item->Layers().Start() : F_Cu );
+            break;
+
+        case LOGGER::EVT_START_DRAG:
+            router->StartDragging( evt.p, item, 0 );
+            break;
+
+        case LOGGER::EVT_FIX:
+            router->FixRoute( evt.p, item );
+            break;
+
+        case LOGGER::EVT_MOVE:
+            router->Move( evt.p, item );
+            break;
+
+        default:
+            break;
+        }
+
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        aStats.latencies.push_back(
+                std::chrono::duration<double, std::milli>( elapsed ).count() );
+    }
+
+    // The peak is tracked by NODE itself, so it includes the branches freed within an event
+    aStats.peakLiveNodes = NODE::GetPeakLiveCount();
+
+    aStats.shoveIterations = SHOVE::GetIterationCount() - shoveStart;
+    aStats.nodesCreated = NODE::GetCreatedCount() - nodesStart;
+    aStats.residentGrowthKb = residentKb() - residentStart;
+
+    router->StopRouting();
+
+    return true;
+}
+
+
+static bool readCorpus( const wxString& aCorpusFile, std::vector<REPLAY_SESSION>& aSessions )
+{
+    wxTextFile corpus( aCorpusFile );
+
+    if( !corpus.Open() )
+    {
+        printf( "failed to open corpus %s\n", (const char*) aCorpusFile.c_str() );
+        return false;
+    }
+
+    wxString baseDir = wxFileName( aCorpusFile ).GetPath();
+
+    for( size_t i = 0; i < corpus.GetLineCount(); i++ )
+    {
+        wxStringTokenizer tokens( corpus[i].BeforeFirst( '#' ) );
+
+        if( tokens.CountTokens() != 2 )
+            continue;
+
+        REPLAY_SESSION session;
+        wxFileName     logFile( tokens.GetNextToken() );
+        wxFileName     boardFile( tokens.GetNextToken() );
+
+        logFile.MakeAbsolute( baseDir );
+        boardFile.MakeAbsolute( baseDir );
+
+        session.logFile = logFile.GetFullPath();
+        session.boardFile = boardFile.GetFullPath();
+        aSessions.push_back( session );
+    }
+
+    return true;
+}
+
+
+static void printStats( const wxString& aName, REPLAY_STATS aStats )
+{
+    std::sort( aStats.latencies.begin(), aStats.latencies.end() );
+
+    printf( "%-32s %7d %9.3f %9.3f %9.3f %9.3f %10lld %8lld %6lld %9ld\n",
+            (const char*) aName.c_str(),
+            (int) aStats.latencies.size(),
+            percentile( aStats.latencies, 0.5 ),
+            percentile( aStats.latencies, 0.9 ),
+            percentile( aStats.latencies, 0.99 ),
+            aStats.latencies.empty() ? 0.0 : aStats.latencies.back(),
+            (long long) aStats.shoveIterations,
+            (long long) aStats.nodesCreated,
+            (long long) aStats.peakLiveNodes,
+            aStats.residentGrowthKb );
+}
+
+
+int main( int argc, char** argv )
+{
+    wxInitialize( argc, argv );
+
+    Pgm().InitPgm( true );
+
+    PROPERTY_MANAGER& propMgr = PROPERTY_MANAGER::Instance();
+    propMgr.Rebuild();
+
+    std::vector<REPLAY_SESSION> sessions;
+    int                         repeat = 1;
+    int                         spatialIndex = -1;    // as logged
+    double                      maxP99 = 0.0;         // no limit
+    int64_t                     maxPeakNodes = 0;     // no limit
+    bool                        ok = true;
+
+    for( int i = 1; i < argc && ok; i++ )
+    {
+        std::string arg( argv[i] );
+
+        if( arg == "-n" && i + 1 < argc )
+        {
+            repeat = std::max( 1, atoi( argv[++i] ) );
+        }
+        else if( arg == "-i" && i + 1 < argc )
+        {
+            std::string index( argv[++i] );
+
+            if( index == "rtree" )
+                spatialIndex = SI_RTREE;
+            else if( index == "grid" )
+                spatialIndex = SI_GRID;
+            else
+                ok = false;
+        }
+        else if( arg == "-w" && i + 1 < argc )
+        {
+            std::string walks( argv[++i] );
+
+            if( walks == "serial" )
+                WALKAROUND::SetParallelWalks( false );
+            else if( walks != "parallel" )
+                ok = false;
+        }
+        else if( arg == "-l" && i + 1 < argc )
+        {
+            maxP99 = atof( argv[++i] );
+        }
+        else if( arg == "-p" && i + 1 < argc )
+        {
+            maxPeakNodes = atoll( argv[++i] );
+        }
+        else if( arg == "-c" && i + 1 < argc )
+        {
+            ok = readCorpus( wxString::FromUTF8( argv[++i] ), sessions );
+        }
+        else if( i + 1 < argc )
+        {
+            sessions.push_back( { wxString::FromUTF8( argv[i] ),
+                                  wxString::FromUTF8( argv[i + 1] ) } );
+            i++;
+        }
+        else
+        {
+            ok = false;
+        }
+    }
+
+    if( !ok || sessions.empty() )
+    {
+        printf( "usage: %s [-n repeat] [-i rtree|grid] [-w serial|parallel] [-l max_p99_ms] "
+                "[-p max_peak_nodes] [-c corpus_file] [log_file board_file]...\n",
+                argv[0] );
+        Pgm().Destroy();
+        wxUninitialize();
+        return -1;
+    }
+
+    printf( "%-32s %7s %9s %9s %9s %9s %10s %8s %6s %9s\n", "session", "events", "p50 ms",
+            "p90 ms", "p99 ms", "max ms", "shove its", "nodes", "peak", "rss kB" );
+
+    REPLAY_STATS total;
+    int          failures = 0;
+
+    for( const REPLAY_SESSION& session : sessions )
+    {
+        REPLAY_STATS sessionStats;
+
+        for( int i = 0; i < repeat; i++ )
+        {
+            REPLAY_STATS stats;
+
+            if( !replaySession( session, spatialIndex, stats ) )
+            {
+                failures++;
+                break;
+            }
+
+            sessionStats.Merge( stats );
+        }
+
+        printStats( wxFileName( session.logFile ).GetName(), sessionStats );
+        total.Merge( sessionStats );
+    }
+
+    printStats( "total", total );
+
+    std::sort( total.latencies.begin(), total.latencies.end() );
+
+    double p99 = percentile( total.latencies, 0.99 );
+
+    if( maxP99 > 0.0 && p99 > maxP99 )
+    {
+        printf( "p99 latency %.3f ms exceeds the limit of %.3f ms\n", p99, maxP99 );
+        failures++;
+    }
+
+    if( maxPeakNodes > 0 && total.peakLiveNodes > maxPeakNodes )
+    {
+        printf( "peak of %lld live nodes exceeds the limit of %lld\n",
+                (long long) total.peakLiveNodes, (long long) maxPeakNodes );
+        failures++;
+    }
+
+    Pgm().Destroy();
+    wxUninitialize();
+
+    return failures ? 1 : 0;
+}